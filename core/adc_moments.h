@@ -0,0 +1,82 @@
+/**
+ * @file adc_moments.h
+ * @brief Single-pass mean/variance of raw ADC blocks (header-only)
+ *
+ * Each block is summed exactly in integers (sum, sum of squares), then
+ * merged into the running moments with Chan's parallel form of Welford's
+ * update:
+ *
+ *   delta = mean_b - mean_a
+ *   mean  = mean_a + delta * n_b / n
+ *   m2    = m2_a + m2_b + delta^2 * n_a * n_b / n
+ *
+ * so one pass gives both the DC midpoint and the AC RMS around it, with
+ * no per-sample divide (RP2040 has no FPU) and no cancellation from a
+ * large DC bias. Blocks can come from analogRead() loops or DMA/FIFO
+ * buffers; samples of several channels may be interleaved (stride).
+ */
+
+#ifndef ADC_MOMENTS_H
+#define ADC_MOMENTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+// Keeps n * sum(x^2) inside uint64 for 16-bit codes
+#define ADC_MOMENTS_MAX_BLOCK 4096
+
+typedef struct {
+    uint32_t n;
+    float mean;
+    float m2;  // Sum of squared deviations from mean
+} adc_moments_t;
+
+static inline void adc_moments_reset(adc_moments_t* m) {
+    m->n = 0;
+    m->mean = 0;
+    m->m2 = 0;
+}
+
+// Adds samples[0], samples[stride], ... (n <= ADC_MOMENTS_MAX_BLOCK)
+static inline void adc_moments_add_block(adc_moments_t* m, const uint16_t* samples,
+                                         size_t n, size_t stride) {
+    if (n == 0) return;
+    uint64_t sum = 0, sum_sq = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = samples[i * stride];
+        sum += x;
+        sum_sq += x * x;
+    }
+    // Exact: n * sum(x^2) - sum^2 = n * m2
+    float mean_b = (float)sum / n;
+    float m2_b = (float)(n * sum_sq - sum * sum) / n;
+
+    if (m->n == 0) {
+        m->n = (uint32_t)n;
+        m->mean = mean_b;
+        m->m2 = m2_b;
+        return;
+    }
+    float na = m->n, nb = (float)n, total = na + nb;
+    float delta = mean_b - m->mean;
+    m->mean += delta * nb / total;
+    m->m2 += m2_b + delta * delta * na * nb / total;
+    m->n += (uint32_t)n;
+}
+
+static inline float adc_moments_mean(const adc_moments_t* m) {
+    return m->mean;
+}
+
+// Population variance (ADC codes^2)
+static inline float adc_moments_variance(const adc_moments_t* m) {
+    return (m->n && m->m2 > 0) ? m->m2 / m->n : 0.0f;
+}
+
+// RMS of the AC part, i.e. around the DC midpoint (ADC codes)
+static inline float adc_moments_rms(const adc_moments_t* m) {
+    return sqrtf(adc_moments_variance(m));
+}
+
+#endif
@@ -48,6 +48,18 @@
 // Schema 4: All features (10D) - Full analysis
 // #define FEATURE_SCHEMA_FFT_CURRENT
 
+// High-rate acquisition: sample the accelerometer on the second core at
+// ACQ_SAMPLE_HZ and compute one feature vector per window (sample_pipeline.h).
+// Leave undefined to poll at 10 Hz in loop().
+// #define ACQ_SAMPLE_HZ 1000             // ESP32: <= 1000 (tick-paced); RP2040: up to ~4000
+// #define FEATURE_WINDOW_SAMPLES 256     // Samples per feature vector (>= FFT_SAMPLES)
+// #define FEATURE_HOP_SAMPLES 100        // New vector every hop samples (default: 10/s)
+// #define ACQ_RING_SAMPLES 512           // Power of 2
+
+// FFT options (schemas 3 and 4)
+// #define FFT_FIXED_POINT          // Q15 kernel instead of float (no-FPU MCUs, e.g. RP2040)
+// #define FFT_SAMPLE_FREQ 10.0     // Hz, must match the sampling loop (default: ACQ_SAMPLE_HZ, else 1000)
+
 // =============================================================================
 // SENSOR SELECTION
 // =============================================================================
@@ -72,6 +84,29 @@
 #define MQTT_USER ""
 #define MQTT_PASS ""
 
+// Binary telemetry (docs/MQTT_SCHEMA.md, "Binary Telemetry"): also publish
+// each summary as a ~50-byte frame on sensor/{id}/bin
+// #define TELEMETRY_BINARY
+// #define TELEMETRY_BINARY_ONLY      // ...and stop publishing JSON on sensor/{id}/data
+
+// Raw feature streaming: every feature vector with its cluster and distance,
+// STREAM_BATCH per binary frame on sensor/{id}/stream (same framing as /bin).
+// While disconnected, up to STREAM_QUEUE_FRAMES frames wait in RAM; beyond
+// that the oldest frame is dropped (seq gaps show how many) or, with
+// OFFLINE_QUEUE, moved to flash.
+// #define STREAM_FEATURES
+// #define STREAM_BATCH 20
+// #define STREAM_QUEUE_FRAMES 8
+// #define STREAM_MAX_AGE_MS 10000
+
+// Store-and-forward: messages that cannot be published (broker or WiFi down)
+// go to a flash log (/offline.q on LittleFS) and are replayed on reconnect.
+// Oldest messages are dropped when it is full. With STREAM_FEATURES, stream
+// frames evicted from RAM are kept here too instead of being dropped.
+// #define OFFLINE_QUEUE
+// #define OFFLINE_QUEUE_SECTORS 64        // x 4 KB
+// #define OFFLINE_DRAIN_PER_SEC 10        // Replay rate, messages/s
+
 // =============================================================================
 // DEVICE IDENTITY
 // =============================================================================
@@ -85,6 +120,13 @@
 #define SAMPLE_RATE_HZ 10
 #define OUTLIER_THRESHOLD 2.0f
 #define LEARNING_RATE 0.2f
+#define ANOMALY_WINDOW_SAMPLES 100   // Ring buffer rows captured per anomaly (>= 50)
+
+// Model persistence: labels and retraining are journaled as small records
+// in /model.j (model_storage.h). Set MODEL_CHECKPOINT_MS to also log the
+// clusters that drifted through online learning, at most that often.
+// #define MODEL_CHECKPOINT_MS 600000     // 10 min
+// #define MODEL_JOURNAL_SECTORS 16       // x 4 KB
 
 // =============================================================================
 // CURRENT SENSOR CALIBRATION (if using FEATURE_SCHEMA_*_CURRENT)
@@ -15,8 +15,13 @@
 #include "streaming_kmeans.h"
 #include "feature_extractor.h"
 #include "model_storage.h"  // NEW: Persistence
+#include "window_stats.h"
 #include <Wire.h>
 
+#ifdef ACQ_SAMPLE_HZ
+  #include "sample_pipeline.h"
+#endif
+
 #ifndef LED_BUILTIN
   #if defined(ESP32)
     #define LED_BUILTIN 2
@@ -44,7 +49,20 @@
 
 #ifdef HAS_WIFI
   #include <PubSubClient.h>
-  #include <ArduinoJson.h>
+  #include "mqtt_codec.h"  // Allocation-free JSON for MQTT_SCHEMA v2
+  #if defined(TELEMETRY_BINARY_ONLY) && !defined(TELEMETRY_BINARY)
+    #define TELEMETRY_BINARY
+  #endif
+  #ifdef TELEMETRY_BINARY
+    #include "telemetry.h"   // Compact binary frames on sensor/{id}/bin
+  #endif
+  #ifdef STREAM_FEATURES
+    #include "feature_stream.h"  // Every feature vector, batched, on sensor/{id}/stream
+  #endif
+  #ifdef OFFLINE_QUEUE
+    #include "offline_queue.h"    // Store-and-forward while the broker is unreachable
+    #include "flash_region_fs.h"
+  #endif
   #ifdef ESP32
     #include <WiFi.h>
   #else
@@ -56,8 +74,19 @@
 // Globals
 // =============================================================================
 
-kmeans_model_t model;
+#ifndef ANOMALY_WINDOW_SAMPLES
+  #define ANOMALY_WINDOW_SAMPLES RING_BUFFER_SIZE
+#endif
+
+// Model header only (no MAX_* embedded block); clusters, centroids and
+// anomaly window live in model_memory, sized to this build's schema
+static kmeans_model_header_t model_header;
+kmeans_model_t& model = *kmeans_model_of(&model_header);
+static uint64_t model_memory[KMEANS_STORAGE_SIZE(MAX_CLUSTERS, FEATURE_DIM, ANOMALY_WINDOW_SAMPLES) / 8];
 ModelStorage storage;  // NEW: Persistence handler
+// Scratch for the warm-restart copy of the runtime state (ModelStorage::saveState)
+static uint8_t stateBuffer[KMEANS_STATE_MAX_SIZE(MAX_CLUSTERS, FEATURE_DIM, ANOMALY_WINDOW_SAMPLES)];
+bool stateSaved = false;  // /state.bin holds the current WAITING_LABEL
 
 #ifdef USE_CURRENT
   CurrentSensor currentSensor;
@@ -72,13 +101,115 @@ ModelStorage storage;  // NEW: Persistence handler
   char topic_freeze[64];
   char topic_reset[64];
   char topic_assign[64];  // NEW: Assign to existing cluster
+  char topic_export[64];
+  char topic_model[64];
+  static_assert(MODEL_FILE_MAX_SIZE(MAX_CLUSTERS, FEATURE_DIM) <= 2048 - 128,
+                "Model files exceed the MQTT buffer");
+  #ifdef TELEMETRY_BINARY
+  char topic_bin[64];
+  uint16_t telemetrySeq = 0;
+  #endif
   unsigned long lastMqttAttempt = 0;
+
+  #ifdef STREAM_FEATURES
+    #ifndef STREAM_BATCH
+      #define STREAM_BATCH 20             // Vectors per frame
+    #endif
+    #ifndef STREAM_QUEUE_FRAMES
+      #define STREAM_QUEUE_FRAMES 8       // Sealed frames held while the broker is away
+    #endif
+    #ifndef STREAM_MAX_AGE_MS
+      #define STREAM_MAX_AGE_MS 10000     // Partial batches go out at least this often
+    #endif
+    #ifndef STREAM_FRAMES_PER_LOOP
+      #define STREAM_FRAMES_PER_LOOP 2
+    #endif
+    static_assert(TELEMETRY_BATCH_SIZE(FEATURE_DIM, STREAM_BATCH) <= 2048 - 128,
+                  "STREAM_BATCH frames exceed the MQTT buffer");
+  char topic_stream[64];
+  static uint64_t stream_memory[FEATURE_STREAM_STORAGE_SIZE(FEATURE_DIM, STREAM_BATCH, STREAM_QUEUE_FRAMES) / 8];
+  feature_stream_t featureStream;
+  unsigned long lastStreamSeal = 0;
+
+  // Refused while disconnected: the frame stays queued (oldest dropped when full)
+  static bool streamSend(const uint8_t* frame, size_t len, void* ctx) {
+    (void)ctx;
+    return mqtt.connected() && mqtt.publish(topic_stream, frame, len);
+  }
+  #endif
+
+  enum { OFFLINE_DATA = 1, OFFLINE_BIN = 2, OFFLINE_STREAM = 3 };  // Queued record type = topic
+
+  #ifdef OFFLINE_QUEUE
+    #ifndef OFFLINE_QUEUE_SECTORS
+      #define OFFLINE_QUEUE_SECTORS 64          // x 4 KB = 256 KB of LittleFS
+    #endif
+    #ifndef OFFLINE_DRAIN_PER_SEC
+      #define OFFLINE_DRAIN_PER_SEC 10          // Backlog replay rate after reconnect
+    #endif
+    #define OFFLINE_QUEUE_SECTOR_SIZE 4096
+    #define OFFLINE_QUEUE_FILE "/offline.q"
+  FsFlashRegion offlineFlash;
+  offline_queue_t offlineQueue;
+  bool offlineReady = false;
+  unsigned long lastDrain = 0;
+
+  static bool offlineSend(uint8_t type, const uint8_t* data, uint16_t len, void* ctx) {
+    (void)ctx;
+    if (!mqtt.connected()) return false;
+    switch (type) {
+      case OFFLINE_DATA:   return mqtt.publish(topic_data, data, len);
+      #ifdef TELEMETRY_BINARY
+      case OFFLINE_BIN:    return mqtt.publish(topic_bin, data, len);
+      #endif
+      #ifdef STREAM_FEATURES
+      case OFFLINE_STREAM: return mqtt.publish(topic_stream, data, len);
+      #endif
+      default:             return true;  // Topic no longer enabled: drop it
+    }
+  }
+
+  #ifdef STREAM_FEATURES
+  // Stream frames evicted from RAM go to flash; offlineSend replays them
+  static bool streamSpill(const uint8_t* frame, size_t len, void* ctx) {
+    (void)ctx;
+    return offlineReady && offline_queue_push(&offlineQueue, OFFLINE_STREAM, frame, (uint16_t)len);
+  }
+  static const feature_stream_spill_t streamSpillStore = {streamSpill, NULL, NULL, NULL};
+  #endif
+  #endif
+
+  // Publish now, or keep it for later (OFFLINE_QUEUE) if the broker is away
+  static bool deliver(uint8_t type, const char* topic, const uint8_t* data, size_t len) {
+    if (mqtt.connected() && mqtt.publish(topic, data, len)) return true;
+    #ifdef OFFLINE_QUEUE
+      if (offlineReady && offline_queue_push(&offlineQueue, type, data, (uint16_t)len)) {
+        Serial.printf("[MQTT] Offline, queued %s (%lu waiting)\n", topic,
+                      (unsigned long)offline_queue_count(&offlineQueue));
+        return false;
+      }
+    #else
+      (void)type;
+    #endif
+    Serial.printf("[MQTT] Not connected, dropped %s\n", topic);
+    return false;
+  }
 #endif
 
+// Raw feature vector out to the stream topic (no-op unless STREAM_FEATURES)
+static inline void streamVector(const float* features, int32_t cluster, float distance) {
+  #if defined(HAS_WIFI) && defined(STREAM_FEATURES)
+    feature_stream_add(&featureStream, millis(), cluster, distance, features);
+  #else
+    (void)features; (void)cluster; (void)distance;
+  #endif
+}
+
 // Windowing for Statistics (Averaging before publish)
+// Summaries are kept incrementally, so publishing never rescans the window
 const int WINDOW_SIZE = 100; // 100 samples @ 10Hz = 10 seconds
-float window_features[WINDOW_SIZE][FEATURE_DIM];
-int window_idx = 0;
+static uint64_t window_memory[WINDOW_STATS_STORAGE_SIZE(FEATURE_DIM, WINDOW_SIZE) / 8];
+window_stats_t windowStats;
 
 // Timing
 const int SAMPLE_MS = 100;    // 10 Hz sampling
@@ -88,12 +219,120 @@ const int WINDOW_SETTLE = 50;  // Skip first 50 samples (5s warmup)
 unsigned long lastSample = 0;
 unsigned long lastPublish = 0;
 unsigned long lastDebug = 0;
+#ifdef MODEL_CHECKPOINT_MS
+unsigned long lastCheckpoint = 0;
+#endif
 
 // Instantaneous stats for debug
 float lastRawAx = 0, lastRawAy = 0, lastRawAz = 0;
 float lastRms = 0, lastPeak = 0, lastCrest = 0;
 int sampleCount = 0;
 
+// =============================================================================
+// High-rate acquisition pipeline (ACQ_SAMPLE_HZ in config.h)
+// =============================================================================
+// acquisition (other core) -> SPSC ring -> gravity filter -> window
+// -> features once per hop -> kmeans. Without ACQ_SAMPLE_HZ, loop() polls
+// the accelerometer at SAMPLE_MS as before.
+
+#ifdef ACQ_SAMPLE_HZ
+  #ifndef ACQ_RING_SAMPLES
+    #define ACQ_RING_SAMPLES 512          // Power of 2; absorbs loop() stalls
+  #endif
+  #ifndef FEATURE_WINDOW_SAMPLES
+    #define FEATURE_WINDOW_SAMPLES 256    // Samples per feature vector
+  #endif
+  #ifndef FEATURE_HOP_SAMPLES
+    #define FEATURE_HOP_SAMPLES (ACQ_SAMPLE_HZ / 10)  // 10 vectors/s, like SAMPLE_MS
+  #endif
+  #if !defined(ESP32) && !defined(ARDUINO_ARCH_RP2040)
+    #error "ACQ_SAMPLE_HZ needs a second core (ESP32 or RP2040/RP2350)"
+  #endif
+  #if defined(USE_FFT) && FEATURE_WINDOW_SAMPLES < FFT_SAMPLES
+    #error "FEATURE_WINDOW_SAMPLES must be >= FFT_SAMPLES"
+  #endif
+
+  static accel_sample_t accelSlots[ACQ_RING_SAMPLES];
+  static spsc_ring_t accelRing;
+  static float windowFrame[FEATURE_WINDOW_SAMPLES];
+  static float windowOrdered[FEATURE_WINDOW_SAMPLES];
+  static sample_window_t featureWindow;
+  static volatile bool acqRunning = false;
+#endif
+
+// Only the acquisition side touches the accelerometer once running
+static void readAccel(float* ax, float* ay, float* az) {
+  #ifdef SENSOR_ACCEL_MPU6050
+    sensors_event_t a, g, temp;
+    mpu.getEvent(&a, &g, &temp);
+    *ax = a.acceleration.x;
+    *ay = a.acceleration.y;
+    *az = a.acceleration.z;
+  #endif
+  #ifdef SENSOR_ACCEL_ADXL345
+    sensors_event_t event;
+    accel.getEvent(&event);
+    *ax = event.acceleration.x;
+    *ay = event.acceleration.y;
+    *az = event.acceleration.z;
+  #endif
+}
+
+#ifdef ACQ_SAMPLE_HZ
+static void acquireSample() {
+  accel_sample_t s;
+  readAccel(&s.x, &s.y, &s.z);
+  spsc_push(&accelRing, &s);  // Full ring: counted in accelRing.dropped
+}
+
+#if defined(ESP32)
+// FreeRTOS task on core 0 (loop() runs on core 1). Tick-paced, so the
+// achievable rate is capped at configTICK_RATE_HZ (1 kHz on Arduino-ESP32).
+static void acquisitionTask(void*) {
+  const TickType_t period = (configTICK_RATE_HZ / ACQ_SAMPLE_HZ) > 0
+                            ? (configTICK_RATE_HZ / ACQ_SAMPLE_HZ) : 1;
+  TickType_t last = xTaskGetTickCount();
+  for (;;) {
+    acquireSample();
+    vTaskDelayUntil(&last, period);
+  }
+}
+#elif defined(ARDUINO_ARCH_RP2040)
+// Core 1 (arduino-pico), paced on micros(); up to ~4 kHz with a 400 kHz bus
+void loop1() {
+  static uint32_t next = 0;
+  if (!acqRunning) { next = micros(); return; }
+  if ((int32_t)(micros() - next) < 0) return;
+  next += 1000000UL / ACQ_SAMPLE_HZ;
+  if ((int32_t)(micros() - next) > 0) next = micros();  // Fell behind: resync, don't burst
+  acquireSample();
+}
+#endif
+
+static void startAcquisition() {
+  spsc_init(&accelRing, accelSlots, ACQ_RING_SAMPLES);
+  window_init(&featureWindow, windowFrame, FEATURE_WINDOW_SAMPLES, FEATURE_HOP_SAMPLES);
+  Wire.setClock(400000);
+  acqRunning = true;
+  #if defined(ESP32)
+    xTaskCreatePinnedToCore(acquisitionTask, "acq", 4096, NULL, 5, NULL, 0);
+  #endif
+  Serial.printf("[Acq] %d Hz, window %d, hop %d, ring %d\n", ACQ_SAMPLE_HZ,
+                FEATURE_WINDOW_SAMPLES, FEATURE_HOP_SAMPLES, ACQ_RING_SAMPLES);
+}
+
+// Feature stage: drain the ring until one window completes
+static bool drainAcquisition() {
+  accel_sample_t s;
+  while (spsc_pop(&accelRing, &s)) {
+    lastRawAx = s.x; lastRawAy = s.y; lastRawAz = s.z;
+    float ac = FeatureExtractor::filterSample(s.x, s.y, s.z);
+    if (window_push(&featureWindow, ac)) return true;  // Rest waits for next loop()
+  }
+  return false;
+}
+#endif
+
 // =============================================================================
 // Setup
 // =============================================================================
@@ -113,7 +352,8 @@ void setup() {
   #endif
   
   Serial.printf("Features: %dD\n", FEATURE_DIM);
-  Serial.printf("Model size: %d bytes\n", sizeof(kmeans_model_t));
+  Serial.printf("Model size: %d bytes (%d-sample window)\n",
+                (int)(sizeof(model_header) + sizeof(model_memory)), ANOMALY_WINDOW_SAMPLES);
   
   pinMode(LED_BUILTIN, OUTPUT);
 
@@ -167,11 +407,31 @@ void setup() {
 
   // Model initialization with persistence
   Serial.print("[Model] Initializing... ");
-  if (!kmeans_init(&model, FEATURE_DIM, LEARNING_RATE)) {
+  if (!kmeans_init_with_storage(&model, FEATURE_DIM, LEARNING_RATE, MAX_CLUSTERS,
+                                ANOMALY_WINDOW_SAMPLES, model_memory, sizeof(model_memory))) {
     Serial.println("FAILED!");
     while (1) delay(1000);
   }
   Serial.printf("OK (K=%d)\n", model.k);
+  window_stats_init(&windowStats, FEATURE_DIM, WINDOW_SIZE, window_memory, sizeof(window_memory));
+  #if defined(HAS_WIFI) && defined(STREAM_FEATURES)
+    feature_stream_init(&featureStream, FEATURE_DIM, STREAM_BATCH, STREAM_QUEUE_FRAMES,
+                        stream_memory, sizeof(stream_memory));
+    feature_stream_set_transport(&featureStream, streamSend, NULL);
+  #endif
+  #if defined(HAS_WIFI) && defined(OFFLINE_QUEUE)
+    Serial.print("[Offline] Mounting queue... ");
+    offlineReady = offlineFlash.begin(OFFLINE_QUEUE_FILE, OFFLINE_QUEUE_SECTORS, OFFLINE_QUEUE_SECTOR_SIZE) &&
+                   offline_queue_mount(&offlineQueue, offlineFlash.region());
+    if (offlineReady) {
+      Serial.printf("OK (%lu waiting)\n", (unsigned long)offline_queue_count(&offlineQueue));
+    } else {
+      Serial.println("FAILED (publishing live only)");
+    }
+    #ifdef STREAM_FEATURES
+      feature_stream_set_spill(&featureStream, &streamSpillStore);
+    #endif
+  #endif
 
   // NEW: Try to load saved model
   if (storage.hasModel()) {
@@ -185,6 +445,11 @@ void setup() {
         Serial.printf("  C%d: \"%s\" (%lu samples)\n", 
                       i, label, model.clusters[i].count);
       }
+      if (storage.restoreState(&model, stateBuffer, sizeof(stateBuffer))) {
+        stateSaved = kmeans_is_waiting_label(&model);
+        Serial.printf("[Model] ✓ Warm restart: state %d, %d buffered samples\n",
+                      model.state, model.buffer.count);
+      }
     } else {
       Serial.println("[Model] Load failed, using fresh model");
     }
@@ -214,6 +479,14 @@ void setup() {
       snprintf(topic_freeze, sizeof(topic_freeze), "tinyol/%s/freeze", DEVICE_ID);
       snprintf(topic_reset, sizeof(topic_reset), "tinyol/%s/reset", DEVICE_ID);
       snprintf(topic_assign, sizeof(topic_assign), "tinyol/%s/assign", DEVICE_ID);
+      snprintf(topic_export, sizeof(topic_export), "tinyol/%s/export", DEVICE_ID);
+      snprintf(topic_model, sizeof(topic_model), "sensor/%s/model", DEVICE_ID);
+      #ifdef TELEMETRY_BINARY
+      snprintf(topic_bin, sizeof(topic_bin), "sensor/%s/bin", DEVICE_ID);
+      #endif
+      #ifdef STREAM_FEATURES
+      snprintf(topic_stream, sizeof(topic_stream), "sensor/%s/stream", DEVICE_ID);
+      #endif
       
       Serial.println("[MQTT] Topics Configured:");
       Serial.printf("  DATA:    %s\n", topic_data);
@@ -221,11 +494,22 @@ void setup() {
       Serial.printf("  DISCARD: %s\n", topic_discard);
       Serial.printf("  RESET:   %s\n", topic_reset);
       Serial.printf("  ASSIGN:  %s\n", topic_assign);
+      Serial.printf("  EXPORT:  %s -> %s\n", topic_export, topic_model);
+      #ifdef TELEMETRY_BINARY
+      Serial.printf("  BINARY:  %s\n", topic_bin);
+      #endif
+      #ifdef STREAM_FEATURES
+      Serial.printf("  STREAM:  %s\n", topic_stream);
+      #endif
     } else {
       Serial.println(" FAILED");
     }
   #endif
 
+  #ifdef ACQ_SAMPLE_HZ
+    startAcquisition();
+  #endif
+
   Serial.println("\n=== READY ===\n");
   Serial.println("Commands via MQTT:");
   Serial.println("  label:   {\"label\":\"fault_name\"}  - Create NEW cluster K++");
@@ -233,6 +517,7 @@ void setup() {
   Serial.println("  discard: {\"discard\":true}         - Discard alarm");
   Serial.println("  freeze:  {\"freeze\":true}          - Manual freeze");
   Serial.println("  reset:   {\"reset\":true}           - Reset model to K=1");
+  Serial.println("  export:  {\"export\":true}          - Publish the model file (v2)");
   Serial.println("");
 }
 
@@ -246,20 +531,20 @@ void mqttCallback(char* topic, byte* payload, unsigned int len) {
   
   // Print raw payload for debug
   char payloadStr[256];
-  len = min(len, (unsigned int)255);
-  memcpy(payloadStr, payload, len);
-  payloadStr[len] = '\0';
+  unsigned int printLen = min(len, (unsigned int)255);
+  memcpy(payloadStr, payload, printLen);
+  payloadStr[printLen] = '\0';
   Serial.println(payloadStr);
   
-  JsonDocument doc;
-  if (deserializeJson(doc, payload, len)) {
+  mqtt_command_t cmd;
+  if (!mqtt_decode_command((const char*)payload, len, &cmd)) {
     Serial.println("[MQTT] JSON parse error");
     return;
   }
   
   // Handle LABEL command
   if (strstr(topic, "/label")) {
-    const char* label = doc["label"];
+    const char* label = cmd.has_label ? cmd.label : NULL;
     
     if (!label || strlen(label) == 0) {
       Serial.println("[MQTT] Empty label - ignored");
@@ -272,7 +557,7 @@ void mqttCallback(char* topic, byte* payload, unsigned int len) {
     if (strcmp(label, "normal") == 0 && model.k > 0) {
       Serial.println("[MQTT] Retraining 'normal' cluster 0");
       if (kmeans_assign_existing(&model, 0)) {
-        storage.save(&model);
+        storage.saveCentroid(&model, 0);
         Serial.printf("[MQTT] ✓ Retrained cluster 0 with %d samples\n", model.buffer.count);
       }
       return;
@@ -299,7 +584,8 @@ void mqttCallback(char* topic, byte* payload, unsigned int len) {
     }
     
     if (success) {
-      storage.save(&model);
+      if (existing >= 0) storage.saveCentroid(&model, (uint8_t)existing);
+      else storage.saveCluster(&model, model.k - 1);
       for(int i=0; i<3; i++) { 
         digitalWrite(LED_BUILTIN, HIGH); delay(50); 
         digitalWrite(LED_BUILTIN, LOW); delay(50); 
@@ -310,7 +596,7 @@ void mqttCallback(char* topic, byte* payload, unsigned int len) {
   
   // Handle DISCARD command
   if (strstr(topic, "/discard")) {
-    if (doc["discard"] == true) {
+    if (cmd.has_discard && cmd.discard) {
       Serial.println("[MQTT] Discard command");
       kmeans_discard(&model);
       Serial.println("[MQTT] ✓ Discarded");
@@ -321,7 +607,7 @@ void mqttCallback(char* topic, byte* payload, unsigned int len) {
   
   // Handle FREEZE command
   if (strstr(topic, "/freeze")) {
-    if (doc["freeze"] == true) {
+    if (cmd.has_freeze && cmd.freeze) {
       Serial.println("[MQTT] Freeze command");
       kmeans_request_label(&model);
       Serial.println("[MQTT] ✓ Frozen");
@@ -332,7 +618,7 @@ void mqttCallback(char* topic, byte* payload, unsigned int len) {
   
   // Handle RESET command
   if (strstr(topic, "/reset")) {
-    if (doc["reset"] == true) {
+    if (cmd.has_reset && cmd.reset) {
       Serial.println("[MQTT] *** RESET ***");
       storage.clear();
       kmeans_reset(&model);
@@ -348,11 +634,12 @@ void mqttCallback(char* topic, byte* payload, unsigned int len) {
   
   // Handle ASSIGN command
   if (strstr(topic, "/assign")) {
-    if (doc.containsKey("cluster_id")) {
-      uint8_t cid = doc["cluster_id"];
+    // Negative ids are our own "cleared" echo ({"cluster_id":-1})
+    if (cmd.has_cluster_id && cmd.cluster_id >= 0 && cmd.cluster_id <= 255) {
+      uint8_t cid = (uint8_t)cmd.cluster_id;
       Serial.printf("[MQTT] Assign to cluster %d\n", cid);
       if (kmeans_assign_existing(&model, cid)) {
-        storage.save(&model);
+        storage.saveCentroid(&model, cid);
         Serial.println("[MQTT] ✓ Assigned");
         mqtt.publish(topic_assign, "{\"cluster_id\":-1}");
       } else {
@@ -362,6 +649,21 @@ void mqttCallback(char* topic, byte* payload, unsigned int len) {
     return;
   }
   
+  // Handle EXPORT command: the model as one v2 file (model_file.h)
+  if (strstr(topic, "/export")) {
+    if (cmd.has_export && cmd.export_model) {
+      static uint8_t file[MODEL_FILE_MAX_SIZE(MAX_CLUSTERS, FEATURE_DIM)];
+      size_t n = model_file_write(&model, file, sizeof(file));
+      if (n && mqtt.publish(topic_model, file, n)) {
+        Serial.printf("[MQTT] ✓ Exported K=%d (%u bytes)\n", model.k, (unsigned)n);
+        mqtt.publish(topic_export, "{\"export\":false}");
+      } else {
+        Serial.println("[MQTT] ✗ Export failed");
+      }
+    }
+    return;
+  }
+  
   Serial.println("[MQTT] Unknown topic");
 }
 
@@ -390,6 +692,7 @@ bool mqttConnect() {
     mqtt.subscribe(topic_freeze, 1);
     mqtt.subscribe(topic_reset, 1);
     mqtt.subscribe(topic_assign, 1);
+    mqtt.subscribe(topic_export, 1);
     
     Serial.println("[MQTT] Subscribed to all control topics");
     return true;
@@ -412,11 +715,6 @@ void safePublish(const char* topic, const char* payload) {
 }
 
 void publishSummary() {
-  if (!mqtt.connected()) {
-    Serial.println("[MQTT] Not connected, skipping publish");
-    return;
-  }
-
   // --- STATE STRING (handle all states) ---
   system_state_t state = kmeans_get_state(&model);
   const char* stateStr;
@@ -428,34 +726,6 @@ void publishSummary() {
     default:                 stateStr = "UNKNOWN"; break;
   }
 
-  // --- COMPUTE STATISTICS ---
-  float vib_rms_sum = 0, vib_rms_max = 0;
-  float vib_peak_sum = 0, vib_peak_max = 0;
-  float vib_crest_sum = 0, vib_crest_max = 0;
-  #ifdef USE_CURRENT
-  float i_rms_sum = 0, i_rms_max = 0;
-  #endif
-
-  int n = (window_idx > 0) ? window_idx : WINDOW_SIZE;
-  int limit = (sampleCount < WINDOW_SIZE) ? sampleCount : n;
-  if (limit == 0) limit = 1;
-
-  for (int i = 0; i < limit; i++) {
-    vib_rms_sum += window_features[i][0];
-    vib_peak_sum += window_features[i][1];
-    vib_crest_sum += window_features[i][2];
-    
-    if (window_features[i][0] > vib_rms_max) vib_rms_max = window_features[i][0];
-    if (window_features[i][1] > vib_peak_max) vib_peak_max = window_features[i][1];
-    if (window_features[i][2] > vib_crest_max) vib_crest_max = window_features[i][2];
-    
-    #ifdef USE_CURRENT
-    float i_val = window_features[i][FEATURE_DIM-1]; 
-    i_rms_sum += i_val;
-    if (i_val > i_rms_max) i_rms_max = i_val;
-    #endif
-  }
-
   // --- BOOLEAN FLAGS (derived from state, not separate) ---
   bool isAlarm = (state == STATE_ALARM) || (state == STATE_WAITING_LABEL);
   bool isWaiting = (state == STATE_WAITING_LABEL);
@@ -469,44 +739,61 @@ void publishSummary() {
     kmeans_get_label(&model, 0, currentLabel);
   }
   
-  // --- BUILD JSON ---
-  JsonDocument doc;
-  doc["device_id"] = DEVICE_ID;
-  doc["state"] = stateStr;
-  doc["alarm_active"] = isAlarm;
-  doc["waiting_label"] = isWaiting;
-  doc["motor_running"] = kmeans_is_motor_running(&model);
+  // --- BUILD JSON (written straight into buf, no document) ---
+  mqtt_summary_t summary = {};
+  summary.device_id = DEVICE_ID;
+  summary.state = stateStr;
+  summary.alarm_active = isAlarm;
+  summary.waiting_label = isWaiting;
+  summary.motor_running = kmeans_is_motor_running(&model);
   
-  doc["cluster"] = currentCluster;
-  doc["label"] = currentLabel;
-  doc["k"] = model.k;
-  doc["total_points"] = model.total_points;
+  summary.cluster = currentCluster;
+  summary.label = currentLabel;
+  summary.k = model.k;
+  summary.total_points = model.total_points;
   
-  doc["vib_rms_avg"] = vib_rms_sum / limit;
-  doc["vib_rms_max"] = vib_rms_max;
-  doc["vib_peak_max"] = vib_peak_max;
-  doc["vib_crest_avg"] = vib_crest_sum / limit;
+  // Last WINDOW_SIZE vectors (fewer until the window fills)
+  summary.vib_rms_avg = window_stats_mean(&windowStats, 0);
+  summary.vib_rms_max = window_stats_max(&windowStats, 0);
+  summary.vib_peak_max = window_stats_max(&windowStats, 1);
+  summary.vib_crest_avg = window_stats_mean(&windowStats, 2);
   
   #ifdef USE_CURRENT
-  doc["current_rms_avg"] = i_rms_sum / limit;
-  doc["current_rms_max"] = i_rms_max;
+  summary.has_current = true;
+  summary.current_rms_avg = window_stats_mean(&windowStats, FEATURE_DIM - 1);
+  summary.current_rms_max = window_stats_max(&windowStats, FEATURE_DIM - 1);
   #endif
 
-  doc["baseline"] = FeatureExtractor::getBaseline();
-  doc["buffer_samples"] = kmeans_get_buffer_size(&model);
-  doc["sample_count"] = limit;
-  doc["timestamp"] = millis();
+  summary.baseline = FeatureExtractor::getBaseline();
+  summary.buffer_samples = kmeans_get_buffer_size(&model);
+  summary.sample_count = window_stats_count(&windowStats);
+  summary.timestamp = millis();
 
-  char buf[1024];
-  size_t len = serializeJson(doc, buf);
+  #ifdef TELEMETRY_BINARY
+  uint8_t frame[128];  // ~50 bytes typical
+  size_t frameLen = telemetry_encode_summary(&summary, telemetrySeq++, frame, sizeof(frame));
+  if (frameLen == 0) {
+    Serial.println("[MQTT] ✗ Binary summary does not fit buffer");
+  } else {
+    Serial.printf("[MQTT] >> %s (%d bytes)\n", topic_bin, frameLen);
+    deliver(OFFLINE_BIN, topic_bin, frame, frameLen);
+  }
+  #endif
+
+  #ifndef TELEMETRY_BINARY_ONLY
+  char buf[768];  // ~360 bytes typical; room for long ids/labels
+  size_t len = mqtt_encode_summary(&summary, buf, sizeof(buf));
+  if (len == 0) {
+    Serial.println("[MQTT] ✗ Summary does not fit buffer");
+    return;
+  }
   
   Serial.printf("[MQTT] >> %s (%d bytes)\n", topic_data, len);
 
-  if (mqtt.publish(topic_data, buf)) {
+  if (deliver(OFFLINE_DATA, topic_data, (const uint8_t*)buf, len)) {
     Serial.println("[MQTT] ✓ Published");
-  } else {
-    Serial.println("[MQTT] ✗ Publish failed");
   }
+  #endif
 }
 #endif
 
@@ -556,6 +843,28 @@ void loop() {
     }
     mqtt.loop();
 
+    #ifdef OFFLINE_QUEUE
+      // Replay the backlog at OFFLINE_DRAIN_PER_SEC, oldest first
+      bool backlog = offlineReady && offline_queue_count(&offlineQueue) > 0;
+      if (backlog && mqtt.connected() && now - lastDrain >= 1000 / OFFLINE_DRAIN_PER_SEC) {
+        lastDrain = now;
+        static uint8_t drainBuf[OFFLINE_QUEUE_MAX_PAYLOAD(OFFLINE_QUEUE_SECTOR_SIZE)];
+        offline_queue_drain(&offlineQueue, offlineSend, NULL, drainBuf, sizeof(drainBuf), 1);
+        if (offline_queue_count(&offlineQueue) == 0) Serial.println("[Offline] Backlog delivered");
+      }
+    #else
+      bool backlog = false;
+    #endif
+
+    #ifdef STREAM_FEATURES
+      if (now - lastStreamSeal >= STREAM_MAX_AGE_MS) {
+        lastStreamSeal = now;
+        feature_stream_seal(&featureStream);
+      }
+      // Spilled frames are in the backlog: RAM frames wait so order holds
+      if (!backlog) feature_stream_poll(&featureStream, STREAM_FRAMES_PER_LOOP);
+    #endif
+
     static unsigned long lastMqttCheck = 0;
     if (now - lastMqttCheck >= 5000) {
       lastMqttCheck = now;
@@ -565,49 +874,67 @@ void loop() {
     }
   #endif
 
-  // Sample at 10 Hz
-  if (now - lastSample < SAMPLE_MS) return;
-  lastSample = now;
-  sampleCount++;
-
-  // Read accelerometer
-  float ax, ay, az;
-  #ifdef SENSOR_ACCEL_MPU6050
-    sensors_event_t a, g, temp;
-    mpu.getEvent(&a, &g, &temp);
-    ax = a.acceleration.x;
-    ay = a.acceleration.y;
-    az = a.acceleration.z;
-  #endif
-  #ifdef SENSOR_ACCEL_ADXL345
-    sensors_event_t event;
-    accel.getEvent(&event);
-    ax = event.acceleration.x;
-    ay = event.acceleration.y;
-    az = event.acceleration.z;
+  #ifdef MODEL_CHECKPOINT_MS
+    if (now - lastCheckpoint >= MODEL_CHECKPOINT_MS) {
+      lastCheckpoint = now;
+      uint8_t logged = storage.checkpoint(&model);
+      if (logged) Serial.printf("[Storage] Checkpoint: %d clusters\n", logged);
+    }
   #endif
-  
-  lastRawAx = ax; lastRawAy = ay; lastRawAz = az;
 
-  // Read current
-  float i1 = 0, i2 = 0, i3 = 0;
-  #ifdef USE_CURRENT
-    currentSensor.read(&i1, &i2, &i3);
-  #endif
+  // A sample waiting for its label survives a reboot
+  bool waiting = kmeans_is_waiting_label(&model);
+  if (waiting != stateSaved) {
+    if (waiting) storage.saveState(&model, stateBuffer, sizeof(stateBuffer));
+    else storage.dropState();
+    stateSaved = waiting;
+  }
 
-  // Extract features (Gravity Compensated)
   float features[FEATURE_DIM];
-  FeatureExtractor::extractSimple(ax, ay, az, i1, i2, i3, features);
+
+  #ifdef ACQ_SAMPLE_HZ
+    // One feature vector per completed window
+    if (!drainAcquisition()) return;
+    sampleCount++;
+
+    float i1 = 0, i2 = 0, i3 = 0;
+    #ifdef USE_CURRENT
+      currentSensor.read(&i1, &i2, &i3);
+    #endif
+
+    window_read(&featureWindow, windowOrdered);
+    FeatureExtractor::extractFrame(windowOrdered, FEATURE_WINDOW_SAMPLES, i1, i2, i3, features);
+  #else
+    // Sample at 10 Hz
+    if (now - lastSample < SAMPLE_MS) return;
+    lastSample = now;
+    sampleCount++;
+
+    float ax, ay, az;
+    readAccel(&ax, &ay, &az);
+    lastRawAx = ax; lastRawAy = ay; lastRawAz = az;
+
+    // Read current
+    float i1 = 0, i2 = 0, i3 = 0;
+    #ifdef USE_CURRENT
+      currentSensor.read(&i1, &i2, &i3);
+    #endif
+
+    // Extract features (Gravity Compensated)
+    #ifdef USE_FFT
+      // FFT features read 0 until the first FFT_SAMPLES samples are in
+      FeatureExtractor::extract(ax, ay, az, i1, i2, i3, FeatureExtractor::getFFTFrame(), features);
+    #else
+      FeatureExtractor::extractSimple(ax, ay, az, i1, i2, i3, features);
+    #endif
+  #endif
   
   lastRms = features[0];
   lastPeak = features[1];
   lastCrest = features[2];
 
-  // Store in window buffer for statistics
-  for (int i = 0; i < FEATURE_DIM; i++) {
-    window_features[window_idx][i] = features[i];
-  }
-  window_idx = (window_idx + 1) % WINDOW_SIZE;
+  // Fold into the publish window statistics
+  window_stats_push(&windowStats, features);
 
   // Update motor status (Idle detection)
   fixed_t rmsFixed = FLOAT_TO_FIXED(features[0]);
@@ -620,6 +947,8 @@ void loop() {
 
   if (!kmeans_is_motor_running(&model)) {
     Serial.println("[Loop] Motor OFF - skipping clustering");
+    streamVector(features, -1, NAN);
+    storage.maintain(&model);  // Idle: compact the model journal if it is half full
     
     // Still publish status but don't cluster
     if (now - lastPublish >= PUBLISH_MS) {
@@ -650,6 +979,7 @@ void loop() {
   // Skip K-Means update if Frozen (Waiting for Label)
   system_state_t state = kmeans_get_state(&model);
   if (state == STATE_WAITING_LABEL) {
+    streamVector(features, -1, NAN);
     if (now - lastDebug >= DEBUG_MS) {
       lastDebug = now;
       Serial.println("⏸️  WAITING_LABEL - send label or discard via MQTT");
@@ -674,10 +1004,19 @@ void loop() {
                 model.k);
 
   int8_t clusterId = kmeans_update(&model, featuresFixed);
+  streamVector(features, clusterId,
+               stateBefore == STATE_BOOTSTRAP ? NAN : FIXED_TO_FLOAT(model.last_distance));
 
   system_state_t stateAfter = kmeans_get_state(&model);
   logStateChange("kmeans_update", stateBefore, stateAfter);
 
+  #if defined(HAS_WIFI) && defined(OFFLINE_QUEUE)
+    // Alarm raised while offline: keep a summary of that moment, not just the next 10 s one
+    if (stateAfter != stateBefore && stateAfter == STATE_ALARM && !mqtt.connected()) {
+      publishSummary();
+    }
+  #endif
+
   Serial.printf("[Loop] After update: cluster=%d, alarm=%s, buffer=%d\n",
                 clusterId,
                 kmeans_is_alarm_active(&model) ? "YES" : "no",
@@ -714,6 +1053,17 @@ void loop() {
     Serial.printf("Threshold: %.2f | Last distance: %.2f\n",
                   FIXED_TO_FLOAT(model.outlier_threshold),
                   FIXED_TO_FLOAT(model.last_distance));
+    #if defined(HAS_WIFI) && defined(STREAM_FEATURES)
+      Serial.printf("Stream: %lu sent | %u queued | %lu dropped\n",
+                    (unsigned long)featureStream.stats.vectors_sent,
+                    feature_stream_queued(&featureStream),
+                    (unsigned long)featureStream.stats.vectors_dropped);
+    #endif
+    #ifdef ACQ_SAMPLE_HZ
+      Serial.printf("Acq ring: %lu queued | %lu dropped\n",
+                    (unsigned long)spsc_count(&accelRing),
+                    (unsigned long)spsc_dropped(&accelRing));
+    #endif
     Serial.println("========================================");
   }
 
@@ -0,0 +1,46 @@
+/**
+ * @file crc.h
+ * @brief CRC-16/CCITT-FALSE and CRC-32 (IEEE, zlib-compatible), header-only
+ *
+ * CRC-16 is bitwise (a few hundred bytes per frame). CRC-32 also covers
+ * whole model files (model_file.h), so it runs a nibble at a time from a
+ * 64-byte table: about twice the bitwise speed for almost no code size.
+ */
+
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+static inline uint16_t crc16_ccitt(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static const uint32_t crc32_nibble_[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+// Chain calls: crc = crc32_update(crc32_update(0, a, n), b, m)
+static inline uint32_t crc32_update(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ crc32_nibble_[crc & 15];
+        crc = (crc >> 4) ^ crc32_nibble_[crc & 15];
+    }
+    return ~crc;
+}
+
+static inline uint32_t crc32(const void* data, size_t len) {
+    return crc32_update(0, data, len);
+}
+
+#endif
@@ -13,14 +13,26 @@
  *   Accelerometers read ~9.8 m/s² at rest. This file includes a 
  *   High-pass filter (VibrationFilter) to extract the AC component 
  *   (actual vibration) before calculating features.
+ *
+ * HOST BUILD:
+ *   Without ARDUINO defined, tests/host/arduino_host.h stands in for
+ *   Arduino.h and the schema comes from -DFEATURE_SCHEMA_* (see
+ *   tests/test_features.cpp, tests/bench_features.cpp).
  */
 
 #ifndef FEATURE_EXTRACTOR_H
 #define FEATURE_EXTRACTOR_H
 
-#include <Arduino.h>
+#ifdef ARDUINO
+  #include <Arduino.h>
+  #include "config.h"
+#else
+  #include "arduino_host.h"  // tests/host: stubs + -DFEATURE_SCHEMA_*
+#endif
 #include <math.h>
-#include "config.h"
+#include "feature_fft.h"
+#include "sliding_stats.h"
+#include "adc_moments.h"
 
 // =============================================================================
 // FEATURE SCHEMA SELECTION
@@ -44,20 +56,35 @@
   #define USE_CURRENT
 #else
   // Default: time-domain only
-  #define FEATURE_SCHEMA_TIME_ONLY
+  #ifndef FEATURE_SCHEMA_TIME_ONLY
+    #define FEATURE_SCHEMA_TIME_ONLY
+  #endif
   #define FEATURE_DIM 3
 #endif
 
 // FFT configuration
 #ifdef USE_FFT
-  #define FFT_SAMPLES 64          // Power of 2, fits in RAM
-  #define FFT_SAMPLE_FREQ 1000.0  // Hz (actual accelerometer rate)
+  #ifndef FFT_SAMPLES
+    #define FFT_SAMPLES 64        // Power of 2, <= FFT_MAX_POINTS
+  #endif
+  #ifndef FFT_SAMPLE_FREQ
+    #ifdef ACQ_SAMPLE_HZ
+      #define FFT_SAMPLE_FREQ ACQ_SAMPLE_HZ  // Windowed pipeline (sample_pipeline.h)
+    #else
+      #define FFT_SAMPLE_FREQ 1000.0  // Hz (rate the FFT frame is sampled at)
+    #endif
+  #endif
+  // FFT_FIXED_POINT in config.h selects the Q15 kernel (MCUs without FPU)
 #endif
 
 // =============================================================================
 // GRAVITY-COMPENSATED VIBRATION EXTRACTOR
 // =============================================================================
 
+#ifndef VIB_WINDOW_SAMPLES
+  #define VIB_WINDOW_SAMPLES 10  // 1 second @ 10Hz
+#endif
+
 class VibrationFilter {
 private:
   // Exponential moving average for baseline (gravity)
@@ -65,13 +92,17 @@ private:
   float alpha = 0.1f;  // Low alpha = slow adaptation = good gravity tracking
   bool initialized = false;
   
-  // Ring buffer for RMS calculation
-  static const int WINDOW = 10;  // 1 second @ 10Hz
+  // Window of AC magnitudes with O(1) running stats (sliding_stats.h)
+  static const int WINDOW = VIB_WINDOW_SAMPLES;
   float acBuffer[WINDOW];
-  int bufIdx = 0;
-  int bufCount = 0;
+  uint16_t maxQueue[WINDOW];
+  sliding_stats_t stats;
 
 public:
+  VibrationFilter() {
+    sliding_stats_init(&stats, acBuffer, maxQueue, WINDOW);
+  }
+
   /**
    * Update baseline and compute AC vibration magnitude
    * @return AC magnitude (vibration without gravity)
@@ -98,36 +129,33 @@ public:
     // Magnitude of AC (actual vibration)
     float acMag = sqrtf(acX*acX + acY*acY + acZ*acZ);
     
-    // Add to ring buffer
-    acBuffer[bufIdx] = acMag;
-    bufIdx = (bufIdx + 1) % WINDOW;
-    if (bufCount < WINDOW) bufCount++;
+    sliding_stats_push(&stats, acMag);
     
     return acMag;
   }
   
   /**
-   * Get RMS of AC vibration over window
+   * Get RMS of AC vibration over window (O(1))
    */
   float getRMS() {
-    if (bufCount == 0) return 0;
-    float sum = 0;
-    for (int i = 0; i < bufCount; i++) {
-      sum += acBuffer[i] * acBuffer[i];
-    }
-    return sqrtf(sum / bufCount);
+    return sliding_stats_rms(&stats);
   }
   
   /**
-   * Get peak of AC vibration over window
+   * Get peak of AC vibration over window (O(1) amortized)
    */
   float getPeak() {
-    float peak = 0;
-    for (int i = 0; i < bufCount; i++) {
-      if (acBuffer[i] > peak) peak = acBuffer[i];
-    }
-    return peak;
+    return sliding_stats_max(&stats);
   }
+
+  /**
+   * Moments of AC vibration over window (O(1)); population estimates
+   * like the CWRU feature script (np.var, scipy kurtosis/skew)
+   */
+  float getMean() { return sliding_stats_mean(&stats); }
+  float getVariance() { return sliding_stats_variance(&stats); }
+  float getSkewness() { return sliding_stats_skewness(&stats); }
+  float getKurtosis() { return sliding_stats_kurtosis(&stats); }  // Excess, 0 = Gaussian
   
   /**
    * Get baseline magnitude (should be ~9.8 m/s² = gravity)
@@ -138,14 +166,21 @@ public:
   
   void reset() {
     initialized = false;
-    bufCount = 0;
-    bufIdx = 0;
+    sliding_stats_reset(&stats);
   }
 };
 
 // Global instance used by FeatureExtractor
 static VibrationFilter vibFilter;
 
+#ifdef USE_FFT
+// Last FFT_SAMPLES AC magnitudes. Kept circular: a rotation only changes
+// phase, so the magnitude spectrum is the same as for the ordered frame.
+static float fftFrame[FFT_SAMPLES];
+static int fftFrameIdx = 0;
+static int fftFrameCount = 0;
+#endif
+
 // =============================================================================
 // FEATURE EXTRACTOR
 // =============================================================================
@@ -159,7 +194,15 @@ public:
    */
   static void extractTime(float ax, float ay, float az, float* features) {
     // Update filter and get AC vibration (gravity removed)
-    vibFilter.update(ax, ay, az);
+    float acMag = vibFilter.update(ax, ay, az);
+
+    #ifdef USE_FFT
+      fftFrame[fftFrameIdx] = acMag;
+      fftFrameIdx = (fftFrameIdx + 1) % FFT_SAMPLES;
+      if (fftFrameCount < FFT_SAMPLES) fftFrameCount++;
+    #else
+      (void)acMag;
+    #endif
     
     float rms = vibFilter.getRMS();
     float peak = vibFilter.getPeak();
@@ -173,16 +216,79 @@ public:
 
 #ifdef USE_FFT
   /**
-   * Extract FFT features from magnitude signal buffer
+   * Extract FFT features from FFT_SAMPLES magnitude samples
+   * @param features Output: [fft_peak_freq (Hz), fft_peak_amp, spectral_centroid (Hz)]
    */
   static void extractFFT(const float* mag_buffer, float* features) {
-    // Placeholder values
-    features[0] = 0.0f;  // fft_peak_freq (Hz)
-    features[1] = 0.0f;  // fft_peak_amp
-    features[2] = 0.0f;  // spectral_centroid (Hz)
+    fft_features_t f;
+    #ifdef FFT_FIXED_POINT
+      static int16_t re[FFT_SAMPLES], im[FFT_SAMPLES];
+      fft_features_q15(mag_buffer, FFT_SAMPLES, FFT_SAMPLE_FREQ, re, im, &f);
+    #else
+      static float re[FFT_SAMPLES], im[FFT_SAMPLES];
+      fft_features_f32(mag_buffer, FFT_SAMPLES, FFT_SAMPLE_FREQ, re, im, &f);
+    #endif
+    features[0] = f.peak_freq;
+    features[1] = f.peak_amp;
+    features[2] = f.centroid;
+  }
+
+  /**
+   * Frame of recent AC magnitudes for extract(), NULL until FFT_SAMPLES seen
+   */
+  static const float* getFFTFrame() {
+    return (fftFrameCount == FFT_SAMPLES) ? fftFrame : NULL;
   }
 #endif
 
+  /**
+   * Gravity-filter one raw sample without computing features
+   * @return AC magnitude, the value the windowed pipeline collects
+   */
+  static float filterSample(float ax, float ay, float az) {
+    return vibFilter.update(ax, ay, az);
+  }
+
+  /**
+   * Features of one window of AC magnitudes (windowed pipeline)
+   * @param frame Oldest -> newest, n samples; FFT uses the newest FFT_SAMPLES
+   */
+  static void extractFrame(const float* frame, int n,
+                           float i1, float i2, float i3,
+                           float* features) {
+    float sumSq = 0, peak = 0;
+    for (int i = 0; i < n; i++) {
+      sumSq += frame[i] * frame[i];
+      if (frame[i] > peak) peak = frame[i];
+    }
+    float rms = (n > 0) ? sqrtf(sumSq / n) : 0;
+
+    features[0] = rms;
+    features[1] = peak;
+    features[2] = (rms > 0.01f) ? (peak / rms) : 1.0f;
+
+    int idx = 3;
+
+    #ifdef USE_FFT
+      if (n >= FFT_SAMPLES) {
+        extractFFT(frame + n - FFT_SAMPLES, &features[idx]);
+      } else {
+        features[idx] = features[idx + 1] = features[idx + 2] = 0.0f;
+      }
+      idx += 3;
+    #endif
+
+    #ifdef USE_CURRENT
+      features[idx++] = i1;
+      features[idx++] = i2;
+      features[idx++] = i3;
+      features[idx++] = sqrtf((i1*i1 + i2*i2 + i3*i3) / 3.0f);
+    #else
+      (void)i1; (void)i2; (void)i3;
+    #endif
+    (void)idx;  // Unused in TIME_ONLY
+  }
+
   /**
    * Full feature extraction based on configured schema
    */
@@ -213,6 +319,7 @@ public:
       features[idx++] = i3;
       features[idx++] = sqrtf((i1*i1 + i2*i2 + i3*i3) / 3.0f);  // i_rms
     #endif
+    (void)idx;
   }
 
   /**
@@ -238,6 +345,15 @@ public:
   // Debug: get raw baseline from the filter
   static float getBaseline() { return vibFilter.getBaseline(); }
 
+  // Forget gravity baseline, window and FFT frame
+  static void reset() {
+    vibFilter.reset();
+    #ifdef USE_FFT
+      fftFrameIdx = 0;
+      fftFrameCount = 0;
+    #endif
+  }
+
   static void getFeatureNames(char names[][32]) {
     strcpy(names[0], "vib_rms");
     strcpy(names[1], "vib_peak");
@@ -257,6 +373,7 @@ public:
       strcpy(names[idx++], "current_l3");
       strcpy(names[idx++], "current_rms");
     #endif
+    (void)idx;
   }
 };
 
@@ -267,8 +384,17 @@ public:
 #ifdef USE_CURRENT
 
 class CurrentSensor {
+public:
+  /**
+   * Sample source: fill out[0 .. 3*frames-1] with raw ADC codes,
+   * interleaved L1, L2, L3 per frame (the order a round-robin continuous
+   * ADC or DMA block delivers them). Returns frames written.
+   */
+  typedef int (*BlockSource)(uint16_t* out, int frames, void* ctx);
+
 private:
-  static constexpr int SAMPLES = 1000;
+  static constexpr int SAMPLES = 1000;      // Per phase, per measurement
+  static constexpr int BLOCK_FRAMES = 100;  // Frames per source call
   static constexpr float V_REF = 3.3f;
   static constexpr int ADC_MAX = 4095;
   // Increased noise floor and added absolute cutoff
@@ -282,24 +408,37 @@ private:
   int bufferIndex = 0;
   bool calibrated = false;
 
-  float measureRawRMS(int pin) {
-    float sum = 0;
-    // Get DC bias
-    for (int i = 0; i < SAMPLES; i++) sum += analogRead(pin);
-    float midpoint = sum / SAMPLES;
-    
-    float sumSq = 0;
-    for (int i = 0; i < SAMPLES; i++) {
-      float v = analogRead(pin) - midpoint;
-      sumSq += v * v;
+  BlockSource source = analogReadBlock;
+  void* sourceCtx = nullptr;
+  uint16_t block[BLOCK_FRAMES * 3];
+
+  // Default source: one analogRead() per phase per frame
+  static int analogReadBlock(uint16_t* out, int frames, void*) {
+    for (int f = 0; f < frames; f++) {
+      out[3 * f + 0] = analogRead(ADC_CURRENT_L1);
+      out[3 * f + 1] = analogRead(ADC_CURRENT_L2);
+      out[3 * f + 2] = analogRead(ADC_CURRENT_L3);
     }
-    float rmsAdc = sqrtf(sumSq / SAMPLES);
-    return (rmsAdc * V_REF) / ADC_MAX;
+    return frames;
   }
 
-  float measureCurrent(int pin, float zeroOff) {
-    float rawVolts = measureRawRMS(pin);
-    
+  // AC RMS (volts) of all three phases in one pass: the DC midpoint and
+  // the deviation around it come from the same samples
+  void measureRawRMS(float* volts) {
+    adc_moments_t m[3];
+    for (int k = 0; k < 3; k++) adc_moments_reset(&m[k]);
+
+    for (int done = 0; done < SAMPLES; ) {
+      int want = SAMPLES - done < BLOCK_FRAMES ? SAMPLES - done : BLOCK_FRAMES;
+      int got = source(block, want, sourceCtx);
+      if (got <= 0) break;  // Source stalled: use what we have
+      for (int k = 0; k < 3; k++) adc_moments_add_block(&m[k], block + k, got, 3);
+      done += got;
+    }
+    for (int k = 0; k < 3; k++) volts[k] = (adc_moments_rms(&m[k]) * V_REF) / ADC_MAX;
+  }
+
+  float measureCurrent(float rawVolts, float zeroOff) {
     // Safety gate: if raw voltage is very close to offset, ignore
     if (rawVolts < zeroOff * 1.05f) return 0.0f;
 
@@ -319,6 +458,15 @@ private:
   }
 
 public:
+  /**
+   * Replace the analogRead() loop, e.g. with a DMA / continuous-ADC reader
+   * or a synthetic signal on the host. nullptr restores the default.
+   */
+  void setSource(BlockSource fn, void* ctx = nullptr) {
+    source = fn ? fn : analogReadBlock;
+    sourceCtx = ctx;
+  }
+
   void calibrate() {
     Serial.println("[CT] Calibrating - motor OFF...");
     delay(2000);
@@ -327,9 +475,11 @@ public:
     float sum1=0, sum2=0, sum3=0;
     int n=10;
     for(int i=0; i<n; i++) {
-      sum1 += measureRawRMS(ADC_CURRENT_L1);
-      sum2 += measureRawRMS(ADC_CURRENT_L2);
-      sum3 += measureRawRMS(ADC_CURRENT_L3);
+      float v[3];
+      measureRawRMS(v);
+      sum1 += v[0];
+      sum2 += v[1];
+      sum3 += v[2];
       delay(50);
     }
     
@@ -347,9 +497,11 @@ public:
   void read(float* i1, float* i2, float* i3) {
     if (!calibrated) { *i1 = *i2 = *i3 = 0; return; }
     
-    float raw1 = measureCurrent(ADC_CURRENT_L1, zeroOffset[0]);
-    float raw2 = measureCurrent(ADC_CURRENT_L2, zeroOffset[1]);
-    float raw3 = measureCurrent(ADC_CURRENT_L3, zeroOffset[2]);
+    float volts[3];
+    measureRawRMS(volts);
+    float raw1 = measureCurrent(volts[0], zeroOffset[0]);
+    float raw2 = measureCurrent(volts[1], zeroOffset[1]);
+    float raw3 = measureCurrent(volts[2], zeroOffset[2]);
     
     buffer[0][bufferIndex] = raw1;
     buffer[1][bufferIndex] = raw2;
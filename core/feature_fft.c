@@ -0,0 +1,343 @@
+/**
+ * @file feature_fft.c
+ * @brief Radix-2 decimation-in-time FFT kernels and spectral features
+ *
+ * Twiddle W^k = cos(2*pi*k/n) - j*sin(2*pi*k/n) is read from one quarter
+ * of a FFT_MAX_POINTS-point sine wave; smaller sizes stride through it.
+ */
+
+#include "feature_fft.h"
+#include <math.h>
+
+#define QUARTER (FFT_MAX_POINTS / 4)
+
+// sin(2*pi*i / FFT_MAX_POINTS), i = 0..QUARTER
+static const int16_t FFT_SIN_Q15[FFT_MAX_POINTS / 4 + 1] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210,
+    2411, 2611, 2811, 3012, 3212, 3412, 3612, 3812, 4011, 4211, 4410, 4609,
+    4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195, 6393, 6590, 6787, 6983,
+    7180, 7376, 7571, 7767, 7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319,
+    9512, 9704, 9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605,
+    11793, 11980, 12167, 12354, 12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828,
+    14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269, 15447, 15624, 15800, 15976,
+    16151, 16326, 16500, 16673, 16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+    18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001,
+    20160, 20318, 20475, 20632, 20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+    22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028, 23170, 23312, 23453, 23593,
+    23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+    25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199, 26320, 26439, 26557, 26674,
+    26791, 26906, 27020, 27133, 27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002,
+    28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803, 28899, 28993, 29086, 29178,
+    29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+    30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784, 30853, 30920, 30986, 31050,
+    31114, 31177, 31238, 31298, 31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737,
+    31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099, 32138, 32177, 32214, 32251,
+    32286, 32319, 32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+    32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738, 32746, 32753,
+    32758, 32762, 32766, 32767, 32767,
+};
+
+static const int32_t FFT_SIN_Q31[FFT_MAX_POINTS / 4 + 1] = {
+    0, 13176712, 26352928, 39528151, 52701887, 65873638,
+    79042909, 92209205, 105372028, 118530885, 131685278, 144834714,
+    157978697, 171116733, 184248325, 197372981, 210490206, 223599506,
+    236700388, 249792358, 262874923, 275947592, 289009871, 302061269,
+    315101295, 328129457, 341145265, 354148230, 367137861, 380113669,
+    393075166, 406021865, 418953276, 431868915, 444768294, 457650927,
+    470516330, 483364019, 496193509, 509004318, 521795963, 534567963,
+    547319836, 560051104, 572761285, 585449903, 598116479, 610760536,
+    623381598, 635979190, 648552838, 661102068, 673626408, 686125387,
+    698598533, 711045377, 723465451, 735858287, 748223418, 760560380,
+    772868706, 785147934, 797397602, 809617249, 821806413, 833964638,
+    846091463, 858186435, 870249095, 882278992, 894275671, 906238681,
+    918167572, 930061894, 941921200, 953745043, 965532978, 977284562,
+    988999351, 1000676905, 1012316784, 1023918550, 1035481766, 1047005996,
+    1058490808, 1069935768, 1081340445, 1092704411, 1104027237, 1115308496,
+    1126547765, 1137744621, 1148898640, 1160009405, 1171076495, 1182099496,
+    1193077991, 1204011567, 1214899813, 1225742318, 1236538675, 1247288478,
+    1257991320, 1268646800, 1279254516, 1289814068, 1300325060, 1310787095,
+    1321199781, 1331562723, 1341875533, 1352137822, 1362349204, 1372509294,
+    1382617710, 1392674072, 1402678000, 1412629117, 1422527051, 1432371426,
+    1442161874, 1451898025, 1461579514, 1471205974, 1480777044, 1490292364,
+    1499751576, 1509154322, 1518500250, 1527789007, 1537020244, 1546193612,
+    1555308768, 1564365367, 1573363068, 1582301533, 1591180426, 1599999411,
+    1608758157, 1617456335, 1626093616, 1634669676, 1643184191, 1651636841,
+    1660027308, 1668355276, 1676620432, 1684822463, 1692961062, 1701035922,
+    1709046739, 1716993211, 1724875040, 1732691928, 1740443581, 1748129707,
+    1755750017, 1763304224, 1770792044, 1778213194, 1785567396, 1792854372,
+    1800073849, 1807225553, 1814309216, 1821324572, 1828271356, 1835149306,
+    1841958164, 1848697674, 1855367581, 1861967634, 1868497586, 1874957189,
+    1881346202, 1887664383, 1893911494, 1900087301, 1906191570, 1912224073,
+    1918184581, 1924072871, 1929888720, 1935631910, 1941302225, 1946899451,
+    1952423377, 1957873796, 1963250501, 1968553292, 1973781967, 1978936331,
+    1984016189, 1989021350, 1993951625, 1998806829, 2003586779, 2008291295,
+    2012920201, 2017473321, 2021950484, 2026351522, 2030676269, 2034924562,
+    2039096241, 2043191150, 2047209133, 2051150040, 2055013723, 2058800036,
+    2062508835, 2066139983, 2069693342, 2073168777, 2076566160, 2079885360,
+    2083126254, 2086288720, 2089372638, 2092377892, 2095304370, 2098151960,
+    2100920556, 2103610054, 2106220352, 2108751352, 2111202959, 2113575080,
+    2115867626, 2118080511, 2120213651, 2122266967, 2124240380, 2126133817,
+    2127947206, 2129680480, 2131333572, 2132906420, 2134398966, 2135811153,
+    2137142927, 2138394240, 2139565043, 2140655293, 2141664948, 2142593971,
+    2143442326, 2144209982, 2144896910, 2145503083, 2146028480, 2146473080,
+    2146836866, 2147119825, 2147321946, 2147443222, 2147483647,
+};
+
+static const float FFT_SIN_F32[FFT_MAX_POINTS / 4 + 1] = {
+    0.000000000f, 0.006135885f, 0.012271538f, 0.018406730f, 0.024541229f, 0.030674803f,
+    0.036807223f, 0.042938257f, 0.049067674f, 0.055195244f, 0.061320736f, 0.067443920f,
+    0.073564564f, 0.079682438f, 0.085797312f, 0.091908956f, 0.098017140f, 0.104121634f,
+    0.110222207f, 0.116318631f, 0.122410675f, 0.128498111f, 0.134580709f, 0.140658239f,
+    0.146730474f, 0.152797185f, 0.158858143f, 0.164913120f, 0.170961889f, 0.177004220f,
+    0.183039888f, 0.189068664f, 0.195090322f, 0.201104635f, 0.207111376f, 0.213110320f,
+    0.219101240f, 0.225083911f, 0.231058108f, 0.237023606f, 0.242980180f, 0.248927606f,
+    0.254865660f, 0.260794118f, 0.266712757f, 0.272621355f, 0.278519689f, 0.284407537f,
+    0.290284677f, 0.296150888f, 0.302005949f, 0.307849640f, 0.313681740f, 0.319502031f,
+    0.325310292f, 0.331106306f, 0.336889853f, 0.342660717f, 0.348418680f, 0.354163525f,
+    0.359895037f, 0.365612998f, 0.371317194f, 0.377007410f, 0.382683432f, 0.388345047f,
+    0.393992040f, 0.399624200f, 0.405241314f, 0.410843171f, 0.416429560f, 0.422000271f,
+    0.427555093f, 0.433093819f, 0.438616239f, 0.444122145f, 0.449611330f, 0.455083587f,
+    0.460538711f, 0.465976496f, 0.471396737f, 0.476799230f, 0.482183772f, 0.487550160f,
+    0.492898192f, 0.498227667f, 0.503538384f, 0.508830143f, 0.514102744f, 0.519355990f,
+    0.524589683f, 0.529803625f, 0.534997620f, 0.540171473f, 0.545324988f, 0.550457973f,
+    0.555570233f, 0.560661576f, 0.565731811f, 0.570780746f, 0.575808191f, 0.580813958f,
+    0.585797857f, 0.590759702f, 0.595699304f, 0.600616479f, 0.605511041f, 0.610382806f,
+    0.615231591f, 0.620057212f, 0.624859488f, 0.629638239f, 0.634393284f, 0.639124445f,
+    0.643831543f, 0.648514401f, 0.653172843f, 0.657806693f, 0.662415778f, 0.666999922f,
+    0.671558955f, 0.676092704f, 0.680600998f, 0.685083668f, 0.689540545f, 0.693971461f,
+    0.698376249f, 0.702754744f, 0.707106781f, 0.711432196f, 0.715730825f, 0.720002508f,
+    0.724247083f, 0.728464390f, 0.732654272f, 0.736816569f, 0.740951125f, 0.745057785f,
+    0.749136395f, 0.753186799f, 0.757208847f, 0.761202385f, 0.765167266f, 0.769103338f,
+    0.773010453f, 0.776888466f, 0.780737229f, 0.784556597f, 0.788346428f, 0.792106577f,
+    0.795836905f, 0.799537269f, 0.803207531f, 0.806847554f, 0.810457198f, 0.814036330f,
+    0.817584813f, 0.821102515f, 0.824589303f, 0.828045045f, 0.831469612f, 0.834862875f,
+    0.838224706f, 0.841554977f, 0.844853565f, 0.848120345f, 0.851355193f, 0.854557988f,
+    0.857728610f, 0.860866939f, 0.863972856f, 0.867046246f, 0.870086991f, 0.873094978f,
+    0.876070094f, 0.879012226f, 0.881921264f, 0.884797098f, 0.887639620f, 0.890448723f,
+    0.893224301f, 0.895966250f, 0.898674466f, 0.901348847f, 0.903989293f, 0.906595705f,
+    0.909167983f, 0.911706032f, 0.914209756f, 0.916679060f, 0.919113852f, 0.921514039f,
+    0.923879533f, 0.926210242f, 0.928506080f, 0.930766961f, 0.932992799f, 0.935183510f,
+    0.937339012f, 0.939459224f, 0.941544065f, 0.943593458f, 0.945607325f, 0.947585591f,
+    0.949528181f, 0.951435021f, 0.953306040f, 0.955141168f, 0.956940336f, 0.958703475f,
+    0.960430519f, 0.962121404f, 0.963776066f, 0.965394442f, 0.966976471f, 0.968522094f,
+    0.970031253f, 0.971503891f, 0.972939952f, 0.974339383f, 0.975702130f, 0.977028143f,
+    0.978317371f, 0.979569766f, 0.980785280f, 0.981963869f, 0.983105487f, 0.984210092f,
+    0.985277642f, 0.986308097f, 0.987301418f, 0.988257568f, 0.989176510f, 0.990058210f,
+    0.990902635f, 0.991709754f, 0.992479535f, 0.993211949f, 0.993906970f, 0.994564571f,
+    0.995184727f, 0.995767414f, 0.996312612f, 0.996820299f, 0.997290457f, 0.997723067f,
+    0.998118113f, 0.998475581f, 0.998795456f, 0.999077728f, 0.999322385f, 0.999529418f,
+    0.999698819f, 0.999830582f, 0.999924702f, 0.999981175f, 1.000000000f,
+};
+
+static bool valid_size(uint16_t n) {
+    return n >= 2 && n <= FFT_MAX_POINTS && (n & (n - 1)) == 0;
+}
+
+// Table index i < FFT_MAX_POINTS / 2 -> cos, sin of 2*pi*i / FFT_MAX_POINTS
+#define TWIDDLE(table, i, c, s) do { \
+    if ((i) <= QUARTER) { (s) = table[i]; (c) = table[QUARTER - (i)]; } \
+    else { (s) = table[2 * QUARTER - (i)]; (c) = -table[(i) - QUARTER]; } \
+} while (0)
+
+#define BIT_REVERSE(T, re, im, n) do { \
+    uint16_t j = 0; \
+    for (uint16_t i = 1; i < (n); i++) { \
+        uint16_t bit = (n) >> 1; \
+        for (; j & bit; bit >>= 1) j ^= bit; \
+        j ^= bit; \
+        if (i < j) { \
+            T t = re[i]; re[i] = re[j]; re[j] = t; \
+            t = im[i]; im[i] = im[j]; im[j] = t; \
+        } \
+    } \
+} while (0)
+
+bool fft_f32(float* re, float* im, uint16_t n) {
+    if (!valid_size(n)) return false;
+    BIT_REVERSE(float, re, im, n);
+
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        uint16_t half = len >> 1;
+        uint16_t step = FFT_MAX_POINTS / len;
+        for (uint16_t k = 0; k < half; k++) {
+            float c, s;
+            TWIDDLE(FFT_SIN_F32, k * step, c, s);
+            for (uint16_t a = k; a < n; a += len) {
+                uint16_t b = a + half;
+                float tr = re[b] * c + im[b] * s;
+                float ti = im[b] * c - re[b] * s;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+    return true;
+}
+
+bool fft_q15(int16_t* re, int16_t* im, uint16_t n) {
+    if (!valid_size(n)) return false;
+    BIT_REVERSE(int16_t, re, im, n);
+
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        uint16_t half = len >> 1;
+        uint16_t step = FFT_MAX_POINTS / len;
+        for (uint16_t k = 0; k < half; k++) {
+            int32_t c, s;
+            TWIDDLE(FFT_SIN_Q15, k * step, c, s);
+            for (uint16_t a = k; a < n; a += len) {
+                uint16_t b = a + half;
+                int32_t tr = (re[b] * c + im[b] * s) >> 15;
+                int32_t ti = (im[b] * c - re[b] * s) >> 15;
+                int32_t ar = re[a], ai = im[a];
+                re[b] = (int16_t)((ar - tr) >> 1);
+                im[b] = (int16_t)((ai - ti) >> 1);
+                re[a] = (int16_t)((ar + tr) >> 1);
+                im[a] = (int16_t)((ai + ti) >> 1);
+            }
+        }
+    }
+    return true;
+}
+
+bool fft_q31(int32_t* re, int32_t* im, uint16_t n) {
+    if (!valid_size(n)) return false;
+    BIT_REVERSE(int32_t, re, im, n);
+
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        uint16_t half = len >> 1;
+        uint16_t step = FFT_MAX_POINTS / len;
+        for (uint16_t k = 0; k < half; k++) {
+            int64_t c, s;
+            TWIDDLE(FFT_SIN_Q31, k * step, c, s);
+            for (uint16_t a = k; a < n; a += len) {
+                uint16_t b = a + half;
+                int64_t tr = (re[b] * c + im[b] * s) >> 31;
+                int64_t ti = (im[b] * c - re[b] * s) >> 31;
+                int64_t ar = re[a], ai = im[a];
+                re[b] = (int32_t)((ar - tr) >> 1);
+                im[b] = (int32_t)((ai - ti) >> 1);
+                re[a] = (int32_t)((ar + tr) >> 1);
+                im[a] = (int32_t)((ai + ti) >> 1);
+            }
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// SPECTRAL FEATURES
+// =============================================================================
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t root = 0, bit = 1ull << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static float signal_mean(const float* signal, uint16_t n) {
+    float sum = 0;
+    for (uint16_t i = 0; i < n; i++) sum += signal[i];
+    return sum / n;
+}
+
+// Block scaling: largest |x - mean| maps to half of full scale
+static float block_scale(const float* signal, uint16_t n, float mean, float half_scale) {
+    float peak = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        float d = fabsf(signal[i] - mean);
+        if (d > peak) peak = d;
+    }
+    return (peak > 0) ? half_scale / peak : 0;
+}
+
+// |X[k]| for k = 1..n/2 arrive as `mag`; `unit` converts mag to amplitude
+static void finish(fft_features_t* out, uint16_t n, float sample_freq,
+                   uint16_t best_k, float best_mag, float sum_mag, float sum_k_mag, float unit) {
+    float bin_hz = sample_freq / n;
+    out->peak_freq = best_k * bin_hz;
+    out->peak_amp = best_mag * unit * (best_k == n / 2 ? 1.0f : 2.0f);
+    out->centroid = (sum_mag > 0) ? bin_hz * sum_k_mag / sum_mag : 0;
+}
+
+bool fft_features_f32(const float* signal, uint16_t n, float sample_freq,
+                      float* re, float* im, fft_features_t* out) {
+    if (!valid_size(n)) return false;
+    float mean = signal_mean(signal, n);
+    for (uint16_t i = 0; i < n; i++) {
+        re[i] = signal[i] - mean;
+        im[i] = 0;
+    }
+    fft_f32(re, im, n);
+
+    uint16_t best_k = 0;
+    float best = 0, sum = 0, sum_k = 0;
+    for (uint16_t k = 1; k <= n / 2; k++) {
+        float mag = sqrtf(re[k] * re[k] + im[k] * im[k]);
+        if (mag > best) { best = mag; best_k = k; }
+        sum += mag;
+        sum_k += k * mag;
+    }
+    finish(out, n, sample_freq, best_k, best, sum, sum_k, 1.0f / n);
+    return true;
+}
+
+bool fft_features_q15(const float* signal, uint16_t n, float sample_freq,
+                      int16_t* re, int16_t* im, fft_features_t* out) {
+    if (!valid_size(n)) return false;
+    float mean = signal_mean(signal, n);
+    float scale = block_scale(signal, n, mean, 16383.0f);
+    for (uint16_t i = 0; i < n; i++) {
+        re[i] = (int16_t)lrintf((signal[i] - mean) * scale);
+        im[i] = 0;
+    }
+    fft_q15(re, im, n);
+
+    uint16_t best_k = 0;
+    uint32_t best = 0;
+    uint64_t sum = 0, sum_k = 0;
+    for (uint16_t k = 1; k <= n / 2; k++) {
+        uint32_t mag = isqrt64((uint64_t)((int32_t)re[k] * re[k]) + (uint64_t)((int32_t)im[k] * im[k]));
+        if (mag > best) { best = mag; best_k = k; }
+        sum += mag;
+        sum_k += (uint64_t)k * mag;
+    }
+    finish(out, n, sample_freq, best_k, (float)best, (float)sum, (float)sum_k,
+           scale > 0 ? 1.0f / scale : 0);
+    return true;
+}
+
+bool fft_features_q31(const float* signal, uint16_t n, float sample_freq,
+                      int32_t* re, int32_t* im, fft_features_t* out) {
+    if (!valid_size(n)) return false;
+    float mean = signal_mean(signal, n);
+    float scale = block_scale(signal, n, mean, 1073741823.0f);
+    for (uint16_t i = 0; i < n; i++) {
+        re[i] = (int32_t)llrintf((signal[i] - mean) * scale);
+        im[i] = 0;
+    }
+    fft_q31(re, im, n);
+
+    uint16_t best_k = 0;
+    uint32_t best = 0;
+    uint64_t sum = 0, sum_k = 0;
+    for (uint16_t k = 1; k <= n / 2; k++) {
+        uint32_t mag = isqrt64((uint64_t)((int64_t)re[k] * re[k]) + (uint64_t)((int64_t)im[k] * im[k]));
+        if (mag > best) { best = mag; best_k = k; }
+        sum += mag;
+        sum_k += (uint64_t)k * mag;
+    }
+    finish(out, n, sample_freq, best_k, (float)best, (float)sum, (float)sum_k,
+           scale > 0 ? 1.0f / scale : 0);
+    return true;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file feature_fft.h
+ * @brief In-place radix-2 FFT (Q15, Q31, float) and spectral features
+ *
+ * All transforms work in place on caller buffers (no malloc) and read
+ * twiddles from const quarter-wave sine tables, which the linker keeps in
+ * flash. Any power-of-two size from 2 to FFT_MAX_POINTS is supported.
+ *
+ * Fixed-point transforms halve every stage so no butterfly can overflow;
+ * their output is X[k] / n. Inputs should stay within half of full scale
+ * (|x| < 0.5), which fft_features_q15/q31 ensure by block scaling.
+ *
+ * Features are taken from the single-sided spectrum (bins 1..n/2) of the
+ * mean-removed signal:
+ *   peak_freq  frequency of the largest bin (Hz)
+ *   peak_amp   amplitude of that bin (input units; a sine of amplitude A
+ *              at a bin centre reads A)
+ *   centroid   amplitude-weighted mean frequency (Hz)
+ */
+
+#ifndef FEATURE_FFT_H
+#define FEATURE_FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FFT_MAX_POINTS 1024
+
+typedef struct {
+    float peak_freq;
+    float peak_amp;
+    float centroid;
+} fft_features_t;
+
+// Transforms: false if n is not a power of two in [2, FFT_MAX_POINTS]
+bool fft_f32(float* re, float* im, uint16_t n);
+bool fft_q15(int16_t* re, int16_t* im, uint16_t n);  // out = X / n
+bool fft_q31(int32_t* re, int32_t* im, uint16_t n);  // out = X / n
+
+// Features of signal[0..n-1]; re/im are n-element scratch buffers
+bool fft_features_f32(const float* signal, uint16_t n, float sample_freq,
+                      float* re, float* im, fft_features_t* out);
+bool fft_features_q15(const float* signal, uint16_t n, float sample_freq,
+                      int16_t* re, int16_t* im, fft_features_t* out);
+bool fft_features_q31(const float* signal, uint16_t n, float sample_freq,
+                      int32_t* re, int32_t* im, fft_features_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file feature_stream.c
+ * @brief Batched feature-vector streaming with backpressure (see feature_stream.h)
+ */
+
+#include "feature_stream.h"
+#include <string.h>
+
+static uint8_t* slot(const feature_stream_t* s, uint16_t i) {
+    return s->slots + (size_t)i * s->slot_size;
+}
+
+static uint16_t slot_len(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Vector count from a sealed features frame
+static uint16_t frame_vectors(const uint8_t* frame) {
+    const uint8_t* p = frame + TELEMETRY_HEADER_SIZE + 1;
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void open_batch(feature_stream_t* s) {
+    uint16_t i = (uint16_t)((s->head + s->queued) % s->slot_count);
+    telemetry_batch_begin(&s->batch, slot(s, i) + 2, s->slot_size - 2, s->batch.dim, s->seq);
+}
+
+// Oldest RAM frame leaves the queue: to the spill store if it takes it
+static void evict_oldest(feature_stream_t* s) {
+    uint8_t* p = slot(s, s->head);
+    uint16_t len = slot_len(p);
+    if (s->spill && s->spill->write(p + 2, len, s->spill->ctx)) {
+        s->stats.frames_spilled++;
+    } else {
+        s->stats.frames_dropped++;
+        s->stats.vectors_dropped += frame_vectors(p + 2);
+    }
+    s->head = (uint16_t)((s->head + 1) % s->slot_count);
+    s->queued--;
+}
+
+bool feature_stream_init(feature_stream_t* s, uint8_t dim, uint16_t batch_size,
+                         uint16_t queue_frames, void* storage, size_t storage_bytes) {
+    if (!s || !storage || dim == 0 || dim > TELEMETRY_MAX_DIM) return false;
+    if (batch_size == 0 || queue_frames == 0 || queue_frames > 0xFFFD) return false;
+    if (FEATURE_STREAM_SLOT_SIZE(dim, batch_size) > 0xFFFF + 2) return false;
+    if (storage_bytes < FEATURE_STREAM_STORAGE_SIZE(dim, batch_size, queue_frames)) return false;
+
+    memset(s, 0, sizeof(*s));
+    s->slots = (uint8_t*)storage;
+    s->slot_size = FEATURE_STREAM_SLOT_SIZE(dim, batch_size);
+    s->slot_count = (uint16_t)(queue_frames + 1);
+    s->batch_size = batch_size;
+    s->batch.dim = dim;
+    open_batch(s);
+    return true;
+}
+
+void feature_stream_set_transport(feature_stream_t* s, feature_stream_send_fn send, void* ctx) {
+    s->send = send;
+    s->send_ctx = ctx;
+}
+
+void feature_stream_set_spill(feature_stream_t* s, const feature_stream_spill_t* spill) {
+    s->spill = spill;
+}
+
+bool feature_stream_seal(feature_stream_t* s) {
+    if (s->batch.count == 0) return false;
+    uint8_t* p = s->batch.buf - 2;
+    size_t len = telemetry_batch_finish(&s->batch);
+    p[0] = (uint8_t)len;
+    p[1] = (uint8_t)(len >> 8);
+    s->seq++;
+    s->queued++;
+    if (s->queued == s->slot_count) evict_oldest(s);  // Keep a slot for the next batch
+    open_batch(s);
+    return true;
+}
+
+void feature_stream_add(feature_stream_t* s, uint32_t timestamp, int32_t cluster,
+                        float distance, const float* features) {
+    // Slots are sized for the worst case, so this should not fail; if it does,
+    // ship what the batch holds and retry once in a fresh one
+    if (!telemetry_batch_add(&s->batch, timestamp, cluster, distance, features) &&
+        (!feature_stream_seal(s) ||
+         !telemetry_batch_add(&s->batch, timestamp, cluster, distance, features))) {
+        s->stats.vectors_dropped++;
+        return;
+    }
+    s->stats.vectors++;
+    if (s->batch.count >= s->batch_size) feature_stream_seal(s);
+}
+
+uint16_t feature_stream_poll(feature_stream_t* s, uint16_t max_frames) {
+    if (!s->send) return 0;
+    uint16_t sent = 0;
+
+    // Spilled frames are older than anything in RAM
+    if (s->spill && s->spill->peek) {
+        uint8_t* scratch = slot(s, s->slot_count);
+        while (sent < max_frames) {
+            size_t len = s->spill->peek(scratch, s->slot_size, s->spill->ctx);
+            if (len == 0) break;
+            telemetry_header_t h;
+            if (len > s->slot_size || !telemetry_check(scratch, len, &h, NULL) ||
+                h.type != TELEMETRY_FEATURES || h.body_len < 3) {
+                s->spill->pop(s->spill->ctx);  // Corrupt or foreign: skip it
+                s->stats.frames_dropped++;
+                continue;
+            }
+            if (!s->send(scratch, len, s->send_ctx)) return sent;
+            s->spill->pop(s->spill->ctx);
+            s->stats.frames_sent++;
+            s->stats.vectors_sent += frame_vectors(scratch);
+            sent++;
+        }
+    }
+
+    while (sent < max_frames && s->queued > 0) {
+        uint8_t* p = slot(s, s->head);
+        if (!s->send(p + 2, slot_len(p), s->send_ctx)) break;
+        s->stats.frames_sent++;
+        s->stats.vectors_sent += frame_vectors(p + 2);
+        s->head = (uint16_t)((s->head + 1) % s->slot_count);
+        s->queued--;
+        sent++;
+    }
+    return sent;
+}
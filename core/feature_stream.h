@@ -0,0 +1,97 @@
+/**
+ * @file feature_stream.h
+ * @brief Raw feature-vector streaming in batched telemetry frames
+ *
+ * Every vector (features, cluster, distance) goes into an open
+ * telemetry_batch_t; after `batch_size` vectors the frame is sealed and
+ * queued. feature_stream_poll() hands queued frames to the transport,
+ * oldest first, until it refuses one (broker down) or the per-call limit.
+ *
+ * Backpressure: when the RAM queue is full, the oldest frame is given to
+ * the spill backend (e.g. flash), or dropped when there is none or it is
+ * full. Spilled frames drain before RAM frames, so order is preserved.
+ * Frame seq numbers let the receiver count what was dropped.
+ *
+ * Ring slots live in one caller buffer of FEATURE_STREAM_STORAGE_SIZE()
+ * bytes: `queue_frames` sealed frames, the open batch and a scratch slot
+ * for reading back spilled frames.
+ */
+
+#ifndef FEATURE_STREAM_H
+#define FEATURE_STREAM_H
+
+#include "telemetry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns false if the frame was not sent (not connected, publish failed)
+typedef bool (*feature_stream_send_fn)(const uint8_t* frame, size_t len, void* ctx);
+
+// Secondary store for frames evicted from RAM. With peek/pop NULL the store
+// drains them itself (e.g. offline_queue.h), and the caller must hold off
+// poll() until it has, to keep frames in order.
+typedef struct {
+    bool (*write)(const uint8_t* frame, size_t len, void* ctx);  // False when full
+    size_t (*peek)(uint8_t* buf, size_t cap, void* ctx);         // Oldest frame's length, 0 if none
+    void (*pop)(void* ctx);                                      // Drop the peeked frame
+    void* ctx;
+} feature_stream_spill_t;
+
+typedef struct {
+    uint32_t vectors;          // Added
+    uint32_t vectors_sent;
+    uint32_t frames_sent;
+    uint32_t frames_spilled;
+    uint32_t frames_dropped;
+    uint32_t vectors_dropped;  // In dropped frames, or refused by the batch
+} feature_stream_stats_t;
+
+#define FEATURE_STREAM_SLOT_SIZE(dim, batch) \
+    ((TELEMETRY_BATCH_SIZE(dim, batch) + 2 + 7) & ~(size_t)7)
+#define FEATURE_STREAM_STORAGE_SIZE(dim, batch, queue_frames) \
+    (((size_t)(queue_frames) + 2) * FEATURE_STREAM_SLOT_SIZE(dim, batch))
+
+typedef struct {
+    uint8_t* slots;            // Each: u16 frame length + frame bytes
+    size_t slot_size;
+    uint16_t slot_count;       // queue_frames + open batch (scratch slot follows)
+    uint16_t head;             // Oldest queued frame
+    uint16_t queued;
+    uint16_t batch_size;
+    uint16_t seq;
+    telemetry_batch_t batch;   // Writes into slot (head + queued) % slot_count
+
+    feature_stream_send_fn send;
+    void* send_ctx;
+    const feature_stream_spill_t* spill;  // NULL: drop oldest
+
+    feature_stream_stats_t stats;
+} feature_stream_t;
+
+bool feature_stream_init(feature_stream_t* s, uint8_t dim, uint16_t batch_size,
+                         uint16_t queue_frames, void* storage, size_t storage_bytes);
+void feature_stream_set_transport(feature_stream_t* s, feature_stream_send_fn send, void* ctx);
+void feature_stream_set_spill(feature_stream_t* s, const feature_stream_spill_t* spill);
+
+// Appends one vector; seals and queues the batch when it reaches batch_size.
+// A vector the open batch refuses seals it early and goes in the next one.
+void feature_stream_add(feature_stream_t* s, uint32_t timestamp, int32_t cluster,
+                        float distance, const float* features);
+
+// Seals a partial batch (e.g. on a time limit). False if it was empty.
+bool feature_stream_seal(feature_stream_t* s);
+
+// Sends up to max_frames queued frames; returns how many were sent
+uint16_t feature_stream_poll(feature_stream_t* s, uint16_t max_frames);
+
+static inline uint16_t feature_stream_queued(const feature_stream_t* s) {
+    return s->queued;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
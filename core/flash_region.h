@@ -0,0 +1,50 @@
+/**
+ * @file flash_region.h
+ * @brief Byte-addressed flash region with NOR semantics (backend interface)
+ *
+ * Persistence code (offline_queue.c, ...) talks to flash only through this
+ * struct, so the same logic runs on the device (flash_region_fs.h: a
+ * preallocated LittleFS file) and on Linux (tests/host/flash_file.h).
+ *
+ * Rules callers follow, as on raw NOR flash:
+ *   - erase() works on whole sectors and sets every byte to 0xFF
+ *   - write() only clears bits: program erased bytes, or clear flag bytes
+ *     in place (0xFF -> 0x00)
+ *   - a write interrupted by power loss may leave any prefix of its bytes
+ *   - an erase interrupted by power loss may leave old bytes anywhere in
+ *     its range: it only raises bits, so stale data can look valid
+ */
+
+#ifndef FLASH_REGION_H
+#define FLASH_REGION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FLASH_ERASED 0xFF
+
+typedef struct {
+    bool (*read)(uint32_t offset, void* buf, uint32_t len, void* ctx);
+    bool (*write)(uint32_t offset, const void* buf, uint32_t len, void* ctx);
+    bool (*erase)(uint32_t offset, uint32_t len, void* ctx);  // Sector-aligned
+    void* ctx;
+    uint32_t size;         // Bytes, a multiple of sector_size
+    uint32_t sector_size;  // Erase unit
+} flash_region_t;
+
+/**
+ * Zeroes the [seq u32][magic u32] header of a log segment at `offset`
+ * before the segment is erased (no-op if already erased). A cut erase
+ * could leave the old header valid with a higher seq; a zeroed magic
+ * cannot come back.
+ */
+static inline bool flash_region_retire(const flash_region_t* f, uint32_t offset) {
+    uint32_t h[2];
+    if (!f->read(offset, h, sizeof(h), f->ctx)) return false;
+    if (h[0] == 0xFFFFFFFF && h[1] == 0xFFFFFFFF) return true;
+    static const uint32_t zero[2] = {0, 0};
+    return f->write(offset, zero, sizeof(zero), f->ctx);
+}
+
+#endif
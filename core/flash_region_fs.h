@@ -0,0 +1,83 @@
+/**
+ * @file flash_region_fs.h
+ * @brief flash_region_t on a preallocated LittleFS file (ESP32 and RP2350)
+ *
+ * The file is created once, filled with 0xFF, and then only rewritten in
+ * place; LittleFS adds its own wear leveling and power-loss safety
+ * underneath. Every write is flushed before returning.
+ */
+
+#ifndef FLASH_REGION_FS_H
+#define FLASH_REGION_FS_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "flash_region.h"
+
+class FsFlashRegion {
+private:
+  File file;
+  flash_region_t region_;
+
+  static bool readCb(uint32_t offset, void* buf, uint32_t len, void* ctx) {
+    File& f = ((FsFlashRegion*)ctx)->file;
+    return f.seek(offset) && f.read((uint8_t*)buf, len) == len;
+  }
+
+  static bool writeCb(uint32_t offset, const void* buf, uint32_t len, void* ctx) {
+    File& f = ((FsFlashRegion*)ctx)->file;
+    if (!f.seek(offset) || f.write((const uint8_t*)buf, len) != len) return false;
+    f.flush();
+    return true;
+  }
+
+  static bool eraseCb(uint32_t offset, uint32_t len, void* ctx) {
+    File& f = ((FsFlashRegion*)ctx)->file;
+    uint8_t ff[64];
+    memset(ff, FLASH_ERASED, sizeof(ff));
+    if (!f.seek(offset)) return false;
+    for (uint32_t done = 0; done < len; done += sizeof(ff)) {
+      if (f.write(ff, sizeof(ff)) != sizeof(ff)) return false;
+    }
+    f.flush();
+    return true;
+  }
+
+public:
+  /**
+   * Open (or create, erased) `path` as sectors x sector_size bytes
+   */
+  bool begin(const char* path, uint32_t sectors, uint32_t sectorSize) {
+    #ifdef ESP32
+      if (!LittleFS.begin(true)) return false;  // true = format on first use
+    #else
+      if (!LittleFS.begin()) return false;
+    #endif
+
+    uint32_t size = sectors * sectorSize;
+    if (LittleFS.exists(path)) {
+      file = LittleFS.open(path, "r+");
+      if (file && file.size() != size) {
+        file.close();
+        LittleFS.remove(path);
+      }
+    }
+    if (!file) {
+      file = LittleFS.open(path, "w+");
+      if (!file) return false;
+      if (!eraseCb(0, size, this)) return false;
+    }
+
+    region_.read = readCb;
+    region_.write = writeCb;
+    region_.erase = eraseCb;
+    region_.ctx = this;
+    region_.size = size;
+    region_.sector_size = sectorSize;
+    return true;
+  }
+
+  const flash_region_t* region() const { return &region_; }
+};
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file kmeans_distance.c
+ * @brief SoA squared-distance kernels (AVX2 / SSE4.1 / scalar)
+ *
+ * |a - b| of two int32 always fits in uint32, so max(a,b) - min(a,b)
+ * computed with 32-bit wraparound is the exact magnitude. Squaring it as
+ * unsigned 32x32->64 (mul_epu32) is exact too, which is what keeps the
+ * SIMD paths bit-identical to the scalar loop.
+ */
+
+#include "kmeans_distance.h"
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+static inline uint64_t sq_shift(fixed_t a, fixed_t b) {
+    int64_t diff = (int64_t)a - (int64_t)b;
+    uint64_t mag = (uint64_t)(diff < 0 ? -diff : diff);
+    return (mag * mag) >> FIXED_POINT_SHIFT;
+}
+
+static void distances_scalar_from(const fixed_t* point, const fixed_t* centroids,
+                                  uint8_t first, uint8_t k, uint8_t dim, uint8_t stride,
+                                  fixed_t* out) {
+    for (uint8_t c = first; c < k; c++) {
+        uint64_t sum = 0;
+        for (uint8_t d = 0; d < dim; d++) {
+            sum += sq_shift(point[d], centroids[d * stride + c]);
+        }
+        out[c] = (fixed_t)(int64_t)sum;
+    }
+}
+
+void kmeans_distances_scalar(const fixed_t* point, const fixed_t* centroids,
+                             uint8_t k, uint8_t dim, uint8_t stride, fixed_t* out) {
+    distances_scalar_from(point, centroids, 0, k, dim, stride, out);
+}
+
+#if defined(__SSE4_1__)
+// 4 clusters per step; returns the first cluster not handled
+static uint8_t distances_sse41(const fixed_t* point, const fixed_t* centroids,
+                               uint8_t first, uint8_t k, uint8_t dim, uint8_t stride,
+                               fixed_t* out) {
+    uint8_t c = first;
+    for (; c + 4 <= k; c += 4) {
+        __m128i acc_even = _mm_setzero_si128();  // clusters c, c+2
+        __m128i acc_odd = _mm_setzero_si128();   // clusters c+1, c+3
+        for (uint8_t d = 0; d < dim; d++) {
+            __m128i cv = _mm_loadu_si128((const __m128i*)&centroids[d * stride + c]);
+            __m128i pv = _mm_set1_epi32(point[d]);
+            __m128i mag = _mm_sub_epi32(_mm_max_epi32(cv, pv), _mm_min_epi32(cv, pv));
+            __m128i mag_odd = _mm_srli_epi64(mag, 32);
+            acc_even = _mm_add_epi64(acc_even, _mm_srli_epi64(_mm_mul_epu32(mag, mag), FIXED_POINT_SHIFT));
+            acc_odd = _mm_add_epi64(acc_odd, _mm_srli_epi64(_mm_mul_epu32(mag_odd, mag_odd), FIXED_POINT_SHIFT));
+        }
+        uint64_t even[2], odd[2];
+        _mm_storeu_si128((__m128i*)even, acc_even);
+        _mm_storeu_si128((__m128i*)odd, acc_odd);
+        out[c + 0] = (fixed_t)(int64_t)even[0];
+        out[c + 1] = (fixed_t)(int64_t)odd[0];
+        out[c + 2] = (fixed_t)(int64_t)even[1];
+        out[c + 3] = (fixed_t)(int64_t)odd[1];
+    }
+    return c;
+}
+#endif
+
+#if defined(__AVX2__)
+// 8 clusters per step; returns the first cluster not handled
+static uint8_t distances_avx2(const fixed_t* point, const fixed_t* centroids,
+                              uint8_t k, uint8_t dim, uint8_t stride, fixed_t* out) {
+    uint8_t c = 0;
+    for (; c + 8 <= k; c += 8) {
+        __m256i acc_even = _mm256_setzero_si256();  // clusters c, c+2, c+4, c+6
+        __m256i acc_odd = _mm256_setzero_si256();   // clusters c+1, c+3, c+5, c+7
+        for (uint8_t d = 0; d < dim; d++) {
+            __m256i cv = _mm256_loadu_si256((const __m256i*)&centroids[d * stride + c]);
+            __m256i pv = _mm256_set1_epi32(point[d]);
+            __m256i mag = _mm256_sub_epi32(_mm256_max_epi32(cv, pv), _mm256_min_epi32(cv, pv));
+            __m256i mag_odd = _mm256_srli_epi64(mag, 32);
+            acc_even = _mm256_add_epi64(acc_even, _mm256_srli_epi64(_mm256_mul_epu32(mag, mag), FIXED_POINT_SHIFT));
+            acc_odd = _mm256_add_epi64(acc_odd, _mm256_srli_epi64(_mm256_mul_epu32(mag_odd, mag_odd), FIXED_POINT_SHIFT));
+        }
+        uint64_t even[4], odd[4];
+        _mm256_storeu_si256((__m256i*)even, acc_even);
+        _mm256_storeu_si256((__m256i*)odd, acc_odd);
+        for (int j = 0; j < 4; j++) {
+            out[c + 2 * j] = (fixed_t)(int64_t)even[j];
+            out[c + 2 * j + 1] = (fixed_t)(int64_t)odd[j];
+        }
+    }
+    return c;
+}
+#endif
+
+void kmeans_distances(const fixed_t* point, const fixed_t* centroids,
+                      uint8_t k, uint8_t dim, uint8_t stride, fixed_t* out) {
+    uint8_t c = 0;
+#if defined(__AVX2__)
+    c = distances_avx2(point, centroids, k, dim, stride, out);
+#endif
+#if defined(__SSE4_1__)
+    c = distances_sse41(point, centroids, c, k, dim, stride, out);
+#endif
+    distances_scalar_from(point, centroids, c, k, dim, stride, out);
+}
+
+const char* kmeans_distance_kernel(void) {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE4_1__)
+    return "sse4.1";
+#else
+    return "scalar";
+#endif
+}
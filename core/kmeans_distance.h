@@ -0,0 +1,43 @@
+/**
+ * @file kmeans_distance.h
+ * @brief Nearest-centroid distance kernels over a structure-of-arrays layout
+ *
+ * Centroids are stored dimension-major: centroids[d * stride + c] is
+ * dimension d of cluster c. One dimension of every cluster is contiguous,
+ * so a kernel computes the distance to all K clusters at once, one SIMD
+ * lane per cluster.
+ *
+ * Kernel is picked at build time:
+ *   __AVX2__    8 clusters per step (+ SSE4.1 tail)
+ *   __SSE4_1__  4 clusters per step
+ *   otherwise   portable scalar loop
+ *
+ * Every kernel is bit-exact with kmeans_distances_scalar(): per-element
+ * (diff^2 >> FIXED_POINT_SHIFT), summed in 64 bits, truncated to fixed_t.
+ */
+
+#ifndef KMEANS_DISTANCE_H
+#define KMEANS_DISTANCE_H
+
+#include "streaming_kmeans.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Squared distances from `point` to clusters 0..k-1 -> out[0..k-1]
+void kmeans_distances(const fixed_t* point, const fixed_t* centroids,
+                      uint8_t k, uint8_t dim, uint8_t stride, fixed_t* out);
+
+// Portable reference (always compiled)
+void kmeans_distances_scalar(const fixed_t* point, const fixed_t* centroids,
+                             uint8_t k, uint8_t dim, uint8_t stride, fixed_t* out);
+
+// "avx2", "sse4.1" or "scalar"
+const char* kmeans_distance_kernel(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file kmeans_fleet.c
+ * @brief Pooled per-device k-means models
+ */
+
+#include "kmeans_fleet.h"
+#include <string.h>
+
+#define GENERATION_MASK 0x7Fu  // Keeps handles non-negative
+
+// Leads every slot; stays valid while the slot is free
+typedef struct {
+    uint32_t generation;
+    int32_t next_free;
+} slot_tag_t;
+
+static inline uint8_t* slot_of(const kmeans_fleet_t* fleet, uint32_t slot) {
+    return fleet->arena + (size_t)slot * fleet->slot_size;
+}
+
+static inline slot_tag_t* tag_of(const kmeans_fleet_t* fleet, uint32_t slot) {
+    return (slot_tag_t*)slot_of(fleet, slot);
+}
+
+static inline kmeans_model_t* model_of(const kmeans_fleet_t* fleet, uint32_t slot) {
+    return (kmeans_model_t*)(slot_of(fleet, slot) + KMEANS_FLEET_TAG_SIZE);
+}
+
+// Storage follows the model header
+static inline uint8_t* slot_storage(const kmeans_fleet_t* fleet, uint32_t slot) {
+    return slot_of(fleet, slot) + KMEANS_FLEET_TAG_SIZE + KMEANS_MODEL_HEADER_SIZE;
+}
+
+static inline kmeans_device_t handle_of(const kmeans_fleet_t* fleet, uint32_t slot) {
+    return (kmeans_device_t)((tag_of(fleet, slot)->generation << KMEANS_FLEET_SLOT_BITS) | slot);
+}
+
+bool kmeans_fleet_init(kmeans_fleet_t* fleet, void* arena, size_t arena_size,
+                       uint8_t feature_dim, uint8_t max_clusters, uint16_t buffer_capacity) {
+    if (!fleet || !arena || ((uintptr_t)arena & 7u) != 0) return false;
+    if (feature_dim == 0 || feature_dim > MAX_FEATURES) return false;
+    if (max_clusters == 0 || max_clusters > MAX_CLUSTERS) return false;
+    if (buffer_capacity < BOOTSTRAP_SAMPLES) return false;
+
+    size_t slot_size = KMEANS_FLEET_SLOT_SIZE(max_clusters, feature_dim, buffer_capacity);
+    if (arena_size < slot_size) return false;
+
+    memset(fleet, 0, sizeof(kmeans_fleet_t));
+    fleet->arena = (uint8_t*)arena;
+    fleet->slot_size = slot_size;
+    fleet->capacity = (uint32_t)(arena_size / slot_size);
+    if (fleet->capacity > KMEANS_FLEET_MAX_DEVICES) fleet->capacity = KMEANS_FLEET_MAX_DEVICES;
+    fleet->free_head = KMEANS_FLEET_INVALID;
+    fleet->feature_dim = feature_dim;
+    fleet->max_clusters = max_clusters;
+    fleet->buffer_capacity = buffer_capacity;
+    return true;
+}
+
+kmeans_device_t kmeans_fleet_create(kmeans_fleet_t* fleet, float learning_rate) {
+    uint32_t slot;
+
+    // Reuse a destroyed slot first, then extend the high-water mark
+    if (fleet->free_head != KMEANS_FLEET_INVALID) {
+        slot = (uint32_t)fleet->free_head;
+        fleet->free_head = tag_of(fleet, slot)->next_free;
+    } else if (fleet->high_water < fleet->capacity) {
+        slot = fleet->high_water++;
+        tag_of(fleet, slot)->generation = 0;
+    } else {
+        return KMEANS_FLEET_INVALID;
+    }
+
+    // Shape was validated in kmeans_fleet_init, so binding cannot fail
+    kmeans_init_with_storage(model_of(fleet, slot), fleet->feature_dim, learning_rate,
+                             fleet->max_clusters, fleet->buffer_capacity,
+                             slot_storage(fleet, slot),
+                             KMEANS_STORAGE_SIZE(fleet->max_clusters, fleet->feature_dim,
+                                                 fleet->buffer_capacity));
+
+    fleet->live++;
+    return handle_of(fleet, slot);
+}
+
+bool kmeans_fleet_destroy(kmeans_fleet_t* fleet, kmeans_device_t device) {
+    kmeans_model_t* model = kmeans_fleet_model(fleet, device);
+    if (!model) return false;
+
+    uint32_t slot = KMEANS_FLEET_SLOT_OF(device);
+    slot_tag_t* tag = tag_of(fleet, slot);
+    model->initialized = false;
+    tag->generation = (tag->generation + 1) & GENERATION_MASK;  // Retire every old handle
+    tag->next_free = fleet->free_head;
+    fleet->free_head = (int32_t)slot;
+    fleet->live--;
+    return true;
+}
+
+kmeans_model_t* kmeans_fleet_model(const kmeans_fleet_t* fleet, kmeans_device_t device) {
+    if (device < 0) return NULL;
+    uint32_t slot = KMEANS_FLEET_SLOT_OF(device);
+    if (slot >= fleet->high_water) return NULL;
+    if (tag_of(fleet, slot)->generation != (uint32_t)device >> KMEANS_FLEET_SLOT_BITS) return NULL;
+    kmeans_model_t* model = model_of(fleet, slot);
+    return model->initialized ? model : NULL;
+}
+
+int8_t kmeans_fleet_update(kmeans_fleet_t* fleet, kmeans_device_t device, const fixed_t* point) {
+    kmeans_model_t* model = kmeans_fleet_model(fleet, device);
+    if (!model) return -1;
+    return kmeans_update(model, point);
+}
+
+int8_t kmeans_fleet_predict(const kmeans_fleet_t* fleet, kmeans_device_t device, const fixed_t* point) {
+    const kmeans_model_t* model = kmeans_fleet_model(fleet, device);
+    if (!model) return -1;
+    return (int8_t)kmeans_predict(model, point);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file kmeans_fleet.h
+ * @brief Many streaming k-means models in one pooled arena (gateway side)
+ *
+ * Every device gets a fixed-size slot: a small tag, the kmeans_model_t
+ * header (no embedded block) and storage sized to the fleet's real K, D and
+ * buffer capacity, carved as kmeans_init_with_storage() lays it out. Slots
+ * are recycled through a free list, so create/destroy never fragments.
+ *
+ * Slot layout:
+ *   [tag: generation, free link][model header][KMEANS_STORAGE_SIZE(K, D, cap)]
+ */
+
+#ifndef KMEANS_FLEET_H
+#define KMEANS_FLEET_H
+
+#include "streaming_kmeans.h"
+
+#define KMEANS_FLEET_INVALID (-1)
+
+/**
+ * Device handle: slot index in the low KMEANS_FLEET_SLOT_BITS, the slot's
+ * generation above it. Destroy bumps the generation, so a handle kept past
+ * kmeans_fleet_destroy() is rejected instead of reaching the slot's next
+ * device (until the 7-bit generation wraps after 128 reuses of one slot).
+ * A fresh fleet hands out handles equal to slot indexes.
+ */
+typedef int32_t kmeans_device_t;  // KMEANS_FLEET_INVALID on failure
+
+#define KMEANS_FLEET_SLOT_BITS 24
+#define KMEANS_FLEET_MAX_DEVICES (1u << KMEANS_FLEET_SLOT_BITS)
+#define KMEANS_FLEET_SLOT_OF(device) ((uint32_t)(device) & (KMEANS_FLEET_MAX_DEVICES - 1u))
+
+/**
+ * Bytes per device slot / arena bytes for `n` devices
+ */
+#define KMEANS_FLEET_TAG_SIZE 8
+#define KMEANS_FLEET_SLOT_SIZE(k, d, cap) \
+    (KMEANS_FLEET_TAG_SIZE + KMEANS_MODEL_HEADER_SIZE + KMEANS_STORAGE_SIZE(k, d, cap))
+#define KMEANS_FLEET_ARENA_SIZE(n, k, d, cap) \
+    ((size_t)(n) * KMEANS_FLEET_SLOT_SIZE(k, d, cap))
+
+typedef struct {
+    uint8_t* arena;          // Caller-owned, 8-byte aligned
+    size_t slot_size;
+    uint32_t capacity;       // Max devices (<= KMEANS_FLEET_MAX_DEVICES)
+    uint32_t live;           // Devices currently created
+    uint32_t high_water;     // Slots ever handed out
+    int32_t free_head;       // Recycled slot indexes (linked through slot tags)
+
+    // Shape shared by every device
+    uint8_t feature_dim;
+    uint8_t max_clusters;
+    uint16_t buffer_capacity;
+} kmeans_fleet_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool kmeans_fleet_init(kmeans_fleet_t* fleet, void* arena, size_t arena_size,
+                       uint8_t feature_dim, uint8_t max_clusters, uint16_t buffer_capacity);
+
+// Device lifecycle
+kmeans_device_t kmeans_fleet_create(kmeans_fleet_t* fleet, float learning_rate);
+bool kmeans_fleet_destroy(kmeans_fleet_t* fleet, kmeans_device_t device);
+
+// Per-device model (NULL if handle is stale or not live). Use the regular kmeans_*
+// API on it for labeling, motor status, thresholds, queries.
+kmeans_model_t* kmeans_fleet_model(const kmeans_fleet_t* fleet, kmeans_device_t device);
+
+// Hot path
+int8_t kmeans_fleet_update(kmeans_fleet_t* fleet, kmeans_device_t device, const fixed_t* point);
+int8_t kmeans_fleet_predict(const kmeans_fleet_t* fleet, kmeans_device_t device, const fixed_t* point);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,231 @@
+/**
+ * @file kmeans_snapshot.c
+ * @brief Flat multi-model snapshot writer and zero-copy reader
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "kmeans_snapshot.h"
+#include "crc.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SNAPSHOT_HAS_MMAP 1
+#endif
+
+// Header fields
+#define H_MAGIC 0
+#define H_VERSION 4
+#define H_DIM 6
+#define H_MAX_CLUSTERS 7
+#define H_CLUSTER_SIZE 8
+#define H_RECORD_SIZE 12
+#define H_COUNT 16
+#define H_CRC 60
+
+static const uint8_t* record_of(const kmeans_snapshot_t* s, uint32_t index) {
+    return s->base + KMEANS_SNAPSHOT_HEADER_SIZE + (size_t)index * s->record_size;
+}
+
+// =============================================================================
+// WRITER
+// =============================================================================
+
+static void encode_header(const kmeans_snapshot_writer_t* w, uint8_t* h) {
+    memset(h, 0, KMEANS_SNAPSHOT_HEADER_SIZE);
+    uint32_t magic = KMEANS_SNAPSHOT_MAGIC, cluster_size = sizeof(cluster_t);
+    uint16_t version = KMEANS_SNAPSHOT_VERSION;
+    memcpy(h + H_MAGIC, &magic, 4);
+    memcpy(h + H_VERSION, &version, 2);
+    h[H_DIM] = w->feature_dim;
+    h[H_MAX_CLUSTERS] = w->max_clusters;
+    memcpy(h + H_CLUSTER_SIZE, &cluster_size, 4);
+    memcpy(h + H_RECORD_SIZE, &w->record_size, 4);
+    memcpy(h + H_COUNT, &w->count, 4);
+    uint32_t crc = crc32(h, H_CRC);
+    memcpy(h + H_CRC, &crc, 4);
+}
+
+bool kmeans_snapshot_begin(kmeans_snapshot_writer_t* w, FILE* fp,
+                           uint8_t feature_dim, uint8_t max_clusters) {
+    if (!w || !fp) return false;
+    if (feature_dim == 0 || feature_dim > MAX_FEATURES) return false;
+    if (max_clusters == 0 || max_clusters > MAX_CLUSTERS) return false;
+
+    memset(w, 0, sizeof(*w));
+    w->fp = fp;
+    w->feature_dim = feature_dim;
+    w->max_clusters = max_clusters;
+    w->record_size = (uint32_t)KMEANS_SNAPSHOT_RECORD_SIZE(max_clusters, feature_dim);
+
+    // Placeholder until finish() knows the count
+    uint8_t h[KMEANS_SNAPSHOT_HEADER_SIZE];
+    memset(h, 0, sizeof(h));
+    w->failed = fwrite(h, 1, sizeof(h), fp) != sizeof(h);
+    return !w->failed;
+}
+
+bool kmeans_snapshot_add(kmeans_snapshot_writer_t* w, const char* id, const kmeans_model_t* model) {
+    if (!w || w->failed || !id || !model || !model->initialized) return false;
+    size_t id_len = strlen(id);
+    if (id_len == 0 || id_len >= KMEANS_SNAPSHOT_ID_LEN) return false;
+    if (w->count > 0 && strcmp(id, w->last_id) <= 0) return false;
+    if (model->feature_dim != w->feature_dim || model->k > w->max_clusters) return false;
+    if (w->count == INT32_MAX) return false;
+
+    uint8_t rec[KMEANS_SNAPSHOT_RECORD_SIZE(MAX_CLUSTERS, MAX_FEATURES)];
+    memset(rec, 0, w->record_size);
+    memcpy(rec, id, id_len);
+    rec[32] = model->k;
+    rec[33] = model->feature_dim;
+    rec[34] = (uint8_t)model->alpha_schedule;
+    memcpy(rec + 36, &model->total_points, 4);
+    memcpy(rec + 40, &model->outlier_threshold, 4);
+    memcpy(rec + 44, &model->learning_rate, 4);
+
+    // Same arrays as the bound model storage, restrided to max_clusters
+    uint8_t K = w->max_clusters;
+    uint8_t* p = rec + KMEANS_SNAPSHOT_RECORD_HEADER;
+    memcpy(p, model->clusters, (size_t)model->k * sizeof(cluster_t));
+    p += KMEANS_ALIGN8((size_t)K * sizeof(cluster_t));
+    fixed_t* centroids = (fixed_t*)p;
+    for (uint8_t d = 0; d < model->feature_dim; d++) {
+        memcpy(centroids + (size_t)d * K, model->centroids + (size_t)d * model->max_clusters,
+               (size_t)model->k * sizeof(fixed_t));
+    }
+    p += KMEANS_ALIGN8((size_t)K * model->feature_dim * sizeof(fixed_t));
+    memcpy(p, model->labels, (size_t)model->k * MAX_LABEL_LENGTH);
+
+    if (fwrite(rec, 1, w->record_size, w->fp) != w->record_size) {
+        w->failed = true;
+        return false;
+    }
+    memcpy(w->last_id, rec, KMEANS_SNAPSHOT_ID_LEN);
+    w->count++;
+    return true;
+}
+
+bool kmeans_snapshot_finish(kmeans_snapshot_writer_t* w) {
+    if (!w || w->failed) return false;
+    uint8_t h[KMEANS_SNAPSHOT_HEADER_SIZE];
+    encode_header(w, h);
+    if (fseek(w->fp, 0, SEEK_SET) != 0 || fwrite(h, 1, sizeof(h), w->fp) != sizeof(h)) return false;
+    if (fseek(w->fp, 0, SEEK_END) != 0) return false;
+    return fflush(w->fp) == 0;
+}
+
+// =============================================================================
+// READER
+// =============================================================================
+
+bool kmeans_snapshot_open(kmeans_snapshot_t* s, const void* data, size_t len) {
+    if (!s || !data || len < KMEANS_SNAPSHOT_HEADER_SIZE || ((uintptr_t)data & 7u) != 0) return false;
+    const uint8_t* h = (const uint8_t*)data;
+    uint32_t magic, cluster_size, record_size, count, crc;
+    uint16_t version;
+    memcpy(&magic, h + H_MAGIC, 4);
+    memcpy(&version, h + H_VERSION, 2);
+    memcpy(&cluster_size, h + H_CLUSTER_SIZE, 4);
+    memcpy(&record_size, h + H_RECORD_SIZE, 4);
+    memcpy(&count, h + H_COUNT, 4);
+    memcpy(&crc, h + H_CRC, 4);
+
+    if (magic != KMEANS_SNAPSHOT_MAGIC || version != KMEANS_SNAPSHOT_VERSION) return false;
+    if (crc != crc32(h, H_CRC) || cluster_size != sizeof(cluster_t)) return false;
+    uint8_t dim = h[H_DIM], max_clusters = h[H_MAX_CLUSTERS];
+    if (dim == 0 || dim > MAX_FEATURES || max_clusters == 0 || max_clusters > MAX_CLUSTERS) return false;
+    if (record_size != KMEANS_SNAPSHOT_RECORD_SIZE(max_clusters, dim) || count > INT32_MAX) return false;
+    if ((len - KMEANS_SNAPSHOT_HEADER_SIZE) / record_size < count) return false;
+
+    s->base = h;
+    s->size = len;
+    s->count = count;
+    s->record_size = record_size;
+    s->feature_dim = dim;
+    s->max_clusters = max_clusters;
+    return true;
+}
+
+bool kmeans_snapshot_map(kmeans_snapshot_t* s, const char* path) {
+#ifdef SNAPSHOT_HAS_MMAP
+    if (!s || !path) return false;
+    memset(s, 0, sizeof(*s));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < KMEANS_SNAPSHOT_HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file
+    if (map == MAP_FAILED) return false;
+    if (!kmeans_snapshot_open(s, map, (size_t)st.st_size)) {
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+    s->map = map;
+    s->map_size = (size_t)st.st_size;
+    return true;
+#else
+    (void)s; (void)path;
+    return false;
+#endif
+}
+
+void kmeans_snapshot_unmap(kmeans_snapshot_t* s) {
+#ifdef SNAPSHOT_HAS_MMAP
+    if (s && s->map) munmap(s->map, s->map_size);
+#endif
+    if (s) memset(s, 0, sizeof(*s));
+}
+
+int32_t kmeans_snapshot_find(const kmeans_snapshot_t* s, const char* id) {
+    if (!s || !s->base || !id) return -1;
+    uint32_t lo = 0, hi = s->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int c = strncmp(id, (const char*)record_of(s, mid), KMEANS_SNAPSHOT_ID_LEN);
+        if (c == 0) return (int32_t)mid;
+        if (c < 0) hi = mid;
+        else lo = mid + 1;
+    }
+    return -1;
+}
+
+const char* kmeans_snapshot_id(const kmeans_snapshot_t* s, uint32_t index) {
+    if (!s || !s->base || index >= s->count) return NULL;
+    return (const char*)record_of(s, index);
+}
+
+bool kmeans_snapshot_model(const kmeans_snapshot_t* s, uint32_t index, kmeans_model_t* view) {
+    if (!s || !s->base || !view || index >= s->count) return false;
+    const uint8_t* rec = record_of(s, index);
+    if (rec[32] > s->max_clusters || rec[33] != s->feature_dim) return false;
+
+    memset(view, 0, offsetof(kmeans_model_t, embedded));  // May be header-only
+    uint8_t K = s->max_clusters;
+    uint8_t* p = (uint8_t*)(uintptr_t)(rec + KMEANS_SNAPSHOT_RECORD_HEADER);
+    view->clusters = (cluster_t*)p;
+    p += KMEANS_ALIGN8((size_t)K * sizeof(cluster_t));
+    view->centroids = (fixed_t*)p;
+    p += KMEANS_ALIGN8((size_t)K * s->feature_dim * sizeof(fixed_t));
+    view->labels = (char (*)[MAX_LABEL_LENGTH])p;
+
+    view->max_clusters = K;
+    view->k = rec[32];
+    view->feature_dim = rec[33];
+    view->alpha_schedule = (alpha_schedule_t)rec[34];
+    memcpy(&view->total_points, rec + 36, 4);
+    memcpy(&view->outlier_threshold, rec + 40, 4);
+    memcpy(&view->learning_rate, rec + 44, 4);
+    view->initialized = true;
+    view->state = view->k ? STATE_NORMAL : STATE_BOOTSTRAP;
+    view->motor_running = true;
+    return true;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file kmeans_snapshot.h
+ * @brief Many models in one flat, mmap-able file (gateway side)
+ *
+ * A gateway restart reloads every device model. Instead of parsing one
+ * file per device, the fleet is written once into a snapshot whose records
+ * already hold the in-memory layout of kmeans_model_t storage (cluster_t
+ * array, dimension-major centroids, labels). Opening it checks the header
+ * only; a model is a view whose pointers lead straight into the mapping,
+ * ready for kmeans_predict() with no copy.
+ *
+ * File layout (host byte order and ABI; magic and cluster_t size are
+ * checked on open), every offset relative to the file start:
+ *
+ *   0    64 B header: magic, version, feature_dim, max_clusters,
+ *        sizeof(cluster_t), record size, count, CRC-32 of the header
+ *   64   count records of KMEANS_SNAPSHOT_RECORD_SIZE(k, d) bytes, sorted
+ *        by device id:
+ *          id[32], k, feature_dim, alpha_schedule, 0, total_points,
+ *          outlier_threshold, learning_rate,
+ *          cluster_t[k], centroids[d x k], labels[k][MAX_LABEL_LENGTH]
+ *
+ * Records are 8-byte aligned. Only the header carries a CRC: checking the
+ * whole file would read every page, which is what the format avoids.
+ */
+
+#ifndef KMEANS_SNAPSHOT_H
+#define KMEANS_SNAPSHOT_H
+
+#include "streaming_kmeans.h"
+#include <stdio.h>
+
+#define KMEANS_SNAPSHOT_MAGIC 0x534C4F54    // "TOLS"
+#define KMEANS_SNAPSHOT_VERSION 1
+#define KMEANS_SNAPSHOT_HEADER_SIZE 64
+#define KMEANS_SNAPSHOT_ID_LEN 32           // Device id, NUL-padded
+
+#define KMEANS_SNAPSHOT_RECORD_HEADER (KMEANS_SNAPSHOT_ID_LEN + 16)
+#define KMEANS_SNAPSHOT_RECORD_SIZE(k, d) \
+    (KMEANS_SNAPSHOT_RECORD_HEADER + \
+     KMEANS_ALIGN8((size_t)(k) * sizeof(cluster_t)) + \
+     KMEANS_ALIGN8((size_t)(k) * (d) * sizeof(fixed_t)) + \
+     KMEANS_ALIGN8((size_t)(k) * MAX_LABEL_LENGTH))
+
+typedef struct {
+    const uint8_t* base;     // Header; records follow
+    size_t size;
+    uint32_t count;
+    uint32_t record_size;
+    uint8_t feature_dim;
+    uint8_t max_clusters;
+
+    void* map;               // Set by kmeans_snapshot_map()
+    size_t map_size;
+} kmeans_snapshot_t;
+
+typedef struct {
+    FILE* fp;
+    uint32_t count;
+    uint32_t record_size;
+    uint8_t feature_dim;
+    uint8_t max_clusters;
+    bool failed;
+    char last_id[KMEANS_SNAPSHOT_ID_LEN];
+} kmeans_snapshot_writer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// WRITER (stdio)
+// =============================================================================
+
+// fp: opened "wb" (seekable). Every model added must have this feature_dim
+// and at most max_clusters clusters.
+bool kmeans_snapshot_begin(kmeans_snapshot_writer_t* w, FILE* fp,
+                           uint8_t feature_dim, uint8_t max_clusters);
+// ids must be added in strictly increasing strcmp() order, < ID_LEN chars
+bool kmeans_snapshot_add(kmeans_snapshot_writer_t* w, const char* id, const kmeans_model_t* model);
+// Writes the final header; false if any add or write failed. Does not close fp.
+bool kmeans_snapshot_finish(kmeans_snapshot_writer_t* w);
+
+// =============================================================================
+// READER
+// =============================================================================
+
+// Validates the header and size of a snapshot already in memory
+bool kmeans_snapshot_open(kmeans_snapshot_t* s, const void* data, size_t len);
+
+// mmap()s the file read-only and opens it (POSIX only)
+bool kmeans_snapshot_map(kmeans_snapshot_t* s, const char* path);
+void kmeans_snapshot_unmap(kmeans_snapshot_t* s);
+
+// Record index of a device, -1 if absent (binary search)
+int32_t kmeans_snapshot_find(const kmeans_snapshot_t* s, const char* id);
+const char* kmeans_snapshot_id(const kmeans_snapshot_t* s, uint32_t index);
+
+// Read-only view of record `index`: kmeans_predict(), kmeans_is_outlier(),
+// kmeans_get_label() and kmeans_get_centroid() work on it directly. It has
+// no ring buffer, and updating it would write into the mapping. A
+// header-only model (kmeans_model_of()) is enough for the view.
+bool kmeans_snapshot_model(const kmeans_snapshot_t* s, uint32_t index, kmeans_model_t* view);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file kmeans_static.h
+ * @brief Compile-time specialized k-means for a fixed feature dimension
+ *
+ * KMEANS_DEFINE(D) generates a model type and inline functions where the
+ * feature dimension D and cluster capacity KMEANS_STATIC_CLUSTERS are
+ * constants, so the nearest-centroid scan (the K x D hot loop) unrolls
+ * and the storage is embedded at its exact size, after a model header
+ * without kmeans_model_t's worst-case block:
+ *
+ *   #define KMEANS_STATIC_CLUSTERS 8   // optional, default MAX_CLUSTERS
+ *   #include "kmeans_static.h"
+ *   KMEANS_DEFINE(7)
+ *
+ *   static kmeans_d7_t model;
+ *   kmeans_d7_init(&model, 0.2f);
+ *   kmeans_d7_update(&model, features);
+ *   kmeans_add_cluster(kmeans_d7_model(&model), "fault");   // full API
+ *
+ * Results are bit-identical to the dynamic API. Bootstrap, labeling and
+ * every other state stay in streaming_kmeans.c (the dynamic fallback);
+ * only the per-sample scan is specialized.
+ */
+
+#ifndef KMEANS_STATIC_H
+#define KMEANS_STATIC_H
+
+#include "streaming_kmeans.h"
+
+#ifndef KMEANS_STATIC_CLUSTERS
+#define KMEANS_STATIC_CLUSTERS MAX_CLUSTERS
+#endif
+
+#ifndef KMEANS_STATIC_BUFFER
+#define KMEANS_STATIC_BUFFER RING_BUFFER_SIZE
+#endif
+
+// Indirection so KMEANS_DEFINE(FEATURE_DIM) expands to kmeans_d7_t etc.
+#define KMEANS_DEFINE(D) KMEANS_DEFINE_IMPL(D)
+
+#define KMEANS_DEFINE_IMPL(D) \
+typedef struct { \
+    kmeans_model_header_t header; \
+    uint64_t storage[KMEANS_STORAGE_SIZE(KMEANS_STATIC_CLUSTERS, D, KMEANS_STATIC_BUFFER) / 8]; \
+} kmeans_d##D##_t; \
+\
+/* The model for the rest of the kmeans_* API */ \
+static inline kmeans_model_t* kmeans_d##D##_model(kmeans_d##D##_t* s) { \
+    return kmeans_model_of(&s->header); \
+} \
+\
+static inline bool kmeans_d##D##_init(kmeans_d##D##_t* s, float learning_rate) { \
+    return kmeans_init_with_storage(kmeans_d##D##_model(s), D, learning_rate, \
+                                    KMEANS_STATIC_CLUSTERS, KMEANS_STATIC_BUFFER, \
+                                    s->storage, sizeof(s->storage)); \
+} \
+\
+/* Same arithmetic and tie-breaking as find_nearest_cluster() */ \
+static inline uint8_t kmeans_d##D##_nearest(const kmeans_model_t* m, const fixed_t* point, \
+                                            fixed_t* out_distance) { \
+    uint8_t n = m->k > 0 ? m->k : 1; \
+    uint64_t dist[KMEANS_STATIC_CLUSTERS]; \
+    for (uint8_t c = 0; c < n; c++) { \
+        const fixed_t* col = &m->centroids[c]; \
+        uint64_t sum = 0; \
+        for (int d = 0; d < D; d++) { \
+            int64_t diff = (int64_t)point[d] - col[d * KMEANS_STATIC_CLUSTERS]; \
+            uint64_t mag = (uint64_t)(diff < 0 ? -diff : diff); \
+            sum += (mag * mag) >> FIXED_POINT_SHIFT; \
+        } \
+        dist[c] = sum; \
+    } \
+    uint8_t nearest = 0; \
+    fixed_t min_dist = (fixed_t)(int64_t)dist[0]; \
+    for (uint8_t c = 1; c < m->k; c++) { \
+        if (!m->clusters[c].active) continue; \
+        if ((fixed_t)(int64_t)dist[c] < min_dist) { \
+            min_dist = (fixed_t)(int64_t)dist[c]; \
+            nearest = c; \
+        } \
+    } \
+    if (out_distance) *out_distance = min_dist; \
+    return nearest; \
+} \
+\
+static inline uint8_t kmeans_d##D##_predict(const kmeans_d##D##_t* s, const fixed_t* point) { \
+    const kmeans_model_t* m = kmeans_model_of((kmeans_model_header_t*)&s->header); \
+    if (!m->initialized || m->k == 0) return 0; \
+    return kmeans_d##D##_nearest(m, point, NULL); \
+} \
+\
+static inline int8_t kmeans_d##D##_update(kmeans_d##D##_t* s, const fixed_t* point) { \
+    kmeans_model_t* m = kmeans_d##D##_model(s); \
+    if (m->state != STATE_NORMAL && m->state != STATE_ALARM) return kmeans_update(m, point); \
+    fixed_t distance; \
+    uint8_t nearest = kmeans_d##D##_nearest(m, point, &distance); \
+    return kmeans_update_located(m, point, nearest, distance); \
+}
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file model_codec.h
+ * @brief Little-endian fields and the cluster record shared by every model
+ *        format (journal, file, state), header-only
+ *
+ * Cluster record, little-endian, no padding:
+ *
+ *   count u32, inertia i32, active u8, label length u8, label bytes (no
+ *   NUL), centroid i32[feature_dim]
+ *
+ * Deltas that leave the label alone write length 0 and decode without it.
+ */
+
+#ifndef MODEL_CODEC_H
+#define MODEL_CODEC_H
+
+#include "streaming_kmeans.h"
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODEL_CODEC_CLUSTER_HEADER 10
+
+// Largest record for dim features (full-length label)
+#define MODEL_CODEC_CLUSTER_MAX_SIZE(dim) \
+    (MODEL_CODEC_CLUSTER_HEADER + (MAX_LABEL_LENGTH - 1) + 4 * (size_t)(dim))
+
+static inline void put_le16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline uint16_t get_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline void put_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t get_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint8_t model_codec_label_length(const char* label) {
+    uint8_t n = 0;
+    while (n < MAX_LABEL_LENGTH - 1 && label[n]) n++;
+    return n;
+}
+
+// Record of cluster id at p; bytes written
+static inline size_t model_codec_put_cluster(uint8_t* p, const kmeans_model_t* m, uint8_t id,
+                                             bool with_label) {
+    const cluster_t* c = &m->clusters[id];
+    uint8_t label_len = with_label ? model_codec_label_length(m->labels[id]) : 0;
+    put_le32(p, c->count);
+    put_le32(p + 4, (uint32_t)c->inertia);
+    p[8] = c->active ? 1 : 0;
+    p[9] = label_len;
+    memcpy(p + MODEL_CODEC_CLUSTER_HEADER, m->labels[id], label_len);
+    uint8_t* q = p + MODEL_CODEC_CLUSTER_HEADER + label_len;
+
+    fixed_t centroid[MAX_FEATURES];
+    kmeans_get_centroid(m, id, centroid);
+    for (uint8_t d = 0; d < m->feature_dim; d++, q += 4) put_le32(q, (uint32_t)centroid[d]);
+    return (size_t)(q - p);
+}
+
+// Size of the record at p; 0 if it runs past len or its label is too long
+static inline size_t model_codec_cluster_size(const uint8_t* p, size_t len, uint8_t dim) {
+    if (len < MODEL_CODEC_CLUSTER_HEADER || p[9] >= MAX_LABEL_LENGTH) return 0;
+    size_t n = MODEL_CODEC_CLUSTER_HEADER + p[9] + 4 * (size_t)dim;
+    return n <= len ? n : 0;
+}
+
+// Loads a checked record into cluster id (< max_clusters); k is the
+// caller's. with_label replaces the stored label, empty if none was written.
+static inline void model_codec_get_cluster(const uint8_t* p, kmeans_model_t* m, uint8_t id,
+                                           bool with_label) {
+    cluster_t* c = &m->clusters[id];
+    c->count = get_le32(p);
+    c->inertia = (fixed_t)get_le32(p + 4);
+    c->active = p[8] != 0;
+    uint8_t label_len = p[9];
+    if (with_label) {
+        memcpy(m->labels[id], p + MODEL_CODEC_CLUSTER_HEADER, label_len);
+        m->labels[id][label_len] = '\0';
+    }
+    const uint8_t* q = p + MODEL_CODEC_CLUSTER_HEADER + label_len;
+
+    fixed_t centroid[MAX_FEATURES];
+    for (uint8_t d = 0; d < m->feature_dim; d++, q += 4) centroid[d] = (fixed_t)get_le32(q);
+    kmeans_set_centroid(m, id, centroid);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
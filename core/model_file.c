@@ -0,0 +1,160 @@
+/**
+ * @file model_file.c
+ * @brief v2 model file writer/reader and v1 migration (format in model_file.h)
+ */
+
+#include "model_file.h"
+#include "crc.h"
+#include "model_codec.h"
+#include <string.h>
+
+#define V1_LABEL_OFFSET (MODEL_FILE_V1_MAX_FEATURES * 4 + 8)
+
+static void clear_clusters(kmeans_model_t* model) {
+    model->k = 0;
+    for (uint8_t i = 0; i < model->max_clusters; i++) {
+        model->clusters[i].count = 0;
+        model->clusters[i].inertia = 0;
+        model->clusters[i].active = false;
+        model->labels[i][0] = '\0';
+    }
+}
+
+// =============================================================================
+// V2
+// =============================================================================
+
+size_t model_file_size(const kmeans_model_t* model) {
+    size_t n = MODEL_FILE_HEADER_SIZE + 4;
+    for (uint8_t i = 0; i < model->k; i++) {
+        n += MODEL_CODEC_CLUSTER_HEADER + model_codec_label_length(model->labels[i]) +
+             4 * (size_t)model->feature_dim;
+    }
+    return n;
+}
+
+size_t model_file_write(const kmeans_model_t* model, uint8_t* buf, size_t cap) {
+    if (!model || !buf || !model->initialized) return 0;
+    size_t size = model_file_size(model);
+    if (size > cap) return 0;
+
+    put_le32(buf, MODEL_FILE_MAGIC);
+    buf[4] = MODEL_FILE_VERSION;
+    buf[5] = model->k;
+    buf[6] = model->feature_dim;
+    buf[7] = (uint8_t)model->alpha_schedule;
+    put_le32(buf + 8, model->total_points);
+    put_le32(buf + 12, (uint32_t)model->outlier_threshold);
+    put_le32(buf + 16, (uint32_t)model->learning_rate);
+
+    uint8_t* p = buf + MODEL_FILE_HEADER_SIZE;
+    for (uint8_t i = 0; i < model->k; i++) p += model_codec_put_cluster(p, model, i, true);
+    put_le32(p, crc32(buf, (size_t)(p - buf)));
+    return size;
+}
+
+// Walks the cluster records; the exact file size, 0 if malformed
+static size_t v2_size(const uint8_t* data, size_t len) {
+    if (len < MODEL_FILE_HEADER_SIZE + 4) return 0;
+    uint8_t k = data[5], dim = data[6];
+    if (dim == 0 || dim > MAX_FEATURES || data[7] > ALPHA_SCHEDULE_CONSTANT) return 0;
+    size_t off = MODEL_FILE_HEADER_SIZE;
+    for (uint8_t i = 0; i < k; i++) {
+        size_t n = model_codec_cluster_size(data + off, len - off, dim);
+        if (n == 0) return 0;
+        off += n;
+    }
+    off += 4;
+    if (off > len) return 0;
+    return get_le32(data + off - 4) == crc32(data, off - 4) ? off : 0;
+}
+
+static void v2_apply(const uint8_t* data, kmeans_model_t* model) {
+    clear_clusters(model);
+    model->alpha_schedule = (alpha_schedule_t)data[7];
+    model->total_points = get_le32(data + 8);
+    model->outlier_threshold = (fixed_t)get_le32(data + 12);
+    model->learning_rate = (fixed_t)get_le32(data + 16);
+
+    const uint8_t* p = data + MODEL_FILE_HEADER_SIZE;
+    for (uint8_t i = 0; i < data[5]; i++) {
+        model_codec_get_cluster(p, model, i, true);
+        p += MODEL_CODEC_CLUSTER_HEADER + p[9] + 4 * (size_t)model->feature_dim;
+    }
+    model->k = data[5];
+}
+
+// =============================================================================
+// V1
+// =============================================================================
+
+bool model_file_v1_begin(const uint8_t* header, size_t len, kmeans_model_t* model, uint8_t* k) {
+    if (!header || !model || !model->initialized || len < MODEL_FILE_V1_HEADER_SIZE) return false;
+    if (get_le32(header) != MODEL_FILE_V1_MAGIC || header[4] != 1) return false;
+    if (header[6] != model->feature_dim || header[5] > model->max_clusters) return false;
+
+    clear_clusters(model);
+    model->total_points = get_le32(header + 8);
+    model->outlier_threshold = (fixed_t)get_le32(header + 12);
+    model->learning_rate = (fixed_t)get_le32(header + 16);
+    if (k) *k = header[5];
+    return true;
+}
+
+bool model_file_v1_cluster(const uint8_t* cluster, size_t len, kmeans_model_t* model) {
+    if (!cluster || !model || len < MODEL_FILE_V1_CLUSTER_SIZE) return false;
+    if (model->k >= model->max_clusters) return false;
+    uint8_t id = model->k;
+
+    fixed_t centroid[MAX_FEATURES];
+    for (uint8_t d = 0; d < model->feature_dim; d++) centroid[d] = (fixed_t)get_le32(cluster + 4 * d);
+    kmeans_set_centroid(model, id, centroid);
+    model->clusters[id].count = get_le32(cluster + MODEL_FILE_V1_MAX_FEATURES * 4);
+    model->clusters[id].inertia = (fixed_t)get_le32(cluster + MODEL_FILE_V1_MAX_FEATURES * 4 + 4);
+    memcpy(model->labels[id], cluster + V1_LABEL_OFFSET, MAX_LABEL_LENGTH);
+    model->labels[id][MAX_LABEL_LENGTH - 1] = '\0';
+    model->clusters[id].active = cluster[V1_LABEL_OFFSET + MAX_LABEL_LENGTH] != 0;
+    model->k++;
+    return true;
+}
+
+// =============================================================================
+// API
+// =============================================================================
+
+bool model_file_info(const uint8_t* data, size_t len, model_file_info_t* info) {
+    if (!data || !info || len < 8) return false;
+    uint32_t magic = get_le32(data);
+    if (magic == MODEL_FILE_MAGIC && data[4] == MODEL_FILE_VERSION) {
+        info->size = v2_size(data, len);
+        if (info->size == 0) return false;
+    } else if (magic == MODEL_FILE_V1_MAGIC && data[4] == 1) {
+        info->size = MODEL_FILE_V1_HEADER_SIZE + (size_t)data[5] * MODEL_FILE_V1_CLUSTER_SIZE;
+        if (info->size > len) return false;
+    } else {
+        return false;
+    }
+    info->version = data[4];
+    info->k = data[5];
+    info->feature_dim = data[6];
+    info->total_points = get_le32(data + 8);
+    return true;
+}
+
+bool model_file_read(const uint8_t* data, size_t len, kmeans_model_t* model) {
+    model_file_info_t info;
+    if (!model || !model->initialized || !model_file_info(data, len, &info)) return false;
+    if (info.feature_dim != model->feature_dim || info.k > model->max_clusters) return false;
+
+    if (info.version == MODEL_FILE_VERSION) {
+        v2_apply(data, model);
+    } else {
+        model_file_v1_begin(data, len, model, NULL);
+        for (uint8_t i = 0; i < info.k; i++) {
+            model_file_v1_cluster(data + MODEL_FILE_V1_HEADER_SIZE + (size_t)i * MODEL_FILE_V1_CLUSTER_SIZE,
+                                  MODEL_FILE_V1_CLUSTER_SIZE, model);
+        }
+    }
+    model->state = model->k ? STATE_NORMAL : STATE_BOOTSTRAP;
+    return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file model_file.h
+ * @brief Portable single-file model format (v2), with v1 import
+ *
+ * One buffer holds a whole model, sized to the real K and D, for export to
+ * gateways and other tools. Little-endian, no padding:
+ *
+ *   off  size  field
+ *   0    4     magic "TOLM" (MODEL_FILE_MAGIC)
+ *   4    1     version (MODEL_FILE_VERSION)
+ *   5    1     k
+ *   6    1     feature_dim
+ *   7    1     alpha_schedule
+ *   8    4     total_points
+ *   12   4     outlier_threshold (Q16.16)
+ *   16   4     learning_rate (Q16.16)
+ *   20   ...   k cluster records (model_codec.h): count u32, inertia i32,
+ *              active u8, label length u8, label bytes, centroid
+ *              i32[feature_dim]
+ *   end  4     CRC-32 of every byte before it
+ *
+ * v1 (STORAGE_VERSION 1 in model_storage.h) is the raw struct layout: a
+ * 20-byte header and k 300-byte clusters of MAX_FEATURES (64) centroid
+ * entries. The reader migrates it: only the first feature_dim entries are
+ * used and the alpha schedule is left as is.
+ */
+
+#ifndef MODEL_FILE_H
+#define MODEL_FILE_H
+
+#include "model_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODEL_FILE_MAGIC 0x4D4C4F54       // "TOLM"
+#define MODEL_FILE_VERSION 2
+#define MODEL_FILE_HEADER_SIZE 20
+
+#define MODEL_FILE_V1_MAGIC 0x544F4C48    // "TOLH"
+#define MODEL_FILE_V1_HEADER_SIZE 20
+#define MODEL_FILE_V1_CLUSTER_SIZE 300
+#define MODEL_FILE_V1_MAX_FEATURES 64
+
+// Largest v2 file for k clusters of dim features (full-length labels)
+#define MODEL_FILE_MAX_SIZE(k, dim) \
+    (MODEL_FILE_HEADER_SIZE + (size_t)(k) * MODEL_CODEC_CLUSTER_MAX_SIZE(dim) + 4)
+
+typedef struct {
+    uint8_t version;
+    uint8_t k;
+    uint8_t feature_dim;
+    uint32_t total_points;
+    size_t size;          // Bytes the file occupies
+} model_file_info_t;
+
+// Exact v2 size of this model
+size_t model_file_size(const kmeans_model_t* model);
+
+// v2 file of the model; 0 if it does not fit in cap
+size_t model_file_write(const kmeans_model_t* model, uint8_t* buf, size_t cap);
+
+// Header of a v1 or v2 file. v2 is fully checked (length and CRC).
+bool model_file_info(const uint8_t* data, size_t len, model_file_info_t* info);
+
+// Loads a v2 or v1 file into an initialized model with the same
+// feature_dim and room for k. The model is untouched on failure.
+bool model_file_read(const uint8_t* data, size_t len, kmeans_model_t* model);
+
+// v1 piecewise, for stores that keep the header and each cluster apart
+// (ESP32 Preferences). begin() clears the model to k = 0; each cluster()
+// must be the next id. Checks as in model_file_read().
+bool model_file_v1_begin(const uint8_t* header, size_t len, kmeans_model_t* model, uint8_t* k);
+bool model_file_v1_cluster(const uint8_t* cluster, size_t len, kmeans_model_t* model);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
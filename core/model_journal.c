@@ -0,0 +1,405 @@
+/**
+ * @file model_journal.c
+ * @brief Snapshot + delta model log on flash (format in model_journal.h)
+ */
+
+#include "model_journal.h"
+#include "crc.h"
+#include "model_codec.h"
+#include <string.h>
+
+#define SEGMENT_HEADER 8                     // [seq u32][magic u32], magic written last
+#define RECORD_HEADER 8                      // [len u16][type u8][0][crc32 u32]
+#define LEN_ERASED 0xFFFF
+#define CLUSTER_PREFIX 5                     // [id u8][total_points u32]
+#define MAX_PAYLOAD (CLUSTER_PREFIX + MODEL_CODEC_CLUSTER_MAX_SIZE(MAX_FEATURES))
+
+typedef struct {
+    uint16_t len;
+    uint8_t type;
+    uint8_t reserved;
+    uint32_t crc;
+} record_header_t;
+
+typedef struct {
+    uint16_t seg;
+    uint32_t off;
+    bool done;
+} cursor_t;
+
+// =============================================================================
+// LOG
+// =============================================================================
+
+static uint32_t record_size(uint16_t len) {
+    return (RECORD_HEADER + len + 3u) & ~3u;
+}
+
+static uint32_t seg_addr(const model_journal_t* j, uint16_t seg, uint32_t off) {
+    return (uint32_t)seg * j->seg_size + off;
+}
+
+static uint16_t next_seg(const model_journal_t* j, uint16_t seg) {
+    return (uint16_t)((seg + 1) % j->segments);
+}
+
+static uint32_t record_crc(const record_header_t* h, const void* payload) {
+    uint32_t crc = crc32_update(0, &h->len, sizeof(h->len));
+    crc = crc32_update(crc, &h->type, 1);
+    return crc32_update(crc, payload, h->len);
+}
+
+static bool read_segment_header(const model_journal_t* j, uint16_t seg, uint32_t* seq) {
+    uint32_t h[2];
+    if (!j->flash->read(seg_addr(j, seg, 0), h, sizeof(h), j->flash->ctx)) return false;
+    *seq = h[0];
+    return h[1] == MODEL_JOURNAL_MAGIC;
+}
+
+typedef enum { REC_END, REC_OK, REC_BAD } record_status_t;
+
+static record_status_t read_record(const model_journal_t* j, uint16_t seg, uint32_t off,
+                                   record_header_t* h, uint8_t* payload) {
+    if (off + RECORD_HEADER > j->seg_size) return REC_END;
+    if (!j->flash->read(seg_addr(j, seg, off), h, sizeof(*h), j->flash->ctx)) return REC_BAD;
+    if (h->len == LEN_ERASED) return REC_END;
+    if (h->len > MAX_PAYLOAD || off + record_size(h->len) > j->seg_size) return REC_BAD;
+    if (!j->flash->read(seg_addr(j, seg, off + RECORD_HEADER), payload, h->len, j->flash->ctx)) {
+        return REC_BAD;
+    }
+    return record_crc(h, payload) == h->crc ? REC_OK : REC_BAD;
+}
+
+// Next intact record at or after the cursor; a torn record ends its segment
+static bool next_record(model_journal_t* j, cursor_t* c, record_header_t* h,
+                        uint8_t* payload, bool count_corrupt) {
+    while (!c->done) {
+        bool at_tail = c->seg == j->tail_seg;
+        if (at_tail && c->off >= j->tail_off) break;
+        record_status_t st = read_record(j, c->seg, c->off, h, payload);
+        if (st == REC_OK) {
+            c->off += record_size(h->len);
+            return true;
+        }
+        if (st == REC_BAD && count_corrupt) j->stats.corrupt++;
+        if (at_tail) break;
+        c->seg = next_seg(j, c->seg);
+        c->off = SEGMENT_HEADER;
+    }
+    c->done = true;
+    return false;
+}
+
+// Zeroed ahead of every erase (flash_region_retire)
+static bool retire_segment(model_journal_t* j, uint16_t seg) {
+    return flash_region_retire(j->flash, seg_addr(j, seg, 0));
+}
+
+static bool open_segment(model_journal_t* j) {
+    uint16_t seg = j->empty_ring ? 0 : next_seg(j, j->tail_seg);
+    if (!j->empty_ring && seg == j->head_seg) {
+        // Reclaim the oldest segment, never the one holding the base
+        if (j->has_base && j->head_seg == j->base_seg) return false;
+        j->head_seg = next_seg(j, j->head_seg);
+    }
+
+    j->tail_off = j->seg_size;  // Closed until the header is down
+    if (!retire_segment(j, seg)) return false;
+    if (!j->flash->erase(seg_addr(j, seg, 0), j->seg_size, j->flash->ctx)) return false;
+    j->stats.erases++;
+    if (j->empty_ring) j->head_seg = seg;
+    j->empty_ring = false;
+    j->tail_seg = seg;
+    uint32_t header[2] = {j->tail_seq + 1, MODEL_JOURNAL_MAGIC};
+    if (!j->flash->write(seg_addr(j, seg, 0), header, sizeof(header), j->flash->ctx)) return false;
+    j->tail_seq++;
+    j->tail_off = SEGMENT_HEADER;
+    return true;
+}
+
+static bool append(model_journal_t* j, uint8_t type, const void* payload, uint16_t len,
+                   uint16_t* at_seg, uint32_t* at_off) {
+    if (j->empty_ring || j->tail_off + record_size(len) > j->seg_size) {
+        if (!open_segment(j)) return false;
+    }
+    record_header_t h = {len, type, 0, 0};
+    h.crc = record_crc(&h, payload);
+    uint32_t off = j->tail_off;
+    j->tail_off = j->seg_size;  // Closed if either write fails
+    if (!j->flash->write(seg_addr(j, j->tail_seg, off), &h, sizeof(h), j->flash->ctx)) return false;
+    if (!j->flash->write(seg_addr(j, j->tail_seg, off + RECORD_HEADER), payload, len, j->flash->ctx)) {
+        return false;
+    }
+    j->tail_off = off + record_size(len);
+    if (at_seg) *at_seg = j->tail_seg;
+    if (at_off) *at_off = off;
+    j->stats.records++;
+    j->stats.bytes += record_size(len);
+    return true;
+}
+
+// Segments from the base (or the oldest, without one) to the tail
+static uint16_t live_segments(const model_journal_t* j) {
+    if (j->empty_ring) return 0;
+    uint16_t from = j->has_base ? j->base_seg : j->head_seg;
+    return (uint16_t)((j->tail_seg + j->segments - from) % j->segments + 1);
+}
+
+// =============================================================================
+// RECORDS (little-endian payloads)
+// =============================================================================
+
+// BEGIN: dim, k, schedule, 0, total_points, threshold, learning_rate
+static uint16_t encode_begin(const kmeans_model_t* m, uint8_t* p) {
+    p[0] = m->feature_dim;
+    p[1] = m->k;
+    p[2] = (uint8_t)m->alpha_schedule;
+    p[3] = 0;
+    put_le32(p + 4, m->total_points);
+    put_le32(p + 8, (uint32_t)m->outlier_threshold);
+    put_le32(p + 12, (uint32_t)m->learning_rate);
+    return 16;
+}
+
+// CLUSTER / CENTROID: id, total_points, cluster record (model_codec.h);
+// CENTROID leaves the label out
+static uint16_t encode_cluster(const kmeans_model_t* m, uint8_t id, bool with_label, uint8_t* p) {
+    p[0] = id;
+    put_le32(p + 1, m->total_points);
+    return (uint16_t)(CLUSTER_PREFIX + model_codec_put_cluster(p + CLUSTER_PREFIX, m, id, with_label));
+}
+
+static bool apply_cluster(kmeans_model_t* m, const uint8_t* p, uint16_t len, bool with_label) {
+    uint8_t id = p[0];
+    if (len < CLUSTER_PREFIX) return false;
+    const uint8_t* rec = p + CLUSTER_PREFIX;
+    size_t rec_len = (size_t)(len - CLUSTER_PREFIX);
+    if (model_codec_cluster_size(rec, rec_len, m->feature_dim) != rec_len) return false;
+    if (!with_label && rec[9] != 0) return false;
+    if (id >= m->max_clusters || id > m->k || (!with_label && id >= m->k)) return false;
+
+    if (id == m->k) m->k++;
+    model_codec_get_cluster(rec, m, id, with_label);
+    m->total_points = get_le32(p + 1);
+    return true;
+}
+
+static uint16_t snapshot_bytes(const kmeans_model_t* m) {
+    uint32_t n = record_size(16) + record_size(4);
+    for (uint8_t i = 0; i < m->k; i++) {
+        n += record_size((uint16_t)(CLUSTER_PREFIX + MODEL_CODEC_CLUSTER_MAX_SIZE(m->feature_dim)));
+    }
+    return (uint16_t)(n > 0xFFFF ? 0xFFFF : n);
+}
+
+// Segments a snapshot may need, counting a partly used tail segment
+static uint16_t snapshot_segments(const model_journal_t* j, const kmeans_model_t* m) {
+    return (uint16_t)(snapshot_bytes(m) / (j->seg_size - SEGMENT_HEADER) + 2);
+}
+
+// =============================================================================
+// API
+// =============================================================================
+
+bool model_journal_mount(model_journal_t* j, const flash_region_t* flash) {
+    if (!j || !flash || flash->sector_size < 512 || flash->size / flash->sector_size < 4) return false;
+    memset(j, 0, sizeof(*j));
+    j->flash = flash;
+    j->seg_size = flash->sector_size;
+    j->segments = (uint16_t)(flash->size / flash->sector_size);
+    j->empty_ring = true;
+
+    bool found = false;
+    for (uint16_t s = 0; s < j->segments; s++) {
+        uint32_t seq;
+        if (read_segment_header(j, s, &seq) && (!found || seq > j->tail_seq)) {
+            found = true;
+            j->tail_seg = s;
+            j->tail_seq = seq;
+        }
+    }
+    if (!found) return true;
+    j->empty_ring = false;
+
+    j->head_seg = j->tail_seg;
+    uint32_t head_seq = j->tail_seq;
+    for (uint16_t i = 1; i < j->segments; i++) {
+        uint16_t prev = (uint16_t)((j->head_seg + j->segments - 1) % j->segments);
+        uint32_t seq;
+        if (!read_segment_header(j, prev, &seq) || seq != head_seq - 1) break;
+        j->head_seg = prev;
+        head_seq = seq;
+    }
+
+    // Tail offset: end of the intact records in the tail segment
+    j->tail_off = SEGMENT_HEADER;
+    record_header_t h;
+    uint8_t payload[MAX_PAYLOAD];
+    record_status_t st;
+    while ((st = read_record(j, j->tail_seg, j->tail_off, &h, payload)) == REC_OK) {
+        j->tail_off += record_size(h.len);
+    }
+    if (st == REC_BAD) j->tail_off = j->seg_size;
+
+    // Last complete snapshot: BEGIN, k CLUSTERs, COMMIT, nothing in between
+    cursor_t c = {j->head_seg, SEGMENT_HEADER, false};
+    bool open = false;
+    uint16_t open_seg = 0;
+    uint32_t open_off = 0, open_bytes = 0;
+    uint8_t open_k = 0, open_dim = 0, seen = 0;
+    for (;;) {
+        if (!next_record(j, &c, &h, payload, true)) break;
+        uint16_t seg = c.seg;
+        uint32_t off = c.off - record_size(h.len);
+
+        if (h.type == JOURNAL_BEGIN && h.len == 16) {
+            open = true;
+            open_seg = seg;
+            open_off = off;
+            open_dim = payload[0];
+            open_k = payload[1];
+            open_bytes = 0;
+            seen = 0;
+        } else if (open && h.type == JOURNAL_CLUSTER && payload[0] == seen) {
+            seen++;
+        } else if (open && h.type == JOURNAL_COMMIT && seen == open_k) {
+            j->has_base = true;
+            j->base_seg = open_seg;
+            j->base_off = open_off;
+            j->base_dim = open_dim;
+            j->snapshot_bytes = open_bytes + record_size(h.len);
+            open = false;
+            continue;
+        } else {
+            open = false;
+        }
+        open_bytes += record_size(h.len);
+    }
+    return true;
+}
+
+bool model_journal_load(model_journal_t* j, kmeans_model_t* model) {
+    if (!j || !model || !model->initialized || !j->has_base) return false;
+    if (j->base_dim != model->feature_dim) return false;
+
+    cursor_t c = {j->base_seg, j->base_off, false};
+    record_header_t h;
+    uint8_t p[MAX_PAYLOAD];
+    if (!next_record(j, &c, &h, p, false) || h.type != JOURNAL_BEGIN) return false;
+    if (p[1] > model->max_clusters || p[2] > ALPHA_SCHEDULE_CONSTANT) return false;
+
+    model->k = 0;
+    model->alpha_schedule = (alpha_schedule_t)p[2];
+    model->total_points = get_le32(p + 4);
+    model->outlier_threshold = (fixed_t)get_le32(p + 8);
+    model->learning_rate = (fixed_t)get_le32(p + 12);
+    for (uint8_t i = 0; i < model->max_clusters; i++) {
+        model->clusters[i].count = 0;
+        model->clusters[i].active = false;
+        model->labels[i][0] = '\0';
+    }
+
+    // Snapshot body, then every delta after it
+    bool in_snapshot = true;
+    j->stats.replayed = 0;
+    while (next_record(j, &c, &h, p, false)) {
+        bool ok = true;
+        switch (h.type) {
+            case JOURNAL_CLUSTER:   ok = apply_cluster(model, p, h.len, true); break;
+            case JOURNAL_CENTROID:  ok = apply_cluster(model, p, h.len, false); break;
+            case JOURNAL_THRESHOLD:
+                if (h.len != 8) { ok = false; break; }
+                model->outlier_threshold = (fixed_t)get_le32(p);
+                model->learning_rate = (fixed_t)get_le32(p + 4);
+                break;
+            case JOURNAL_COMMIT:    in_snapshot = false; continue;
+            default:                continue;  // Uncommitted BEGIN: its CLUSTERs are upserts
+        }
+        if (!ok) return false;
+        if (!in_snapshot) j->stats.replayed++;
+    }
+
+    model->state = model->k ? STATE_NORMAL : STATE_BOOTSTRAP;
+    return true;
+}
+
+bool model_journal_compact(model_journal_t* j, const kmeans_model_t* model) {
+    if (!j || !model || !model->initialized) return false;
+    uint8_t p[MAX_PAYLOAD];
+    uint16_t seg;
+    uint32_t off;
+    uint32_t bytes = j->stats.bytes;
+
+    if (!append(j, JOURNAL_BEGIN, p, encode_begin(model, p), &seg, &off)) return false;
+    for (uint8_t i = 0; i < model->k; i++) {
+        if (!append(j, JOURNAL_CLUSTER, p, encode_cluster(model, i, true, p), NULL, NULL)) return false;
+    }
+    put_le32(p, model->k);
+    if (!append(j, JOURNAL_COMMIT, p, 4, NULL, NULL)) return false;
+
+    j->has_base = true;
+    j->base_seg = seg;
+    j->base_off = off;
+    j->base_dim = model->feature_dim;
+    j->snapshot_bytes = j->stats.bytes - bytes;
+    j->stats.snapshots++;
+    return true;
+}
+
+// Deltas need a base, and must leave room for the next snapshot
+static bool ready_for_delta(model_journal_t* j, const kmeans_model_t* model, bool* compacted) {
+    *compacted = false;
+    if (!j->has_base || j->segments - live_segments(j) < snapshot_segments(j, model) + 1) {
+        *compacted = true;
+        return model_journal_compact(j, model);
+    }
+    return true;
+}
+
+bool model_journal_log_cluster(model_journal_t* j, const kmeans_model_t* model, uint8_t id) {
+    if (!j || !model || id >= model->k) return false;
+    bool compacted;
+    if (!ready_for_delta(j, model, &compacted)) return false;
+    if (compacted) return true;  // The snapshot already holds it
+    uint8_t p[MAX_PAYLOAD];
+    return append(j, JOURNAL_CLUSTER, p, encode_cluster(model, id, true, p), NULL, NULL);
+}
+
+bool model_journal_log_centroid(model_journal_t* j, const kmeans_model_t* model, uint8_t id) {
+    if (!j || !model || id >= model->k) return false;
+    bool compacted;
+    if (!ready_for_delta(j, model, &compacted)) return false;
+    if (compacted) return true;
+    uint8_t p[MAX_PAYLOAD];
+    return append(j, JOURNAL_CENTROID, p, encode_cluster(model, id, false, p), NULL, NULL);
+}
+
+bool model_journal_log_threshold(model_journal_t* j, const kmeans_model_t* model) {
+    if (!j || !model) return false;
+    bool compacted;
+    if (!ready_for_delta(j, model, &compacted)) return false;
+    if (compacted) return true;
+    uint8_t p[8];
+    put_le32(p, (uint32_t)model->outlier_threshold);
+    put_le32(p + 4, (uint32_t)model->learning_rate);
+    return append(j, JOURNAL_THRESHOLD, p, 8, NULL, NULL);
+}
+
+bool model_journal_needs_compaction(const model_journal_t* j) {
+    return !j->empty_ring && live_segments(j) > j->segments / 2;
+}
+
+bool model_journal_clear(model_journal_t* j) {
+    // Stale segments first, then the chain from its oldest: the base goes
+    // before its deltas, so a cut clear leaves the old model or none
+    for (uint16_t i = 1; !j->empty_ring && i <= j->segments; i++) {
+        if (!retire_segment(j, (uint16_t)((j->tail_seg + i) % j->segments))) return false;
+    }
+    if (!j->flash->erase(0, j->flash->size, j->flash->ctx)) return false;
+    j->stats.erases += j->segments;
+    j->empty_ring = true;
+    j->has_base = false;
+    j->head_seg = j->tail_seg = j->base_seg = 0;
+    j->tail_off = j->base_off = 0;
+    return true;
+}
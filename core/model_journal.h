@@ -0,0 +1,109 @@
+/**
+ * @file model_journal.h
+ * @brief Append-only model persistence: snapshot + delta records on flash
+ *
+ * Instead of rewriting the whole model on every label event, changes are
+ * appended as small records to a log of circular segments (one erase
+ * sector each, same scheme as offline_queue.h):
+ *
+ *   BEGIN      snapshot header: dim, k, total_points, threshold, rate
+ *   CLUSTER    one cluster, complete: centroid[D], count, inertia, label
+ *   COMMIT     closes a snapshot: BEGIN + k CLUSTERs are now the base
+ *   CENTROID   delta: one cluster's centroid, count, inertia
+ *   THRESHOLD  delta: outlier threshold and learning rate
+ *
+ * Payloads are little-endian; clusters use the record in model_codec.h.
+ * A new cluster or a retrained one is a CLUSTER/CENTROID delta (tens of
+ * bytes, no erase). Compaction appends a fresh snapshot; the segments
+ * before it become free and are erased only when the ring reuses them.
+ *
+ * Crash safety: every record carries a CRC32 and is written header first,
+ * so a torn record is detected and ends the log. Load starts from the last
+ * snapshot with a COMMIT and replays every intact delta after it; an
+ * interrupted compaction leaves the previous base and its deltas in place.
+ * A segment's header is zeroed before it is erased, so a cut erase cannot
+ * leave stale records that mount as the newest.
+ */
+
+#ifndef MODEL_JOURNAL_H
+#define MODEL_JOURNAL_H
+
+#include "flash_region.h"
+#include "streaming_kmeans.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODEL_JOURNAL_MAGIC 0x4A4C4F54    // "TOLJ"
+
+typedef enum {
+    JOURNAL_BEGIN = 1,
+    JOURNAL_CLUSTER = 2,
+    JOURNAL_COMMIT = 3,
+    JOURNAL_CENTROID = 4,
+    JOURNAL_THRESHOLD = 5,
+} journal_record_t;
+
+typedef struct {
+    uint32_t records;        // Appended this boot
+    uint32_t bytes;
+    uint32_t snapshots;
+    uint32_t erases;
+    uint32_t replayed;       // Deltas applied by the last load
+    uint32_t corrupt;        // Torn or bad-CRC records seen at mount
+} model_journal_stats_t;
+
+typedef struct {
+    const flash_region_t* flash;
+    uint32_t seg_size;
+    uint16_t segments;
+    bool empty_ring;
+
+    uint16_t head_seg;       // Oldest segment in the chain
+    uint16_t tail_seg;       // Segment being appended
+    uint32_t tail_off;       // seg_size = closed
+    uint32_t tail_seq;
+
+    bool has_base;           // A committed snapshot exists
+    uint16_t base_seg;       // Its BEGIN record
+    uint32_t base_off;
+    uint8_t base_dim;
+    uint32_t snapshot_bytes; // Size of the last snapshot, for room checks
+
+    model_journal_stats_t stats;
+} model_journal_t;
+
+// Scans the region. A blank or foreign region mounts empty. False on a read
+// error or fewer than 4 sectors.
+bool model_journal_mount(model_journal_t* j, const flash_region_t* flash);
+
+static inline bool model_journal_has_model(const model_journal_t* j) {
+    return j->has_base;
+}
+
+// Rebuilds clusters, labels, threshold and rate from the last snapshot and
+// its deltas. The model must be initialized with the same feature_dim and
+// room for the stored k. State is set to NORMAL.
+bool model_journal_load(model_journal_t* j, kmeans_model_t* model);
+
+// Deltas. The first write to an empty journal is a full snapshot; a ring
+// short of room for the next snapshot compacts first.
+bool model_journal_log_cluster(model_journal_t* j, const kmeans_model_t* model, uint8_t id);
+bool model_journal_log_centroid(model_journal_t* j, const kmeans_model_t* model, uint8_t id);
+bool model_journal_log_threshold(model_journal_t* j, const kmeans_model_t* model);
+
+// Appends a snapshot of the whole model; earlier segments become free
+bool model_journal_compact(model_journal_t* j, const kmeans_model_t* model);
+
+// More than half the ring is live: a good time for compact() when idle
+bool model_journal_needs_compaction(const model_journal_t* j);
+
+// Erases every segment
+bool model_journal_clear(model_journal_t* j);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
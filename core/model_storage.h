@@ -4,16 +4,31 @@
  * 
  * Saves trained clusters to flash. Survives power cycles.
  * 
+ * The model lives in an append-only journal (model_journal.h) in a
+ * preallocated LittleFS file on both platforms:
+ *   - a new cluster is one CLUSTER record, a retrained one a CENTROID record
+ *     (tens of bytes, no rewrite of the whole model)
+ *   - checkpoint() logs clusters that drifted since their last record
+ *   - maintain() compacts (fresh snapshot) when the log is half full; call
+ *     it when idle
+ * 
  * WHEN SAVES HAPPEN:
- *   - Immediately after kmeans_add_cluster() succeeds
- *   - That's it. No periodic saves needed.
+ *   - Right after kmeans_add_cluster() / kmeans_assign_existing() succeed
+ *   - Every MODEL_CHECKPOINT_MS, if set, for online-learning drift
  * 
  * WHEN STORAGE CLEARS:
  *   - MQTT reset command: {"reset": true}
  *   - Firmware re-upload
  * 
- * ESP32: Uses Preferences (NVS)
- * RP2350: Uses LittleFS JSON file
+ * Models saved by older firmware (v1: ESP32 Preferences, RP2350
+ * /model.bin) are imported once and then erased.
+ * 
+ * WARM RESTART:
+ *   - saveState() keeps the full runtime state (anomaly window, alarm and
+ *     motor counters, kmeans_serialize()) in /state.bin, e.g. while a
+ *     sample waits for its label; restoreState() puts it back after load()
+ *   - Any change logged to the journal drops it first, so a stale state
+ *     can never roll the clusters back
  */
 
 #ifndef MODEL_STORAGE_H
@@ -21,172 +36,72 @@
 
 #include <Arduino.h>
 #include "streaming_kmeans.h"
+#include "model_journal.h"
+#include "model_file.h"
+#include "flash_region_fs.h"
 #include "config.h"
 
-// Storage namespace/filename
+#define MODEL_JOURNAL_FILE "/model.j"
+#ifndef MODEL_JOURNAL_SECTORS
+  #define MODEL_JOURNAL_SECTORS 16      // x 4 KB = 64 KB of LittleFS
+#endif
+#define MODEL_JOURNAL_SECTOR_SIZE 4096
+#define MODEL_STATE_FILE "/state.bin"
+#define MODEL_STATE_TEMP "/state.tmp"
+
+// v1 storage namespace/filename (read-only, imported once)
 #define STORAGE_NAMESPACE "tinyol"
 #define STORAGE_FILENAME "/model.bin"
 
-// Magic number to detect valid stored model
-#define STORAGE_MAGIC 0x544F4C48  // "TOLH" = TinyOL-HITL
-
-// Version for future compatibility
-#define STORAGE_VERSION 1
-
-/**
- * Header stored at beginning of model data
- */
-typedef struct {
-    uint32_t magic;
-    uint8_t version;
-    uint8_t k;
-    uint8_t feature_dim;
-    uint8_t reserved;
-    uint32_t total_points;
-    fixed_t outlier_threshold;
-    fixed_t learning_rate;
-} storage_header_t;
-
-/**
- * Per-cluster data for storage
- */
-typedef struct {
-    fixed_t centroid[MAX_FEATURES];
-    uint32_t count;
-    fixed_t inertia;
-    char label[MAX_LABEL_LENGTH];
-    bool active;
-} stored_cluster_t;
-
 // =============================================================================
-// Platform-specific implementations
+// v1 loaders (read-only, layout in model_file.h)
 // =============================================================================
 
 #ifdef ESP32
 
 #include <Preferences.h>
 
-class ModelStorage {
+class LegacyStorage {
 private:
     Preferences prefs;
     
 public:
     /**
-     * Initialize storage subsystem
+     * Open the v1 namespace
      */
     bool begin() {
         return prefs.begin(STORAGE_NAMESPACE, false);  // false = read/write
     }
     
     /**
-     * Save model to flash
-     * @return true if successful
-     */
-    bool save(const kmeans_model_t* model) {
-        if (!model || !model->initialized) return false;
-        
-        Serial.println("[Storage] Saving model to NVS...");
-        
-        // Save header
-        storage_header_t header;
-        header.magic = STORAGE_MAGIC;
-        header.version = STORAGE_VERSION;
-        header.k = model->k;
-        header.feature_dim = model->feature_dim;
-        header.reserved = 0;
-        header.total_points = model->total_points;
-        header.outlier_threshold = model->outlier_threshold;
-        header.learning_rate = model->learning_rate;
-        
-        prefs.putBytes("header", &header, sizeof(header));
-        
-        // Save each cluster
-        for (uint8_t i = 0; i < model->k; i++) {
-            char key[16];
-            snprintf(key, sizeof(key), "cluster%d", i);
-            
-            stored_cluster_t sc;
-            memcpy(sc.centroid, model->clusters[i].centroid, 
-                   model->feature_dim * sizeof(fixed_t));
-            sc.count = model->clusters[i].count;
-            sc.inertia = model->clusters[i].inertia;
-            strncpy(sc.label, model->clusters[i].label, MAX_LABEL_LENGTH);
-            sc.active = model->clusters[i].active;
-            
-            prefs.putBytes(key, &sc, sizeof(sc));
-        }
-        
-        Serial.printf("[Storage] Saved K=%d clusters (%lu points)\n", 
-                      model->k, model->total_points);
-        return true;
-    }
-    
-    /**
-     * Load model from flash
+     * Load a v1 model
      * @return true if valid model found and loaded
      */
     bool load(kmeans_model_t* model) {
         if (!model) return false;
         
-        Serial.println("[Storage] Loading model from NVS...");
-        
-        // Read header
-        storage_header_t header;
-        size_t len = prefs.getBytes("header", &header, sizeof(header));
-        
-        if (len != sizeof(header)) {
-            Serial.println("[Storage] No saved model found");
-            return false;
-        }
-        
-        if (header.magic != STORAGE_MAGIC) {
-            Serial.println("[Storage] Invalid magic number");
-            return false;
-        }
-        
-        if (header.version != STORAGE_VERSION) {
-            Serial.printf("[Storage] Version mismatch (stored=%d, current=%d)\n",
-                          header.version, STORAGE_VERSION);
-            return false;
-        }
+        Serial.println("[Storage] Loading v1 model from NVS...");
         
-        if (header.feature_dim != model->feature_dim) {
-            Serial.printf("[Storage] Feature dim mismatch (stored=%d, current=%d)\n",
-                          header.feature_dim, model->feature_dim);
+        uint8_t header[MODEL_FILE_V1_HEADER_SIZE];
+        uint8_t k;
+        size_t len = prefs.getBytes("header", header, sizeof(header));
+        if (!model_file_v1_begin(header, len, model, &k)) {
+            Serial.println("[Storage] No usable v1 model (magic, version or feature dim)");
             return false;
         }
         
-        // Load clusters
-        for (uint8_t i = 0; i < header.k; i++) {
+        for (uint8_t i = 0; i < k; i++) {
             char key[16];
             snprintf(key, sizeof(key), "cluster%d", i);
             
-            stored_cluster_t sc;
-            len = prefs.getBytes(key, &sc, sizeof(sc));
-            
-            if (len != sizeof(sc)) {
+            uint8_t cluster[MODEL_FILE_V1_CLUSTER_SIZE];
+            len = prefs.getBytes(key, cluster, sizeof(cluster));
+            if (!model_file_v1_cluster(cluster, len, model)) {
                 Serial.printf("[Storage] Failed to load cluster %d\n", i);
                 return false;
             }
-            
-            memcpy(model->clusters[i].centroid, sc.centroid,
-                   model->feature_dim * sizeof(fixed_t));
-            model->clusters[i].count = sc.count;
-            model->clusters[i].inertia = sc.inertia;
-            strncpy(model->clusters[i].label, sc.label, MAX_LABEL_LENGTH);
-            model->clusters[i].active = sc.active;
         }
-        
-        // Update model state
-        model->k = header.k;
-        model->total_points = header.total_points;
-        model->outlier_threshold = header.outlier_threshold;
-        model->learning_rate = header.learning_rate;
-        model->initialized = true;
         model->state = STATE_NORMAL;
-        
-        Serial.printf("[Storage] Loaded K=%d clusters (%lu points)\n",
-                      model->k, model->total_points);
         return true;
     }
     
@@ -194,25 +109,16 @@ public:
      * Check if valid model exists in storage
      */
     bool hasModel() {
-        storage_header_t header;
-        size_t len = prefs.getBytes("header", &header, sizeof(header));
-        return (len == sizeof(header) && header.magic == STORAGE_MAGIC);
+        uint32_t magic = 0;
+        size_t len = prefs.getBytes("header", &magic, sizeof(magic));  // First header field
+        return len == sizeof(magic) && magic == MODEL_FILE_V1_MAGIC;
     }
     
     /**
-     * Erase all stored model data
+     * Erase the v1 model
      */
     void clear() {
-        Serial.println("[Storage] Clearing saved model...");
         prefs.clear();
-        Serial.println("[Storage] Model cleared");
-    }
-    
-    /**
-     * Get storage stats
-     */
-    void printStats() {
-        Serial.printf("[Storage] Free entries: %d\n", prefs.freeEntries());
     }
 };
 
@@ -220,7 +126,7 @@ public:
 
 #include <LittleFS.h>
 
-class ModelStorage {
+class LegacyStorage {
 public:
     bool begin() {
         if (!LittleFS.begin()) {
@@ -231,144 +137,245 @@ public:
         return true;
     }
     
-    bool save(const kmeans_model_t* model) {
-        if (!model || !model->initialized) return false;
+    bool load(kmeans_model_t* model) {
+        if (!model) return false;
+        
+        Serial.println("[Storage] Loading v1 model from LittleFS...");
         
-        Serial.println("[Storage] Saving model to LittleFS...");
+        File file = LittleFS.open(STORAGE_FILENAME, "r");
+        if (!file) return false;
         
-        File file = LittleFS.open(STORAGE_FILENAME, "w");
-        if (!file) {
-            Serial.println("[Storage] Failed to open file for writing");
+        uint8_t header[MODEL_FILE_V1_HEADER_SIZE];
+        uint8_t k;
+        size_t len = file.read(header, sizeof(header));
+        if (!model_file_v1_begin(header, len, model, &k)) {
+            Serial.println("[Storage] Invalid or outdated model file");
+            file.close();
             return false;
         }
         
-        // Write header
-        storage_header_t header;
-        header.magic = STORAGE_MAGIC;
-        header.version = STORAGE_VERSION;
-        header.k = model->k;
-        header.feature_dim = model->feature_dim;
-        header.reserved = 0;
-        header.total_points = model->total_points;
-        header.outlier_threshold = model->outlier_threshold;
-        header.learning_rate = model->learning_rate;
-        
-        file.write((uint8_t*)&header, sizeof(header));
-        
-        // Write clusters
-        for (uint8_t i = 0; i < model->k; i++) {
-            stored_cluster_t sc;
-            memcpy(sc.centroid, model->clusters[i].centroid,
-                   model->feature_dim * sizeof(fixed_t));
-            sc.count = model->clusters[i].count;
-            sc.inertia = model->clusters[i].inertia;
-            strncpy(sc.label, model->clusters[i].label, MAX_LABEL_LENGTH);
-            sc.active = model->clusters[i].active;
-            
-            file.write((uint8_t*)&sc, sizeof(sc));
+        for (uint8_t i = 0; i < k; i++) {
+            uint8_t cluster[MODEL_FILE_V1_CLUSTER_SIZE];
+            len = file.read(cluster, sizeof(cluster));
+            if (!model_file_v1_cluster(cluster, len, model)) {
+                file.close();
+                return false;
+            }
         }
         
         file.close();
-        
+        model->state = STATE_NORMAL;
+        return true;
+    }
+    
+    bool hasModel() {
+        return LittleFS.exists(STORAGE_FILENAME);
+    }
+    
+    void clear() {
+        LittleFS.remove(STORAGE_FILENAME);
+    }
+};
+
+#else
+#error "No storage implementation for this platform"
+#endif
+
+// =============================================================================
+// Journal storage (both platforms)
+// =============================================================================
+
+class ModelStorage {
+private:
+    LegacyStorage legacy;
+    FsFlashRegion flash;
+    model_journal_t journal;
+    bool ready = false;
+    uint32_t loggedCount[MAX_CLUSTERS];  // clusters[i].count at its last record
+    
+    void markLogged(const kmeans_model_t* model, uint8_t id) {
+        if (id < MAX_CLUSTERS) loggedCount[id] = model->clusters[id].count;
+    }
+    
+    void markAllLogged(const kmeans_model_t* model) {
+        for (uint8_t i = 0; i < model->k && i < MAX_CLUSTERS; i++) markLogged(model, i);
+    }
+    
+public:
+    /**
+     * Initialize storage subsystem
+     */
+    bool begin() {
+        legacy.begin();
+        ready = flash.begin(MODEL_JOURNAL_FILE, MODEL_JOURNAL_SECTORS, MODEL_JOURNAL_SECTOR_SIZE) &&
+                model_journal_mount(&journal, flash.region());
+        return ready;
+    }
+    
+    /**
+     * Save the whole model as a fresh snapshot
+     */
+    bool save(const kmeans_model_t* model) {
+        if (!ready || !model || !model->initialized) return false;
+        if (!model_journal_compact(&journal, model)) {
+            Serial.println("[Storage] Snapshot failed");
+            return false;
+        }
+        markAllLogged(model);
         Serial.printf("[Storage] Saved K=%d clusters (%lu points)\n",
-                      model->k, model->total_points);
+                      model->k, (unsigned long)model->total_points);
+        return true;
+    }
+    
+    /**
+     * Log a new cluster (after kmeans_add_cluster)
+     */
+    bool saveCluster(const kmeans_model_t* model, uint8_t id) {
+        dropState();
+        if (!ready || !model_journal_log_cluster(&journal, model, id)) return false;
+        markLogged(model, id);
+        return true;
+    }
+    
+    /**
+     * Log a retrained cluster (after kmeans_assign_existing)
+     */
+    bool saveCentroid(const kmeans_model_t* model, uint8_t id) {
+        dropState();
+        if (!ready || !model_journal_log_centroid(&journal, model, id)) return false;
+        markLogged(model, id);
         return true;
     }
     
+    /**
+     * Log every cluster that learned online since its last record
+     * @return number of records written
+     */
+    uint8_t checkpoint(const kmeans_model_t* model) {
+        if (!ready || model->k == 0) return 0;
+        if (!model_journal_has_model(&journal)) return save(model) ? model->k : 0;
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < model->k && i < MAX_CLUSTERS; i++) {
+            if (model->clusters[i].count != loggedCount[i] && saveCentroid(model, i)) n++;
+        }
+        return n;
+    }
+    
+    /**
+     * Compact when the log is half full (call when idle)
+     */
+    bool maintain(const kmeans_model_t* model) {
+        if (!ready || !model_journal_needs_compaction(&journal)) return false;
+        return save(model);
+    }
+    
+    /**
+     * Load the journal, or import a v1 model once
+     * @return true if valid model found and loaded
+     */
     bool load(kmeans_model_t* model) {
         if (!model) return false;
         
-        Serial.println("[Storage] Loading model from LittleFS...");
-        
-        if (!LittleFS.exists(STORAGE_FILENAME)) {
-            Serial.println("[Storage] No saved model found");
-            return false;
-        }
-        
-        File file = LittleFS.open(STORAGE_FILENAME, "r");
-        if (!file) {
-            Serial.println("[Storage] Failed to open file");
-            return false;
+        if (ready && model_journal_has_model(&journal)) {
+            Serial.println("[Storage] Loading model journal...");
+            if (!model_journal_load(&journal, model)) {
+                Serial.println("[Storage] Journal does not fit this model");
+                return false;
+            }
+            markAllLogged(model);
+            Serial.printf("[Storage] Loaded K=%d clusters (%lu points, %lu deltas)\n",
+                          model->k, (unsigned long)model->total_points,
+                          (unsigned long)journal.stats.replayed);
+            return true;
         }
         
-        // Read header
-        storage_header_t header;
-        if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
-            file.close();
-            return false;
+        if (!legacy.hasModel() || !legacy.load(model)) return false;
+        if (save(model)) {
+            legacy.clear();
+            Serial.println("[Storage] Imported v1 model into the journal");
         }
-        
-        if (header.magic != STORAGE_MAGIC || header.version != STORAGE_VERSION) {
-            Serial.println("[Storage] Invalid or outdated model file");
-            file.close();
+        return true;
+    }
+    
+    /**
+     * Save the whole runtime state for a warm restart. Written aside and
+     * renamed over the old copy, so a power cut keeps one or the other.
+     * @param buf scratch of KMEANS_STATE_MAX_SIZE(max_clusters, dim, capacity) bytes
+     */
+    bool saveState(const kmeans_model_t* model, uint8_t* buf, size_t cap) {
+        size_t n = kmeans_serialize(model, buf, cap);
+        if (!ready || n == 0) return false;
+        File file = LittleFS.open(MODEL_STATE_TEMP, "w");
+        if (!file) return false;
+        bool ok = file.write(buf, n) == n;
+        file.close();
+        if (!ok || !LittleFS.rename(MODEL_STATE_TEMP, MODEL_STATE_FILE)) {
+            Serial.println("[Storage] Runtime state save failed");
             return false;
         }
-        
-        if (header.feature_dim != model->feature_dim) {
-            Serial.println("[Storage] Feature dimension mismatch");
-            file.close();
+        Serial.printf("[Storage] Saved runtime state (%u B, %u buffered samples)\n",
+                      (unsigned)n, (unsigned)model->buffer.count);
+        return true;
+    }
+    
+    /**
+     * Put a saved runtime state over the model loaded by load()
+     * @return true if a state was found and fits the model
+     */
+    bool restoreState(kmeans_model_t* model, uint8_t* buf, size_t cap) {
+        if (!ready || !LittleFS.exists(MODEL_STATE_FILE)) return false;
+        File file = LittleFS.open(MODEL_STATE_FILE, "r");
+        if (!file) return false;
+        size_t n = file.size() <= cap ? file.read(buf, file.size()) : 0;
+        file.close();
+        if (n == 0 || !kmeans_deserialize(model, buf, n)) {
+            Serial.println("[Storage] Runtime state does not fit this model, dropped");
+            dropState();
             return false;
         }
-        
-        // Read clusters
-        for (uint8_t i = 0; i < header.k; i++) {
-            stored_cluster_t sc;
-            if (file.read((uint8_t*)&sc, sizeof(sc)) != sizeof(sc)) {
-                file.close();
-                return false;
-            }
-            
-            memcpy(model->clusters[i].centroid, sc.centroid,
-                   model->feature_dim * sizeof(fixed_t));
-            model->clusters[i].count = sc.count;
-            model->clusters[i].inertia = sc.inertia;
-            strncpy(model->clusters[i].label, sc.label, MAX_LABEL_LENGTH);
-            model->clusters[i].active = sc.active;
-        }
-        
-        file.close();
-        
-        model->k = header.k;
-        model->total_points = header.total_points;
-        model->outlier_threshold = header.outlier_threshold;
-        model->learning_rate = header.learning_rate;
-        model->initialized = true;
-        model->state = STATE_NORMAL;
-        
-        Serial.printf("[Storage] Loaded K=%d clusters (%lu points)\n",
-                      model->k, model->total_points);
         return true;
     }
     
+    /**
+     * Forget the runtime state (it no longer matches the model)
+     */
+    void dropState() {
+        if (ready && LittleFS.exists(MODEL_STATE_FILE)) LittleFS.remove(MODEL_STATE_FILE);
+    }
+    
+    /**
+     * Check if valid model exists in storage
+     */
     bool hasModel() {
-        if (!LittleFS.exists(STORAGE_FILENAME)) return false;
-        
-        File file = LittleFS.open(STORAGE_FILENAME, "r");
-        if (!file) return false;
-        
-        storage_header_t header;
-        bool valid = (file.read((uint8_t*)&header, sizeof(header)) == sizeof(header))
-                     && (header.magic == STORAGE_MAGIC);
-        file.close();
-        return valid;
+        return (ready && model_journal_has_model(&journal)) || legacy.hasModel();
     }
     
+    /**
+     * Erase all stored model data
+     */
     void clear() {
         Serial.println("[Storage] Clearing saved model...");
-        LittleFS.remove(STORAGE_FILENAME);
+        dropState();
+        if (ready) model_journal_clear(&journal);
+        legacy.clear();
         Serial.println("[Storage] Model cleared");
     }
     
+    /**
+     * Get storage stats
+     */
     void printStats() {
-        FSInfo fs_info;
-        LittleFS.info(fs_info);
-        Serial.printf("[Storage] Used: %lu / %lu bytes\n", 
-                      fs_info.usedBytes, fs_info.totalBytes);
+        if (!ready) {
+            Serial.println("[Storage] Journal unavailable");
+            return;
+        }
+        const model_journal_stats_t* st = &journal.stats;
+        Serial.printf("[Storage] Journal: %u x %lu B, %lu records (%lu B), %lu snapshots, %lu erases, %lu corrupt\n",
+                      journal.segments, (unsigned long)journal.seg_size,
+                      (unsigned long)st->records, (unsigned long)st->bytes,
+                      (unsigned long)st->snapshots, (unsigned long)st->erases,
+                      (unsigned long)st->corrupt);
     }
 };
 
-#else
-#error "No storage implementation for this platform"
-#endif
-
 #endif // MODEL_STORAGE_H
\ No newline at end of file
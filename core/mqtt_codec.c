@@ -0,0 +1,458 @@
+/**
+ * @file mqtt_codec.c
+ * @brief Streaming JSON writer and flat command scanner
+ */
+
+#include "mqtt_codec.h"
+#include <string.h>
+#include <math.h>
+
+// =============================================================================
+// ENCODER
+// =============================================================================
+
+static void put(json_writer_t* w, const char* s, size_t n) {
+    if (w->overflow) return;
+    if (w->len + n >= w->cap) {  // Keep room for the NUL
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static void put_char(json_writer_t* w, char c) {
+    put(w, &c, 1);
+}
+
+static void put_escaped(json_writer_t* w, const char* s) {
+    static const char HEX[] = "0123456789abcdef";
+    put_char(w, '"');
+    const char* run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        put(w, run, (size_t)(s - run));
+        run = s + 1;
+        switch (c) {
+            case '"':  put(w, "\\\"", 2); break;
+            case '\\': put(w, "\\\\", 2); break;
+            case '\n': put(w, "\\n", 2); break;
+            case '\r': put(w, "\\r", 2); break;
+            case '\t': put(w, "\\t", 2); break;
+            default: {
+                char u[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 15]};
+                put(w, u, 6);
+            }
+        }
+    }
+    put(w, run, (size_t)(s - run));
+    put_char(w, '"');
+}
+
+static void put_key(json_writer_t* w, const char* key) {
+    if (w->need_comma) put_char(w, ',');
+    w->need_comma = true;
+    put_escaped(w, key);
+    put_char(w, ':');
+}
+
+// Digits of v, most significant first
+static void put_u64(json_writer_t* w, uint64_t v) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[sizeof(tmp) - 1 - n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    put(w, tmp + sizeof(tmp) - n, (size_t)n);
+}
+
+void json_begin(json_writer_t* w, char* buf, size_t cap) {
+    w->buf = buf;
+    w->cap = cap;
+    w->len = 0;
+    w->overflow = (buf == NULL || cap == 0);
+    w->need_comma = false;
+    put_char(w, '{');
+}
+
+void json_str(json_writer_t* w, const char* key, const char* value) {
+    put_key(w, key);
+    if (value) put_escaped(w, value);
+    else put(w, "null", 4);
+}
+
+void json_int(json_writer_t* w, const char* key, int32_t value) {
+    put_key(w, key);
+    if (value < 0) put_char(w, '-');
+    put_u64(w, value < 0 ? (uint64_t)(-(int64_t)value) : (uint64_t)value);
+}
+
+void json_uint(json_writer_t* w, const char* key, uint32_t value) {
+    put_key(w, key);
+    put_u64(w, value);
+}
+
+void json_bool(json_writer_t* w, const char* key, bool value) {
+    put_key(w, key);
+    if (value) put(w, "true", 4);
+    else put(w, "false", 5);
+}
+
+static void put_float(json_writer_t* w, float value, uint8_t decimals) {
+    if (isnan(value) || isinf(value)) {
+        put(w, "null", 4);  // JSON has no NaN/Inf
+        return;
+    }
+    if (decimals > 9) decimals = 9;
+    double v = value < 0 ? -(double)value : value;
+
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+
+    if (v * scale >= 1e18) {
+        // Out of fixed-point range: d.dddddde+XX
+        int exp = 0;
+        while (v >= 10) { v /= 10; exp++; }
+        if (value < 0) put_char(w, '-');
+        uint64_t m = (uint64_t)(v * 1e6 + 0.5);
+        if (m >= 10000000) { m /= 10; exp++; }  // 9.9999999 rounded up
+        put_u64(w, m / 1000000);
+        put_char(w, '.');
+        char frac[6];
+        for (int i = 5; i >= 0; i--) { frac[i] = (char)('0' + m % 10); m /= 10; }
+        put(w, frac, 6);
+        put(w, "e+", 2);
+        put_u64(w, (uint64_t)exp);
+        return;
+    }
+
+    uint64_t fixed = (uint64_t)(v * scale + 0.5);
+    uint64_t whole = fixed / scale;
+    uint32_t frac = (uint32_t)(fixed % scale);
+    if (value < 0 && fixed != 0) put_char(w, '-');
+    put_u64(w, whole);
+    if (frac == 0) return;
+
+    // Fraction without trailing zeros
+    char digits[9];
+    int n = decimals;
+    for (int i = n - 1; i >= 0; i--) { digits[i] = (char)('0' + frac % 10); frac /= 10; }
+    while (n > 0 && digits[n - 1] == '0') n--;
+    put_char(w, '.');
+    put(w, digits, (size_t)n);
+}
+
+void json_float(json_writer_t* w, const char* key, float value, uint8_t decimals) {
+    put_key(w, key);
+    put_float(w, value, decimals);
+}
+
+void json_float_array(json_writer_t* w, const char* key, const float* values, size_t n,
+                      uint8_t decimals) {
+    put_key(w, key);
+    put_char(w, '[');
+    for (size_t i = 0; i < n; i++) {
+        if (i) put_char(w, ',');
+        put_float(w, values[i], decimals);
+    }
+    put_char(w, ']');
+}
+
+size_t json_end(json_writer_t* w) {
+    put_char(w, '}');
+    if (w->overflow) {
+        if (w->buf && w->cap) w->buf[0] = '\0';
+        return 0;
+    }
+    w->buf[w->len] = '\0';
+    return w->len;
+}
+
+size_t mqtt_encode_summary(const mqtt_summary_t* s, char* buf, size_t cap) {
+    json_writer_t w;
+    json_begin(&w, buf, cap);
+    json_str(&w, "device_id", s->device_id);
+    json_str(&w, "state", s->state);
+    json_bool(&w, "alarm_active", s->alarm_active);
+    json_bool(&w, "waiting_label", s->waiting_label);
+    json_bool(&w, "motor_running", s->motor_running);
+    json_int(&w, "cluster", s->cluster);
+    json_str(&w, "label", s->label);
+    json_uint(&w, "k", s->k);
+    json_uint(&w, "total_points", s->total_points);
+    json_float(&w, "vib_rms_avg", s->vib_rms_avg, MQTT_FLOAT_DECIMALS);
+    json_float(&w, "vib_rms_max", s->vib_rms_max, MQTT_FLOAT_DECIMALS);
+    json_float(&w, "vib_peak_max", s->vib_peak_max, MQTT_FLOAT_DECIMALS);
+    json_float(&w, "vib_crest_avg", s->vib_crest_avg, MQTT_FLOAT_DECIMALS);
+    if (s->has_current) {
+        json_float(&w, "current_rms_avg", s->current_rms_avg, MQTT_FLOAT_DECIMALS);
+        json_float(&w, "current_rms_max", s->current_rms_max, MQTT_FLOAT_DECIMALS);
+    }
+    json_float(&w, "baseline", s->baseline, MQTT_FLOAT_DECIMALS);
+    json_uint(&w, "buffer_samples", s->buffer_samples);
+    json_uint(&w, "sample_count", s->sample_count);
+    json_uint(&w, "timestamp", s->timestamp);
+    return json_end(&w);
+}
+
+// =============================================================================
+// DECODER
+// =============================================================================
+
+typedef struct {
+    const char* p;
+    const char* end;
+} scanner_t;
+
+typedef enum { VAL_NONE, VAL_STRING, VAL_NUMBER, VAL_BOOL, VAL_NULL, VAL_NESTED } val_type_t;
+
+static void skip_ws(scanner_t* s) {
+    while (s->p < s->end && (*s->p == ' ' || *s->p == '\t' || *s->p == '\n' || *s->p == '\r')) s->p++;
+}
+
+static bool accept(scanner_t* s, char c) {
+    skip_ws(s);
+    if (s->p < s->end && *s->p == c) {
+        s->p++;
+        return true;
+    }
+    return false;
+}
+
+static int hex_val(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool read_hex4(scanner_t* s, uint32_t* out) {
+    if (s->end - s->p < 4) return false;
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        int h = hex_val(s->p[i]);
+        if (h < 0) return false;
+        v = (v << 4) | (uint32_t)h;
+    }
+    s->p += 4;
+    *out = v;
+    return true;
+}
+
+// Appends c to out if it fits (cap includes the NUL)
+static void emit(char* out, size_t cap, size_t* n, char c) {
+    if (out && *n + 1 < cap) out[(*n)++] = c;
+}
+
+static void emit_utf8(char* out, size_t cap, size_t* n, uint32_t cp) {
+    if (cp < 0x80) {
+        emit(out, cap, n, (char)cp);
+    } else if (cp < 0x800) {
+        emit(out, cap, n, (char)(0xC0 | (cp >> 6)));
+        emit(out, cap, n, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        emit(out, cap, n, (char)(0xE0 | (cp >> 12)));
+        emit(out, cap, n, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        emit(out, cap, n, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        emit(out, cap, n, (char)(0xF0 | (cp >> 18)));
+        emit(out, cap, n, (char)(0x80 | ((cp >> 12) & 0x3F)));
+        emit(out, cap, n, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        emit(out, cap, n, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+// After the opening quote. Unescaped into out (truncated, NUL-terminated) if given.
+static bool read_string(scanner_t* s, char* out, size_t cap) {
+    size_t n = 0;
+    while (s->p < s->end) {
+        char c = *s->p++;
+        if (c == '"') {
+            if (out && cap) out[n] = '\0';
+            return true;
+        }
+        if ((unsigned char)c < 0x20) return false;
+        if (c != '\\') {
+            emit(out, cap, &n, c);
+            continue;
+        }
+        if (s->p >= s->end) return false;
+        c = *s->p++;
+        switch (c) {
+            case '"': case '\\': case '/': emit(out, cap, &n, c); break;
+            case 'b': emit(out, cap, &n, '\b'); break;
+            case 'f': emit(out, cap, &n, '\f'); break;
+            case 'n': emit(out, cap, &n, '\n'); break;
+            case 'r': emit(out, cap, &n, '\r'); break;
+            case 't': emit(out, cap, &n, '\t'); break;
+            case 'u': {
+                uint32_t cp;
+                if (!read_hex4(s, &cp)) return false;
+                if (cp >= 0xD800 && cp < 0xDC00) {
+                    // High surrogate: combine with the low one that must follow
+                    uint32_t lo;
+                    if (s->end - s->p < 2 || s->p[0] != '\\' || s->p[1] != 'u') return false;
+                    s->p += 2;
+                    if (!read_hex4(s, &lo) || lo < 0xDC00 || lo > 0xDFFF) return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                emit_utf8(out, cap, &n, cp);
+                break;
+            }
+            default: return false;
+        }
+    }
+    return false;  // Unterminated
+}
+
+static bool match_word(scanner_t* s, const char* word) {
+    size_t n = strlen(word);
+    if ((size_t)(s->end - s->p) < n || memcmp(s->p, word, n) != 0) return false;
+    s->p += n;
+    return true;
+}
+
+// JSON number; integer part saturated to int32 (fraction truncated)
+static bool read_number(scanner_t* s, int32_t* out) {
+    bool neg = false;
+    if (s->p < s->end && *s->p == '-') { neg = true; s->p++; }
+    if (s->p >= s->end || *s->p < '0' || *s->p > '9') return false;
+    int64_t v = 0;
+    if (*s->p == '0') {
+        s->p++;
+    } else {
+        while (s->p < s->end && *s->p >= '0' && *s->p <= '9') {
+            if (v <= INT32_MAX) v = v * 10 + (*s->p - '0');
+            s->p++;
+        }
+    }
+    if (s->p < s->end && *s->p == '.') {
+        s->p++;
+        if (s->p >= s->end || *s->p < '0' || *s->p > '9') return false;
+        while (s->p < s->end && *s->p >= '0' && *s->p <= '9') s->p++;
+    }
+    if (s->p < s->end && (*s->p == 'e' || *s->p == 'E')) {
+        s->p++;
+        if (s->p < s->end && (*s->p == '+' || *s->p == '-')) s->p++;
+        if (s->p >= s->end || *s->p < '0' || *s->p > '9') return false;
+        while (s->p < s->end && *s->p >= '0' && *s->p <= '9') s->p++;
+    }
+    if (neg) v = -v;
+    if (v > INT32_MAX) v = INT32_MAX;
+    if (v < INT32_MIN) v = INT32_MIN;
+    *out = (int32_t)v;
+    return true;
+}
+
+static bool skip_value(scanner_t* s, int depth);
+
+// Object or array after its opening bracket
+static bool skip_container(scanner_t* s, char close, int depth) {
+    if (depth > 8) return false;
+    if (accept(s, close)) return true;
+    do {
+        if (close == '}') {
+            if (!accept(s, '"') || !read_string(s, NULL, 0) || !accept(s, ':')) return false;
+        }
+        if (!skip_value(s, depth + 1)) return false;
+    } while (accept(s, ','));
+    return accept(s, close);
+}
+
+static bool skip_value(scanner_t* s, int depth) {
+    skip_ws(s);
+    if (s->p >= s->end) return false;
+    char c = *s->p;
+    int32_t ignored;
+    if (c == '"') { s->p++; return read_string(s, NULL, 0); }
+    if (c == '{') { s->p++; return skip_container(s, '}', depth); }
+    if (c == '[') { s->p++; return skip_container(s, ']', depth); }
+    if (c == 't') return match_word(s, "true");
+    if (c == 'f') return match_word(s, "false");
+    if (c == 'n') return match_word(s, "null");
+    return read_number(s, &ignored);
+}
+
+// One value: type, and the payload for scalars (string copied into str)
+static bool read_value(scanner_t* s, val_type_t* type, bool* b, int32_t* num,
+                       char* str, size_t str_cap) {
+    skip_ws(s);
+    if (s->p >= s->end) return false;
+    char c = *s->p;
+    if (c == '"') {
+        s->p++;
+        *type = VAL_STRING;
+        return read_string(s, str, str_cap);
+    }
+    if (c == '{' || c == '[') {
+        *type = VAL_NESTED;
+        return skip_value(s, 0);
+    }
+    if (c == 't' || c == 'f') {
+        *type = VAL_BOOL;
+        *b = (c == 't');
+        return match_word(s, *b ? "true" : "false");
+    }
+    if (c == 'n') {
+        *type = VAL_NULL;
+        return match_word(s, "null");
+    }
+    *type = VAL_NUMBER;
+    return read_number(s, num);
+}
+
+// Fields of one flat object into cmd (left partly filled on error)
+static bool decode_object(scanner_t* s, mqtt_command_t* cmd) {
+    if (!accept(s, '{')) return false;
+    if (accept(s, '}')) return true;
+    do {
+        char key[16];  // Longest command key is "cluster_id"
+        if (!accept(s, '"') || !read_string(s, key, sizeof(key)) || !accept(s, ':')) return false;
+
+        bool is_label = strcmp(key, "label") == 0;
+        val_type_t type = VAL_NONE;
+        bool b = false;
+        int32_t num = 0;
+        char label[MQTT_LABEL_MAX];
+        if (!read_value(s, &type, &b, &num, is_label ? label : NULL, sizeof(label))) return false;
+
+        if (is_label && type == VAL_STRING) {
+            cmd->has_label = true;
+            memcpy(cmd->label, label, sizeof(label));
+        } else if (type == VAL_BOOL && strcmp(key, "discard") == 0) {
+            cmd->has_discard = true;
+            cmd->discard = b;
+        } else if (type == VAL_BOOL && strcmp(key, "freeze") == 0) {
+            cmd->has_freeze = true;
+            cmd->freeze = b;
+        } else if (type == VAL_BOOL && strcmp(key, "reset") == 0) {
+            cmd->has_reset = true;
+            cmd->reset = b;
+        } else if (type == VAL_BOOL && strcmp(key, "export") == 0) {
+            cmd->has_export = true;
+            cmd->export_model = b;
+        } else if (type == VAL_NUMBER && strcmp(key, "cluster_id") == 0) {
+            cmd->has_cluster_id = true;
+            cmd->cluster_id = num;
+        }
+    } while (accept(s, ','));
+    return accept(s, '}');
+}
+
+bool mqtt_decode_command(const char* payload, size_t len, mqtt_command_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!payload) return false;
+
+    // Nothing from a rejected payload may reach the caller
+    mqtt_command_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    scanner_t s = {payload, payload + len};
+    if (!decode_object(&s, &cmd)) return false;
+    skip_ws(&s);
+    while (s.p < s.end && *s.p == '\0') s.p++;  // Senders that count the terminator
+    if (s.p != s.end) return false;
+    *out = cmd;
+    return true;
+}
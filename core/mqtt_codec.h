@@ -0,0 +1,100 @@
+/**
+ * @file mqtt_codec.h
+ * @brief Allocation-free JSON for the MQTT schema v2 messages (docs/MQTT_SCHEMA.md)
+ *
+ * Encoder: a streaming writer for one flat JSON object, appending straight
+ * into a caller buffer. Nothing is built in memory first, so there is no
+ * document and no heap; a too-small buffer is reported, never overrun.
+ *
+ * Decoder: a single-pass scanner for the flat command objects
+ * ({"label": ...}, {"discard": true}, {"cluster_id": 1}, ...). It reads a
+ * length-bounded payload (MQTT payloads are not NUL-terminated), ignores
+ * unknown keys, skips nested values and rejects malformed JSON.
+ */
+
+#ifndef MQTT_CODEC_H
+#define MQTT_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MQTT_LABEL_MAX 32        // Same as MAX_LABEL_LENGTH; longer labels are truncated
+#define MQTT_FLOAT_DECIMALS 4    // Summary floats: m/s^2 and A to 0.1 m-units
+
+// =============================================================================
+// ENCODER
+// =============================================================================
+
+typedef struct {
+    char* buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+    bool need_comma;
+} json_writer_t;
+
+void json_begin(json_writer_t* w, char* buf, size_t cap);
+void json_str(json_writer_t* w, const char* key, const char* value);  // NULL -> null
+void json_int(json_writer_t* w, const char* key, int32_t value);
+void json_uint(json_writer_t* w, const char* key, uint32_t value);
+void json_bool(json_writer_t* w, const char* key, bool value);
+void json_float(json_writer_t* w, const char* key, float value, uint8_t decimals);  // NaN/Inf -> null
+void json_float_array(json_writer_t* w, const char* key, const float* values, size_t n,
+                      uint8_t decimals);
+// Closes the object and NUL-terminates. Length without NUL, 0 on overflow.
+size_t json_end(json_writer_t* w);
+
+// sensor/{device_id}/data
+typedef struct {
+    const char* device_id;
+    const char* state;
+    bool alarm_active;
+    bool waiting_label;
+    bool motor_running;
+    int32_t cluster;
+    const char* label;
+    uint32_t k;
+    uint32_t total_points;
+    float vib_rms_avg;
+    float vib_rms_max;
+    float vib_peak_max;
+    float vib_crest_avg;
+    bool has_current;  // *_CURRENT schemas
+    float current_rms_avg;
+    float current_rms_max;
+    float baseline;
+    uint32_t buffer_samples;
+    uint32_t sample_count;
+    uint32_t timestamp;
+} mqtt_summary_t;
+
+size_t mqtt_encode_summary(const mqtt_summary_t* s, char* buf, size_t cap);
+
+// =============================================================================
+// DECODER
+// =============================================================================
+
+typedef struct {
+    bool has_label;       // "label" present and a string
+    char label[MQTT_LABEL_MAX];
+    bool has_discard, discard;
+    bool has_freeze, freeze;
+    bool has_reset, reset;
+    bool has_export, export_model;  // "export"
+    bool has_cluster_id;  // "cluster_id" present and a number
+    int32_t cluster_id;
+} mqtt_command_t;
+
+// False if payload is not one well-formed JSON object
+bool mqtt_decode_command(const char* payload, size_t len, mqtt_command_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
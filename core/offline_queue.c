@@ -0,0 +1,323 @@
+/**
+ * @file offline_queue.c
+ * @brief Flash segment log for store-and-forward (format in offline_queue.h)
+ */
+
+#include "offline_queue.h"
+#include "crc.h"
+#include <string.h>
+
+#define FLAG_PENDING 0xFF
+#define FLAG_DELIVERED 0x00
+#define LEN_ERASED 0xFFFF
+
+typedef struct {
+    uint16_t len;
+    uint8_t type;
+    uint8_t flag;
+    uint32_t crc;
+} record_header_t;
+
+typedef enum {
+    REC_END,      // Erased: nothing more in this segment
+    REC_OK,
+    REC_BAD,      // Torn or corrupt: nothing after it can be trusted
+} record_status_t;
+
+static uint32_t align4(uint32_t n) {
+    return (n + 3) & ~3u;
+}
+
+static uint32_t record_size(uint16_t len) {
+    return align4(OFFLINE_QUEUE_RECORD_HEADER + len);
+}
+
+static uint32_t seg_addr(const offline_queue_t* q, uint16_t seg, uint32_t off) {
+    return (uint32_t)seg * q->seg_size + off;
+}
+
+static uint16_t next_seg(const offline_queue_t* q, uint16_t seg) {
+    return (uint16_t)((seg + 1) % q->segments);
+}
+
+static uint32_t record_crc(const record_header_t* h, const void* payload, uint16_t len) {
+    uint32_t crc = crc32_update(0, &h->len, sizeof(h->len));
+    crc = crc32_update(crc, &h->type, 1);
+    return crc32_update(crc, payload, len);
+}
+
+static bool read_segment_header(const offline_queue_t* q, uint16_t seg, uint32_t* seq) {
+    uint32_t h[2];
+    if (!q->flash->read(seg_addr(q, seg, 0), h, sizeof(h), q->flash->ctx)) return false;
+    *seq = h[0];
+    return h[1] == OFFLINE_QUEUE_MAGIC;
+}
+
+// Ahead of every erase, so a cut erase never mounts as the tail
+static bool retire_segment(const offline_queue_t* q, uint16_t seg) {
+    return flash_region_retire(q->flash, seg_addr(q, seg, 0));
+}
+
+static record_status_t read_header(const offline_queue_t* q, uint16_t seg, uint32_t off,
+                                   record_header_t* h) {
+    if (off + OFFLINE_QUEUE_RECORD_HEADER > q->seg_size) return REC_END;
+    if (!q->flash->read(seg_addr(q, seg, off), h, sizeof(*h), q->flash->ctx)) return REC_BAD;
+    if (h->len == LEN_ERASED) return REC_END;
+    if (off + record_size(h->len) > q->seg_size) return REC_BAD;
+    return REC_OK;
+}
+
+// Header plus CRC over the payload, streamed through a small buffer
+static record_status_t check_record(const offline_queue_t* q, uint16_t seg, uint32_t off,
+                                    record_header_t* h) {
+    record_status_t st = read_header(q, seg, off, h);
+    if (st != REC_OK) return st;
+    uint8_t chunk[64];
+    uint32_t crc = crc32_update(0, &h->len, sizeof(h->len));
+    crc = crc32_update(crc, &h->type, 1);
+    uint32_t addr = seg_addr(q, seg, off + OFFLINE_QUEUE_RECORD_HEADER);
+    for (uint16_t done = 0; done < h->len;) {
+        uint16_t n = (uint16_t)(h->len - done < sizeof(chunk) ? h->len - done : sizeof(chunk));
+        if (!q->flash->read(addr + done, chunk, n, q->flash->ctx)) return REC_BAD;
+        crc = crc32_update(crc, chunk, n);
+        done += n;
+    }
+    return crc == h->crc ? REC_OK : REC_BAD;
+}
+
+// Moves head to the next pending record at or after (head_seg, head_off)
+static void seek_pending(offline_queue_t* q) {
+    for (;;) {
+        bool at_tail = q->head_seg == q->tail_seg;
+        if (at_tail && q->head_off >= q->tail_off) break;
+        record_header_t h;
+        if (read_header(q, q->head_seg, q->head_off, &h) != REC_OK) {
+            if (at_tail) break;
+            q->head_seg = next_seg(q, q->head_seg);
+            q->head_off = OFFLINE_QUEUE_SEGMENT_HEADER;
+            continue;
+        }
+        if (h.flag == FLAG_PENDING) return;
+        q->head_off += record_size(h.len);
+    }
+    q->head_seg = q->tail_seg;
+    q->head_off = q->tail_off;
+    q->pending = 0;
+}
+
+// Intact pending records from head to the end of the head segment
+static uint32_t count_head_segment(const offline_queue_t* q) {
+    uint32_t n = 0;
+    record_header_t h;
+    for (uint32_t off = q->head_off; check_record(q, q->head_seg, off, &h) == REC_OK;
+         off += record_size(h.len)) {
+        if (h.flag == FLAG_PENDING) n++;
+    }
+    return n;
+}
+
+static bool open_segment(offline_queue_t* q) {
+    uint16_t seg = q->empty_ring ? 0 : next_seg(q, q->tail_seg);
+    if (!q->empty_ring && seg == q->head_seg && q->pending > 0) {
+        // Ring full: the oldest segment goes
+        uint32_t lost = count_head_segment(q);
+        if (lost > q->pending) lost = q->pending;
+        q->pending -= lost;
+        q->stats.dropped += lost;
+        q->head_seg = next_seg(q, seg);
+        q->head_off = OFFLINE_QUEUE_SEGMENT_HEADER;
+        seek_pending(q);
+    }
+
+    q->tail_off = q->seg_size;  // Closed until the header is down
+    if (!retire_segment(q, seg)) return false;
+    if (!q->flash->erase(seg_addr(q, seg, 0), q->seg_size, q->flash->ctx)) return false;
+    q->stats.erases++;
+    uint32_t header[2] = {q->tail_seq + 1, OFFLINE_QUEUE_MAGIC};  // Magic last: torn = invalid
+    q->tail_seg = seg;
+    q->empty_ring = false;
+    if (!q->flash->write(seg_addr(q, seg, 0), header, sizeof(header), q->flash->ctx)) return false;
+    q->tail_seq++;
+    q->tail_off = OFFLINE_QUEUE_SEGMENT_HEADER;
+
+    if (q->pending == 0) {
+        q->head_seg = seg;
+        q->head_off = q->tail_off;
+    }
+    return true;
+}
+
+bool offline_queue_mount(offline_queue_t* q, const flash_region_t* flash) {
+    if (!q || !flash || flash->sector_size < 64 || flash->size / flash->sector_size < 2) return false;
+    memset(q, 0, sizeof(*q));
+    q->flash = flash;
+    q->seg_size = flash->sector_size;
+    q->segments = (uint16_t)(flash->size / flash->sector_size);
+    q->empty_ring = true;
+
+    // Newest valid segment is the tail; the chain runs back through consecutive seqs
+    bool found = false;
+    for (uint16_t s = 0; s < q->segments; s++) {
+        uint32_t seq;
+        if (read_segment_header(q, s, &seq) && (!found || seq > q->tail_seq)) {
+            found = true;
+            q->tail_seg = s;
+            q->tail_seq = seq;
+        }
+    }
+    if (!found) return true;
+    q->empty_ring = false;
+
+    uint16_t head = q->tail_seg;
+    uint32_t head_seq = q->tail_seq;
+    for (uint16_t i = 1; i < q->segments; i++) {
+        uint16_t prev = (uint16_t)((head + q->segments - 1) % q->segments);
+        uint32_t seq;
+        if (!read_segment_header(q, prev, &seq) || seq != head_seq - 1) break;
+        head = prev;
+        head_seq = seq;
+    }
+
+    // Count pending records; a torn record ends its segment
+    bool have_head = false;
+    for (uint16_t s = head;; s = next_seg(q, s)) {
+        uint32_t off = OFFLINE_QUEUE_SEGMENT_HEADER;
+        record_header_t h;
+        record_status_t st;
+        while ((st = check_record(q, s, off, &h)) == REC_OK) {
+            if (h.flag == FLAG_PENDING) {
+                if (!have_head) {
+                    have_head = true;
+                    q->head_seg = s;
+                    q->head_off = off;
+                }
+                q->pending++;
+            }
+            off += record_size(h.len);
+        }
+        if (st == REC_BAD) q->stats.corrupt++;
+        if (s == q->tail_seg) {
+            q->tail_off = st == REC_END ? off : q->seg_size;
+            break;
+        }
+    }
+    if (!have_head) {
+        q->head_seg = q->tail_seg;
+        q->head_off = q->tail_off;
+    }
+    return true;
+}
+
+bool offline_queue_push(offline_queue_t* q, uint8_t type, const void* data, uint16_t len) {
+    if (len == 0 || len > OFFLINE_QUEUE_MAX_PAYLOAD(q->seg_size)) return false;
+    if (q->empty_ring || q->tail_off + record_size(len) > q->seg_size) {
+        if (!open_segment(q)) return false;
+    }
+
+    record_header_t h = {len, type, FLAG_PENDING, 0};
+    h.crc = record_crc(&h, data, len);
+    uint32_t off = q->tail_off;
+    q->tail_off = q->seg_size;  // Closed if either write fails
+    // Header first: a record torn anywhere fails its CRC, and nothing is
+    // ever programmed over bytes a torn write may have touched
+    if (!q->flash->write(seg_addr(q, q->tail_seg, off), &h, sizeof(h), q->flash->ctx)) return false;
+    if (len && !q->flash->write(seg_addr(q, q->tail_seg, off + sizeof(h)), data, len, q->flash->ctx)) {
+        return false;
+    }
+    q->tail_off = off + record_size(len);
+
+    if (q->pending == 0) {
+        q->head_seg = q->tail_seg;
+        q->head_off = off;
+    }
+    q->pending++;
+    q->stats.appended++;
+    return true;
+}
+
+// Clears the head record's flag and moves on; callers do the counting
+static bool release_head(offline_queue_t* q) {
+    if (q->pending == 0) return false;
+    record_header_t h;
+    if (read_header(q, q->head_seg, q->head_off, &h) != REC_OK) return false;
+    uint8_t delivered = FLAG_DELIVERED;
+    uint32_t flag_addr = seg_addr(q, q->head_seg, q->head_off + offsetof(record_header_t, flag));
+    if (!q->flash->write(flag_addr, &delivered, 1, q->flash->ctx)) return false;
+    q->pending--;
+    q->head_off += record_size(h.len);
+    if (q->pending > 0) seek_pending(q);
+    else {
+        q->head_seg = q->tail_seg;
+        q->head_off = q->tail_off;
+    }
+    return true;
+}
+
+uint16_t offline_queue_peek(offline_queue_t* q, uint8_t* type, void* buf, uint16_t cap) {
+    while (q->pending > 0) {
+        record_header_t h;
+        if (read_header(q, q->head_seg, q->head_off, &h) != REC_OK) {
+            seek_pending(q);
+            continue;
+        }
+        if (h.len > cap) {
+            if (!release_head(q)) return 0;
+            q->stats.dropped++;
+            continue;
+        }
+        uint32_t addr = seg_addr(q, q->head_seg, q->head_off + OFFLINE_QUEUE_RECORD_HEADER);
+        if (!q->flash->read(addr, buf, h.len, q->flash->ctx)) return 0;
+        if (record_crc(&h, buf, h.len) != h.crc) {
+            // Torn record that ended a segment (mount did not count it), or
+            // bit rot since: nothing after it in this segment is trusted.
+            // seek_pending() resets pending if the count ran ahead.
+            q->stats.corrupt++;
+            if (q->head_seg == q->tail_seg) {
+                q->pending = 0;
+                q->head_off = q->tail_off;
+                return 0;
+            }
+            q->head_seg = next_seg(q, q->head_seg);
+            q->head_off = OFFLINE_QUEUE_SEGMENT_HEADER;
+            seek_pending(q);
+            continue;
+        }
+        if (type) *type = h.type;
+        return h.len;
+    }
+    return 0;
+}
+
+bool offline_queue_pop(offline_queue_t* q) {
+    if (!release_head(q)) return false;
+    q->stats.delivered++;
+    return true;
+}
+
+uint16_t offline_queue_drain(offline_queue_t* q, offline_queue_send_fn send, void* ctx,
+                             uint8_t* buf, uint16_t cap, uint16_t max) {
+    uint16_t sent = 0;
+    while (sent < max) {
+        uint8_t type;
+        uint16_t len = offline_queue_peek(q, &type, buf, cap);
+        if (len == 0) break;
+        if (!send(type, buf, len, ctx)) break;
+        if (!offline_queue_pop(q)) break;
+        sent++;
+    }
+    return sent;
+}
+
+bool offline_queue_clear(offline_queue_t* q) {
+    // Every header first: a cut erase must not leave part of the old log behind
+    for (uint16_t s = 0; s < q->segments; s++) {
+        if (!retire_segment(q, s)) return false;
+    }
+    if (!q->flash->erase(0, q->flash->size, q->flash->ctx)) return false;
+    q->stats.erases += q->segments;
+    q->empty_ring = true;
+    q->pending = 0;
+    q->head_seg = q->tail_seg = 0;
+    q->head_off = q->tail_off = 0;
+    return true;
+}
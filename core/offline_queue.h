@@ -0,0 +1,100 @@
+/**
+ * @file offline_queue.h
+ * @brief Store-and-forward message queue on flash for broker outages
+ *
+ * Messages that cannot be published are appended to a log of circular
+ * segments (one erase sector each) and drained, oldest first, once the
+ * broker is back. Bounded: when the ring is full, the oldest segment is
+ * erased and its messages are dropped (counted in stats.dropped).
+ *
+ * Wear: segments are used in rotation, a sector is erased only when the
+ * ring reuses it, and popping a message clears one flag byte in place
+ * (no erase). Appends never rewrite data.
+ *
+ * Segment:  [seq u32][magic u32] then records, rest erased (0xFF); the
+ *           header is zeroed before the segment is erased, so an erase cut
+ *           short never mounts as a segment.
+ * Record:   [len u16][type u8][flag u8][crc32 u32][payload], 4-byte aligned
+ *           flag 0xFF = pending, 0x00 = delivered; crc32 covers len, type
+ *           and payload, so a record torn by power loss is recognised and
+ *           ends its segment.
+ *
+ * Only a few indices live in RAM; offline_queue_mount() rebuilds them by
+ * scanning the region after a reboot.
+ */
+
+#ifndef OFFLINE_QUEUE_H
+#define OFFLINE_QUEUE_H
+
+#include "flash_region.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OFFLINE_QUEUE_MAGIC 0x514C4F54    // "TOLQ"
+#define OFFLINE_QUEUE_SEGMENT_HEADER 8
+#define OFFLINE_QUEUE_RECORD_HEADER 8
+// Largest payload for a region with this sector size
+#define OFFLINE_QUEUE_MAX_PAYLOAD(sector_size) \
+    ((sector_size) - OFFLINE_QUEUE_SEGMENT_HEADER - OFFLINE_QUEUE_RECORD_HEADER)
+
+typedef struct {
+    uint32_t appended;
+    uint32_t delivered;
+    uint32_t dropped;        // Lost to a full ring
+    uint32_t corrupt;        // Torn or bad-CRC records skipped at mount
+    uint32_t erases;
+} offline_queue_stats_t;
+
+typedef struct {
+    const flash_region_t* flash;
+    uint32_t seg_size;
+    uint16_t segments;
+    bool empty_ring;         // No segment in use yet
+
+    uint16_t head_seg;       // Oldest segment in use
+    uint32_t head_off;       // Next record to inspect in head_seg
+    uint16_t tail_seg;       // Segment being appended
+    uint32_t tail_off;       // Next append offset (seg_size = closed)
+    uint32_t tail_seq;
+
+    uint32_t pending;        // Records not yet popped
+    offline_queue_stats_t stats;
+} offline_queue_t;
+
+// Scans the region and resumes where the last boot left off. A blank or
+// foreign region mounts as an empty queue. False on a read error or a
+// region with fewer than 2 sectors.
+bool offline_queue_mount(offline_queue_t* q, const flash_region_t* flash);
+
+// Appends one message. False if len is 0 or exceeds OFFLINE_QUEUE_MAX_PAYLOAD,
+// or on a flash error.
+bool offline_queue_push(offline_queue_t* q, uint8_t type, const void* data, uint16_t len);
+
+// Copies the oldest pending message; returns its length, 0 if the queue is
+// empty. Messages longer than cap are skipped (popped).
+uint16_t offline_queue_peek(offline_queue_t* q, uint8_t* type, void* buf, uint16_t cap);
+
+// Marks the message returned by the last peek as delivered
+bool offline_queue_pop(offline_queue_t* q);
+
+// Returns false if the message could not be published (stop draining)
+typedef bool (*offline_queue_send_fn)(uint8_t type, const uint8_t* data, uint16_t len, void* ctx);
+
+// Peek/send/pop up to max messages; returns how many were delivered
+uint16_t offline_queue_drain(offline_queue_t* q, offline_queue_send_fn send, void* ctx,
+                             uint8_t* buf, uint16_t cap, uint16_t max);
+
+// Erases every segment
+bool offline_queue_clear(offline_queue_t* q);
+
+static inline uint32_t offline_queue_count(const offline_queue_t* q) {
+    return q->pending;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
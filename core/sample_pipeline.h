@@ -0,0 +1,149 @@
+/**
+ * @file sample_pipeline.h
+ * @brief Lock-free SPSC sample ring and hop-based windowing (header-only)
+ *
+ * Decouples high-rate accelerometer acquisition from the clustering loop:
+ *
+ *   acquisition (timer task / other core)
+ *       -> spsc_push()              1-4 kHz, never blocks
+ *   feature stage (loop)
+ *       -> spsc_pop() -> gravity filter -> window_push()
+ *       -> window_read() -> features, once per hop
+ *   k-means stage
+ *       -> kmeans_update(), one vector per window
+ *
+ * The ring has exactly one producer and one consumer. head is written only
+ * by the producer, tail only by the consumer; both are free-running uint32
+ * published with release/acquire ordering, so no lock or CAS is needed.
+ * spsc_push() drops the new sample on a full ring and counts it in
+ * `dropped`; spsc_try_push() leaves the policy to the caller.
+ *
+ * Uses GCC/Clang __atomic builtins so the header compiles as C (host
+ * tests) and C++ (Arduino ESP32 / RP2040 toolchains) alike.
+ */
+
+#ifndef SAMPLE_PIPELINE_H
+#define SAMPLE_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    float x, y, z;  // m/s^2
+} accel_sample_t;
+
+// =============================================================================
+// SPSC RING
+// =============================================================================
+
+typedef struct {
+    accel_sample_t* slots;  // Caller-owned, capacity entries
+    uint32_t mask;          // capacity - 1 (capacity is a power of two)
+    uint32_t head;          // Next write, producer-owned
+    uint32_t tail;          // Next read, consumer-owned
+    uint32_t dropped;       // Samples lost to a full ring, producer-owned
+} spsc_ring_t;
+
+static inline bool spsc_init(spsc_ring_t* r, accel_sample_t* slots, uint32_t capacity) {
+    if (!r || !slots || capacity < 2 || (capacity & (capacity - 1)) != 0) return false;
+    r->slots = slots;
+    r->mask = capacity - 1;
+    r->head = 0;
+    r->tail = 0;
+    r->dropped = 0;
+    return true;
+}
+
+// Producer side. False if the ring is full; nothing is recorded.
+static inline bool spsc_try_push(spsc_ring_t* r, const accel_sample_t* s) {
+    uint32_t head = r->head;  // Only we write head
+    uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    if (head - tail > r->mask) return false;
+    r->slots[head & r->mask] = *s;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Producer side for real-time acquisition: a full ring drops the sample
+// and counts it, the producer never waits.
+static inline bool spsc_push(spsc_ring_t* r, const accel_sample_t* s) {
+    if (spsc_try_push(r, s)) return true;
+    __atomic_store_n(&r->dropped, r->dropped + 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+// Consumer side. False if the ring is empty.
+static inline bool spsc_pop(spsc_ring_t* r, accel_sample_t* out) {
+    uint32_t tail = r->tail;  // Only we write tail
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    if (head == tail) return false;
+    *out = r->slots[tail & r->mask];
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Samples waiting (either side; a snapshot while the other side runs)
+static inline uint32_t spsc_count(const spsc_ring_t* r) {
+    return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t spsc_dropped(const spsc_ring_t* r) {
+    return __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+}
+
+// =============================================================================
+// WINDOWING
+// =============================================================================
+
+// Last `size` samples; ready once full and then every `hop` samples
+// (hop < size overlaps windows, hop == size tiles them)
+typedef struct {
+    float* frame;        // Caller-owned, size entries, circular
+    uint16_t size;
+    uint16_t hop;
+    uint16_t next;       // Write position
+    uint16_t count;      // Valid samples (<= size)
+    uint16_t since_emit; // Samples since the last ready window
+} sample_window_t;
+
+static inline bool window_init(sample_window_t* w, float* frame, uint16_t size, uint16_t hop) {
+    if (!w || !frame || size == 0 || hop == 0 || hop > size) return false;
+    w->frame = frame;
+    w->size = size;
+    w->hop = hop;
+    w->next = 0;
+    w->count = 0;
+    w->since_emit = 0;
+    return true;
+}
+
+// True when this sample completes a window
+static inline bool window_push(sample_window_t* w, float v) {
+    w->frame[w->next] = v;
+    w->next = (uint16_t)((w->next + 1) % w->size);
+    if (w->count < w->size) w->count++;
+    if (w->since_emit < w->hop) w->since_emit++;
+
+    if (w->count < w->size || w->since_emit < w->hop) return false;
+    w->since_emit = 0;
+    return true;
+}
+
+// Copy the window oldest -> newest into out[0..size-1]
+static inline void window_read(const sample_window_t* w, float* out) {
+    uint16_t start = (w->count < w->size) ? 0 : w->next;
+    for (uint16_t i = 0; i < w->count; i++) {
+        uint16_t j = (uint16_t)(start + i);
+        if (j >= w->size) j -= w->size;
+        out[i] = w->frame[j];
+    }
+}
+
+static inline void window_reset(sample_window_t* w) {
+    w->next = 0;
+    w->count = 0;
+    w->since_emit = 0;
+}
+
+#endif
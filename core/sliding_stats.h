@@ -0,0 +1,169 @@
+/**
+ * @file sliding_stats.h
+ * @brief O(1) windowed moments and sliding max of one signal (header-only)
+ *
+ * Keeps the last `capacity` samples and, per push:
+ *   - power sums S1..S4 of (x - shift): add the new sample, subtract the
+ *     evicted one -> mean, RMS, variance, skewness, kurtosis in O(1)
+ *   - a monotonic deque of window positions with decreasing values, so
+ *     the front is always the window max (amortized O(1))
+ *
+ * Float add/subtract drifts, so once every `capacity` pushes the sums are
+ * rebuilt from the window around its current mean (the shift, which also
+ * avoids cancellation when the signal rides on a large offset). That is
+ * O(W) once per W samples: still O(1) amortized. Evicting a sample that
+ * dominated S4 (an impulse leaving the window) would leave mostly rounding
+ * error behind, so that triggers a rebuild too.
+ *
+ * Moments are population (biased) estimates, matching numpy/scipy defaults
+ * used by tests/cwru/extract_features.py: var = m2, skew = m3 / m2^1.5,
+ * kurtosis = m4 / m2^2 - 3 (Fisher excess).
+ */
+
+#ifndef SLIDING_STATS_H
+#define SLIDING_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+typedef struct {
+    float* values;       // Caller-owned, capacity entries, circular
+    uint16_t* max_queue; // Caller-owned, capacity entries
+    uint16_t capacity;
+    uint16_t next;       // Write position
+    uint16_t count;
+    uint16_t q_head;     // Deque of positions, values decreasing
+    uint16_t q_len;
+    uint16_t since_resync;
+    float shift;
+    float s1, s2, s3, s4;  // Sums of (x - shift)^1..4
+} sliding_stats_t;
+
+static inline void sliding_stats_reset(sliding_stats_t* s) {
+    s->next = 0;
+    s->count = 0;
+    s->q_head = 0;
+    s->q_len = 0;
+    s->since_resync = 0;
+    s->shift = 0;
+    s->s1 = s->s2 = s->s3 = s->s4 = 0;
+}
+
+static inline bool sliding_stats_init(sliding_stats_t* s, float* values, uint16_t* max_queue,
+                                      uint16_t capacity) {
+    if (!s || !values || !max_queue || capacity == 0) return false;
+    s->values = values;
+    s->max_queue = max_queue;
+    s->capacity = capacity;
+    sliding_stats_reset(s);
+    return true;
+}
+
+static inline void sliding_stats_resync(sliding_stats_t* s) {
+    uint16_t n = s->count;
+    float mean = s->shift + s->s1 / n;
+    float s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        float d = s->values[i] - mean;
+        float d2 = d * d;
+        s1 += d;
+        s2 += d2;
+        s3 += d2 * d;
+        s4 += d2 * d2;
+    }
+    s->shift = mean;
+    s->s1 = s1; s->s2 = s2; s->s3 = s3; s->s4 = s4;
+    s->since_resync = 0;
+}
+
+static inline void sliding_stats_push(sliding_stats_t* s, float x) {
+    uint16_t pos = s->next;
+    uint16_t cap = s->capacity;
+    bool cancelled = false;
+
+    if (s->count == cap) {
+        // Evict the oldest sample (the one being overwritten)
+        float d = s->values[pos] - s->shift;
+        float d2 = d * d;
+        s->s1 -= d;
+        s->s2 -= d2;
+        s->s3 -= d2 * d;
+        s->s4 -= d2 * d2;
+        cancelled = d2 * d2 > s->s4;
+        if (s->q_len && s->max_queue[s->q_head] == pos) {
+            s->q_head = (uint16_t)((s->q_head + 1) % cap);
+            s->q_len--;
+        }
+    } else {
+        if (s->count == 0) s->shift = x;
+        s->count++;
+    }
+
+    s->values[pos] = x;
+    float d = x - s->shift;
+    float d2 = d * d;
+    s->s1 += d;
+    s->s2 += d2;
+    s->s3 += d2 * d;
+    s->s4 += d2 * d2;
+
+    // Drop smaller values from the back; they can never be the max again
+    while (s->q_len) {
+        uint16_t back = (uint16_t)((s->q_head + s->q_len - 1) % cap);
+        if (s->values[s->max_queue[back]] > x) break;
+        s->q_len--;
+    }
+    s->max_queue[(s->q_head + s->q_len) % cap] = pos;
+    s->q_len++;
+
+    s->next = (uint16_t)((pos + 1) % cap);
+    if (s->count == cap && (++s->since_resync >= cap || cancelled)) sliding_stats_resync(s);
+}
+
+static inline uint16_t sliding_stats_count(const sliding_stats_t* s) {
+    return s->count;
+}
+
+static inline float sliding_stats_max(const sliding_stats_t* s) {
+    return s->q_len ? s->values[s->max_queue[s->q_head]] : 0.0f;
+}
+
+static inline float sliding_stats_mean(const sliding_stats_t* s) {
+    return s->count ? s->shift + s->s1 / s->count : 0.0f;
+}
+
+// Central moment m2 (population variance)
+static inline float sliding_stats_variance(const sliding_stats_t* s) {
+    if (s->count == 0) return 0.0f;
+    float n = s->count, a = s->s1 / n;
+    float m2 = s->s2 / n - a * a;
+    return m2 > 0 ? m2 : 0.0f;
+}
+
+static inline float sliding_stats_rms(const sliding_stats_t* s) {
+    if (s->count == 0) return 0.0f;
+    float n = s->count, c = s->shift;
+    // sum(x^2) = S2 + 2c*S1 + n*c^2
+    float mean_sq = (s->s2 + 2 * c * s->s1) / n + c * c;
+    return mean_sq > 0 ? sqrtf(mean_sq) : 0.0f;
+}
+
+static inline float sliding_stats_skewness(const sliding_stats_t* s) {
+    float m2 = sliding_stats_variance(s);
+    if (m2 <= 0) return 0.0f;
+    float n = s->count, a = s->s1 / n;
+    float m3 = s->s3 / n - 3 * a * s->s2 / n + 2 * a * a * a;
+    return m3 / (m2 * sqrtf(m2));
+}
+
+// Excess kurtosis (0 for a Gaussian)
+static inline float sliding_stats_kurtosis(const sliding_stats_t* s) {
+    float m2 = sliding_stats_variance(s);
+    if (m2 <= 0) return 0.0f;
+    float n = s->count, a = s->s1 / n, a2 = a * a;
+    float m4 = s->s4 / n - 4 * a * s->s3 / n + 6 * a2 * s->s2 / n - 3 * a2 * a2;
+    return m4 / (m2 * m2) - 3.0f;
+}
+
+#endif
@@ -9,6 +9,9 @@
  */
 
 #include "streaming_kmeans.h"
+#include "kmeans_distance.h"
+#include "crc.h"
+#include "model_codec.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -21,13 +24,52 @@
 //     return min + (fixed_t)(((int64_t)range * rng_state) >> 31);
 // }
 
-bool kmeans_init(kmeans_model_t* model, uint8_t feature_dim, float learning_rate) {
+// Centroids are dimension-major: dimension d of a cluster is centroid_of()[d * max_clusters]
+static inline fixed_t* centroid_of(const kmeans_model_t* model, uint8_t cluster_id) {
+    return &model->centroids[cluster_id];
+}
+
+static inline fixed_t* buffer_row(const kmeans_model_t* model, uint16_t row) {
+    return &model->buffer.samples[(size_t)row * model->feature_dim];
+}
+
+static void buffer_clear(kmeans_model_t* model);
+
+bool kmeans_init_with_storage(kmeans_model_t* model, uint8_t feature_dim, float learning_rate,
+                              uint8_t max_clusters, uint16_t buffer_capacity,
+                              void* storage, size_t storage_size) {
     if (feature_dim > MAX_FEATURES || feature_dim == 0) return false;
+    if (max_clusters == 0 || max_clusters > MAX_CLUSTERS) return false;
+    if (buffer_capacity < BOOTSTRAP_SAMPLES) return false;  // Bootstrap needs the room
+    if (!storage || ((uintptr_t)storage & 7u) != 0) return false;
+    if (storage_size < KMEANS_STORAGE_SIZE(max_clusters, feature_dim, buffer_capacity)) return false;
+
+    memset(model, 0, offsetof(kmeans_model_t, embedded));  // Header only, see kmeans_model_t
+
+    // Carve storage: clusters | centroids | ring buffer rows | sums | labels (cold, last)
+    uint8_t* p = (uint8_t*)storage;
+    model->clusters = (cluster_t*)p;
+    p += KMEANS_ALIGN8((size_t)max_clusters * sizeof(cluster_t));
+    model->centroids = (fixed_t*)p;
+    p += KMEANS_ALIGN8((size_t)max_clusters * feature_dim * sizeof(fixed_t));
+    model->buffer.samples = (fixed_t*)p;
+    p += KMEANS_ALIGN8((size_t)buffer_capacity * feature_dim * sizeof(fixed_t));
+    model->buffer.sum = (int64_t*)p;
+    p += feature_dim * sizeof(int64_t);
+    model->buffer.sum_sq = (int64_t*)p;
+    p += feature_dim * sizeof(int64_t);
+    model->labels = (char (*)[MAX_LABEL_LENGTH])p;
+    model->buffer.capacity = buffer_capacity;
+    model->max_clusters = max_clusters;
+
+    memset(model->clusters, 0, (size_t)max_clusters * sizeof(cluster_t));
+    memset(model->centroids, 0, (size_t)max_clusters * feature_dim * sizeof(fixed_t));
+    memset(model->labels, 0, (size_t)max_clusters * MAX_LABEL_LENGTH);
 
-    memset(model, 0, sizeof(kmeans_model_t));
     model->k = 0;  // START WITH K=0
     model->feature_dim = feature_dim;
     model->learning_rate = FLOAT_TO_FIXED(learning_rate);
+    model->alpha_schedule = ALPHA_SCHEDULE_DECAY;
     model->state = STATE_BOOTSTRAP;  // NEW STATE
     model->outlier_threshold = FLOAT_TO_FIXED(8.0f);  // Less sensitive
     
@@ -42,39 +84,42 @@ bool kmeans_init(kmeans_model_t* model, uint8_t feature_dim, float learning_rate
     model->motor_running = true;  // Assume running initially
 
     // Initialize baseline cluster
-    memset(model->clusters[0].centroid, 0, feature_dim * sizeof(fixed_t));
-    strncpy(model->clusters[0].label, "normal", MAX_LABEL_LENGTH - 1);
+    strncpy(model->labels[0], "normal", MAX_LABEL_LENGTH - 1);
     model->clusters[0].active = true;
     model->clusters[0].count = 0;
     model->clusters[0].inertia = FLOAT_TO_FIXED(1.0f);
 
     // Ring buffer
-    model->buffer.head = 0;
-    model->buffer.count = 0;
+    buffer_clear(model);
     model->buffer.frozen = false;
 
     model->initialized = true;
     return true;
 }
 
-static fixed_t distance_squared(const fixed_t* a, const fixed_t* b, uint8_t dim) {
-    int64_t sum = 0;
-    for (uint8_t i = 0; i < dim; i++) {
-        int64_t diff = (int64_t)a[i] - (int64_t)b[i];
-        sum += (diff * diff) >> FIXED_POINT_SHIFT;
-    }
-    return (fixed_t)sum;
+bool kmeans_init(kmeans_model_t* model, uint8_t feature_dim, float learning_rate) {
+    return kmeans_init_with_storage(model, feature_dim, learning_rate,
+                                    MAX_CLUSTERS, RING_BUFFER_SIZE,
+                                    model->embedded, sizeof(model->embedded));
+}
+
+kmeans_model_t* kmeans_model_of(kmeans_model_header_t* header) {
+    return (kmeans_model_t*)(void*)header;
 }
 
 static uint8_t find_nearest_cluster(const kmeans_model_t* model, const fixed_t* point, fixed_t* out_distance) {
+    // Distances to every cluster in one kernel call (cluster 0 always scanned)
+    fixed_t dist[MAX_CLUSTERS];
+    uint8_t n = model->k > 0 ? model->k : 1;
+    kmeans_distances(point, model->centroids, n, model->feature_dim, model->max_clusters, dist);
+
     uint8_t nearest = 0;
-    fixed_t min_dist = distance_squared(point, model->clusters[0].centroid, model->feature_dim);
+    fixed_t min_dist = dist[0];
 
     for (uint8_t i = 1; i < model->k; i++) {
         if (!model->clusters[i].active) continue;
-        fixed_t dist = distance_squared(point, model->clusters[i].centroid, model->feature_dim);
-        if (dist < min_dist) {
-            min_dist = dist;
+        if (dist[i] < min_dist) {
+            min_dist = dist[i];
             nearest = i;
         }
     }
@@ -83,20 +128,60 @@ static uint8_t find_nearest_cluster(const kmeans_model_t* model, const fixed_t*
     return nearest;
 }
 
-static void buffer_add_sample(ring_buffer_t* buffer, const fixed_t* point, uint8_t feature_dim) {
+static inline int64_t square_q16(fixed_t x) {
+    return ((int64_t)x * x) >> FIXED_POINT_SHIFT;
+}
+
+static void buffer_clear(kmeans_model_t* model) {
+    model->buffer.head = 0;
+    model->buffer.count = 0;
+    memset(model->buffer.sum, 0, model->feature_dim * sizeof(int64_t));
+    memset(model->buffer.sum_sq, 0, model->feature_dim * sizeof(int64_t));
+}
+
+static void buffer_add_sample(kmeans_model_t* model, const fixed_t* point) {
+    ring_buffer_t* buffer = &model->buffer;
     if (buffer->frozen) return;
 
-    memcpy(buffer->samples[buffer->head], point, feature_dim * sizeof(fixed_t));
-    buffer->head = (buffer->head + 1) % RING_BUFFER_SIZE;
-    if (buffer->count < RING_BUFFER_SIZE) buffer->count++;
+    fixed_t* row = buffer_row(model, buffer->head);
+    bool evict = buffer->count == buffer->capacity;
+    for (uint8_t d = 0; d < model->feature_dim; d++) {
+        if (evict) {
+            buffer->sum[d] -= row[d];
+            buffer->sum_sq[d] -= square_q16(row[d]);
+        }
+        buffer->sum[d] += point[d];
+        buffer->sum_sq[d] += square_q16(point[d]);
+        row[d] = point[d];
+    }
+    buffer->head = (buffer->head + 1) % buffer->capacity;
+    if (!evict) buffer->count++;
 }
 
-bool kmeans_is_outlier(const kmeans_model_t* model, const fixed_t* point) {
-    if (!model->initialized || model->k == 0) return false;
+// New cluster from the buffered samples in O(D): centroid = mean,
+// inertia = total variance (expected squared distance to the mean)
+static void cluster_from_buffer(kmeans_model_t* model, uint8_t cluster_id) {
+    const ring_buffer_t* buffer = &model->buffer;
+    fixed_t* centroid = centroid_of(model, cluster_id);
+    uint8_t stride = model->max_clusters;
+    int64_t n = buffer->count;
+    int64_t variance = 0;
+
+    for (uint8_t d = 0; d < model->feature_dim; d++) {
+        int64_t mean = buffer->sum[d] / n;
+        int64_t var = buffer->sum_sq[d] / n - square_q16((fixed_t)mean);
+        if (var > 0) variance += var;
+        centroid[d * stride] = (fixed_t)mean;
+    }
 
-    fixed_t distance;
-    uint8_t nearest = find_nearest_cluster(model, point, &distance);
-    
+    cluster_t* cluster = &model->clusters[cluster_id];
+    cluster->active = true;
+    cluster->count = buffer->count;
+    cluster->inertia = variance > INT32_MAX ? INT32_MAX : (fixed_t)variance;
+}
+
+// Outlier test against an already-found nearest cluster
+static bool outlier_at(const kmeans_model_t* model, uint8_t nearest, fixed_t distance) {
     fixed_t radius = model->clusters[nearest].inertia;
     if (radius == 0) radius = FLOAT_TO_FIXED(1.0f);
 
@@ -104,52 +189,155 @@ bool kmeans_is_outlier(const kmeans_model_t* model, const fixed_t* point) {
     return distance > threshold;
 }
 
-int8_t kmeans_update(kmeans_model_t* model, const fixed_t* point) {
-    if (!model->initialized) return -1;
-    
+bool kmeans_is_outlier(const kmeans_model_t* model, const fixed_t* point) {
+    if (!model->initialized || model->k == 0) return false;
+
+    fixed_t distance;
+    uint8_t nearest = find_nearest_cluster(model, point, &distance);
+    return outlier_at(model, nearest, distance);
+}
+
+// ceil(2^32 / (100 + c)): floor(n / (100 + c)) == (n * recip[c]) >> 32
+// for n < 2^23, so the first ALPHA_LUT_SIZE samples of a cluster skip the divide
+#define ALPHA_LUT_SIZE 256
+#define ALPHA_LUT_MAX_N (1u << 23)
+static const uint32_t alpha_recip[ALPHA_LUT_SIZE] = {
+    0x028F5C29u, 0x0288DF0Du, 0x02828283u, 0x027C4598u, 0x02762763u, 0x02702703u,
+    0x026A43A0u, 0x02647C6Au, 0x025ED098u, 0x02593F6Au, 0x0253C826u, 0x024E6A18u,
+    0x02492493u, 0x0243F6F1u, 0x023EE090u, 0x0239E0D6u, 0x0234F72Du, 0x02302303u,
+    0x022B63CCu, 0x0226B903u, 0x02222223u, 0x021D9EAEu, 0x02192E2Au, 0x0214D022u,
+    0x02108422u, 0x020C49BBu, 0x02082083u, 0x02040811u, 0x02000000u, 0x01FC07F1u,
+    0x01F81F82u, 0x01F4465Au, 0x01F07C20u, 0x01ECC07Cu, 0x01E9131Bu, 0x01E573ADu,
+    0x01E1E1E2u, 0x01DE5D6Fu, 0x01DAE608u, 0x01D77B66u, 0x01D41D42u, 0x01D0CB59u,
+    0x01CD8569u, 0x01CA4B31u, 0x01C71C72u, 0x01C3F8F1u, 0x01C0E071u, 0x01BDD2B9u,
+    0x01BACF92u, 0x01B7D6C4u, 0x01B4E81Cu, 0x01B20365u, 0x01AF286Cu, 0x01AC5702u,
+    0x01A98EF7u, 0x01A6D01Bu, 0x01A41A42u, 0x01A16D40u, 0x019EC8EAu, 0x019C2D15u,
+    0x0199999Au, 0x01970E50u, 0x01948B10u, 0x01920FB5u, 0x018F9C19u, 0x018D3019u,
+    0x018ACB91u, 0x01886E60u, 0x01861862u, 0x0183C978u, 0x01818182u, 0x017F4060u,
+    0x017D05F5u, 0x017AD221u, 0x0178A4C9u, 0x01767DCFu, 0x01745D18u, 0x01724288u,
+    0x01702E06u, 0x016E1F77u, 0x016C16C2u, 0x016A13CEu, 0x01681682u, 0x01661EC7u,
+    0x01642C86u, 0x01623FA8u, 0x01605817u, 0x015E75BCu, 0x015C9883u, 0x015AC057u,
+    0x0158ED24u, 0x01571ED4u, 0x01555556u, 0x01539095u, 0x0151D07Fu, 0x01501502u,
+    0x014E5E0Bu, 0x014CAB89u, 0x014AFD6Bu, 0x0149539Fu, 0x0147AE15u, 0x01460CBDu,
+    0x01446F87u, 0x0142D663u, 0x01414142u, 0x013FB014u, 0x013E22CCu, 0x013C995Bu,
+    0x013B13B2u, 0x013991C3u, 0x01381382u, 0x013698E0u, 0x013521D0u, 0x0133AE46u,
+    0x01323E35u, 0x0130D191u, 0x012F684Cu, 0x012E025Du, 0x012C9FB5u, 0x012B404Bu,
+    0x0129E413u, 0x01288B02u, 0x0127350Cu, 0x0125E228u, 0x0124924Au, 0x01234568u,
+    0x0121FB79u, 0x0120B471u, 0x011F7048u, 0x011E2EF4u, 0x011CF06Bu, 0x011BB4A5u,
+    0x011A7B97u, 0x01194539u, 0x01181182u, 0x0116E069u, 0x0115B1E6u, 0x011485F1u,
+    0x01135C82u, 0x0112358Fu, 0x01111112u, 0x010FEF02u, 0x010ECF57u, 0x010DB20Bu,
+    0x010C9715u, 0x010B7E6Fu, 0x010A6811u, 0x010953F4u, 0x01084211u, 0x01073261u,
+    0x010624DEu, 0x01051980u, 0x01041042u, 0x0103091Cu, 0x01020409u, 0x01010102u,
+    0x01000000u, 0x00FF0100u, 0x00FE03F9u, 0x00FD08E6u, 0x00FC0FC1u, 0x00FB1886u,
+    0x00FA232Du, 0x00F92FB3u, 0x00F83E10u, 0x00F74E40u, 0x00F6603Eu, 0x00F57404u,
+    0x00F4898Eu, 0x00F3A0D6u, 0x00F2B9D7u, 0x00F1D48Cu, 0x00F0F0F1u, 0x00F00F01u,
+    0x00EF2EB8u, 0x00EE500Fu, 0x00ED7304u, 0x00EC9792u, 0x00EBBDB3u, 0x00EAE565u,
+    0x00EA0EA1u, 0x00E93966u, 0x00E865ADu, 0x00E79373u, 0x00E6C2B5u, 0x00E5F36Du,
+    0x00E52599u, 0x00E45933u, 0x00E38E39u, 0x00E2C4A7u, 0x00E1FC79u, 0x00E135AAu,
+    0x00E07039u, 0x00DFAC20u, 0x00DEE95Du, 0x00DE27ECu, 0x00DD67C9u, 0x00DCA8F2u,
+    0x00DBEB62u, 0x00DB2F18u, 0x00DA740Eu, 0x00D9BA43u, 0x00D901B3u, 0x00D84A5Au,
+    0x00D79436u, 0x00D6DF44u, 0x00D62B81u, 0x00D578EAu, 0x00D4C77Cu, 0x00D41733u,
+    0x00D3680Eu, 0x00D2BA09u, 0x00D20D21u, 0x00D16155u, 0x00D0B6A0u, 0x00D00D01u,
+    0x00CF6475u, 0x00CEBCF9u, 0x00CE168Bu, 0x00CD7128u, 0x00CCCCCDu, 0x00CC2979u,
+    0x00CB8728u, 0x00CAE5D9u, 0x00CA4588u, 0x00C9A634u, 0x00C907DBu, 0x00C86A79u,
+    0x00C7CE0Du, 0x00C73294u, 0x00C6980Du, 0x00C5FE75u, 0x00C565C9u, 0x00C4CE08u,
+    0x00C43730u, 0x00C3A13Eu, 0x00C30C31u, 0x00C27807u, 0x00C1E4BCu, 0x00C15251u,
+    0x00C0C0C1u, 0x00C0300Du, 0x00BFA030u, 0x00BF112Bu, 0x00BE82FBu, 0x00BDF59Du,
+    0x00BD6911u, 0x00BCDD54u, 0x00BC5265u, 0x00BBC841u, 0x00BB3EE8u, 0x00BAB657u,
+    0x00BA2E8Cu, 0x00B9A787u, 0x00B92144u, 0x00B89BC4u
+};
+
+fixed_t kmeans_alpha(const kmeans_model_t* model, uint32_t count) {
+    fixed_t lr = model->learning_rate;
+
+    switch (model->alpha_schedule) {
+        case ALPHA_SCHEDULE_CONSTANT:
+            return lr;
+
+        case ALPHA_SCHEDULE_POW2: {
+            // lr / 2^floor(log2(1 + count / 100)): halves at 100, 300, 700, ...
+            uint32_t q = count / 100u + 1u;
+            uint8_t shift = 0;
+            while (q >>= 1) shift++;
+            return shift >= 31 ? 0 : lr >> shift;
+        }
+
+        case ALPHA_SCHEDULE_DECAY:
+        default: {
+            // lr / (1 + 0.01 * count) == lr * 100 / (100 + count), floored
+            uint32_t denom = count > UINT32_MAX - 100u ? UINT32_MAX : count + 100u;
+            if ((uint32_t)lr <= UINT32_MAX / 100u) {
+                uint32_t n = (uint32_t)lr * 100u;
+                if (count < ALPHA_LUT_SIZE && n < ALPHA_LUT_MAX_N) {
+                    return (fixed_t)(((uint64_t)n * alpha_recip[count]) >> 32);
+                }
+                return (fixed_t)(n / denom);  // 32-bit divide: no __aeabi_uldivmod on M0+
+            }
+            // lr >= 655.36 (Q16.16): lr * 100 needs 64 bits
+            return (fixed_t)(((uint64_t)(uint32_t)lr * 100u) / denom);
+        }
+    }
+}
+
+bool kmeans_set_alpha_schedule(kmeans_model_t* model, alpha_schedule_t schedule) {
+    if (schedule != ALPHA_SCHEDULE_DECAY && schedule != ALPHA_SCHEDULE_POW2 &&
+        schedule != ALPHA_SCHEDULE_CONSTANT) return false;
+    model->alpha_schedule = schedule;
+    return true;
+}
+
+static int8_t update_at(kmeans_model_t* model, const fixed_t* point,
+                        uint8_t cluster_id, fixed_t distance);
+
+// One sample through the state machine (model already validated)
+static int8_t update_one(kmeans_model_t* model, const fixed_t* point) {
     // WAITING_LABEL: frozen, reject updates
     if (model->state == STATE_WAITING_LABEL) {
         return -1;
     }
 
     // Add to ring buffer
-    buffer_add_sample(&model->buffer, point, model->feature_dim);
+    buffer_add_sample(model, point);
 
     // BOOTSTRAP MODE: K=0, collecting first baseline
     if (model->state == STATE_BOOTSTRAP) {  
         if (model->buffer.count >= BOOTSTRAP_SAMPLES) {
-            // Create first cluster from buffer average
-            cluster_t* first = &model->clusters[0];
-            memset(first->centroid, 0, model->feature_dim * sizeof(fixed_t));
-            
-            for (uint16_t i = 0; i < model->buffer.count; i++) {
-                for (uint8_t d = 0; d < model->feature_dim; d++) {
-                    first->centroid[d] += model->buffer.samples[i][d] / (fixed_t)model->buffer.count;
-                }
-            }
-            
-            strncpy(first->label, "normal", MAX_LABEL_LENGTH - 1);
-            first->active = true;
-            first->count = model->buffer.count;
-            first->inertia = FLOAT_TO_FIXED(1.0f);
+            // Create first cluster from buffer mean and spread
+            cluster_from_buffer(model, 0);
+            strncpy(model->labels[0], "normal", MAX_LABEL_LENGTH - 1);
             
             model->k = 1;
             model->state = STATE_NORMAL;
-            model->buffer.head = 0;
-            model->buffer.count = 0;
+            buffer_clear(model);
         }
         return 0;  // No cluster assignment during bootstrap
     }
 
-    // Find nearest cluster
+    // Find nearest cluster (single scan, reused by the outlier check)
     fixed_t distance;
     uint8_t cluster_id = find_nearest_cluster(model, point, &distance);
+    return update_at(model, point, cluster_id, distance);
+}
+
+int8_t kmeans_update_located(kmeans_model_t* model, const fixed_t* point,
+                             uint8_t nearest, fixed_t distance) {
+    if (!model->initialized) return -1;
+    if ((model->state != STATE_NORMAL && model->state != STATE_ALARM) || nearest >= model->k) {
+        return update_one(model, point);
+    }
+    buffer_add_sample(model, point);
+    return update_at(model, point, nearest, distance);
+}
+
+// Outlier check, state transitions and EMA for a located sample (NORMAL/ALARM)
+static int8_t update_at(kmeans_model_t* model, const fixed_t* point,
+                        uint8_t cluster_id, fixed_t distance) {
     model->last_distance = distance;
 
     // Check outlier (after 10 samples baseline)
     bool is_outlier = false;
-    if (model->buffer.count >= 10) {
-        is_outlier = kmeans_is_outlier(model, point);
+    if (model->buffer.count >= 10 && model->k > 0) {
+        is_outlier = outlier_at(model, cluster_id, distance);
     }
 
     // State transitions
@@ -183,14 +371,13 @@ int8_t kmeans_update(kmeans_model_t* model, const fixed_t* point) {
 
     // Update centroid (only in NORMAL or ALARM state, and only for non-outliers)
     cluster_t* cluster = &model->clusters[cluster_id];
-    
-    float decay = 1.0f + 0.01f * cluster->count;
-    float alpha_f = FIXED_TO_FLOAT(model->learning_rate) / decay;
-    fixed_t alpha = FLOAT_TO_FIXED(alpha_f);
+    fixed_t* centroid = centroid_of(model, cluster_id);
+    uint8_t stride = model->max_clusters;
+    fixed_t alpha = kmeans_alpha(model, cluster->count);
 
     for (uint8_t i = 0; i < model->feature_dim; i++) {
-        fixed_t diff = point[i] - cluster->centroid[i];
-        cluster->centroid[i] += FIXED_MUL(alpha, diff);
+        fixed_t diff = point[i] - centroid[i * stride];
+        centroid[i * stride] += FIXED_MUL(alpha, diff);
     }
     
     cluster->inertia += FIXED_MUL(alpha, distance - cluster->inertia);
@@ -200,6 +387,29 @@ int8_t kmeans_update(kmeans_model_t* model, const fixed_t* point) {
     return cluster_id;
 }
 
+int8_t kmeans_update(kmeans_model_t* model, const fixed_t* point) {
+    if (!model->initialized) return -1;
+    return update_one(model, point);
+}
+
+size_t kmeans_update_batch(kmeans_model_t* model, const fixed_t* points, size_t n, int8_t* out) {
+    size_t i = 0;
+
+    if (model->initialized) {
+        // Stop at the freeze: later sequential calls would be rejected anyway
+        while (i < n && model->state != STATE_WAITING_LABEL) {
+            int8_t result = update_one(model, points + i * model->feature_dim);
+            if (out) out[i] = result;
+            i++;
+        }
+    }
+
+    if (out) {
+        for (size_t j = i; j < n; j++) out[j] = -1;
+    }
+    return i;
+}
+
 uint8_t kmeans_predict(const kmeans_model_t* model, const fixed_t* point) {
     if (!model->initialized || model->k == 0) return 0;
     
@@ -289,39 +499,25 @@ void kmeans_discard(kmeans_model_t* model) {
     model->normal_streak = 0;
     
     model->buffer.frozen = false;
-    model->buffer.head = 0;
-    model->buffer.count = 0;
+    buffer_clear(model);
 }
 
 bool kmeans_add_cluster(kmeans_model_t* model, const char* label) {
     if (!model->initialized) return false;
-    if (model->k >= MAX_CLUSTERS) return false;
+    if (model->k >= model->max_clusters) return false;
     if (!label || strlen(label) == 0) return false;
     if (model->state != STATE_WAITING_LABEL) return false;
     if (model->buffer.count == 0) return false;
 
     // Check duplicate label
     for (uint8_t i = 0; i < model->k; i++) {
-        if (strcmp(model->clusters[i].label, label) == 0) return false;
-    }
-
-    cluster_t* new_cluster = &model->clusters[model->k];
-
-    // NEW: Average ALL buffered samples (not just last one)
-    memset(new_cluster->centroid, 0, model->feature_dim * sizeof(fixed_t));
-    
-    for (uint16_t i = 0; i < model->buffer.count; i++) {
-        for (uint8_t d = 0; d < model->feature_dim; d++) {
-            // Accumulate then divide to avoid overflow
-            new_cluster->centroid[d] += model->buffer.samples[i][d] / (fixed_t)model->buffer.count;
-        }
+        if (strcmp(model->labels[i], label) == 0) return false;
     }
 
-    strncpy(new_cluster->label, label, MAX_LABEL_LENGTH - 1);
-    new_cluster->label[MAX_LABEL_LENGTH - 1] = '\0';
-    new_cluster->active = true;
-    new_cluster->count = model->buffer.count;  // Start with buffer size
-    new_cluster->inertia = FLOAT_TO_FIXED(1.0f);
+    // Centroid = mean of ALL buffered samples, inertia = their spread
+    cluster_from_buffer(model, model->k);
+    strncpy(model->labels[model->k], label, MAX_LABEL_LENGTH - 1);
+    model->labels[model->k][MAX_LABEL_LENGTH - 1] = '\0';
 
     model->k++;
 
@@ -333,8 +529,7 @@ bool kmeans_add_cluster(kmeans_model_t* model, const char* label) {
     model->normal_streak = 0;
     
     model->buffer.frozen = false;
-    model->buffer.head = 0;
-    model->buffer.count = 0;
+    buffer_clear(model);
 
     return true;
 }
@@ -346,18 +541,19 @@ bool kmeans_assign_existing(kmeans_model_t* model, uint8_t cluster_id) {
     if (model->buffer.count == 0) return false;
 
     cluster_t* cluster = &model->clusters[cluster_id];
+    fixed_t* centroid = centroid_of(model, cluster_id);
+    uint8_t stride = model->max_clusters;
 
     // Train existing cluster with ALL buffered samples via EMA
     for (uint16_t i = 0; i < model->buffer.count; i++) {
-        fixed_t* sample = model->buffer.samples[i];
+        const fixed_t* sample = buffer_row(model, i);
         
         // EMA update with decay
-        float decay = 1.0f + 0.01f * cluster->count;
-        fixed_t alpha = FLOAT_TO_FIXED(FIXED_TO_FLOAT(model->learning_rate) / decay);
+        fixed_t alpha = kmeans_alpha(model, cluster->count);
         
         for (uint8_t d = 0; d < model->feature_dim; d++) {
-            fixed_t diff = sample[d] - cluster->centroid[d];
-            cluster->centroid[d] += FIXED_MUL(alpha, diff);
+            fixed_t diff = sample[d] - centroid[d * stride];
+            centroid[d * stride] += FIXED_MUL(alpha, diff);
         }
         cluster->count++;
     }
@@ -370,8 +566,7 @@ bool kmeans_assign_existing(kmeans_model_t* model, uint8_t cluster_id) {
     model->normal_streak = 0;
     
     model->buffer.frozen = false;
-    model->buffer.head = 0;
-    model->buffer.count = 0;
+    buffer_clear(model);
 
     return true;
 }
@@ -398,13 +593,21 @@ uint16_t kmeans_get_buffer_size(const kmeans_model_t* model) {
 
 bool kmeans_get_centroid(const kmeans_model_t* model, uint8_t cluster_id, fixed_t* centroid) {
     if (!model->initialized || cluster_id >= model->k) return false;
-    memcpy(centroid, model->clusters[cluster_id].centroid, model->feature_dim * sizeof(fixed_t));
+    const fixed_t* src = centroid_of(model, cluster_id);
+    for (uint8_t d = 0; d < model->feature_dim; d++) centroid[d] = src[d * model->max_clusters];
+    return true;
+}
+
+bool kmeans_set_centroid(kmeans_model_t* model, uint8_t cluster_id, const fixed_t* centroid) {
+    if (!model->initialized || cluster_id >= model->max_clusters) return false;
+    fixed_t* dst = centroid_of(model, cluster_id);
+    for (uint8_t d = 0; d < model->feature_dim; d++) dst[d * model->max_clusters] = centroid[d];
     return true;
 }
 
 bool kmeans_get_label(const kmeans_model_t* model, uint8_t cluster_id, char* label) {
     if (!model->initialized || cluster_id >= model->k) return false;
-    strncpy(label, model->clusters[cluster_id].label, MAX_LABEL_LENGTH);
+    strncpy(label, model->labels[cluster_id], MAX_LABEL_LENGTH);
     return true;
 }
 
@@ -420,8 +623,14 @@ fixed_t kmeans_inertia(const kmeans_model_t* model) {
 void kmeans_reset(kmeans_model_t* model) {
     if (!model->initialized) return;
     uint8_t feature_dim = model->feature_dim;
+    uint8_t max_clusters = model->max_clusters;
+    uint16_t capacity = model->buffer.capacity;
     fixed_t lr = model->learning_rate;
-    kmeans_init(model, feature_dim, FIXED_TO_FLOAT(lr));
+    alpha_schedule_t schedule = model->alpha_schedule;
+    void* storage = model->clusters;  // Storage starts with the cluster table
+    kmeans_init_with_storage(model, feature_dim, FIXED_TO_FLOAT(lr), max_clusters, capacity,
+                             storage, KMEANS_STORAGE_SIZE(max_clusters, feature_dim, capacity));
+    model->alpha_schedule = schedule;
 }
 
 bool kmeans_correct(kmeans_model_t* model, const fixed_t* point, uint8_t old_cluster, uint8_t new_cluster) {
@@ -430,18 +639,21 @@ bool kmeans_correct(kmeans_model_t* model, const fixed_t* point, uint8_t old_clu
     if (old_cluster == new_cluster) return true;
 
     cluster_t* old = &model->clusters[old_cluster];
+    fixed_t* old_centroid = centroid_of(model, old_cluster);
+    uint8_t stride = model->max_clusters;
     fixed_t repel_rate = FLOAT_TO_FIXED(0.1f);
     for (uint8_t i = 0; i < model->feature_dim; i++) {
-        fixed_t diff = point[i] - old->centroid[i];
-        old->centroid[i] -= FIXED_MUL(repel_rate, diff);
+        fixed_t diff = point[i] - old_centroid[i * stride];
+        old_centroid[i * stride] -= FIXED_MUL(repel_rate, diff);
     }
     if (old->count > 0) old->count--;
 
     cluster_t* new = &model->clusters[new_cluster];
+    fixed_t* new_centroid = centroid_of(model, new_cluster);
     fixed_t attract_rate = FLOAT_TO_FIXED(0.2f);
     for (uint8_t i = 0; i < model->feature_dim; i++) {
-        fixed_t diff = point[i] - new->centroid[i];
-        new->centroid[i] += FIXED_MUL(attract_rate, diff);
+        fixed_t diff = point[i] - new_centroid[i * stride];
+        new_centroid[i * stride] += FIXED_MUL(attract_rate, diff);
     }
     new->count++;
     
@@ -450,7 +662,115 @@ bool kmeans_correct(kmeans_model_t* model, const fixed_t* point, uint8_t old_clu
 
 void kmeans_set_threshold(kmeans_model_t* model, float multiplier) {
     if (!model->initialized) return;
-    if (multiplier < 1.0f) multiplier = 1.0f;
-    if (multiplier > 5.0f) multiplier = 5.0f;
+    if (multiplier < KMEANS_THRESHOLD_MIN) multiplier = KMEANS_THRESHOLD_MIN;
+    if (multiplier > KMEANS_THRESHOLD_MAX) multiplier = KMEANS_THRESHOLD_MAX;
     model->outlier_threshold = FLOAT_TO_FIXED(multiplier);
-}
\ No newline at end of file
+}
+
+// Runtime state (layout in streaming_kmeans.h), little-endian throughout
+#define FLAG_ALARM_ACTIVE   0x01
+#define FLAG_WAITING_LABEL  0x02
+#define FLAG_MOTOR_RUNNING  0x04
+#define FLAG_FROZEN         0x08
+
+size_t kmeans_state_size(const kmeans_model_t* model) {
+    if (!model || !model->initialized) return 0;
+    size_t n = KMEANS_STATE_HEADER_SIZE + 4;
+    for (uint8_t i = 0; i < model->k; i++) {
+        n += MODEL_CODEC_CLUSTER_HEADER + model_codec_label_length(model->labels[i]) +
+             4 * (size_t)model->feature_dim;
+    }
+    return n + (size_t)model->buffer.count * model->feature_dim * 4;
+}
+
+size_t kmeans_serialize(const kmeans_model_t* model, uint8_t* buf, size_t cap) {
+    size_t size = kmeans_state_size(model);
+    if (size == 0 || !buf || size > cap) return 0;
+    const ring_buffer_t* buffer = &model->buffer;
+
+    memset(buf, 0, KMEANS_STATE_HEADER_SIZE);
+    put_le32(buf, KMEANS_STATE_MAGIC);
+    buf[4] = KMEANS_STATE_VERSION;
+    buf[5] = model->feature_dim;
+    buf[6] = model->k;
+    buf[7] = (uint8_t)model->state;
+    buf[8] = (uint8_t)model->alpha_schedule;
+    buf[9] = (model->alarm_active ? FLAG_ALARM_ACTIVE : 0) |
+             (model->waiting_label ? FLAG_WAITING_LABEL : 0) |
+             (model->motor_running ? FLAG_MOTOR_RUNNING : 0) |
+             (buffer->frozen ? FLAG_FROZEN : 0);
+    buf[10] = model->idle_count;
+    put_le16(buf + 12, model->alarm_sample_count);
+    put_le16(buf + 14, model->normal_streak);
+    put_le16(buf + 16, buffer->count);
+    put_le32(buf + 20, model->total_points);
+    put_le32(buf + 24, (uint32_t)model->learning_rate);
+    put_le32(buf + 28, (uint32_t)model->outlier_threshold);
+    put_le32(buf + 32, (uint32_t)model->last_distance);
+    put_le32(buf + 36, (uint32_t)model->last_rms);
+    put_le32(buf + 40, (uint32_t)model->last_current);
+
+    uint8_t* p = buf + KMEANS_STATE_HEADER_SIZE;
+    for (uint8_t i = 0; i < model->k; i++) p += model_codec_put_cluster(p, model, i, true);
+
+    // Live rows only, oldest first
+    uint16_t row = (uint16_t)((buffer->head + buffer->capacity - buffer->count) % buffer->capacity);
+    for (uint16_t r = 0; r < buffer->count; r++) {
+        const fixed_t* x = buffer_row(model, row);
+        for (uint8_t d = 0; d < model->feature_dim; d++, p += 4) put_le32(p, (uint32_t)x[d]);
+        row = (uint16_t)((row + 1) % buffer->capacity);
+    }
+    put_le32(p, crc32(buf, (size_t)(p - buf)));
+    return size;
+}
+
+bool kmeans_deserialize(kmeans_model_t* model, const uint8_t* buf, size_t len) {
+    if (!model || !model->initialized || !buf || len < KMEANS_STATE_HEADER_SIZE + 4) return false;
+    if (get_le32(buf) != KMEANS_STATE_MAGIC || buf[4] != KMEANS_STATE_VERSION) return false;
+    uint8_t dim = buf[5], k = buf[6];
+    uint16_t rows = get_le16(buf + 16);
+    if (dim != model->feature_dim || k > model->max_clusters || rows > model->buffer.capacity) return false;
+    if (buf[7] > STATE_WAITING_LABEL || buf[8] > ALPHA_SCHEDULE_CONSTANT) return false;
+
+    // Walk the variable-length clusters before touching the model
+    size_t off = KMEANS_STATE_HEADER_SIZE;
+    for (uint8_t i = 0; i < k; i++) {
+        size_t n = model_codec_cluster_size(buf + off, len - off, dim);
+        if (n == 0) return false;
+        off += n;
+    }
+    size_t end = off + (size_t)rows * dim * 4;
+    if (end + 4 != len || get_le32(buf + end) != crc32(buf, end)) return false;
+
+    kmeans_reset(model);
+    model->k = k;
+    model->state = (system_state_t)buf[7];
+    model->alpha_schedule = (alpha_schedule_t)buf[8];
+    model->alarm_active = (buf[9] & FLAG_ALARM_ACTIVE) != 0;
+    model->waiting_label = (buf[9] & FLAG_WAITING_LABEL) != 0;
+    model->motor_running = (buf[9] & FLAG_MOTOR_RUNNING) != 0;
+    model->idle_count = buf[10];
+    model->alarm_sample_count = get_le16(buf + 12);
+    model->normal_streak = get_le16(buf + 14);
+    model->total_points = get_le32(buf + 20);
+    model->learning_rate = (fixed_t)get_le32(buf + 24);
+    model->outlier_threshold = (fixed_t)get_le32(buf + 28);
+    model->last_distance = (fixed_t)get_le32(buf + 32);
+    model->last_rms = (fixed_t)get_le32(buf + 36);
+    model->last_current = (fixed_t)get_le32(buf + 40);
+
+    const uint8_t* p = buf + KMEANS_STATE_HEADER_SIZE;
+    for (uint8_t i = 0; i < k; i++) {
+        model_codec_get_cluster(p, model, i, true);
+        p += MODEL_CODEC_CLUSTER_HEADER + p[9] + 4 * (size_t)dim;
+    }
+
+    // Rows back in order from slot 0; the sums are rebuilt exactly
+    for (uint16_t r = 0; r < rows; r++) {
+        fixed_t x[MAX_FEATURES];
+        for (uint8_t d = 0; d < dim; d++, p += 4) x[d] = (fixed_t)get_le32(p);
+        buffer_add_sample(model, x);
+    }
+    model->buffer.frozen = (buf[9] & FLAG_FROZEN) != 0;
+    return true;
+}
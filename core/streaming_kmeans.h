@@ -15,6 +15,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #define MAX_CLUSTERS 16
 #define MAX_FEATURES 64
@@ -41,6 +42,18 @@ typedef enum {
     STATE_WAITING_LABEL
 } system_state_t;
 
+/**
+ * Learning-rate schedules (integer only, no float on the sample path):
+ * - DECAY:    alpha = lr / (1 + 0.01 * count)   (default)
+ * - POW2:     alpha = lr >> floor(log2(1 + count / 100)), shift only
+ * - CONSTANT: alpha = lr, plain EMA that keeps tracking drift
+ */
+typedef enum {
+    ALPHA_SCHEDULE_DECAY,
+    ALPHA_SCHEDULE_POW2,
+    ALPHA_SCHEDULE_CONSTANT
+} alpha_schedule_t;
+
 // Add bootstrap threshold
 #define BOOTSTRAP_SAMPLES 50  // Samples before creating first cluster
 
@@ -51,26 +64,56 @@ typedef enum {
 #define IDLE_CONSECUTIVE_SAMPLES 30                   // 1 second @ 10Hz
 #define ALARM_CLEAR_SAMPLES 30                        // 3 seconds of normal = auto-clear
 
+// kmeans_set_threshold() clamps its multiplier to this range
+#define KMEANS_THRESHOLD_MIN 1.0f
+#define KMEANS_THRESHOLD_MAX 5.0f
+
+/**
+ * Ring buffer rows live in bound storage (see kmeans_init_with_storage),
+ * packed at the model's real feature_dim. Per-dimension sums over the
+ * rows currently held are kept as samples arrive and are evicted.
+ */
 typedef struct {
-    fixed_t samples[RING_BUFFER_SIZE][MAX_FEATURES];
+    fixed_t* samples;    // capacity x feature_dim, row-major
+    int64_t* sum;        // feature_dim: sum of x (Q16.16)
+    int64_t* sum_sq;     // feature_dim: sum of (x*x >> 16) (Q16.16)
+    uint16_t capacity;
     uint16_t head;
     uint16_t count;
     bool frozen;
 } ring_buffer_t;
 
+// Hot per-cluster stats read on every sample; labels are kept apart (cold)
 typedef struct {
-    fixed_t centroid[MAX_FEATURES];
     uint32_t count;
     fixed_t inertia;
-    char label[MAX_LABEL_LENGTH];
     bool active;
 } cluster_t;
 
+/**
+ * Bytes of storage for a model with up to `k` clusters of dimension `d`
+ * and a `cap`-sample ring buffer. Always a multiple of 8, so static
+ * storage can be declared as: static uint64_t s[KMEANS_STORAGE_SIZE(k, d, cap) / 8];
+ */
+#define KMEANS_ALIGN8(n) (((size_t)(n) + 7u) & ~(size_t)7u)
+#define KMEANS_STORAGE_SIZE(k, d, cap) \
+    (KMEANS_ALIGN8((size_t)(k) * sizeof(cluster_t)) + \
+     KMEANS_ALIGN8((size_t)(k) * (d) * sizeof(fixed_t)) + \
+     KMEANS_ALIGN8((size_t)(cap) * (d) * sizeof(fixed_t)) + \
+     (size_t)2 * (d) * sizeof(int64_t) + \
+     KMEANS_ALIGN8((size_t)(k) * MAX_LABEL_LENGTH))
+
 typedef struct {
-    cluster_t clusters[MAX_CLUSTERS];
+    // Bound storage (sized to max_clusters and feature_dim)
+    cluster_t* clusters;         // max_clusters entries
+    fixed_t* centroids;          // feature_dim x max_clusters, dimension-major (SoA)
+    char (*labels)[MAX_LABEL_LENGTH];  // max_clusters entries, only touched on label events
+    uint8_t max_clusters;
+
     uint8_t k;
     uint8_t feature_dim;
     fixed_t learning_rate;
+    alpha_schedule_t alpha_schedule;
     uint32_t total_points;
     bool initialized;
     
@@ -91,16 +134,47 @@ typedef struct {
     fixed_t last_rms;
     fixed_t last_current;
     bool motor_running;
+
+    // Worst-case storage bound by kmeans_init(). Models bound with
+    // kmeans_init_with_storage() never touch it, so their object may stop
+    // at KMEANS_MODEL_HEADER_SIZE (fleet slots do).
+    uint64_t embedded[KMEANS_STORAGE_SIZE(MAX_CLUSTERS, MAX_FEATURES, RING_BUFFER_SIZE) / 8];
 } kmeans_model_t;
 
+// Bytes of kmeans_model_t in front of the embedded block
+#define KMEANS_MODEL_HEADER_SIZE KMEANS_ALIGN8(offsetof(kmeans_model_t, embedded))
+
+// Model object without the embedded block, for kmeans_init_with_storage()
+typedef struct {
+    uint64_t words[KMEANS_MODEL_HEADER_SIZE / 8];
+} kmeans_model_header_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // Core API
+// kmeans_init() binds the model's own MAX_CLUSTERS x MAX_FEATURES embedded block
 bool kmeans_init(kmeans_model_t* model, uint8_t feature_dim, float learning_rate);
+// Bind caller-owned storage (8-byte aligned, >= KMEANS_STORAGE_SIZE bytes).
+// Only the first KMEANS_MODEL_HEADER_SIZE bytes of *model are used.
+bool kmeans_init_with_storage(kmeans_model_t* model, uint8_t feature_dim, float learning_rate,
+                              uint8_t max_clusters, uint16_t buffer_capacity,
+                              void* storage, size_t storage_size);
+// The model living in a header object. Out of line, so the compiler never
+// checks model accesses against the header's smaller declared size.
+kmeans_model_t* kmeans_model_of(kmeans_model_header_t* header);
 int8_t kmeans_update(kmeans_model_t* model, const fixed_t* point);
 uint8_t kmeans_predict(const kmeans_model_t* model, const fixed_t* point);
+// Batch update: n points, row-major n x feature_dim. out[i] (optional) gets
+// exactly what kmeans_update() would return. Stops once the model freezes
+// (remaining out = -1); returns the number of samples consumed.
+size_t kmeans_update_batch(kmeans_model_t* model, const fixed_t* points, size_t n, int8_t* out);
+// kmeans_update() with the nearest-cluster scan already done by the caller
+// (specialized front-ends, see kmeans_static.h). Falls back to kmeans_update()
+// outside NORMAL/ALARM.
+int8_t kmeans_update_located(kmeans_model_t* model, const fixed_t* point,
+                             uint8_t nearest, fixed_t distance);
 
 // Alarm handling
 bool kmeans_add_cluster(kmeans_model_t* model, const char* label);
@@ -121,15 +195,58 @@ void kmeans_update_motor_status(kmeans_model_t* model, fixed_t rms, fixed_t curr
 
 // Utilities
 bool kmeans_get_centroid(const kmeans_model_t* model, uint8_t cluster_id, fixed_t* centroid);
+bool kmeans_set_centroid(kmeans_model_t* model, uint8_t cluster_id, const fixed_t* centroid);
 bool kmeans_get_label(const kmeans_model_t* model, uint8_t cluster_id, char* label);
 fixed_t kmeans_inertia(const kmeans_model_t* model);
 void kmeans_reset(kmeans_model_t* model);
 bool kmeans_correct(kmeans_model_t* model, const fixed_t* point, uint8_t old_cluster, uint8_t new_cluster);
+
+// Learning rate
+bool kmeans_set_alpha_schedule(kmeans_model_t* model, alpha_schedule_t schedule);
+fixed_t kmeans_alpha(const kmeans_model_t* model, uint32_t count);  // EMA weight for a cluster with `count` points
 void kmeans_set_threshold(kmeans_model_t* model, float multiplier);
 
 // Legacy compatibility
 bool kmeans_is_outlier(const kmeans_model_t* model, const fixed_t* point);
 
+/**
+ * Runtime state: everything kmeans_update() depends on, for warm restarts
+ * and moving a live model between device and gateway. Little-endian:
+ *
+ *   off  size  field
+ *   0    4     magic "TOLR"
+ *   4    1     version (KMEANS_STATE_VERSION)
+ *   5    1     feature_dim
+ *   6    1     k
+ *   7    1     state
+ *   8    1     alpha_schedule
+ *   9    1     flags: alarm_active 1, waiting_label 2, motor_running 4, frozen 8
+ *   10   1     idle_count
+ *   12   2     alarm_sample_count
+ *   14   2     normal_streak
+ *   16   2     rows: live ring-buffer rows
+ *   20   4     total_points
+ *   24   4x5   learning_rate, outlier_threshold, last_distance, last_rms, last_current
+ *   44   ...   k cluster records (model_codec.h): count u32, inertia i32,
+ *              active u8, label length u8, label, centroid i32[feature_dim]
+ *        ...   rows x feature_dim i32, oldest first
+ *        4     CRC-32 of everything before it
+ */
+#define KMEANS_STATE_MAGIC 0x524C4F54    // "TOLR"
+#define KMEANS_STATE_VERSION 1
+#define KMEANS_STATE_HEADER_SIZE 44
+#define KMEANS_STATE_MAX_SIZE(k, d, cap) \
+    (KMEANS_STATE_HEADER_SIZE + 4 + \
+     (size_t)(k) * (10 + MAX_LABEL_LENGTH - 1 + 4 * (size_t)(d)) + \
+     (size_t)(cap) * 4 * (d))
+
+size_t kmeans_state_size(const kmeans_model_t* model);
+// Bytes written, 0 if the model is not initialized or cap is too small
+size_t kmeans_serialize(const kmeans_model_t* model, uint8_t* buf, size_t cap);
+// Into an initialized model with the same feature_dim and room for k
+// clusters and the rows. The model is untouched on failure.
+bool kmeans_deserialize(kmeans_model_t* model, const uint8_t* buf, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
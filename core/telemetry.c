@@ -0,0 +1,346 @@
+/**
+ * @file telemetry.c
+ * @brief Binary telemetry encoder/decoder (format in telemetry.h)
+ */
+
+#include "telemetry.h"
+#include "crc.h"
+#include <string.h>
+#include <math.h>
+
+#define FIXED_NAN INT32_MIN
+
+static const char* const STATE_NAMES[] = {"BOOTSTRAP", "NORMAL", "ALARM", "WAITING_LABEL"};
+#define N_STATES 4
+#define STATE_UNKNOWN 0xFF
+
+enum {
+    FLAG_ALARM = 1 << 0,
+    FLAG_WAITING = 1 << 1,
+    FLAG_MOTOR = 1 << 2,
+    FLAG_CURRENT = 1 << 3,
+};
+
+uint16_t telemetry_crc16(const uint8_t* data, size_t len) {
+    return crc16_ccitt(data, len);
+}
+
+static float pow10_scale(uint8_t decimals) {
+    float s = 1;
+    for (uint8_t i = 0; i < decimals; i++) s *= 10;
+    return s;
+}
+
+static int32_t to_fixed(float v, float scale) {
+    if (isnan(v)) return FIXED_NAN;
+    float x = v * scale;
+    if (x >= 2147483647.0f) return INT32_MAX;
+    if (x <= -2147483647.0f) return -INT32_MAX;  // INT32_MIN is NaN
+    return (int32_t)lroundf(x);
+}
+
+static float from_fixed(int32_t v, float scale) {
+    return v == FIXED_NAN ? NAN : v / scale;
+}
+
+// =============================================================================
+// VARINT WRITER
+// =============================================================================
+
+typedef struct {
+    uint8_t* buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+} byte_writer_t;
+
+static void put_u8(byte_writer_t* w, uint8_t v) {
+    if (w->len >= w->cap) { w->overflow = true; return; }
+    w->buf[w->len++] = v;
+}
+
+static void put_uvarint(byte_writer_t* w, uint32_t v) {
+    while (v >= 0x80) {
+        put_u8(w, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    put_u8(w, (uint8_t)v);
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static void put_svarint(byte_writer_t* w, int32_t v) {
+    put_uvarint(w, zigzag(v));
+}
+
+static void put_u16_at(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put_header(byte_writer_t* w, uint8_t type, uint16_t seq) {
+    put_u8(w, TELEMETRY_MAGIC);
+    put_u8(w, TELEMETRY_VERSION);
+    put_u8(w, type);
+    put_u8(w, TELEMETRY_DECIMALS);
+    put_u8(w, (uint8_t)seq);
+    put_u8(w, (uint8_t)(seq >> 8));
+    put_u8(w, 0);  // Body length, patched by seal()
+    put_u8(w, 0);
+}
+
+// Patches the body length and appends the CRC
+static size_t seal(byte_writer_t* w) {
+    size_t body = w->len - TELEMETRY_HEADER_SIZE;
+    if (w->overflow || body > 0xFFFF || w->len + 2 > w->cap) return 0;
+    put_u16_at(w->buf + 6, (uint16_t)body);
+    put_u16_at(w->buf + w->len, telemetry_crc16(w->buf, w->len));
+    w->len += 2;
+    return w->len;
+}
+
+// =============================================================================
+// ENCODER
+// =============================================================================
+
+size_t telemetry_encode_summary(const mqtt_summary_t* s, uint16_t seq,
+                                uint8_t* buf, size_t cap) {
+    if (!buf) return 0;
+    byte_writer_t w = {buf, cap, 0, false};
+    const float scale = pow10_scale(TELEMETRY_DECIMALS);
+
+    uint8_t state = STATE_UNKNOWN;
+    for (uint8_t i = 0; i < N_STATES; i++) {
+        if (s->state && strcmp(s->state, STATE_NAMES[i]) == 0) state = i;
+    }
+    uint8_t flags = (s->alarm_active ? FLAG_ALARM : 0) | (s->waiting_label ? FLAG_WAITING : 0) |
+                    (s->motor_running ? FLAG_MOTOR : 0) | (s->has_current ? FLAG_CURRENT : 0);
+
+    put_header(&w, TELEMETRY_SUMMARY, seq);
+    put_u8(&w, state);
+    put_u8(&w, flags);
+    put_svarint(&w, s->cluster);
+    put_uvarint(&w, s->k);
+    put_uvarint(&w, s->total_points);
+    put_uvarint(&w, s->buffer_samples);
+    put_uvarint(&w, s->sample_count);
+    put_uvarint(&w, s->timestamp);
+
+    size_t label_len = s->label ? strlen(s->label) : 0;
+    if (label_len > MQTT_LABEL_MAX - 1) label_len = MQTT_LABEL_MAX - 1;
+    put_u8(&w, (uint8_t)label_len);
+    for (size_t i = 0; i < label_len; i++) put_u8(&w, (uint8_t)s->label[i]);
+
+    put_svarint(&w, to_fixed(s->vib_rms_avg, scale));
+    put_svarint(&w, to_fixed(s->vib_rms_max, scale));
+    put_svarint(&w, to_fixed(s->vib_peak_max, scale));
+    put_svarint(&w, to_fixed(s->vib_crest_avg, scale));
+    if (s->has_current) {
+        put_svarint(&w, to_fixed(s->current_rms_avg, scale));
+        put_svarint(&w, to_fixed(s->current_rms_max, scale));
+    }
+    put_svarint(&w, to_fixed(s->baseline, scale));
+    return seal(&w);
+}
+
+bool telemetry_batch_begin(telemetry_batch_t* b, uint8_t* buf, size_t cap,
+                           uint8_t dim, uint16_t seq) {
+    if (!b || !buf || dim == 0 || dim > TELEMETRY_MAX_DIM) return false;
+    if (cap < TELEMETRY_OVERHEAD + 3) return false;
+    byte_writer_t w = {buf, cap, 0, false};
+    put_header(&w, TELEMETRY_FEATURES, seq);
+    put_u8(&w, dim);
+    put_u8(&w, 0);  // Count, patched by finish()
+    put_u8(&w, 0);
+
+    b->buf = buf;
+    b->cap = cap;
+    b->len = w.len;
+    b->dim = dim;
+    b->count = 0;
+    b->last_time = 0;
+    memset(b->last, 0, sizeof(b->last));
+    return true;
+}
+
+bool telemetry_batch_add(telemetry_batch_t* b, uint32_t timestamp, int32_t cluster,
+                         float distance, const float* features) {
+    if (b->count == 0xFFFF) return false;
+    const float scale = pow10_scale(TELEMETRY_DECIMALS);
+
+    // Encode in place, commit only if it fits with room for the CRC
+    byte_writer_t w = {b->buf, b->cap - 2, b->len, false};
+    put_uvarint(&w, timestamp - b->last_time);  // Wraps with millis()
+    put_svarint(&w, cluster);
+    put_svarint(&w, to_fixed(distance, scale));
+    int32_t fixed[TELEMETRY_MAX_DIM];
+    for (uint8_t i = 0; i < b->dim; i++) {
+        fixed[i] = to_fixed(features[i], scale);
+        put_svarint(&w, (int32_t)((uint32_t)fixed[i] - (uint32_t)b->last[i]));
+    }
+    if (w.overflow || w.len - TELEMETRY_HEADER_SIZE > 0xFFFF) return false;
+
+    b->len = w.len;
+    b->count++;
+    b->last_time = timestamp;
+    memcpy(b->last, fixed, b->dim * sizeof(int32_t));
+    return true;
+}
+
+size_t telemetry_batch_finish(telemetry_batch_t* b) {
+    if (b->count == 0) return 0;
+    put_u16_at(b->buf + TELEMETRY_HEADER_SIZE + 1, b->count);
+    byte_writer_t w = {b->buf, b->cap, b->len, false};
+    return seal(&w);
+}
+
+// =============================================================================
+// DECODER
+// =============================================================================
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+} byte_reader_t;
+
+static bool get_u8(byte_reader_t* r, uint8_t* v) {
+    if (r->p >= r->end) return false;
+    *v = *r->p++;
+    return true;
+}
+
+static bool get_uvarint(byte_reader_t* r, uint32_t* v) {
+    uint32_t x = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t b;
+        if (!get_u8(r, &b)) return false;
+        if (shift == 28 && b > 0x0F) return false;  // More than 32 bits
+        x |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = x;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool get_svarint(byte_reader_t* r, int32_t* v) {
+    uint32_t u;
+    if (!get_uvarint(r, &u)) return false;
+    *v = unzigzag(u);
+    return true;
+}
+
+bool telemetry_check(const uint8_t* data, size_t len, telemetry_header_t* h, size_t* frame_len) {
+    if (!data || len < TELEMETRY_OVERHEAD) return false;
+    if (data[0] != TELEMETRY_MAGIC || data[1] != TELEMETRY_VERSION) return false;
+    uint16_t body = get_u16(data + 6);
+    size_t total = (size_t)TELEMETRY_OVERHEAD + body;
+    if (len < total) return false;
+    if (telemetry_crc16(data, total - 2) != get_u16(data + total - 2)) return false;
+
+    if (h) {
+        h->version = data[1];
+        h->type = data[2];
+        h->decimals = data[3];
+        h->seq = get_u16(data + 4);
+        h->body_len = body;
+    }
+    if (frame_len) *frame_len = total;
+    return true;
+}
+
+bool telemetry_decode_summary(const uint8_t* frame, size_t len,
+                              mqtt_summary_t* out, char* label_buf) {
+    telemetry_header_t h;
+    if (!telemetry_check(frame, len, &h, NULL) || h.type != TELEMETRY_SUMMARY) return false;
+    if (h.decimals > 9) return false;
+    const float scale = pow10_scale(h.decimals);
+    byte_reader_t r = {frame + TELEMETRY_HEADER_SIZE, frame + TELEMETRY_HEADER_SIZE + h.body_len};
+
+    mqtt_summary_t s;
+    memset(&s, 0, sizeof(s));
+    uint8_t state, flags, label_len;
+    int32_t f[7];
+    if (!get_u8(&r, &state) || !get_u8(&r, &flags)) return false;
+    if (!get_svarint(&r, &s.cluster) || !get_uvarint(&r, &s.k) ||
+        !get_uvarint(&r, &s.total_points) || !get_uvarint(&r, &s.buffer_samples) ||
+        !get_uvarint(&r, &s.sample_count) || !get_uvarint(&r, &s.timestamp)) return false;
+    if (!get_u8(&r, &label_len) || label_len >= MQTT_LABEL_MAX) return false;
+    if (r.end - r.p < label_len) return false;
+    memcpy(label_buf, r.p, label_len);
+    label_buf[label_len] = '\0';
+    r.p += label_len;
+
+    s.has_current = (flags & FLAG_CURRENT) != 0;
+    int n = s.has_current ? 7 : 5;
+    for (int i = 0; i < n; i++) {
+        if (!get_svarint(&r, &f[i])) return false;
+    }
+    if (r.p != r.end) return false;
+
+    s.state = state < N_STATES ? STATE_NAMES[state] : "UNKNOWN";
+    s.alarm_active = (flags & FLAG_ALARM) != 0;
+    s.waiting_label = (flags & FLAG_WAITING) != 0;
+    s.motor_running = (flags & FLAG_MOTOR) != 0;
+    s.label = label_buf;
+    s.vib_rms_avg = from_fixed(f[0], scale);
+    s.vib_rms_max = from_fixed(f[1], scale);
+    s.vib_peak_max = from_fixed(f[2], scale);
+    s.vib_crest_avg = from_fixed(f[3], scale);
+    if (s.has_current) {
+        s.current_rms_avg = from_fixed(f[4], scale);
+        s.current_rms_max = from_fixed(f[5], scale);
+    }
+    s.baseline = from_fixed(f[n - 1], scale);
+    *out = s;
+    return true;
+}
+
+bool telemetry_features_begin(telemetry_reader_t* r, const uint8_t* frame, size_t len) {
+    telemetry_header_t h;
+    if (!telemetry_check(frame, len, &h, NULL) || h.type != TELEMETRY_FEATURES) return false;
+    if (h.decimals > 9 || h.body_len < 3) return false;
+    const uint8_t* body = frame + TELEMETRY_HEADER_SIZE;
+    if (body[0] == 0 || body[0] > TELEMETRY_MAX_DIM) return false;
+
+    r->p = body + 3;
+    r->end = body + h.body_len;
+    r->dim = body[0];
+    r->count = get_u16(body + 1);
+    r->index = 0;
+    r->scale = pow10_scale(h.decimals);
+    r->time = 0;
+    memset(r->last, 0, sizeof(r->last));
+    return true;
+}
+
+bool telemetry_features_next(telemetry_reader_t* r, telemetry_vector_t* v) {
+    if (r->index >= r->count) return false;
+    byte_reader_t br = {r->p, r->end};
+    uint32_t dt;
+    int32_t dist;
+    if (!get_uvarint(&br, &dt) || !get_svarint(&br, &v->cluster) || !get_svarint(&br, &dist)) return false;
+    for (uint8_t i = 0; i < r->dim; i++) {
+        int32_t delta;
+        if (!get_svarint(&br, &delta)) return false;
+        r->last[i] = (int32_t)((uint32_t)r->last[i] + (uint32_t)delta);
+        v->features[i] = from_fixed(r->last[i], r->scale);
+    }
+    r->time += dt;
+    v->timestamp = r->time;
+    v->distance = from_fixed(dist, r->scale);
+    r->p = br.p;
+    r->index++;
+    return true;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file telemetry.h
+ * @brief Compact binary telemetry frames (summary, feature-vector batches)
+ *
+ * Optional alternative to the JSON data topic (docs/MQTT_SCHEMA.md, "Binary
+ * Telemetry"). Every frame is self-delimiting:
+ *
+ *   off  size  field
+ *   0    1     magic 0xB7
+ *   1    1     version (TELEMETRY_VERSION)
+ *   2    1     type (TELEMETRY_SUMMARY / TELEMETRY_FEATURES)
+ *   3    1     decimals: floats travel as round(x * 10^decimals)
+ *   4    2     seq, little-endian (frame counter, gaps = lost frames)
+ *   6    2     body length, little-endian
+ *   8    n     body: LEB128 varints, signed values zigzag-encoded
+ *   8+n  2     CRC-16/CCITT-FALSE of bytes [0, 8+n), little-endian
+ *
+ * Summary body: state u8, flags u8, cluster, k, total_points,
+ * buffer_samples, sample_count, timestamp, label (u8 length + bytes), then
+ * the fixed-point floats in mqtt_summary_t order (current pair only when
+ * flagged). Device id is not sent: it is in the topic.
+ *
+ * Features body: dim u8, count u16 LE, then per vector: timestamp (first:
+ * absolute ms, then delta), cluster, distance, and dim feature deltas
+ * against the previous vector (slowly varying features cost ~1-2 bytes).
+ *
+ * Fixed-point values saturate to int32; NaN travels as INT32_MIN and
+ * decodes back to NaN.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "mqtt_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRY_MAGIC 0xB7
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_HEADER_SIZE 8
+#define TELEMETRY_OVERHEAD (TELEMETRY_HEADER_SIZE + 2)
+#define TELEMETRY_MAX_DIM 32
+#ifndef TELEMETRY_DECIMALS
+  #define TELEMETRY_DECIMALS 3   // 0.001 m/s^2, 1 mA
+#endif
+
+typedef enum {
+    TELEMETRY_SUMMARY = 1,
+    TELEMETRY_FEATURES = 2,
+} telemetry_type_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t type;
+    uint8_t decimals;
+    uint16_t seq;
+    uint16_t body_len;
+} telemetry_header_t;
+
+typedef struct {
+    uint32_t timestamp;  // ms
+    int32_t cluster;     // -1 = outlier / not clustered
+    float distance;      // To the assigned centroid
+    float features[TELEMETRY_MAX_DIM];
+} telemetry_vector_t;
+
+uint16_t telemetry_crc16(const uint8_t* data, size_t len);
+
+// =============================================================================
+// ENCODER
+// =============================================================================
+
+// Summary frame; 0 if it does not fit in cap
+size_t telemetry_encode_summary(const mqtt_summary_t* s, uint16_t seq,
+                                uint8_t* buf, size_t cap);
+
+// Worst-case feature batch frame: every varint at its 5-byte maximum
+#define TELEMETRY_BATCH_SIZE(dim, n) \
+    (TELEMETRY_OVERHEAD + 3 + (size_t)(n) * 5 * (3 + (size_t)(dim)))
+
+// Feature batch, built one vector at a time
+typedef struct {
+    uint8_t* buf;
+    size_t cap;
+    size_t len;
+    uint8_t dim;
+    uint16_t count;
+    uint32_t last_time;
+    int32_t last[TELEMETRY_MAX_DIM];
+} telemetry_batch_t;
+
+bool telemetry_batch_begin(telemetry_batch_t* b, uint8_t* buf, size_t cap,
+                           uint8_t dim, uint16_t seq);
+// False (batch unchanged) when the vector no longer fits or count is at 65535
+bool telemetry_batch_add(telemetry_batch_t* b, uint32_t timestamp, int32_t cluster,
+                         float distance, const float* features);
+// Seals the frame (count, length, CRC); returns its size, 0 if empty
+size_t telemetry_batch_finish(telemetry_batch_t* b);
+
+// =============================================================================
+// DECODER (host tools; the linker drops it from firmware)
+// =============================================================================
+
+// Validates magic, version, length and CRC. *frame_len = full frame size,
+// so back-to-back frames in a stream can be walked.
+bool telemetry_check(const uint8_t* data, size_t len, telemetry_header_t* h, size_t* frame_len);
+
+// label_buf (MQTT_LABEL_MAX bytes) backs out->label; out->device_id is NULL
+bool telemetry_decode_summary(const uint8_t* frame, size_t len,
+                              mqtt_summary_t* out, char* label_buf);
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    uint8_t dim;
+    uint16_t count;
+    uint16_t index;
+    float scale;
+    uint32_t time;
+    int32_t last[TELEMETRY_MAX_DIM];
+} telemetry_reader_t;
+
+bool telemetry_features_begin(telemetry_reader_t* r, const uint8_t* frame, size_t len);
+// False at the end of the batch or on a corrupt vector
+bool telemetry_features_next(telemetry_reader_t* r, telemetry_vector_t* v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
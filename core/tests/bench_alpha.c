@@ -0,0 +1,89 @@
+/**
+ * @file bench_alpha.c
+ * @brief Cost of one learning-rate computation: float path vs integer schedules
+ *
+ * Host numbers understate the float cost: x86 has a fast FPU divider,
+ * while RP2040 (no FPU) pays a soft-float divide per sample.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../streaming_kmeans.h"
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS() __rdtsc()
+#define TICK_UNIT "cycles"
+#else
+static unsigned long long ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#define TICKS() ns_now()
+#define TICK_UNIT "ns"
+#endif
+
+#define N 1000000
+#define D 3
+
+static uint64_t storage[KMEANS_STORAGE_SIZE(4, D, RING_BUFFER_SIZE) / 8];
+
+// Pre-change implementation
+static fixed_t float_alpha(fixed_t lr, uint32_t count) {
+    float decay = 1.0f + 0.01f * count;
+    float alpha_f = FIXED_TO_FLOAT(lr) / decay;
+    return FLOAT_TO_FIXED(alpha_f);
+}
+
+static volatile fixed_t sink;
+
+static double per_call_float(fixed_t lr, uint32_t base, uint32_t span) {
+    double best = 1e18;
+    for (int rep = 0; rep < 5; rep++) {
+        fixed_t acc = 0;
+        unsigned long long t0 = TICKS();
+        for (uint32_t i = 0; i < N; i++) acc += float_alpha(lr, base + i % span);
+        unsigned long long t = TICKS() - t0;
+        sink = acc;
+        if (t < best) best = (double)t;
+    }
+    return best / N;
+}
+
+static double per_call(const kmeans_model_t* model, uint32_t base, uint32_t span) {
+    double best = 1e18;
+    for (int rep = 0; rep < 5; rep++) {
+        fixed_t acc = 0;
+        unsigned long long t0 = TICKS();
+        for (uint32_t i = 0; i < N; i++) acc += kmeans_alpha(model, base + i % span);
+        unsigned long long t = TICKS() - t0;
+        sink = acc;
+        if (t < best) best = (double)t;
+    }
+    return best / N;
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf(" Learning-Rate Schedule Benchmark\n");
+    printf("========================================\n");
+
+    kmeans_model_t model;
+    kmeans_init_with_storage(&model, D, 0.2f, 4, RING_BUFFER_SIZE, storage, sizeof(storage));
+
+    printf("%s per alpha (incl. loop overhead), lr=0.2\n\n", TICK_UNIT);
+    printf("  schedule          count<256   count>=256\n");
+    printf("  float (before)    %9.2f   %10.2f\n",
+           per_call_float(model.learning_rate, 0, 256), per_call_float(model.learning_rate, 256, 100000));
+
+    kmeans_set_alpha_schedule(&model, ALPHA_SCHEDULE_DECAY);
+    printf("  DECAY             %9.2f   %10.2f\n", per_call(&model, 0, 256), per_call(&model, 256, 100000));
+    kmeans_set_alpha_schedule(&model, ALPHA_SCHEDULE_POW2);
+    printf("  POW2              %9.2f   %10.2f\n", per_call(&model, 0, 256), per_call(&model, 256, 100000));
+    kmeans_set_alpha_schedule(&model, ALPHA_SCHEDULE_CONSTANT);
+    printf("  CONSTANT          %9.2f   %10.2f\n", per_call(&model, 0, 256), per_call(&model, 256, 100000));
+    return 0;
+}
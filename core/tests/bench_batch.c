@@ -0,0 +1,83 @@
+/**
+ * @file bench_batch.c
+ * @brief Sequential kmeans_update() vs kmeans_update_batch() on a replayed stream
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../streaming_kmeans.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define D 4               // CWRU feature count
+#define N 100000
+#define REPS 20
+#define CHUNK 1000        // Backfill chunk size
+
+static uint64_t storage[KMEANS_STORAGE_SIZE(MAX_CLUSTERS, D, RING_BUFFER_SIZE) / 8];
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void fresh_model(kmeans_model_t* model) {
+    kmeans_init_with_storage(model, D, 0.2f, MAX_CLUSTERS, RING_BUFFER_SIZE,
+                             storage, sizeof(storage));
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf(" Batch Update Benchmark\n");
+    printf("========================================\n");
+
+    fixed_t* points = malloc(sizeof(fixed_t) * N * D);
+    int8_t* out_seq = malloc(N);
+    int8_t* out_bat = malloc(N);
+    if (!points || !out_seq || !out_bat) { printf("ERROR: out of memory\n"); return 1; }
+
+    // Normalized-feature-like stream: baseline with periodic fault windows
+    uint32_t rng = 42;
+    for (int i = 0; i < N; i++) {
+        float base = (i % 5000 > 4900) ? 0.8f : 0.2f;
+        for (int d = 0; d < D; d++) {
+            rng = 1103515245u * rng + 12345u;
+            points[i * D + d] = FLOAT_TO_FIXED(base) + (fixed_t)((rng >> 8) % 6554) - 3277;
+        }
+    }
+
+    kmeans_model_t model;
+    double best_seq = 1e9, best_bat = 1e9;
+
+    for (int rep = 0; rep < REPS; rep++) {
+        fresh_model(&model);
+        double t0 = now_sec();
+        for (int i = 0; i < N; i++) out_seq[i] = kmeans_update(&model, &points[i * D]);
+        double t = now_sec() - t0;
+        if (t < best_seq) best_seq = t;
+
+        fresh_model(&model);
+        t0 = now_sec();
+        for (size_t done = 0; done < N; done += CHUNK) {
+            kmeans_update_batch(&model, &points[done * D], CHUNK, &out_bat[done]);
+        }
+        t = now_sec() - t0;
+        if (t < best_bat) best_bat = t;
+    }
+
+    int same = memcmp(out_seq, out_bat, N) == 0;
+
+    printf("Stream: %d samples x %dD, best of %d runs, batch chunk %d\n", N, D, REPS, CHUNK);
+    printf("  Sequential: %.2f M samples/sec (%.1f ns/sample)\n", N / best_seq / 1e6, best_seq / N * 1e9);
+    printf("  Batch:      %.2f M samples/sec (%.1f ns/sample)\n", N / best_bat / 1e6, best_bat / N * 1e9);
+    printf("  Speedup:    %.2fx\n", best_seq / best_bat);
+    printf("  Outputs identical: %s\n", same ? "yes" : "NO");
+
+    free(points);
+    free(out_seq);
+    free(out_bat);
+    return same ? 0 : 1;
+}
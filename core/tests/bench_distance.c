@@ -0,0 +1,69 @@
+/**
+ * @file bench_distance.c
+ * @brief Scalar vs SIMD nearest-centroid distances (SoA layout)
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../kmeans_distance.h"
+#include <stdio.h>
+#include <time.h>
+
+#define N 200000
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef void (*kernel_fn)(const fixed_t*, const fixed_t*, uint8_t, uint8_t, uint8_t, fixed_t*);
+
+static double run(kernel_fn fn, const fixed_t* points, const fixed_t* centroids,
+                  uint8_t k, uint8_t dim, volatile fixed_t* sink) {
+    fixed_t out[MAX_CLUSTERS];
+    double best = 1e9;
+    for (int rep = 0; rep < 5; rep++) {
+        double t0 = now_sec();
+        for (int i = 0; i < N; i++) {
+            fn(&points[(i & 1023) * MAX_FEATURES], centroids, k, dim, MAX_CLUSTERS, out);
+            *sink += out[i % k];
+        }
+        double t = now_sec() - t0;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf(" Distance Kernel Benchmark (%s)\n", kmeans_distance_kernel());
+    printf("========================================\n");
+
+    static fixed_t points[1024 * MAX_FEATURES];
+    static fixed_t centroids[MAX_FEATURES * MAX_CLUSTERS];
+    uint32_t rng = 7;
+    for (int i = 0; i < 1024 * MAX_FEATURES; i++) {
+        rng = 1103515245u * rng + 12345u;
+        points[i] = (fixed_t)((rng >> 8) % 655360);
+    }
+    for (int i = 0; i < MAX_FEATURES * MAX_CLUSTERS; i++) {
+        rng = 1103515245u * rng + 12345u;
+        centroids[i] = (fixed_t)((rng >> 8) % 655360);
+    }
+
+    volatile fixed_t sink = 0;
+    const uint8_t ks[] = {4, 8, 16};
+    const uint8_t dims[] = {3, 4, 8};
+
+    printf("  K   D   scalar ns/pt   %s ns/pt   speedup\n", kmeans_distance_kernel());
+    for (size_t a = 0; a < sizeof(ks); a++) {
+        for (size_t b = 0; b < sizeof(dims); b++) {
+            double ts = run(kmeans_distances_scalar, points, centroids, ks[a], dims[b], &sink);
+            double tv = run(kmeans_distances, points, centroids, ks[a], dims[b], &sink);
+            printf("%3d %3d   %12.2f   %*.2f   %6.2fx\n", ks[a], dims[b],
+                   ts / N * 1e9, 9, tv / N * 1e9, ts / tv);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file bench_features.cpp
+ * @brief Per-sample cost of FeatureExtractor::extract, built once per FEATURE_SCHEMA_*
+ *
+ * Drives the real firmware header through the host shim (tests/host) with a
+ * synthetic vibration signal: 1 g gravity, a 50 Hz tone, noise and sparse
+ * impulses. Host cycles track regressions; they are not MCU timings.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../feature_extractor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS() __rdtsc()
+#define TICK_UNIT "cycles"
+#else
+static unsigned long long ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#define TICKS() ns_now()
+#define TICK_UNIT "ns"
+#endif
+
+#if defined(FEATURE_SCHEMA_FFT_CURRENT)
+  #define SCHEMA_NAME "FFT_CURRENT"
+#elif defined(FEATURE_SCHEMA_FFT_ONLY)
+  #define SCHEMA_NAME "FFT_ONLY"
+#elif defined(FEATURE_SCHEMA_TIME_CURRENT)
+  #define SCHEMA_NAME "TIME_CURRENT"
+#else
+  #define SCHEMA_NAME "TIME_ONLY"
+#endif
+
+#define N 200000
+#define FS 1000.0f
+
+static float ax[N], ay[N], az[N];
+static volatile float sink;
+
+static void make_signal(void) {
+    srand(7);
+    for (int i = 0; i < N; i++) {
+        float t = i / FS;
+        float noise = 0.05f * ((float)rand() / RAND_MAX - 0.5f);
+        float impulse = (i % 97 == 0) ? 3.0f : 0.0f;
+        ax[i] = 0.1f * sinf(2 * 3.14159265f * 50 * t) + noise;
+        ay[i] = noise;
+        az[i] = 9.81f + 0.5f * sinf(2 * 3.14159265f * 50 * t) + impulse;
+    }
+}
+
+// Best of 5 passes over the whole signal, per sample
+static double per_sample_extract(void) {
+    double best = 1e18;
+    float f[FEATURE_DIM];
+    for (int rep = 0; rep < 5; rep++) {
+        FeatureExtractor::reset();
+        float acc = 0;
+        unsigned long long t0 = TICKS();
+        for (int i = 0; i < N; i++) {
+            #ifdef USE_FFT
+              FeatureExtractor::extract(ax[i], ay[i], az[i], 1.0f, 1.1f, 0.9f,
+                                        FeatureExtractor::getFFTFrame(), f);
+            #else
+              FeatureExtractor::extract(ax[i], ay[i], az[i], 1.0f, 1.1f, 0.9f, NULL, f);
+            #endif
+            acc += f[0];
+        }
+        unsigned long long t = TICKS() - t0;
+        sink = acc;
+        if (t < best) best = (double)t;
+    }
+    return best / N;
+}
+
+#ifdef USE_FFT
+// One extractFrame() per window, as the acquisition pipeline calls it
+static double per_frame(void) {
+    static float frame[FFT_SAMPLES];
+    float f[FEATURE_DIM];
+    const int frames = N / FFT_SAMPLES;
+    double best = 1e18;
+    for (int rep = 0; rep < 5; rep++) {
+        FeatureExtractor::reset();
+        float acc = 0;
+        unsigned long long t0 = TICKS();
+        for (int k = 0; k < frames; k++) {
+            const float* z = az + k * FFT_SAMPLES;
+            for (int i = 0; i < FFT_SAMPLES; i++) frame[i] = FeatureExtractor::filterSample(0, 0, z[i]);
+            FeatureExtractor::extractFrame(frame, FFT_SAMPLES, 1.0f, 1.1f, 0.9f, f);
+            acc += f[3];
+        }
+        unsigned long long t = TICKS() - t0;
+        sink = acc;
+        if (t < best) best = (double)t;
+    }
+    return best / frames;
+}
+#endif
+
+#ifdef USE_CURRENT
+// Synthetic 50 Hz three-phase ADC codes; counts conversions
+static long conversions = 0;
+static int three_phase_pin(int pin) {
+    static uint32_t pos = 0;
+    conversions++;
+    int k = (pin == ADC_CURRENT_L1) ? 0 : (pin == ADC_CURRENT_L2) ? 1 : 2;
+    float ph = 2 * 3.14159265f * ((pos++ / 3) % 20 / 20.0f + k / 3.0f);
+    return (int)(2048 + 400 * sinf(ph));
+}
+
+// Pre-change CurrentSensor::measureRawRMS(): midpoint pass + RMS pass, per pin
+static float two_pass_rms(int pin) {
+    const int SAMPLES = 1000;
+    float sum = 0;
+    for (int i = 0; i < SAMPLES; i++) sum += analogRead(pin);
+    float midpoint = sum / SAMPLES;
+    float sumSq = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        float v = analogRead(pin) - midpoint;
+        sumSq += v * v;
+    }
+    return (sqrtf(sumSq / SAMPLES) * 3.3f) / 4095;
+}
+
+static double per_read_two_pass(long* conv) {
+    double best = 1e18;
+    for (int rep = 0; rep < 5; rep++) {
+        conversions = 0;
+        unsigned long long t0 = TICKS();
+        float acc = two_pass_rms(ADC_CURRENT_L1) + two_pass_rms(ADC_CURRENT_L2) +
+                    two_pass_rms(ADC_CURRENT_L3);
+        unsigned long long t = TICKS() - t0;
+        sink = acc;
+        *conv = conversions;
+        if (t < best) best = (double)t;
+    }
+    return best;
+}
+
+static double per_read_sensor(long* conv) {
+    static CurrentSensor ct;
+    ct.calibrate();
+    double best = 1e18;
+    for (int rep = 0; rep < 5; rep++) {
+        float i1, i2, i3;
+        conversions = 0;
+        unsigned long long t0 = TICKS();
+        ct.read(&i1, &i2, &i3);
+        unsigned long long t = TICKS() - t0;
+        sink = i1 + i2 + i3;
+        *conv = conversions;
+        if (t < best) best = (double)t;
+    }
+    return best;
+}
+#endif
+
+int main() {
+    Serial.quiet = true;
+    make_signal();
+
+    printf("\n========================================\n");
+    printf("FeatureExtractor Benchmark (%s)\n", SCHEMA_NAME);
+    printf("========================================\n\n");
+    printf("Feature dim: %d, vibration window: %d samples\n", FEATURE_DIM, VIB_WINDOW_SAMPLES);
+    #ifdef USE_FFT
+      printf("FFT: %d points, %s\n", FFT_SAMPLES,
+    #ifdef FFT_FIXED_POINT
+             "Q15"
+    #else
+             "float"
+    #endif
+      );
+    #endif
+    printf("\n");
+
+    printf("extract() per sample:   %8.1f %s\n", per_sample_extract(), TICK_UNIT);
+    #ifdef USE_FFT
+      printf("extractFrame(%d):      %8.1f %s\n", FFT_SAMPLES, per_frame(), TICK_UNIT);
+    #endif
+    #ifdef USE_CURRENT
+      host_analog_source(three_phase_pin);
+      long conv_old = 0, conv_new = 0;
+      double t_old = per_read_two_pass(&conv_old);
+      double t_new = per_read_sensor(&conv_new);
+      printf("\nCurrentSensor::read() (3 phases, 1000 samples each):\n");
+      printf("  two-pass (before):    %5ld conversions  %10.0f %s\n", conv_old, t_old, TICK_UNIT);
+      printf("  single-pass blocks:   %5ld conversions  %10.0f %s\n", conv_new, t_new, TICK_UNIT);
+      printf("  On device analogRead() dominates: read time scales with conversions (%.1fx fewer)\n",
+             (double)conv_old / conv_new);
+    #endif
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file bench_fft.c
+ * @brief Cycles per FFT frame (transform + features) for 64/256/1024 points
+ *
+ * Host numbers rank the variants only. On ESP32-S3 / RP2350 the float path
+ * runs on the single-precision FPU; on RP2040 (no FPU) use Q15.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../feature_fft.h"
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS() __rdtsc()
+#define TICK_UNIT "cycles"
+#else
+static unsigned long long ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#define TICKS() ns_now()
+#define TICK_UNIT "ns"
+#endif
+
+#define REPS 5
+
+static float signal[FFT_MAX_POINTS];
+static float f_re[FFT_MAX_POINTS], f_im[FFT_MAX_POINTS];
+static int16_t q15_re[FFT_MAX_POINTS], q15_im[FFT_MAX_POINTS];
+static int32_t q31_re[FFT_MAX_POINTS], q31_im[FFT_MAX_POINTS];
+
+static volatile float sink;
+
+enum { F32, Q15, Q31, TRANSFORM_ONLY = 4 };
+
+static double per_frame(int variant, uint16_t n) {
+    int frames = 2000000 / n;
+    double best = 1e18;
+    fft_features_t f = {0, 0, 0};
+
+    // Load the scratch buffers with a real frame before timing bare transforms
+    fft_features_f32(signal, n, 1000.0f, f_re, f_im, &f);
+    fft_features_q15(signal, n, 1000.0f, q15_re, q15_im, &f);
+    fft_features_q31(signal, n, 1000.0f, q31_re, q31_im, &f);
+
+    for (int rep = 0; rep < REPS; rep++) {
+        unsigned long long t0 = TICKS();
+        for (int i = 0; i < frames; i++) {
+            switch (variant) {
+            case F32: fft_features_f32(signal, n, 1000.0f, f_re, f_im, &f); break;
+            case Q15: fft_features_q15(signal, n, 1000.0f, q15_re, q15_im, &f); break;
+            case Q31: fft_features_q31(signal, n, 1000.0f, q31_re, q31_im, &f); break;
+            case F32 | TRANSFORM_ONLY: fft_f32(f_re, f_im, n); break;
+            case Q15 | TRANSFORM_ONLY: fft_q15(q15_re, q15_im, n); break;
+            case Q31 | TRANSFORM_ONLY: fft_q31(q31_re, q31_im, n); break;
+            }
+        }
+        unsigned long long t = TICKS() - t0;
+        sink = f.peak_amp + f_re[1];
+        if (t < best) best = (double)t;
+    }
+    return best / frames;
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf(" FFT Benchmark\n");
+    printf("========================================\n");
+
+    for (int i = 0; i < FFT_MAX_POINTS; i++) {
+        signal[i] = 9.8f + 0.5f * sinf(0.37f * i) + 0.1f * sinf(2.1f * i);
+    }
+
+    static const uint16_t sizes[] = {64, 256, 1024};
+    printf("%s per frame (best of %d)\n\n", TICK_UNIT, REPS);
+    printf("  points   variant   transform   +features\n");
+    for (int s = 0; s < 3; s++) {
+        static const char* names[] = {"float", "Q15", "Q31"};
+        for (int v = F32; v <= Q31; v++) {
+            printf("  %6u   %-7s   %9.0f   %9.0f\n", sizes[s], names[v],
+                   per_frame(v | TRANSFORM_ONLY, sizes[s]), per_frame(v, sizes[s]));
+        }
+    }
+    return 0;
+}
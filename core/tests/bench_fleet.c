@@ -0,0 +1,99 @@
+/**
+ * @file bench_fleet.c
+ * @brief Fleet benchmark - memory per device and updates/sec for 10k devices
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../kmeans_fleet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_DEVICES 10000
+#define UPDATES_PER_DEVICE 500
+#define K 4
+#define D 3
+#define CAP RING_BUFFER_SIZE
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng_state = 12345;
+
+static fixed_t noise(void) {
+    rng_state = 1103515245u * rng_state + 12345u;
+    return (fixed_t)((rng_state >> 8) % 6554) - 3277;  // +-0.05
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf(" Fleet Benchmark\n");
+    printf("========================================\n");
+
+    size_t arena_size = KMEANS_FLEET_ARENA_SIZE(NUM_DEVICES, K, D, CAP);
+    void* arena = aligned_alloc(8, arena_size);
+    if (!arena) { printf("ERROR: Cannot allocate arena\n"); return 1; }
+
+    kmeans_fleet_t fleet;
+    if (!kmeans_fleet_init(&fleet, arena, arena_size, D, K, CAP)) {
+        printf("ERROR: fleet init failed\n");
+        free(arena);
+        return 1;
+    }
+
+    double t0 = now_sec();
+    for (int i = 0; i < NUM_DEVICES; i++) {
+        if (kmeans_fleet_create(&fleet, 0.2f) == KMEANS_FLEET_INVALID) {
+            printf("ERROR: create failed at %d\n", i);
+            free(arena);
+            return 1;
+        }
+    }
+    double t_create = now_sec() - t0;
+
+    // Round-robin stream: every device sees one sample per tick
+    int outliers = 0;
+    fixed_t p[D];
+    t0 = now_sec();
+    for (int tick = 0; tick < UPDATES_PER_DEVICE; tick++) {
+        for (kmeans_device_t dev = 0; dev < NUM_DEVICES; dev++) {
+            float base = 1.0f + (dev % 7) * 0.5f;
+            if (tick % 100 == 99 && dev % 10 == 0) base += 8.0f;  // Fault burst
+            for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(base) + noise();
+            if (kmeans_fleet_update(&fleet, dev, p) < 0) outliers++;
+        }
+    }
+    double t_update = now_sec() - t0;
+
+    t0 = now_sec();
+    volatile int sink = 0;
+    for (int tick = 0; tick < 100; tick++) {
+        for (kmeans_device_t dev = 0; dev < NUM_DEVICES; dev++) {
+            for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(1.0f) + noise();
+            sink += kmeans_fleet_predict(&fleet, dev, p);
+        }
+    }
+    double t_predict = now_sec() - t0;
+    (void)sink;
+
+    size_t legacy = sizeof(kmeans_model_t);
+    long total_updates = (long)NUM_DEVICES * UPDATES_PER_DEVICE;
+
+    printf("Devices: %d (K=%d, D=%d, buffer=%d)\n", NUM_DEVICES, K, D, CAP);
+    printf("\nMemory:\n");
+    printf("  Per device:  %zu bytes (legacy MAX_* model: %zu bytes)\n", fleet.slot_size, legacy);
+    printf("  Arena total: %.2f MB (legacy: %.2f MB)\n",
+           arena_size / 1048576.0, (double)legacy * NUM_DEVICES / 1048576.0);
+    printf("\nThroughput:\n");
+    printf("  Create:  %.2f ms for %d devices\n", t_create * 1e3, NUM_DEVICES);
+    printf("  Update:  %.2f M updates/sec (%ld updates, %d non-assigned)\n",
+           total_updates / t_update / 1e6, total_updates, outliers);
+    printf("  Predict: %.2f M predicts/sec\n", 100.0 * NUM_DEVICES / t_predict / 1e6);
+
+    free(arena);
+    return 0;
+}
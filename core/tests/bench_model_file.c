@@ -0,0 +1,118 @@
+/**
+ * @file bench_model_file.c
+ * @brief Bytes and cycles to save/load a model: v2 file vs the v1 layout
+ *
+ * v1 is timed as model_storage.h did it (fill a MAX_FEATURES struct per
+ * cluster, copy it out); v2 through model_file_write()/model_file_read().
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../model_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS() __rdtsc()
+#define TICK_UNIT "cycles"
+#else
+static unsigned long long ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#define TICKS() ns_now()
+#define TICK_UNIT "ns"
+#endif
+
+#define N 20000
+#define REPS 5
+
+typedef struct {
+    fixed_t centroid[64];
+    uint32_t count;
+    fixed_t inertia;
+    char label[MAX_LABEL_LENGTH];
+    bool active;
+} v1_cluster_t;
+
+static volatile size_t sink;
+static uint8_t buf[16384];
+
+static void make_model(kmeans_model_t* m, uint8_t dim, uint8_t k) {
+    kmeans_init(m, dim, 0.2f);
+    m->k = k;
+    for (uint8_t i = 0; i < k; i++) {
+        fixed_t c[MAX_FEATURES];
+        for (uint8_t d = 0; d < dim; d++) c[d] = (fixed_t)(i * 65536 + d * 999);
+        kmeans_set_centroid(m, i, c);
+        m->clusters[i].count = 1000u + i;
+        m->clusters[i].active = true;
+        snprintf(m->labels[i], MAX_LABEL_LENGTH, i == 0 ? "normal" : "fault_%u", i);
+    }
+}
+
+static size_t v1_save(const kmeans_model_t* m, uint8_t* out) {
+    size_t n = MODEL_FILE_V1_HEADER_SIZE;
+    memset(out, 0, n);
+    for (uint8_t i = 0; i < m->k; i++) {
+        v1_cluster_t c;
+        kmeans_get_centroid(m, i, c.centroid);
+        c.count = m->clusters[i].count;
+        c.inertia = m->clusters[i].inertia;
+        memcpy(c.label, m->labels[i], MAX_LABEL_LENGTH);
+        c.active = m->clusters[i].active;
+        memcpy(out + n, &c, sizeof(c));
+        n += sizeof(c);
+    }
+    return n;
+}
+
+static void run(uint8_t dim, uint8_t k) {
+    kmeans_model_t m, got;
+    make_model(&m, dim, k);
+    kmeans_init(&got, dim, 0.2f);
+    double t[4] = {1e18, 1e18, 1e18, 1e18};
+    size_t v1 = 0, v2 = 0;
+
+    for (int rep = 0; rep < REPS; rep++) {
+        unsigned long long t0 = TICKS();
+        for (int i = 0; i < N; i++) sink = v1 = v1_save(&m, buf);
+        double dt = (double)(TICKS() - t0) / N;
+        if (dt < t[0]) t[0] = dt;
+
+        uint32_t magic = MODEL_FILE_V1_MAGIC;
+        memcpy(buf, &magic, 4);
+        buf[4] = 1; buf[5] = k; buf[6] = dim;
+        t0 = TICKS();
+        for (int i = 0; i < N; i++) sink = model_file_read(buf, v1, &got);
+        dt = (double)(TICKS() - t0) / N;
+        if (dt < t[1]) t[1] = dt;
+
+        t0 = TICKS();
+        for (int i = 0; i < N; i++) sink = v2 = model_file_write(&m, buf, sizeof(buf));
+        dt = (double)(TICKS() - t0) / N;
+        if (dt < t[2]) t[2] = dt;
+
+        t0 = TICKS();
+        for (int i = 0; i < N; i++) sink = model_file_read(buf, v2, &got);
+        dt = (double)(TICKS() - t0) / N;
+        if (dt < t[3]) t[3] = dt;
+    }
+    printf("| K=%-2u D=%-2u | %5zu B | %4zu B | %7.0f | %7.0f | %7.0f | %7.0f |\n",
+           k, dim, v1, v2, t[0], t[1], t[2], t[3]);
+}
+
+int main() {
+    printf("\nModel file save/load (%s per model, best of %d x %d)\n\n", TICK_UNIT, REPS, N);
+    printf("| Model      | v1      | v2     | v1 save | v1 load | v2 save | v2 load |\n");
+    printf("|------------|---------|--------|---------|---------|---------|---------|\n");
+    run(3, 4);
+    run(7, 4);
+    run(7, 16);
+    run(10, 16);
+    run(64, 16);
+    return 0;
+}
@@ -0,0 +1,224 @@
+/**
+ * @file bench_mqtt.cpp
+ * @brief Bytes, cycles and heap allocations per MQTT message
+ *
+ * Compares the mqtt_codec encoder/decoder with an snprintf encoder and, when
+ * ArduinoJson is on the include path (make bench_mqtt ARDUINOJSON_DIR=...),
+ * with the JsonDocument path core.ino used before. Host numbers rank the
+ * approaches; ESP32/RP2040 malloc is far slower than glibc's.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../mqtt_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__has_include)
+  #if __has_include(<ArduinoJson.h>)
+    #include <ArduinoJson.h>
+    #define HAVE_ARDUINOJSON
+  #endif
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS() __rdtsc()
+#define TICK_UNIT "cycles"
+#else
+static unsigned long long ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#define TICKS() ns_now()
+#define TICK_UNIT "ns"
+#endif
+
+#ifdef __GLIBC__
+// Count heap allocations made while a path runs
+extern "C" void* __libc_malloc(size_t);
+static volatile unsigned long mallocs = 0;
+extern "C" void* malloc(size_t n) {
+    mallocs++;
+    return __libc_malloc(n);
+}
+#define ALLOCS_SUPPORTED 1
+#else
+static volatile unsigned long mallocs = 0;
+#define ALLOCS_SUPPORTED 0
+#endif
+
+#define N 200000
+
+static volatile size_t sink;
+static char buf[1024];
+
+static mqtt_summary_t summary(uint32_t i) {
+    mqtt_summary_t s;
+    memset(&s, 0, sizeof(s));
+    s.device_id = "motor_01";
+    s.state = (i % 8) ? "NORMAL" : "ALARM";
+    s.alarm_active = (i % 8) == 0;
+    s.motor_running = true;
+    s.cluster = (i % 8) ? (int32_t)(i % 3) : -1;
+    s.label = "normal";
+    s.k = 3;
+    s.total_points = 12500 + i;
+    s.vib_rms_avg = 5.2f + (i % 100) * 0.013f;
+    s.vib_rms_max = 6.1f + (i % 50) * 0.021f;
+    s.vib_peak_max = 9.1f;
+    s.vib_crest_avg = 1.75f;
+    s.has_current = true;
+    s.current_rms_avg = 2.3f;
+    s.current_rms_max = 2.51f;
+    s.baseline = 9.8123f;
+    s.sample_count = 100;
+    s.timestamp = 123456 + i * 10000;
+    return s;
+}
+
+static size_t encode_codec(const mqtt_summary_t* s) {
+    return mqtt_encode_summary(s, buf, sizeof(buf));
+}
+
+static size_t encode_snprintf(const mqtt_summary_t* s) {
+    int n = snprintf(buf, sizeof(buf),
+        "{\"device_id\":\"%s\",\"state\":\"%s\",\"alarm_active\":%s,\"waiting_label\":%s,"
+        "\"motor_running\":%s,\"cluster\":%d,\"label\":\"%s\",\"k\":%u,\"total_points\":%u,"
+        "\"vib_rms_avg\":%.4g,\"vib_rms_max\":%.4g,\"vib_peak_max\":%.4g,\"vib_crest_avg\":%.4g,"
+        "\"current_rms_avg\":%.4g,\"current_rms_max\":%.4g,\"baseline\":%.4g,"
+        "\"buffer_samples\":%u,\"sample_count\":%u,\"timestamp\":%u}",
+        s->device_id, s->state, s->alarm_active ? "true" : "false",
+        s->waiting_label ? "true" : "false", s->motor_running ? "true" : "false",
+        (int)s->cluster, s->label, (unsigned)s->k, (unsigned)s->total_points,
+        s->vib_rms_avg, s->vib_rms_max, s->vib_peak_max, s->vib_crest_avg,
+        s->current_rms_avg, s->current_rms_max, s->baseline,
+        (unsigned)s->buffer_samples, (unsigned)s->sample_count, (unsigned)s->timestamp);
+    return (n > 0 && (size_t)n < sizeof(buf)) ? (size_t)n : 0;
+}
+
+#ifdef HAVE_ARDUINOJSON
+// publishSummary() before mqtt_codec
+static size_t encode_arduinojson(const mqtt_summary_t* s) {
+    JsonDocument doc;
+    doc["device_id"] = s->device_id;
+    doc["state"] = s->state;
+    doc["alarm_active"] = s->alarm_active;
+    doc["waiting_label"] = s->waiting_label;
+    doc["motor_running"] = s->motor_running;
+    doc["cluster"] = s->cluster;
+    doc["label"] = s->label;
+    doc["k"] = s->k;
+    doc["total_points"] = s->total_points;
+    doc["vib_rms_avg"] = s->vib_rms_avg;
+    doc["vib_rms_max"] = s->vib_rms_max;
+    doc["vib_peak_max"] = s->vib_peak_max;
+    doc["vib_crest_avg"] = s->vib_crest_avg;
+    doc["current_rms_avg"] = s->current_rms_avg;
+    doc["current_rms_max"] = s->current_rms_max;
+    doc["baseline"] = s->baseline;
+    doc["buffer_samples"] = s->buffer_samples;
+    doc["sample_count"] = s->sample_count;
+    doc["timestamp"] = s->timestamp;
+    return serializeJson(doc, buf, sizeof(buf));
+}
+#endif
+
+typedef size_t (*encode_fn)(const mqtt_summary_t*);
+
+static void run_encode(const char* name, encode_fn fn) {
+    static mqtt_summary_t msgs[256];
+    for (uint32_t i = 0; i < 256; i++) msgs[i] = summary(i);
+
+    double best = 1e18;
+    size_t bytes = 0;
+    unsigned long allocs = 0;
+    for (int rep = 0; rep < 5; rep++) {
+        size_t total = 0;
+        unsigned long m0 = mallocs;
+        unsigned long long t0 = TICKS();
+        for (uint32_t i = 0; i < N; i++) total += fn(&msgs[i & 255]);
+        unsigned long long t = TICKS() - t0;
+        allocs = mallocs - m0;
+        sink = total;
+        bytes = total / N;
+        if (t < best) best = (double)t;
+    }
+    printf("  %-22s %6zu B  %9.1f %s  %6.2f allocs\n", name, bytes, best / N, TICK_UNIT,
+           (double)allocs / N);
+}
+
+static const char* COMMANDS[] = {
+    "{\"label\":\"bearing_outer_race\"}",
+    "{\"discard\":true}",
+    "{\"freeze\":true}",
+    "{\"cluster_id\":1}",
+};
+#define N_COMMANDS 4
+
+static size_t decode_codec(const char* json, size_t len) {
+    mqtt_command_t c;
+    if (!mqtt_decode_command(json, len, &c)) return 0;
+    return c.has_label + c.discard + c.freeze + (size_t)c.cluster_id;
+}
+
+#ifdef HAVE_ARDUINOJSON
+// mqttCallback() before mqtt_codec
+static size_t decode_arduinojson(const char* json, size_t len) {
+    JsonDocument doc;
+    if (deserializeJson(doc, json, len)) return 0;
+    const char* label = doc["label"];
+    return (label != NULL) + (doc["discard"] == true) + (doc["freeze"] == true) +
+           (size_t)(doc["cluster_id"] | 0);
+}
+#endif
+
+typedef size_t (*decode_fn)(const char*, size_t);
+
+static void run_decode(const char* name, decode_fn fn) {
+    size_t lens[N_COMMANDS];
+    for (int i = 0; i < N_COMMANDS; i++) lens[i] = strlen(COMMANDS[i]);
+
+    double best = 1e18;
+    unsigned long allocs = 0;
+    for (int rep = 0; rep < 5; rep++) {
+        size_t total = 0;
+        unsigned long m0 = mallocs;
+        unsigned long long t0 = TICKS();
+        for (uint32_t i = 0; i < N; i++) total += fn(COMMANDS[i % N_COMMANDS], lens[i % N_COMMANDS]);
+        unsigned long long t = TICKS() - t0;
+        allocs = mallocs - m0;
+        sink = total;
+        if (t < best) best = (double)t;
+    }
+    printf("  %-22s %9.1f %s  %6.2f allocs\n", name, best / N, TICK_UNIT, (double)allocs / N);
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf("MQTT Payload Codec Benchmark\n");
+    printf("========================================\n\n");
+    unsigned long probe = mallocs;
+    free(malloc(16));
+    if (!ALLOCS_SUPPORTED || mallocs == probe) printf("(allocation counting unavailable; allocs read 0)\n\n");
+
+    printf("Summary encode (sensor/{id}/data, %d messages):\n", N);
+    run_encode("mqtt_codec", encode_codec);
+    run_encode("snprintf", encode_snprintf);
+    #ifdef HAVE_ARDUINOJSON
+      run_encode("ArduinoJson", encode_arduinojson);
+    #else
+      printf("  ArduinoJson            not found (make bench_mqtt ARDUINOJSON_DIR=<path>/src)\n");
+    #endif
+
+    printf("\nCommand decode (label/discard/freeze/assign):\n");
+    run_decode("mqtt_codec", decode_codec);
+    #ifdef HAVE_ARDUINOJSON
+      run_decode("ArduinoJson", decode_arduinojson);
+    #endif
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file bench_predict.c
+ * @brief kmeans_predict() throughput: legacy AoS clusters vs SoA centroids
+ *
+ * "Legacy" replays the original layout: each cluster_t carried a
+ * MAX_FEATURES centroid next to count/inertia/label, and the scan called
+ * distance_squared() row by row. "Current" is kmeans_predict() on the
+ * compact model (dense dimension-major centroids, labels stored apart).
+ * Both run on one hot model and on a pool of models that does not fit
+ * in cache (gateway case).
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../streaming_kmeans.h"
+#include "../kmeans_distance.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define N_POINTS 1024
+#define N_PREDICT 2000000
+#define POOL 2000
+
+typedef struct {
+    fixed_t centroid[MAX_FEATURES];
+    uint32_t count;
+    fixed_t inertia;
+    char label[MAX_LABEL_LENGTH];
+    bool active;
+} legacy_cluster_t;
+
+typedef struct {
+    legacy_cluster_t clusters[MAX_CLUSTERS];
+    uint8_t k;
+    uint8_t feature_dim;
+} legacy_model_t;
+
+static fixed_t legacy_distance(const fixed_t* a, const fixed_t* b, uint8_t dim) {
+    int64_t sum = 0;
+    for (uint8_t i = 0; i < dim; i++) {
+        int64_t diff = (int64_t)a[i] - (int64_t)b[i];
+        sum += (diff * diff) >> FIXED_POINT_SHIFT;
+    }
+    return (fixed_t)sum;
+}
+
+static uint8_t legacy_predict(const legacy_model_t* model, const fixed_t* point) {
+    uint8_t nearest = 0;
+    fixed_t min_dist = legacy_distance(point, model->clusters[0].centroid, model->feature_dim);
+    for (uint8_t i = 1; i < model->k; i++) {
+        if (!model->clusters[i].active) continue;
+        fixed_t dist = legacy_distance(point, model->clusters[i].centroid, model->feature_dim);
+        if (dist < min_dist) {
+            min_dist = dist;
+            nearest = i;
+        }
+    }
+    return nearest;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng = 99;
+static fixed_t rand_fixed(void) {
+    rng = 1103515245u * rng + 12345u;
+    return (fixed_t)((rng >> 8) % 655360);  // 0..10
+}
+
+static void fill(legacy_model_t* legacy, kmeans_model_t* model, uint8_t k, uint8_t dim) {
+    legacy->k = k;
+    legacy->feature_dim = dim;
+    model->k = k;
+    for (uint8_t c = 0; c < k; c++) {
+        for (uint8_t d = 0; d < dim; d++) legacy->clusters[c].centroid[d] = rand_fixed();
+        legacy->clusters[c].active = true;
+        kmeans_set_centroid(model, c, legacy->clusters[c].centroid);
+        model->clusters[c].active = true;
+    }
+}
+
+// Headers are packed back to back; storage lives in its own arena
+static kmeans_model_t* model_at(uint8_t* headers, int m) {
+    return (kmeans_model_t*)(headers + KMEANS_MODEL_HEADER_SIZE * (size_t)m);
+}
+
+static void run(uint8_t k, uint8_t dim, int pool) {
+    size_t storage_size = KMEANS_STORAGE_SIZE(k, dim, BOOTSTRAP_SAMPLES);
+    legacy_model_t* legacy = malloc(sizeof(legacy_model_t) * pool);
+    uint8_t* headers = aligned_alloc(8, KMEANS_MODEL_HEADER_SIZE * pool);  // No embedded block
+    uint8_t* arena = aligned_alloc(8, storage_size * pool);
+    fixed_t* points = malloc(sizeof(fixed_t) * N_POINTS * dim);
+    if (!legacy || !headers || !arena || !points) { printf("ERROR: out of memory\n"); exit(1); }
+
+    for (int m = 0; m < pool; m++) {
+        kmeans_init_with_storage(model_at(headers, m), dim, 0.2f, k, BOOTSTRAP_SAMPLES,
+                                 arena + storage_size * m, storage_size);
+        fill(&legacy[m], model_at(headers, m), k, dim);
+    }
+    for (int i = 0; i < N_POINTS * dim; i++) points[i] = rand_fixed();
+
+    double best_legacy = 1e9, best_soa = 1e9;
+    unsigned long sum_legacy = 0, sum_soa = 0;
+    for (int rep = 0; rep < 3; rep++) {
+        sum_legacy = sum_soa = 0;
+        // Stride through the pool so consecutive predicts hit different models
+        double t0 = now_sec();
+        for (int i = 0; i < N_PREDICT; i++) {
+            int m = (int)(((unsigned)i * 7919u) % (unsigned)pool);
+            sum_legacy += legacy_predict(&legacy[m], &points[(i & (N_POINTS - 1)) * dim]);
+        }
+        double t = now_sec() - t0;
+        if (t < best_legacy) best_legacy = t;
+
+        t0 = now_sec();
+        for (int i = 0; i < N_PREDICT; i++) {
+            int m = (int)(((unsigned)i * 7919u) % (unsigned)pool);
+            sum_soa += kmeans_predict(model_at(headers, m), &points[(i & (N_POINTS - 1)) * dim]);
+        }
+        t = now_sec() - t0;
+        if (t < best_soa) best_soa = t;
+    }
+
+    printf("%5d %3d %3d   %8.1f   %8.1f   %6.2fx   %s\n", pool, k, dim,
+           N_PREDICT / best_legacy / 1e6, N_PREDICT / best_soa / 1e6,
+           best_legacy / best_soa, sum_legacy == sum_soa ? "yes" : "NO");
+
+    free(legacy);
+    free(headers);
+    free(arena);
+    free(points);
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf(" Predict Layout Benchmark (%s kernel)\n", kmeans_distance_kernel());
+    printf("========================================\n");
+    printf("Legacy cluster_t: %zu B/cluster, current: %zu B hot + %d B centroid/dim\n",
+           sizeof(legacy_cluster_t), sizeof(cluster_t), (int)sizeof(fixed_t));
+    printf("\n pool   K   D   legacy M/s   SoA M/s   speedup  same\n");
+
+    const uint8_t ks[] = {4, 16};
+    const uint8_t dims[] = {3, 10};
+    const int pools[] = {1, POOL};
+    for (size_t p = 0; p < 2; p++)
+        for (size_t a = 0; a < 2; a++)
+            for (size_t b = 0; b < 2; b++)
+                run(ks[a], dims[b], pools[p]);
+    return 0;
+}
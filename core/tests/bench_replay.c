@@ -0,0 +1,301 @@
+/**
+ * @file bench_replay.c
+ * @brief Replay feature streams through kmeans_update/kmeans_predict
+ *
+ * Reports samples/sec, per-call latency percentiles, peak RSS and model
+ * size, for a K x D matrix of synthetic streams or for a CSV replay.
+ *
+ * Usage:
+ *   ./bench_replay                              # synthetic K x D matrix
+ *   ./bench_replay --csv cwru/features.csv      # replay a CSV (header row;
+ *                                               # a "label" column is skipped)
+ *   ./bench_replay --json bench_results.json    # also write JSON
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../streaming_kmeans.h"
+#include "../kmeans_distance.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#define SYNTH_SAMPLES 200000
+#define MAX_RESULTS 32
+#define CAP RING_BUFFER_SIZE
+
+typedef struct {
+    const char* source;
+    uint8_t k;              // Clusters in the model
+    uint8_t d;
+    size_t samples;
+    size_t model_bytes;     // Model header + bound storage
+    double update_sps;
+    double predict_sps;
+    double update_ns[3];    // p50, p99, p999
+    double predict_ns[3];
+} result_t;
+
+static result_t results[MAX_RESULTS];
+static int num_results = 0;
+static double timer_overhead_ns = 0;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_float(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static void percentiles(float* lat, size_t n, double* out) {
+    qsort(lat, n, sizeof(float), cmp_float);
+    const double q[3] = {0.50, 0.99, 0.999};
+    for (int i = 0; i < 3; i++) {
+        size_t idx = (size_t)(q[i] * (n - 1));
+        out[i] = lat[idx];
+    }
+}
+
+// Cost of one timestamp pair, subtracted from every per-call sample
+static void calibrate_timer(void) {
+    double best = 1e9;
+    for (int i = 0; i < 100000; i++) {
+        double t0 = now_ns();
+        double t = now_ns() - t0;
+        if (t < best) best = t;
+    }
+    timer_overhead_ns = best;
+}
+
+static long peak_rss_kb(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;  // KB on Linux
+}
+
+// Train through the real state machine: each alarm is labeled as a new
+// cluster until `k` clusters exist. Returns samples consumed.
+static size_t train(kmeans_model_t* model, const fixed_t* points, size_t n, uint8_t k) {
+    size_t i = 0;
+    int faults = 0;
+    for (; i < n && model->k < k; i++) {
+        kmeans_update(model, &points[i * model->feature_dim]);
+        // Operator labels once the window is mostly the new regime
+        if (model->state == STATE_ALARM && model->alarm_sample_count >= CAP / 2) {
+            kmeans_request_label(model);
+        }
+        if (model->state == STATE_WAITING_LABEL) {
+            char label[MAX_LABEL_LENGTH];
+            snprintf(label, sizeof(label), "c%d", faults++);
+            if (!kmeans_add_cluster(model, label)) kmeans_discard(model);
+        }
+    }
+    return i;
+}
+
+static void measure(const char* source, const fixed_t* points, size_t n, uint8_t d, uint8_t k,
+                    void* storage, size_t storage_size) {
+    kmeans_model_t model;
+    if (!kmeans_init_with_storage(&model, d, 0.2f, k, CAP, storage, storage_size)) {
+        fprintf(stderr, "init failed (K=%d D=%d)\n", k, d);
+        return;
+    }
+    train(&model, points, n, k);
+
+    float* lat = malloc(sizeof(float) * n);
+    if (!lat) return;
+
+    result_t* r = &results[num_results++];
+    r->source = source;
+    r->k = model.k;
+    r->d = d;
+    r->samples = n;
+    r->model_bytes = KMEANS_MODEL_HEADER_SIZE + KMEANS_STORAGE_SIZE(k, d, CAP);
+
+    // Throughput: untimed calls, keep the model streaming (re-label freezes)
+    volatile int sink = 0;
+    double t0 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        sink += kmeans_update(&model, &points[i * d]);
+        if (model.state == STATE_WAITING_LABEL) kmeans_discard(&model);
+    }
+    r->update_sps = n / ((now_ns() - t0) * 1e-9);
+
+    t0 = now_ns();
+    for (size_t i = 0; i < n; i++) sink += kmeans_predict(&model, &points[i * d]);
+    r->predict_sps = n / ((now_ns() - t0) * 1e-9);
+
+    // Latency: one timestamp pair per call
+    for (size_t i = 0; i < n; i++) {
+        double s = now_ns();
+        sink += kmeans_update(&model, &points[i * d]);
+        double t = now_ns() - s - timer_overhead_ns;
+        lat[i] = t > 0 ? (float)t : 0.0f;
+        if (model.state == STATE_WAITING_LABEL) kmeans_discard(&model);
+    }
+    percentiles(lat, n, r->update_ns);
+
+    for (size_t i = 0; i < n; i++) {
+        double s = now_ns();
+        sink += kmeans_predict(&model, &points[i * d]);
+        double t = now_ns() - s - timer_overhead_ns;
+        lat[i] = t > 0 ? (float)t : 0.0f;
+    }
+    percentiles(lat, n, r->predict_ns);
+    (void)sink;
+
+    free(lat);
+}
+
+// K well-separated blobs in D dimensions, dwelling ~200 samples per blob
+static fixed_t* synth_stream(uint8_t k, uint8_t d, size_t n) {
+    fixed_t* points = malloc(sizeof(fixed_t) * n * d);
+    if (!points) return NULL;
+    uint32_t rng = 42u + k * 131u + d;
+    int blob = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i % 200 == 0) {
+            rng = 1103515245u * rng + 12345u;
+            blob = (i < 200) ? 0 : (int)((rng >> 8) % k);
+        }
+        for (uint8_t j = 0; j < d; j++) {
+            rng = 1103515245u * rng + 12345u;
+            fixed_t center = FLOAT_TO_FIXED(1.0f + 4.0f * blob + 0.5f * (j % 3));
+            points[i * d + j] = center + (fixed_t)((rng >> 8) % 13108) - 6554;  // +-0.1
+        }
+    }
+    return points;
+}
+
+// CSV with a header row; numeric columns become features, "label" is skipped
+static fixed_t* load_csv(const char* path, uint8_t* out_d, size_t* out_n) {
+    FILE* f = fopen(path, "r");
+    if (!f) { fprintf(stderr, "ERROR: Cannot open %s\n", path); return NULL; }
+
+    char line[1024];
+    if (!fgets(line, sizeof(line), f)) { fclose(f); return NULL; }
+
+    bool skip[MAX_FEATURES * 2] = {false};
+    int cols = 0, d = 0;
+    for (char* tok = strtok(line, ",\r\n"); tok && cols < MAX_FEATURES * 2; tok = strtok(NULL, ",\r\n")) {
+        skip[cols] = strcmp(tok, "label") == 0;
+        if (!skip[cols]) d++;
+        cols++;
+    }
+    if (d == 0 || d > MAX_FEATURES) { fclose(f); return NULL; }
+
+    size_t cap = 4096, n = 0;
+    fixed_t* points = malloc(sizeof(fixed_t) * cap * d);
+    while (points && fgets(line, sizeof(line), f)) {
+        if (n == cap) {
+            cap *= 2;
+            fixed_t* grown = realloc(points, sizeof(fixed_t) * cap * d);
+            if (!grown) { free(points); points = NULL; break; }
+            points = grown;
+        }
+        int c = 0, j = 0;
+        for (char* tok = strtok(line, ",\r\n"); tok && c < cols; tok = strtok(NULL, ",\r\n"), c++) {
+            if (!skip[c]) points[n * d + j++] = FLOAT_TO_FIXED(strtof(tok, NULL));
+        }
+        if (j == d) n++;
+    }
+    fclose(f);
+    *out_d = (uint8_t)d;
+    *out_n = n;
+    return points;
+}
+
+static void print_table(void) {
+    printf("%-10s %3s %3s %8s %9s %10s %10s %8s %8s %8s %8s\n", "source", "K", "D", "bytes",
+           "samples", "upd/s", "pred/s", "upd p50", "upd p99", "upd p999", "pred p99");
+    for (int i = 0; i < num_results; i++) {
+        const result_t* r = &results[i];
+        printf("%-10s %3d %3d %8zu %9zu %10.0f %10.0f %8.0f %8.0f %8.0f %8.0f\n", r->source, r->k,
+               r->d, r->model_bytes, r->samples, r->update_sps, r->predict_sps, r->update_ns[0],
+               r->update_ns[1], r->update_ns[2], r->predict_ns[1]);
+    }
+    printf("(latency in ns, timer overhead %.0f ns subtracted; peak RSS %ld KB)\n",
+           timer_overhead_ns, peak_rss_kb());
+}
+
+static int write_json(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) { fprintf(stderr, "ERROR: Cannot write %s\n", path); return 1; }
+    fprintf(f, "{\n");
+    fprintf(f, "  \"model_header_bytes\": %zu,\n", (size_t)KMEANS_MODEL_HEADER_SIZE);
+    fprintf(f, "  \"distance_kernel\": \"%s\",\n", kmeans_distance_kernel());
+    fprintf(f, "  \"timer_overhead_ns\": %.1f,\n", timer_overhead_ns);
+    fprintf(f, "  \"peak_rss_kb\": %ld,\n", peak_rss_kb());
+    fprintf(f, "  \"results\": [\n");
+    for (int i = 0; i < num_results; i++) {
+        const result_t* r = &results[i];
+        fprintf(f, "    {\"source\": \"%s\", \"k\": %d, \"d\": %d, \"model_bytes\": %zu, "
+                   "\"samples\": %zu,\n", r->source, r->k, r->d, r->model_bytes, r->samples);
+        fprintf(f, "     \"update\": {\"samples_per_sec\": %.0f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, "
+                   "\"p999_ns\": %.1f},\n", r->update_sps, r->update_ns[0], r->update_ns[1], r->update_ns[2]);
+        fprintf(f, "     \"predict\": {\"samples_per_sec\": %.0f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, "
+                   "\"p999_ns\": %.1f}}%s\n", r->predict_sps, r->predict_ns[0], r->predict_ns[1],
+                r->predict_ns[2], i + 1 < num_results ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    printf("Wrote %s\n", path);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* csv = NULL;
+    const char* json = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csv = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) json = argv[++i];
+        else { fprintf(stderr, "usage: %s [--csv file] [--json file]\n", argv[0]); return 2; }
+    }
+
+    printf("\n========================================\n");
+    printf(" Replay Benchmark (%s kernel)\n", kmeans_distance_kernel());
+    printf("========================================\n");
+    printf("Model header = %zu bytes (+ bound storage)\n\n", (size_t)KMEANS_MODEL_HEADER_SIZE);
+
+    calibrate_timer();
+
+    if (csv) {
+        uint8_t d;
+        size_t n;
+        fixed_t* points = load_csv(csv, &d, &n);
+        if (!points || n == 0) { free(points); return 1; }
+        size_t size = KMEANS_STORAGE_SIZE(MAX_CLUSTERS, d, CAP);
+        void* storage = aligned_alloc(8, size);
+        // Same K ladder on the real stream: model grows as far as the data allows
+        const uint8_t ks[] = {2, 4, 8};
+        for (size_t a = 0; a < sizeof(ks) && storage; a++) {
+            measure("csv", points, n, d, ks[a], storage, size);
+        }
+        free(storage);
+        free(points);
+    } else {
+        const uint8_t ks[] = {2, 4, 8, 16};
+        const uint8_t ds[] = {3, 4, 7, 10};
+        for (size_t b = 0; b < sizeof(ds); b++) {
+            for (size_t a = 0; a < sizeof(ks); a++) {
+                fixed_t* points = synth_stream(ks[a], ds[b], SYNTH_SAMPLES);
+                size_t size = KMEANS_STORAGE_SIZE(ks[a], ds[b], CAP);
+                void* storage = aligned_alloc(8, size);
+                if (points && storage) {
+                    measure("synthetic", points, SYNTH_SAMPLES, ds[b], ks[a], storage, size);
+                }
+                free(storage);
+                free(points);
+            }
+        }
+    }
+
+    print_table();
+    return json ? write_json(json) : 0;
+}
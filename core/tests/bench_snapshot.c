@@ -0,0 +1,187 @@
+/**
+ * @file bench_snapshot.c
+ * @brief Gateway cold start for 100k models: mmap'd snapshot vs per-model parsing
+ *
+ * Baseline: one v2 model file per device (model_file.h) in a single blob,
+ * read and parsed into kmeans_fleet slots. Snapshot: kmeans_snapshot_map()
+ * and a view per device. Both files are dropped from the page cache first
+ * (posix_fadvise, best effort), then every device answers one predict.
+ *
+ * Usage: bench_snapshot [devices]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../kmeans_snapshot.h"
+#include "../kmeans_fleet.h"
+#include "../model_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define K 8
+#define D 7
+#define SNAPSHOT_PATH "/tmp/bench_snapshot.tols"
+#define BLOB_PATH "/tmp/bench_snapshot.v2"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t source_memory[KMEANS_STORAGE_SIZE(K, D, BOOTSTRAP_SAMPLES) / 8];
+static kmeans_model_t source;
+
+// Device i: 1 + i % K clusters, centroids shifted by i
+static void device_model(uint32_t i, char* id) {
+    snprintf(id, KMEANS_SNAPSHOT_ID_LEN, "motor_%07u", i);
+    source.k = (uint8_t)(1 + i % K);
+    source.total_points = 5000 + i;
+    for (uint8_t c = 0; c < source.k; c++) {
+        fixed_t centroid[D];
+        for (int d = 0; d < D; d++) centroid[d] = FLOAT_TO_FIXED(c * 2.0f + d * 0.25f) + (fixed_t)(i % 1000);
+        kmeans_set_centroid(&source, c, centroid);
+        source.clusters[c].count = 100u + c;
+        source.clusters[c].inertia = FLOAT_TO_FIXED(0.5f);
+        source.clusters[c].active = true;
+        snprintf(source.labels[c], MAX_LABEL_LENGTH, c ? "fault_%u" : "normal", c);
+    }
+}
+
+static void drop_cache(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    fsync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static size_t file_size(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return 0;
+    fseek(fp, 0, SEEK_END);
+    size_t n = (size_t)ftell(fp);
+    fclose(fp);
+    return n;
+}
+
+int main(int argc, char** argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 100000;
+    kmeans_init_with_storage(&source, D, 0.2f, K, BOOTSTRAP_SAMPLES, source_memory, sizeof(source_memory));
+    source.outlier_threshold = FLOAT_TO_FIXED(2.0f);
+    source.state = STATE_NORMAL;
+    char id[KMEANS_SNAPSHOT_ID_LEN];
+
+    printf("\n========================================\n");
+    printf(" Snapshot Cold-Start Benchmark\n");
+    printf("========================================\n");
+    printf("Devices: %u (K<=%d, D=%d)\n", n, K, D);
+
+    // Write both files
+    double t0 = now_sec();
+    FILE* fp = fopen(SNAPSHOT_PATH, "wb");
+    kmeans_snapshot_writer_t w;
+    if (!fp || !kmeans_snapshot_begin(&w, fp, D, K)) { printf("ERROR: cannot write snapshot\n"); return 1; }
+    for (uint32_t i = 0; i < n; i++) {
+        device_model(i, id);
+        kmeans_snapshot_add(&w, id, &source);
+    }
+    if (!kmeans_snapshot_finish(&w)) { printf("ERROR: snapshot write failed\n"); return 1; }
+    fclose(fp);
+    double t_write = now_sec() - t0;
+
+    fp = fopen(BLOB_PATH, "wb");
+    if (!fp) { printf("ERROR: cannot write blob\n"); return 1; }
+    static uint8_t file[MODEL_FILE_MAX_SIZE(K, D)];
+    for (uint32_t i = 0; i < n; i++) {
+        device_model(i, id);
+        uint16_t len = (uint16_t)model_file_write(&source, file, sizeof(file));
+        uint8_t id_len = (uint8_t)strlen(id);
+        fwrite(&id_len, 1, 1, fp);
+        fwrite(id, 1, id_len, fp);
+        fwrite(&len, 2, 1, fp);
+        fwrite(file, 1, len, fp);
+    }
+    fclose(fp);
+
+    // Baseline: read + parse every model into a fleet slot
+    drop_cache(BLOB_PATH);
+    t0 = now_sec();
+    size_t blob_size = file_size(BLOB_PATH);
+    uint8_t* blob = malloc(blob_size);
+    fp = fopen(BLOB_PATH, "rb");
+    if (!blob || !fp || fread(blob, 1, blob_size, fp) != blob_size) { printf("ERROR: read failed\n"); return 1; }
+    fclose(fp);
+    size_t arena_size = KMEANS_FLEET_ARENA_SIZE(n, K, D, BOOTSTRAP_SAMPLES);
+    void* arena = aligned_alloc(8, arena_size);
+    kmeans_fleet_t fleet;
+    if (!arena || !kmeans_fleet_init(&fleet, arena, arena_size, D, K, BOOTSTRAP_SAMPLES)) {
+        printf("ERROR: fleet init failed\n");
+        return 1;
+    }
+    size_t off = 0;
+    uint32_t parsed = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        off += 1 + blob[off];  // Id (a real gateway would also index it)
+        uint16_t len;
+        memcpy(&len, blob + off, 2);
+        off += 2;
+        kmeans_device_t dev = kmeans_fleet_create(&fleet, 0.2f);
+        if (model_file_read(blob + off, len, kmeans_fleet_model(&fleet, dev))) parsed++;
+        off += len;
+    }
+    double t_parse_ready = now_sec() - t0;
+
+    fixed_t p[D];
+    for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(2.0f + d * 0.25f);
+    volatile uint32_t sink = 0;
+    double t1 = now_sec();
+    for (uint32_t i = 0; i < n; i++) sink += kmeans_fleet_predict(&fleet, (kmeans_device_t)i, p);
+    double t_parse_query = now_sec() - t1;
+    free(arena);
+    free(blob);
+
+    // Snapshot: map, then one view + predict per device
+    drop_cache(SNAPSHOT_PATH);
+    t0 = now_sec();
+    kmeans_snapshot_t s;
+    if (!kmeans_snapshot_map(&s, SNAPSHOT_PATH)) { printf("ERROR: map failed\n"); return 1; }
+    double t_map_ready = now_sec() - t0;
+    t1 = now_sec();
+    for (uint32_t i = 0; i < s.count; i++) {
+        kmeans_model_header_t view;
+        kmeans_snapshot_model(&s, i, kmeans_model_of(&view));
+        sink += kmeans_predict(kmeans_model_of(&view), p);
+    }
+    double t_map_query = now_sec() - t1;
+
+    // Warm lookups by device id
+    t1 = now_sec();
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        snprintf(id, sizeof(id), "motor_%07u", (i * 7919u) % n);
+        if (kmeans_snapshot_find(&s, id) >= 0) found++;
+    }
+    double t_find = now_sec() - t1;
+    kmeans_snapshot_unmap(&s);
+    (void)sink;
+
+    printf("\nFiles:\n");
+    printf("  Snapshot: %.1f MB (%u B/model), written in %.0f ms\n",
+           file_size(SNAPSHOT_PATH) / 1048576.0, (unsigned)KMEANS_SNAPSHOT_RECORD_SIZE(K, D), t_write * 1e3);
+    printf("  v2 blobs: %.1f MB\n", blob_size / 1048576.0);
+    printf("\nCold start (%u models):\n", n);
+    printf("  Parse v2 into fleet: ready %.1f ms, first predict on all %.1f ms (%u parsed, %.0f MB heap)\n",
+           t_parse_ready * 1e3, t_parse_query * 1e3, parsed, (arena_size + blob_size) / 1048576.0);
+    printf("  mmap snapshot:       ready %.3f ms, first predict on all %.1f ms (0 MB heap)\n",
+           t_map_ready * 1e3, t_map_query * 1e3);
+    printf("  Lookup by id:        %.0f ns per find (%u found)\n", t_find * 1e9 / n, found);
+
+    unlink(SNAPSHOT_PATH);
+    unlink(BLOB_PATH);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file bench_static.c
+ * @brief Dynamic API vs KMEANS_DEFINE(D) specialization, per feature schema
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../kmeans_static.h"
+#include "../kmeans_distance.h"
+#include <stdio.h>
+#include <time.h>
+
+KMEANS_DEFINE(3)
+KMEANS_DEFINE(7)
+KMEANS_DEFINE(10)
+
+#define N 2000000
+#define N_POINTS 1024
+#define K_USED 8
+#define MAX_D 10
+
+static uint64_t dyn_storage[KMEANS_STORAGE_SIZE(KMEANS_STATIC_CLUSTERS, MAX_D, KMEANS_STATIC_BUFFER) / 8];
+static fixed_t points[N_POINTS * MAX_D];
+static volatile int sink;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// K_USED trained clusters, outliers disabled: every update takes the EMA path
+static void populate(kmeans_model_t* m) {
+    uint32_t rng = 5;
+    fixed_t c[MAX_D];
+    for (uint8_t k = 0; k < K_USED; k++) {
+        for (int d = 0; d < m->feature_dim; d++) {
+            rng = 1103515245u * rng + 12345u;
+            c[d] = (fixed_t)((rng >> 8) % 655360);
+        }
+        kmeans_set_centroid(m, k, c);
+        m->clusters[k].active = true;
+        m->clusters[k].count = 1000;
+        m->clusters[k].inertia = FLOAT_TO_FIXED(1.0f);
+    }
+    m->k = K_USED;
+    m->state = STATE_NORMAL;
+    m->outlier_threshold = FLOAT_TO_FIXED(30000.0f);
+}
+
+#define TIME_LOOP(result, expr) do { \
+    double best = 1e9; \
+    for (int rep = 0; rep < 5; rep++) { \
+        int acc = 0; \
+        double t0 = now_sec(); \
+        for (int i = 0; i < N; i++) { \
+            const fixed_t* p = &points[(i & (N_POINTS - 1)) * dim]; \
+            acc += (expr); \
+        } \
+        double t = now_sec() - t0; \
+        sink = acc; \
+        if (t < best) best = t; \
+    } \
+    result = N / best / 1e6; \
+} while (0)
+
+#define BENCH(D) do { \
+    static kmeans_d##D##_t s; \
+    kmeans_model_t dyn; \
+    const int dim = D; \
+    double dyn_pred, st_pred, dyn_upd, st_upd; \
+    kmeans_d##D##_init(&s, 0.2f); \
+    kmeans_init_with_storage(&dyn, D, 0.2f, KMEANS_STATIC_CLUSTERS, KMEANS_STATIC_BUFFER, \
+                             dyn_storage, sizeof(dyn_storage)); \
+    populate(kmeans_d##D##_model(&s)); \
+    populate(&dyn); \
+    TIME_LOOP(dyn_pred, kmeans_predict(&dyn, p)); \
+    TIME_LOOP(st_pred, kmeans_d##D##_predict(&s, p)); \
+    TIME_LOOP(dyn_upd, kmeans_update(&dyn, p)); \
+    TIME_LOOP(st_upd, kmeans_d##D##_update(&s, p)); \
+    printf("%3d           %7.1f  %8.1f  %5.2fx          %7.1f  %8.1f  %5.2fx  %6zu\n", D, \
+           dyn_pred, st_pred, st_pred / dyn_pred, dyn_upd, st_upd, st_upd / dyn_upd, \
+           sizeof(kmeans_d##D##_t)); \
+} while (0)
+
+int main() {
+    printf("\n========================================\n");
+    printf(" Static vs Dynamic Benchmark (dynamic kernel: %s)\n", kmeans_distance_kernel());
+    printf("========================================\n");
+
+    uint32_t rng = 11;
+    for (int i = 0; i < N_POINTS * MAX_D; i++) {
+        rng = 1103515245u * rng + 12345u;
+        points[i] = (fixed_t)((rng >> 8) % 655360);
+    }
+
+    printf("K=%d of %d, M ops/sec\n\n", K_USED, KMEANS_STATIC_CLUSTERS);
+    printf("  D  predict: dynamic    static   gain  update: dynamic    static   gain  sizeof\n");
+    BENCH(3);
+    BENCH(7);
+    BENCH(10);
+    printf("\nDynamic model at MAX_* shape: %zu bytes\n",
+           sizeof(kmeans_model_t));
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file bench_telemetry.c
+ * @brief Bytes and cycles per message: binary telemetry vs JSON
+ *
+ * Summary: the sensor/{id}/data message. Features: batches of per-window
+ * vectors, against one JSON object per vector (the telemetry_json output).
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../telemetry.h"
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS() __rdtsc()
+#define TICK_UNIT "cycles"
+#else
+static unsigned long long ns_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#define TICKS() ns_now()
+#define TICK_UNIT "ns"
+#endif
+
+#define N 100000
+#define BATCH 10
+#define REPS 5
+
+static volatile size_t sink;
+static char json[1024];
+static uint8_t bin[1024];
+
+static mqtt_summary_t summary(uint32_t i) {
+    mqtt_summary_t s = {
+        .device_id = "motor_01", .state = "NORMAL", .motor_running = true,
+        .cluster = (int32_t)(i % 3), .label = "normal", .k = 3, .total_points = 12500 + i,
+        .vib_rms_avg = 5.2f + (i % 100) * 0.013f, .vib_rms_max = 6.1f, .vib_peak_max = 9.1f,
+        .vib_crest_avg = 1.75f, .has_current = true, .current_rms_avg = 2.3f,
+        .current_rms_max = 2.51f, .baseline = 9.8123f, .sample_count = 100,
+        .timestamp = 123456 + i * 10000,
+    };
+    return s;
+}
+
+static void bench_summary(void) {
+    double t_json = 1e18, t_bin = 1e18, t_dec = 1e18;
+    size_t b_json = 0, b_bin = 0;
+    for (int rep = 0; rep < REPS; rep++) {
+        size_t total = 0;
+        unsigned long long t0 = TICKS();
+        for (uint32_t i = 0; i < N; i++) {
+            mqtt_summary_t s = summary(i);
+            total += mqtt_encode_summary(&s, json, sizeof(json));
+        }
+        double t = (double)(TICKS() - t0);
+        if (t < t_json) t_json = t;
+        b_json = total / N;
+
+        total = 0;
+        t0 = TICKS();
+        for (uint32_t i = 0; i < N; i++) {
+            mqtt_summary_t s = summary(i);
+            total += telemetry_encode_summary(&s, (uint16_t)i, bin, sizeof(bin));
+        }
+        t = (double)(TICKS() - t0);
+        if (t < t_bin) t_bin = t;
+        b_bin = total / N;
+
+        mqtt_summary_t s = summary(7);
+        size_t len = telemetry_encode_summary(&s, 0, bin, sizeof(bin));
+        char label[MQTT_LABEL_MAX];
+        total = 0;
+        t0 = TICKS();
+        for (uint32_t i = 0; i < N; i++) {
+            mqtt_summary_t d;
+            total += telemetry_decode_summary(bin, len, &d, label) ? d.k : 0;
+        }
+        t = (double)(TICKS() - t0);
+        if (t < t_dec) t_dec = t;
+        sink = total;
+    }
+    printf("Summary (sensor/{id}/data):\n");
+    printf("  JSON    %4zu B  encode %7.1f %s\n", b_json, t_json / N, TICK_UNIT);
+    printf("  binary  %4zu B  encode %7.1f %s  decode %7.1f %s  (%.1fx smaller)\n",
+           b_bin, t_bin / N, TICK_UNIT, t_dec / N, TICK_UNIT, (double)b_json / b_bin);
+    printf("  per device per day at 10 s: %.1f KB JSON, %.1f KB binary\n\n",
+           b_json * 8640 / 1024.0, b_bin * 8640 / 1024.0);
+}
+
+static void make_vector(uint32_t i, int dim, float* f) {
+    for (int k = 0; k < dim; k++) f[k] = 2.0f + k + 0.3f * sinf(i * 0.05f + k) + 0.01f * (i % 7);
+}
+
+static void bench_features(int dim) {
+    float f[TELEMETRY_MAX_DIM];
+    const int batches = N / BATCH;
+    double t_json = 1e18, t_bin = 1e18, t_dec = 1e18;
+    size_t b_json = 0, b_bin = 0;
+
+    for (int rep = 0; rep < REPS; rep++) {
+        size_t total = 0;
+        unsigned long long t0 = TICKS();
+        for (uint32_t i = 0; i < (uint32_t)N; i++) {
+            make_vector(i, dim, f);
+            json_writer_t w;
+            json_begin(&w, json, sizeof(json));
+            json_str(&w, "device_id", "motor_01");
+            json_uint(&w, "timestamp", 100 * i);
+            json_int(&w, "cluster", (int32_t)(i % 3));
+            json_float(&w, "distance", 0.05f * (i % 9), MQTT_FLOAT_DECIMALS);
+            json_float_array(&w, "features", f, dim, MQTT_FLOAT_DECIMALS);
+            total += json_end(&w);
+        }
+        double t = (double)(TICKS() - t0);
+        if (t < t_json) t_json = t;
+        b_json = total;
+
+        total = 0;
+        t0 = TICKS();
+        for (int bi = 0; bi < batches; bi++) {
+            telemetry_batch_t b;
+            telemetry_batch_begin(&b, bin, sizeof(bin), (uint8_t)dim, (uint16_t)bi);
+            for (int j = 0; j < BATCH; j++) {
+                uint32_t i = (uint32_t)(bi * BATCH + j);
+                make_vector(i, dim, f);
+                telemetry_batch_add(&b, 100 * i, (int32_t)(i % 3), 0.05f * (i % 9), f);
+            }
+            total += telemetry_batch_finish(&b);
+        }
+        t = (double)(TICKS() - t0);
+        if (t < t_bin) t_bin = t;
+        b_bin = total;
+
+        // Decode the last batch repeatedly
+        telemetry_batch_t b;
+        telemetry_batch_begin(&b, bin, sizeof(bin), (uint8_t)dim, 0);
+        for (int j = 0; j < BATCH; j++) {
+            make_vector((uint32_t)j, dim, f);
+            telemetry_batch_add(&b, 100u * j, 0, 0.1f, f);
+        }
+        size_t len = telemetry_batch_finish(&b);
+        float acc = 0;
+        t0 = TICKS();
+        for (int bi = 0; bi < batches; bi++) {
+            telemetry_reader_t r;
+            telemetry_vector_t v;
+            telemetry_features_begin(&r, bin, len);
+            while (telemetry_features_next(&r, &v)) acc += v.features[0];
+        }
+        t = (double)(TICKS() - t0);
+        if (t < t_dec) t_dec = t;
+        sink = (size_t)acc;
+    }
+    printf("  D=%-2d  JSON %5.1f B/vec %6.1f %s/vec   binary %4.1f B/vec %6.1f %s/vec"
+           "  decode %5.1f %s/vec  (%.1fx smaller)\n",
+           dim, (double)b_json / N, t_json / N, TICK_UNIT, (double)b_bin / N, t_bin / N, TICK_UNIT,
+           t_dec / N, TICK_UNIT, (double)b_json / b_bin);
+}
+
+int main(void) {
+    printf("\n========================================\n");
+    printf("Binary Telemetry vs JSON Benchmark\n");
+    printf("========================================\n\n");
+    bench_summary();
+    printf("Feature vectors (batches of %d, %d decimals):\n", BATCH, TELEMETRY_DECIMALS);
+    bench_features(3);
+    bench_features(7);
+    bench_features(10);
+    printf("\n");
+    return 0;
+}
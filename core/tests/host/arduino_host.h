@@ -0,0 +1,81 @@
+/**
+ * @file arduino_host.h
+ * @brief Minimal Arduino API for building firmware headers on Linux
+ *
+ * Enough of Arduino.h for feature_extractor.h: Serial, analogRead, delay,
+ * millis/micros. Time is virtual: delay() advances the clock instead of
+ * sleeping, so calibration waits cost nothing in tests. analogRead() returns
+ * whatever host_analog_source() supplies (0 when unset).
+ *
+ * Feature schema comes from -DFEATURE_SCHEMA_* instead of config.h.
+ */
+
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+typedef uint8_t byte;
+
+// Pins from config.template.h
+#ifndef ADC_CURRENT_L1
+  #define ADC_CURRENT_L1 1
+  #define ADC_CURRENT_L2 2
+  #define ADC_CURRENT_L3 3
+#endif
+
+// =============================================================================
+// TIME (virtual)
+// =============================================================================
+
+static uint64_t host_delay_us = 0;  // Added by delay()/delayMicroseconds()
+
+static inline uint64_t host_now_us() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000 + host_delay_us;
+}
+
+static inline unsigned long micros() { return (unsigned long)host_now_us(); }
+static inline unsigned long millis() { return (unsigned long)(host_now_us() / 1000); }
+static inline void delay(unsigned long ms) { host_delay_us += (uint64_t)ms * 1000; }
+static inline void delayMicroseconds(unsigned int us) { host_delay_us += us; }
+
+// =============================================================================
+// ADC
+// =============================================================================
+
+typedef int (*host_analog_fn)(int pin);
+static host_analog_fn host_analog = nullptr;
+
+static inline void host_analog_source(host_analog_fn fn) { host_analog = fn; }
+static inline int analogRead(int pin) { return host_analog ? host_analog(pin) : 0; }
+
+// =============================================================================
+// SERIAL
+// =============================================================================
+
+class HostSerial {
+public:
+  bool quiet = false;  // Tests silence calibration chatter
+
+  void begin(unsigned long) {}
+  void print(const char* s) { if (!quiet) fputs(s, stdout); }
+  void println(const char* s = "") { if (!quiet) puts(s); }
+  void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    if (quiet) return;
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+  }
+};
+
+static HostSerial Serial;
+
+#endif
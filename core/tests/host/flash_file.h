@@ -0,0 +1,143 @@
+/**
+ * @file flash_file.h
+ * @brief File-backed flash_region_t for host tests (header-only)
+ *
+ * The region is a regular file, so it survives "reboots" (re-mounting in
+ * the same test) and can be inspected or corrupted from outside. Flash
+ * rules are enforced: a write that would set a 0 bit back to 1 fails the
+ * test, as it would silently corrupt data on NOR flash.
+ *
+ * Fault injection: after `fail_after_bytes` more bytes have been written,
+ * the write in progress is cut at that byte and every later write or erase
+ * fails, like power lost mid-write. With tear_erases set, erased bytes
+ * count against the same budget and a cut erase leaves the rest of the
+ * sector's old contents. Counters report erases per sector.
+ */
+
+#ifndef FLASH_FILE_H
+#define FLASH_FILE_H
+
+#include "../../flash_region.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define FLASH_FILE_MAX_SECTORS 256
+
+typedef struct {
+    FILE* fp;
+    long fail_after_bytes;   // -1: never
+    bool dead;               // Power lost: all further writes/erases fail
+    bool tear_erases;        // Erases can be cut too (bytes_erased counts them)
+    uint32_t bytes_written;
+    uint32_t bytes_erased;
+    uint32_t erases[FLASH_FILE_MAX_SECTORS];
+    flash_region_t region;
+} flash_file_t;
+
+static bool flash_file_read(uint32_t offset, void* buf, uint32_t len, void* ctx) {
+    flash_file_t* f = (flash_file_t*)ctx;
+    if ((uint64_t)offset + len > f->region.size) return false;
+    if (fseek(f->fp, (long)offset, SEEK_SET) != 0) return false;
+    return fread(buf, 1, len, f->fp) == len;
+}
+
+static bool flash_file_write(uint32_t offset, const void* buf, uint32_t len, void* ctx) {
+    flash_file_t* f = (flash_file_t*)ctx;
+    if (f->dead || (uint64_t)offset + len > f->region.size) return false;
+
+    uint8_t old[512];
+    const uint8_t* src = (const uint8_t*)buf;
+    for (uint32_t done = 0; done < len;) {
+        uint32_t n = len - done < sizeof(old) ? len - done : (uint32_t)sizeof(old);
+        assert(flash_file_read(offset + done, old, n, ctx));
+        for (uint32_t i = 0; i < n; i++) {
+            assert((old[i] & src[done + i]) == src[done + i] && "write sets a cleared bit");
+        }
+        done += n;
+    }
+
+    uint32_t n = len;
+    if (f->fail_after_bytes >= 0 && (long)len > f->fail_after_bytes) {
+        n = (uint32_t)f->fail_after_bytes;
+        f->dead = true;
+    }
+    if (f->fail_after_bytes >= 0) f->fail_after_bytes -= n;
+    if (n > 0) {
+        if (fseek(f->fp, (long)offset, SEEK_SET) != 0) return false;
+        if (fwrite(src, 1, n, f->fp) != n) return false;
+        fflush(f->fp);
+    }
+    f->bytes_written += n;
+    return !f->dead;
+}
+
+static bool flash_file_erase(uint32_t offset, uint32_t len, void* ctx) {
+    flash_file_t* f = (flash_file_t*)ctx;
+    uint32_t ss = f->region.sector_size;
+    assert(offset % ss == 0 && len % ss == 0);
+    if (f->dead || (uint64_t)offset + len > f->region.size) return false;
+
+    uint32_t cut = len;
+    if (f->tear_erases && f->fail_after_bytes >= 0) {
+        if ((long)len > f->fail_after_bytes) {
+            cut = (uint32_t)f->fail_after_bytes;
+            f->dead = true;
+        }
+        f->fail_after_bytes -= cut;
+    }
+    uint8_t ff[256];
+    memset(ff, FLASH_ERASED, sizeof(ff));
+    if (fseek(f->fp, (long)offset, SEEK_SET) != 0) return false;
+    for (uint32_t done = 0; done < cut; done += sizeof(ff)) {
+        uint32_t n = cut - done < sizeof(ff) ? cut - done : (uint32_t)sizeof(ff);
+        if (fwrite(ff, 1, n, f->fp) != n) return false;
+    }
+    fflush(f->fp);
+    f->bytes_erased += cut;
+    if (f->dead) return false;
+    for (uint32_t s = offset / ss; s < (offset + len) / ss && s < FLASH_FILE_MAX_SECTORS; s++) {
+        f->erases[s]++;
+    }
+    return true;
+}
+
+// Opens (or creates, erased) a region of sectors x sector_size bytes
+static bool flash_file_open(flash_file_t* f, const char* path, uint32_t sectors,
+                            uint32_t sector_size) {
+    memset(f, 0, sizeof(*f));
+    f->fail_after_bytes = -1;
+    f->fp = fopen(path, "r+b");
+    bool fresh = false;
+    if (!f->fp) {
+        f->fp = fopen(path, "w+b");
+        fresh = true;
+    }
+    if (!f->fp) return false;
+    f->region.read = flash_file_read;
+    f->region.write = flash_file_write;
+    f->region.erase = flash_file_erase;
+    f->region.ctx = f;
+    f->region.size = sectors * sector_size;
+    f->region.sector_size = sector_size;
+    if (fresh) {
+        if (!flash_file_erase(0, f->region.size, f)) return false;
+        memset(f->erases, 0, sizeof(f->erases));
+        f->bytes_erased = 0;
+    }
+    return true;
+}
+
+static void flash_file_close(flash_file_t* f) {
+    if (f->fp) fclose(f->fp);
+    f->fp = NULL;
+}
+
+// Simulated power loss after n more bytes (-1 to disarm and "power up")
+static void flash_file_fail_after(flash_file_t* f, long n) {
+    f->fail_after_bytes = n;
+    f->dead = false;
+}
+
+#endif
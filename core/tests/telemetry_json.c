@@ -0,0 +1,125 @@
+/**
+ * @file telemetry_json.c
+ * @brief Convert binary telemetry frames back to MQTT schema v2 JSON
+ *
+ * Reads back-to-back frames (one MQTT payload per frame, e.g. captured with
+ * `mosquitto_sub -t 'sensor/+/bin' -N > capture.bin`) and prints one JSON
+ * object per line: summaries exactly as the data topic, feature vectors as
+ * {"device_id","timestamp","cluster","distance","features":[...]}.
+ * Corrupt bytes are skipped until the next valid frame.
+ *
+ *   ./telemetry_json [--device ID] [file ...]     (stdin when no file)
+ */
+
+#include "../telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* device_id = "unknown";
+static unsigned long frames = 0, skipped = 0, vectors = 0;
+
+static void print_summary(const uint8_t* frame, size_t len) {
+    mqtt_summary_t s;
+    char label[MQTT_LABEL_MAX];
+    char json[1024];
+    if (!telemetry_decode_summary(frame, len, &s, label)) {
+        fprintf(stderr, "telemetry_json: bad summary body\n");
+        return;
+    }
+    s.device_id = device_id;
+    if (mqtt_encode_summary(&s, json, sizeof(json))) puts(json);
+}
+
+static void print_features(const uint8_t* frame, size_t len) {
+    telemetry_reader_t r;
+    telemetry_vector_t v;
+    char json[1024];
+    if (!telemetry_features_begin(&r, frame, len)) {
+        fprintf(stderr, "telemetry_json: bad feature batch\n");
+        return;
+    }
+    while (telemetry_features_next(&r, &v)) {
+        json_writer_t w;
+        json_begin(&w, json, sizeof(json));
+        json_str(&w, "device_id", device_id);
+        json_uint(&w, "timestamp", v.timestamp);
+        json_int(&w, "cluster", v.cluster);
+        json_float(&w, "distance", v.distance, MQTT_FLOAT_DECIMALS);
+        json_float_array(&w, "features", v.features, r.dim, MQTT_FLOAT_DECIMALS);
+        if (json_end(&w)) puts(json);
+        vectors++;
+    }
+    if (r.index != r.count) fprintf(stderr, "telemetry_json: batch cut short at %u/%u\n", r.index, r.count);
+}
+
+static void convert(const uint8_t* data, size_t len) {
+    size_t off = 0;
+    while (off + TELEMETRY_OVERHEAD <= len) {
+        telemetry_header_t h;
+        size_t frame_len;
+        if (!telemetry_check(data + off, len - off, &h, &frame_len)) {
+            off++;  // Resync on the next magic byte
+            skipped++;
+            continue;
+        }
+        if (h.type == TELEMETRY_SUMMARY) print_summary(data + off, frame_len);
+        else if (h.type == TELEMETRY_FEATURES) print_features(data + off, frame_len);
+        else fprintf(stderr, "telemetry_json: unknown frame type %u\n", h.type);
+        frames++;
+        off += frame_len;
+    }
+    skipped += len - off;
+}
+
+static uint8_t* read_all(FILE* f, size_t* len) {
+    size_t cap = 1 << 16, n = 0;
+    uint8_t* buf = (uint8_t*)malloc(cap);
+    size_t got;
+    while (buf && (got = fread(buf + n, 1, cap - n, f)) > 0) {
+        n += got;
+        if (n == cap) {
+            uint8_t* bigger = (uint8_t*)realloc(buf, cap *= 2);
+            if (!bigger) { free(buf); return NULL; }
+            buf = bigger;
+        }
+    }
+    *len = n;
+    return buf;
+}
+
+int main(int argc, char** argv) {
+    int files = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--device") == 0 && i + 1 < argc) {
+            device_id = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            fprintf(stderr, "usage: %s [--device ID] [file ...]\n", argv[0]);
+            return 0;
+        }
+        FILE* f = fopen(argv[i], "rb");
+        if (!f) {
+            perror(argv[i]);
+            return 1;
+        }
+        size_t len;
+        uint8_t* data = read_all(f, &len);
+        fclose(f);
+        if (!data) return 1;
+        convert(data, len);
+        free(data);
+        files++;
+    }
+    if (files == 0) {
+        size_t len;
+        uint8_t* data = read_all(stdin, &len);
+        if (!data) return 1;
+        convert(data, len);
+        free(data);
+    }
+    fprintf(stderr, "telemetry_json: %lu frames, %lu vectors, %lu bytes skipped\n",
+            frames, vectors, skipped);
+    return skipped ? 2 : 0;
+}
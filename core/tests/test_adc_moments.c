@@ -0,0 +1,127 @@
+/**
+ * @file test_adc_moments.c
+ * @brief Block-merged single-pass moments vs two-pass double reference
+ */
+
+#include "../adc_moments.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define N 3000
+
+static uint16_t samples[N * 3];
+
+// Two passes in double, like the original measureRawRMS()
+static void reference(const uint16_t* x, int n, int stride, double* mean, double* rms) {
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += x[i * stride];
+    *mean = sum / n;
+    double sum_sq = 0;
+    for (int i = 0; i < n; i++) {
+        double d = x[i * stride] - *mean;
+        sum_sq += d * d;
+    }
+    *rms = sqrt(sum_sq / n);
+}
+
+TEST(empty_and_constant) {
+    adc_moments_t m;
+    adc_moments_reset(&m);
+    assert(adc_moments_rms(&m) == 0 && adc_moments_variance(&m) == 0);
+    adc_moments_add_block(&m, samples, 0, 1);
+    assert(m.n == 0);
+
+    for (int i = 0; i < 500; i++) samples[i] = 2048;
+    adc_moments_add_block(&m, samples, 200, 1);
+    adc_moments_add_block(&m, samples + 200, 300, 1);
+    assert(m.n == 500);
+    assert(adc_moments_mean(&m) == 2048.0f);
+    assert(adc_moments_rms(&m) == 0.0f);
+}
+
+TEST(single_block_exact) {
+    // {0, 4} * 50: mean 2, rms 2
+    for (int i = 0; i < 100; i++) samples[i] = (i % 2) ? 4 : 0;
+    adc_moments_t m;
+    adc_moments_reset(&m);
+    adc_moments_add_block(&m, samples, 100, 1);
+    assert(adc_moments_mean(&m) == 2.0f);
+    assert(adc_moments_rms(&m) == 2.0f);
+}
+
+TEST(merged_blocks_match_reference) {
+    // Sine on a 12-bit midpoint plus noise, uneven block sizes
+    srand(5);
+    for (int i = 0; i < N; i++) {
+        samples[i] = (uint16_t)(2048 + 600 * sin(2 * 3.14159265358979 * i / 20) + rand() % 21 - 10);
+    }
+    double mean, rms;
+    reference(samples, N, 1, &mean, &rms);
+
+    int sizes[] = {1, 7, 100, 333, 1000, 4096};
+    for (int s = 0; s < 6; s++) {
+        adc_moments_t m;
+        adc_moments_reset(&m);
+        for (int i = 0; i < N; i += sizes[s]) {
+            int n = (N - i < sizes[s]) ? N - i : sizes[s];
+            adc_moments_add_block(&m, samples + i, n, 1);
+        }
+        assert(m.n == N);
+        assert(fabs(adc_moments_mean(&m) - mean) < 1e-3 * mean);
+        assert(fabs(adc_moments_rms(&m) - rms) < 1e-3 * rms);
+    }
+}
+
+TEST(interleaved_channels) {
+    // Three phases 120 degrees apart, different amplitudes and offsets
+    const double amp[3] = {400, 800, 50}, dc[3] = {2000, 2100, 1900};
+    for (int i = 0; i < N; i++) {
+        for (int k = 0; k < 3; k++) {
+            double ph = 2 * 3.14159265358979 * (i / 20.0 + k / 3.0);
+            samples[3 * i + k] = (uint16_t)lround(dc[k] + amp[k] * sin(ph));
+        }
+    }
+    for (int k = 0; k < 3; k++) {
+        double mean, rms;
+        reference(samples + k, N, 3, &mean, &rms);
+        adc_moments_t m;
+        adc_moments_reset(&m);
+        for (int i = 0; i < N; i += 100) adc_moments_add_block(&m, samples + 3 * i + k, 100, 3);
+        assert(fabs(adc_moments_mean(&m) - mean) < 1e-2);
+        assert(fabs(adc_moments_rms(&m) - rms) < 1e-3 * rms);
+        assert(fabs(rms - amp[k] / sqrt(2)) < 1.0);
+    }
+}
+
+TEST(full_scale_block_no_overflow) {
+    // Largest allowed block of 16-bit codes alternating 0 / 65535
+    static uint16_t big[ADC_MOMENTS_MAX_BLOCK];
+    for (int i = 0; i < ADC_MOMENTS_MAX_BLOCK; i++) big[i] = (i % 2) ? 65535 : 0;
+    adc_moments_t m;
+    adc_moments_reset(&m);
+    adc_moments_add_block(&m, big, ADC_MOMENTS_MAX_BLOCK, 1);
+    assert(fabsf(adc_moments_mean(&m) - 32767.5f) < 0.01f);
+    assert(fabsf(adc_moments_rms(&m) - 32767.5f) < 1.0f);
+}
+
+int main() {
+    printf("\n=== ADC Moments Tests ===\n\n");
+
+    RUN_TEST(empty_and_constant);
+    RUN_TEST(single_block_exact);
+    RUN_TEST(merged_blocks_match_reference);
+    RUN_TEST(interleaved_channels);
+    RUN_TEST(full_scale_block_no_overflow);
+
+    printf("\n✓ All ADC moments tests passed\n\n");
+    return 0;
+}
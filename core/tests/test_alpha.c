@@ -0,0 +1,192 @@
+/**
+ * @file test_alpha.c
+ * @brief Integer learning-rate schedules vs the original float path
+ */
+
+#include "../streaming_kmeans.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define D 3
+#define CAP 100
+
+static uint64_t storage[KMEANS_STORAGE_SIZE(4, D, CAP) / 8];
+
+static const float rates[] = {0.01f, 0.05f, 0.1f, 0.2f, 0.3f, 0.5f, 1.0f};
+#define NUM_RATES (sizeof(rates) / sizeof(rates[0]))
+
+// Pre-change alpha computation, kept as the reference
+static fixed_t float_alpha(fixed_t lr, uint32_t count) {
+    float decay = 1.0f + 0.01f * count;
+    float alpha_f = FIXED_TO_FLOAT(lr) / decay;
+    return FLOAT_TO_FIXED(alpha_f);
+}
+
+static void init_model(kmeans_model_t* model, float lr) {
+    assert(kmeans_init_with_storage(model, D, lr, 4, CAP, storage, sizeof(storage)));
+}
+
+TEST(decay_matches_exact_division) {
+    // LUT range must equal plain integer division, bit for bit
+    kmeans_model_t model;
+    for (size_t r = 0; r < NUM_RATES; r++) {
+        init_model(&model, rates[r]);
+        uint32_t n = (uint32_t)model.learning_rate * 100u;
+        for (uint32_t c = 0; c < 5000; c++) {
+            assert(kmeans_alpha(&model, c) == (fixed_t)(n / (100u + c)));
+        }
+    }
+}
+
+TEST(decay_past_lut_and_large_rates) {
+    // 32-bit divide past the table, 64-bit fallback once lr * 100 overflows
+    static const uint32_t counts[] = {5000, 123456, 1000000000u, UINT32_MAX - 100u, UINT32_MAX};
+    static const float big_rates[] = {0.2f, 600.0f, 700.0f, 30000.0f};
+    kmeans_model_t model;
+    for (size_t r = 0; r < sizeof(big_rates) / sizeof(big_rates[0]); r++) {
+        init_model(&model, big_rates[r]);
+        uint64_t n = (uint64_t)(uint32_t)model.learning_rate * 100u;
+        for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+            uint64_t denom = counts[i] > UINT32_MAX - 100u ? UINT32_MAX : counts[i] + 100u;
+            assert(kmeans_alpha(&model, counts[i]) == (fixed_t)(n / denom));
+        }
+    }
+}
+
+TEST(decay_close_to_float) {
+    kmeans_model_t model;
+    int worst = 0;
+    for (size_t r = 0; r < NUM_RATES; r++) {
+        init_model(&model, rates[r]);
+        for (uint32_t c = 0; c < 200000; c++) {
+            int diff = abs(kmeans_alpha(&model, c) - float_alpha(model.learning_rate, c));
+            if (diff > worst) worst = diff;
+        }
+    }
+    printf(" (max |int - float| = %d LSB)", worst);
+    assert(worst <= 1);
+}
+
+TEST(centroid_drift_vs_float) {
+    // Same EMA update fed by both alpha paths; trajectories must stay together
+    kmeans_model_t model;
+    init_model(&model, 0.2f);
+
+    fixed_t c_int = 0, c_flt = 0;
+    int32_t worst = 0;
+    uint32_t rng = 7;
+    for (uint32_t count = 0; count < 100000; count++) {
+        rng = 1103515245u * rng + 12345u;
+        fixed_t x = FLOAT_TO_FIXED(2.0f) + (fixed_t)((rng >> 8) % 131072) - 65536;  // 2.0 +- 1.0
+        c_int += FIXED_MUL(kmeans_alpha(&model, count), x - c_int);
+        c_flt += FIXED_MUL(float_alpha(model.learning_rate, count), x - c_flt);
+        int32_t diff = abs(c_int - c_flt);
+        if (diff > worst) worst = diff;
+    }
+    printf(" (max drift = %d LSB = %.6f)", worst, FIXED_TO_FLOAT(worst));
+    assert(worst < FLOAT_TO_FIXED(0.001f));
+}
+
+TEST(decay_monotonic) {
+    kmeans_model_t model;
+    init_model(&model, 0.3f);
+    fixed_t prev = kmeans_alpha(&model, 0);
+    assert(prev == model.learning_rate);
+    for (uint32_t c = 1; c < 100000; c++) {
+        fixed_t a = kmeans_alpha(&model, c);
+        assert(a <= prev);
+        prev = a;
+    }
+    assert(kmeans_alpha(&model, UINT32_MAX) == 0);
+}
+
+TEST(pow2_schedule) {
+    kmeans_model_t model;
+    init_model(&model, 0.2f);
+    assert(kmeans_set_alpha_schedule(&model, ALPHA_SCHEDULE_POW2));
+
+    fixed_t lr = model.learning_rate;
+    assert(kmeans_alpha(&model, 0) == lr);
+    assert(kmeans_alpha(&model, 99) == lr);
+    assert(kmeans_alpha(&model, 100) == lr >> 1);
+    assert(kmeans_alpha(&model, 299) == lr >> 1);
+    assert(kmeans_alpha(&model, 300) == lr >> 2);
+    assert(kmeans_alpha(&model, 700) == lr >> 3);
+    assert(kmeans_alpha(&model, UINT32_MAX) == lr >> 25);
+}
+
+TEST(constant_schedule) {
+    kmeans_model_t model;
+    init_model(&model, 0.2f);
+    assert(kmeans_set_alpha_schedule(&model, ALPHA_SCHEDULE_CONSTANT));
+    assert(kmeans_alpha(&model, 0) == model.learning_rate);
+    assert(kmeans_alpha(&model, 123456) == model.learning_rate);
+}
+
+TEST(schedule_selection) {
+    kmeans_model_t model;
+    init_model(&model, 0.2f);
+    assert(model.alpha_schedule == ALPHA_SCHEDULE_DECAY);
+    assert(!kmeans_set_alpha_schedule(&model, (alpha_schedule_t)42));
+    assert(model.alpha_schedule == ALPHA_SCHEDULE_DECAY);
+
+    // Survives reset
+    assert(kmeans_set_alpha_schedule(&model, ALPHA_SCHEDULE_POW2));
+    kmeans_reset(&model);
+    assert(model.alpha_schedule == ALPHA_SCHEDULE_POW2);
+}
+
+TEST(schedule_changes_training) {
+    // 100 samples after a baseline shift: constant alpha has caught up, decay lags
+    kmeans_model_t model;
+    fixed_t p[D], c[D];
+    fixed_t final[2];
+    alpha_schedule_t schedules[2] = {ALPHA_SCHEDULE_DECAY, ALPHA_SCHEDULE_CONSTANT};
+
+    for (int s = 0; s < 2; s++) {
+        init_model(&model, 0.1f);
+        kmeans_set_alpha_schedule(&model, schedules[s]);
+        model.outlier_threshold = FLOAT_TO_FIXED(1000.0f);  // No outliers, pure training
+        uint32_t rng = 3;
+        for (int i = 0; i < 1100; i++) {
+            float base = i < 1000 ? 1.0f : 1.2f;
+            for (int d = 0; d < D; d++) {
+                rng = 1103515245u * rng + 12345u;
+                p[d] = FLOAT_TO_FIXED(base) + (fixed_t)((rng >> 8) % 13108) - 6554;  // +-0.1
+            }
+            kmeans_update(&model, p);
+        }
+        assert(model.k == 1 && model.state == STATE_NORMAL);
+        assert(kmeans_get_centroid(&model, 0, c));
+        final[s] = c[0];
+    }
+    assert(final[1] > FLOAT_TO_FIXED(1.17f));
+    assert(final[0] < FLOAT_TO_FIXED(1.15f));
+    assert(final[0] < final[1]);
+}
+
+int main() {
+    printf("=== Alpha Schedule Tests ===\n");
+
+    RUN_TEST(decay_matches_exact_division);
+    RUN_TEST(decay_past_lut_and_large_rates);
+    RUN_TEST(decay_close_to_float);
+    RUN_TEST(centroid_drift_vs_float);
+    RUN_TEST(decay_monotonic);
+    RUN_TEST(pow2_schedule);
+    RUN_TEST(constant_schedule);
+    RUN_TEST(schedule_selection);
+    RUN_TEST(schedule_changes_training);
+
+    printf("\n=== All Tests Passed ===\n");
+    return 0;
+}
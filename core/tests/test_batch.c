@@ -0,0 +1,156 @@
+/**
+ * @file test_batch.c
+ * @brief kmeans_update_batch() must match sequential kmeans_update() calls
+ */
+
+#include "../streaming_kmeans.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define K 8
+#define D 3
+#define CAP 100
+#define N 2000
+
+static uint64_t storage_a[KMEANS_STORAGE_SIZE(K, D, CAP) / 8];
+static uint64_t storage_b[KMEANS_STORAGE_SIZE(K, D, CAP) / 8];
+static fixed_t points[N * D];
+
+// Baseline around 1.0 with fault bursts around 6.0
+static void make_stream(void) {
+    uint32_t rng = 42;
+    for (int i = 0; i < N; i++) {
+        float base = ((i / 300) % 2 == 1 && i % 300 < 40) ? 6.0f : 1.0f;
+        for (int d = 0; d < D; d++) {
+            rng = 1103515245u * rng + 12345u;
+            points[i * D + d] = FLOAT_TO_FIXED(base) + (fixed_t)((rng >> 8) % 13108) - 6554;
+        }
+    }
+}
+
+static void init_pair(kmeans_model_t* a, kmeans_model_t* b) {
+    assert(kmeans_init_with_storage(a, D, 0.2f, K, CAP, storage_a, sizeof(storage_a)));
+    assert(kmeans_init_with_storage(b, D, 0.2f, K, CAP, storage_b, sizeof(storage_b)));
+}
+
+static void assert_same_model(const kmeans_model_t* a, const kmeans_model_t* b) {
+    assert(a->k == b->k);
+    assert(a->state == b->state);
+    assert(a->total_points == b->total_points);
+    assert(a->last_distance == b->last_distance);
+    assert(a->alarm_active == b->alarm_active);
+    assert(a->normal_streak == b->normal_streak);
+    assert(a->buffer.count == b->buffer.count);
+    assert(a->buffer.head == b->buffer.head);
+    for (uint8_t c = 0; c < a->k; c++) {
+        fixed_t ca[D], cb[D];
+        kmeans_get_centroid(a, c, ca);
+        kmeans_get_centroid(b, c, cb);
+        assert(memcmp(ca, cb, sizeof(ca)) == 0);
+        assert(a->clusters[c].count == b->clusters[c].count);
+        assert(a->clusters[c].inertia == b->clusters[c].inertia);
+    }
+}
+
+TEST(matches_sequential) {
+    kmeans_model_t seq, bat;
+    init_pair(&seq, &bat);
+
+    static int8_t expected[N], got[N];
+    for (int i = 0; i < N; i++) expected[i] = kmeans_update(&seq, &points[i * D]);
+
+    size_t consumed = kmeans_update_batch(&bat, points, N, got);
+
+    assert(consumed == N);
+    assert(memcmp(expected, got, sizeof(expected)) == 0);
+    assert_same_model(&seq, &bat);
+}
+
+TEST(matches_sequential_in_chunks) {
+    kmeans_model_t seq, bat;
+    init_pair(&seq, &bat);
+
+    static int8_t expected[N], got[N];
+    for (int i = 0; i < N; i++) expected[i] = kmeans_update(&seq, &points[i * D]);
+
+    // Odd chunk sizes straddle bootstrap and alarm transitions
+    size_t done = 0;
+    while (done < N) {
+        size_t n = (N - done < 37) ? N - done : 37;
+        assert(kmeans_update_batch(&bat, &points[done * D], n, &got[done]) == n);
+        done += n;
+    }
+
+    assert(memcmp(expected, got, sizeof(expected)) == 0);
+    assert_same_model(&seq, &bat);
+}
+
+TEST(stops_at_freeze) {
+    kmeans_model_t seq, bat;
+    init_pair(&seq, &bat);
+
+    // Motor stopped: the first outlier goes straight to WAITING_LABEL
+    for (int i = 0; i < IDLE_CONSECUTIVE_SAMPLES; i++) {
+        kmeans_update_motor_status(&seq, 0, 0);
+        kmeans_update_motor_status(&bat, 0, 0);
+    }
+    assert(!seq.motor_running && !bat.motor_running);
+
+    static int8_t expected[N], got[N];
+    size_t freeze_at = N;
+    for (int i = 0; i < N; i++) {
+        expected[i] = kmeans_update(&seq, &points[i * D]);
+        if (freeze_at == N && seq.state == STATE_WAITING_LABEL) freeze_at = i + 1;
+    }
+    assert(freeze_at < N);
+
+    memset(got, 0x7f, sizeof(got));
+    size_t consumed = kmeans_update_batch(&bat, points, N, got);
+
+    assert(consumed == freeze_at);
+    assert(memcmp(expected, got, sizeof(expected)) == 0);
+    assert(bat.state == STATE_WAITING_LABEL);
+    assert_same_model(&seq, &bat);
+}
+
+TEST(null_output) {
+    kmeans_model_t seq, bat;
+    init_pair(&seq, &bat);
+
+    for (int i = 0; i < N; i++) kmeans_update(&seq, &points[i * D]);
+    assert(kmeans_update_batch(&bat, points, N, NULL) == N);
+    assert_same_model(&seq, &bat);
+}
+
+TEST(uninitialized) {
+    kmeans_model_t model;
+    memset(&model, 0, sizeof(model));
+
+    int8_t out[4] = {0, 0, 0, 0};
+    assert(kmeans_update_batch(&model, points, 4, out) == 0);
+    for (int i = 0; i < 4; i++) assert(out[i] == -1);
+}
+
+int main() {
+    printf("=== Batch Update Tests ===\n");
+
+    make_stream();
+
+    RUN_TEST(matches_sequential);
+    RUN_TEST(matches_sequential_in_chunks);
+    RUN_TEST(stops_at_freeze);
+    RUN_TEST(null_output);
+    RUN_TEST(uninitialized);
+
+    printf("\n=== All Tests Passed ===\n");
+    return 0;
+}
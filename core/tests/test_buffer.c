@@ -0,0 +1,182 @@
+/**
+ * @file test_buffer.c
+ * @brief Ring buffer running sums and O(D) cluster construction
+ */
+
+#include "../streaming_kmeans.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define K 4
+#define D 3
+#define CAP 60
+
+static uint64_t storage[KMEANS_STORAGE_SIZE(K, D, CAP) / 8];
+static uint32_t rng = 1;
+
+static fixed_t noise(fixed_t span) {
+    rng = 1103515245u * rng + 12345u;
+    return (fixed_t)((rng >> 8) % (uint32_t)(2 * span + 1)) - span;
+}
+
+static void init_model(kmeans_model_t* model) {
+    assert(kmeans_init_with_storage(model, D, 0.2f, K, CAP, storage, sizeof(storage)));
+}
+
+// Brute-force sums over the rows currently held
+static void check_sums(const kmeans_model_t* model) {
+    for (int d = 0; d < D; d++) {
+        int64_t sum = 0, sum_sq = 0;
+        for (int i = 0; i < model->buffer.count; i++) {
+            fixed_t x = model->buffer.samples[i * D + d];
+            sum += x;
+            sum_sq += ((int64_t)x * x) >> FIXED_POINT_SHIFT;
+        }
+        assert(model->buffer.sum[d] == sum);
+        assert(model->buffer.sum_sq[d] == sum_sq);
+    }
+}
+
+// Exact mean / total variance the new cluster must get
+static void expected_cluster(const fixed_t* rows, int n, fixed_t* mean, fixed_t* inertia) {
+    int64_t total_var = 0;
+    for (int d = 0; d < D; d++) {
+        int64_t sum = 0, sum_sq = 0;
+        for (int i = 0; i < n; i++) {
+            sum += rows[i * D + d];
+            sum_sq += ((int64_t)rows[i * D + d] * rows[i * D + d]) >> FIXED_POINT_SHIFT;
+        }
+        int64_t m = sum / n;
+        int64_t var = sum_sq / n - ((m * m) >> FIXED_POINT_SHIFT);
+        if (var > 0) total_var += var;
+        mean[d] = (fixed_t)m;
+    }
+    *inertia = (fixed_t)total_var;
+}
+
+TEST(sums_track_wraparound) {
+    kmeans_model_t model;
+    init_model(&model);
+
+    // Buffer keeps filling in NORMAL and wraps many times
+    fixed_t p[D];
+    for (int i = 0; i < 10 * CAP; i++) {
+        for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(3.0f * d) + noise(FLOAT_TO_FIXED(0.2f));
+        kmeans_update(&model, p);
+        check_sums(&model);
+    }
+    assert(model.state != STATE_BOOTSTRAP);
+    assert(model.buffer.count == CAP);
+}
+
+TEST(bootstrap_mean_is_exact) {
+    kmeans_model_t model;
+    init_model(&model);
+
+    static fixed_t rows[BOOTSTRAP_SAMPLES * D];
+    for (int i = 0; i < BOOTSTRAP_SAMPLES; i++) {
+        // Values whose per-sample share (x / 50) truncates: the old method lost them
+        for (int d = 0; d < D; d++) rows[i * D + d] = FLOAT_TO_FIXED(1.0f) + 49 + noise(1000);
+        kmeans_update(&model, &rows[i * D]);
+    }
+    assert(model.k == 1 && model.state == STATE_NORMAL);
+
+    fixed_t mean[D], got[D], inertia;
+    expected_cluster(rows, BOOTSTRAP_SAMPLES, mean, &inertia);
+    kmeans_get_centroid(&model, 0, got);
+    assert(memcmp(mean, got, sizeof(mean)) == 0);
+    assert(model.clusters[0].inertia == inertia);
+    assert(model.clusters[0].count == BOOTSTRAP_SAMPLES);
+
+    // Buffer and its sums start over
+    assert(model.buffer.count == 0);
+    for (int d = 0; d < D; d++) assert(model.buffer.sum[d] == 0 && model.buffer.sum_sq[d] == 0);
+}
+
+TEST(add_cluster_from_window) {
+    kmeans_model_t model;
+    init_model(&model);
+
+    fixed_t p[D];
+    for (int i = 0; i < 200; i++) {
+        for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(1.0f) + noise(FLOAT_TO_FIXED(0.1f));
+        kmeans_update(&model, p);
+    }
+    for (int i = 0; i < IDLE_CONSECUTIVE_SAMPLES; i++) kmeans_update_motor_status(&model, 0, 0);
+    for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(8.0f) + noise(FLOAT_TO_FIXED(0.1f));
+    kmeans_update(&model, p);
+    assert(model.state == STATE_WAITING_LABEL);
+    check_sums(&model);
+
+    // Rows in ring order do not matter for mean/variance
+    fixed_t mean[D], got[D], inertia;
+    expected_cluster(model.buffer.samples, model.buffer.count, mean, &inertia);
+
+    assert(kmeans_add_cluster(&model, "fault"));
+    assert(model.k == 2);
+    kmeans_get_centroid(&model, 1, got);
+    assert(memcmp(mean, got, sizeof(mean)) == 0);
+    assert(model.clusters[1].inertia == inertia);
+    assert(model.clusters[1].inertia != FLOAT_TO_FIXED(1.0f));
+    for (int d = 0; d < D; d++) assert(model.buffer.sum[d] == 0);
+}
+
+TEST(variance_seed_tracks_spread) {
+    // Tight baseline gets a tight radius, wide baseline a wide one
+    kmeans_model_t model;
+    fixed_t p[D];
+    fixed_t inertia[2];
+    const fixed_t spans[2] = {FLOAT_TO_FIXED(0.05f), FLOAT_TO_FIXED(1.0f)};
+
+    for (int s = 0; s < 2; s++) {
+        init_model(&model);
+        for (int i = 0; i < BOOTSTRAP_SAMPLES; i++) {
+            for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(2.0f) + noise(spans[s]);
+            kmeans_update(&model, p);
+        }
+        inertia[s] = model.clusters[0].inertia;
+    }
+    // Uniform +-a: variance a^2/3 per dimension
+    assert(inertia[0] > 0 && inertia[0] < FLOAT_TO_FIXED(0.01f));
+    assert(inertia[1] > FLOAT_TO_FIXED(0.6f) && inertia[1] < FLOAT_TO_FIXED(1.4f));
+}
+
+TEST(discard_clears_sums) {
+    kmeans_model_t model;
+    init_model(&model);
+
+    fixed_t p[D];
+    for (int i = 0; i < 120; i++) {
+        for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(1.0f) + noise(FLOAT_TO_FIXED(0.1f));
+        kmeans_update(&model, p);
+    }
+    for (int i = 0; i < IDLE_CONSECUTIVE_SAMPLES; i++) kmeans_update_motor_status(&model, 0, 0);
+    for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(8.0f);
+    kmeans_update(&model, p);
+    assert(model.state == STATE_WAITING_LABEL);
+    kmeans_discard(&model);
+    assert(model.buffer.count == 0);
+    for (int d = 0; d < D; d++) assert(model.buffer.sum[d] == 0 && model.buffer.sum_sq[d] == 0);
+}
+
+int main() {
+    printf("=== Ring Buffer Sum Tests ===\n");
+
+    RUN_TEST(sums_track_wraparound);
+    RUN_TEST(bootstrap_mean_is_exact);
+    RUN_TEST(add_cluster_from_window);
+    RUN_TEST(variance_seed_tracks_spread);
+    RUN_TEST(discard_clears_sums);
+
+    printf("\n=== All Tests Passed ===\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test_distance.c
+ * @brief SIMD distance kernels must be bit-exact with the scalar reference
+ *
+ * Built three times by the Makefile (generic, -msse4.1, -mavx2); each build
+ * checks whichever kernel kmeans_distances() compiled to.
+ */
+
+#include "../kmeans_distance.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define STRIDE_MAX 24
+
+static uint32_t rng = 42;
+
+static fixed_t rand_fixed(fixed_t span) {
+    rng = 1103515245u * rng + 12345u;
+    uint32_t r = (rng >> 1) ^ (rng << 17);
+    return (fixed_t)(r % (2u * (uint32_t)span + 1u)) - span;
+}
+
+static void check(const fixed_t* point, const fixed_t* centroids,
+                  uint8_t k, uint8_t dim, uint8_t stride) {
+    fixed_t got[STRIDE_MAX], want[STRIDE_MAX];
+    memset(got, 0x55, sizeof(got));
+    kmeans_distances(point, centroids, k, dim, stride, got);
+    kmeans_distances_scalar(point, centroids, k, dim, stride, want);
+    assert(memcmp(got, want, k * sizeof(fixed_t)) == 0);
+    // Must not write past k
+    for (int c = k; c < STRIDE_MAX; c++) assert(got[c] == 0x55555555);
+}
+
+TEST(random_all_k) {
+    fixed_t point[MAX_FEATURES];
+    fixed_t centroids[MAX_FEATURES * STRIDE_MAX];
+
+    for (int trial = 0; trial < 200; trial++) {
+        for (uint8_t dim = 1; dim <= MAX_FEATURES; dim++) {
+            for (int i = 0; i < MAX_FEATURES * STRIDE_MAX; i++) centroids[i] = rand_fixed(FLOAT_TO_FIXED(8.0f));
+            for (int d = 0; d < dim; d++) point[d] = rand_fixed(FLOAT_TO_FIXED(8.0f));
+            for (uint8_t k = 1; k <= 20; k++) check(point, centroids, k, dim, STRIDE_MAX);
+        }
+    }
+}
+
+TEST(odd_strides) {
+    fixed_t point[MAX_FEATURES];
+    fixed_t centroids[MAX_FEATURES * STRIDE_MAX];
+
+    for (int i = 0; i < MAX_FEATURES * STRIDE_MAX; i++) centroids[i] = rand_fixed(FLOAT_TO_FIXED(100.0f));
+    for (int d = 0; d < MAX_FEATURES; d++) point[d] = rand_fixed(FLOAT_TO_FIXED(100.0f));
+
+    for (uint8_t stride = 1; stride <= STRIDE_MAX; stride++) {
+        for (uint8_t k = 1; k <= stride; k++) check(point, centroids, k, 3, stride);
+    }
+}
+
+TEST(extreme_values) {
+    // Opposite-sign INT32 extremes: diff does not fit int32, square not int64-safe signed
+    fixed_t point[MAX_FEATURES];
+    fixed_t centroids[MAX_FEATURES * 16];
+    const fixed_t vals[] = {INT32_MIN, INT32_MAX, 0, -1, 1, INT32_MIN + 1};
+
+    for (int i = 0; i < MAX_FEATURES * 16; i++) centroids[i] = vals[i % 6];
+    for (int d = 0; d < MAX_FEATURES; d++) point[d] = vals[(d * 5 + 1) % 6];
+
+    for (uint8_t dim = 1; dim <= MAX_FEATURES; dim++) {
+        for (uint8_t k = 1; k <= 16; k++) check(point, centroids, k, dim, 16);
+    }
+}
+
+TEST(matches_direct_formula) {
+    // Scalar reference equals the original per-element shift-then-sum
+    fixed_t point[4] = {FLOAT_TO_FIXED(1.0f), FLOAT_TO_FIXED(-2.0f), FLOAT_TO_FIXED(0.5f), 0};
+    fixed_t centroids[4 * 8];
+    for (int i = 0; i < 4 * 8; i++) centroids[i] = FLOAT_TO_FIXED(0.25f * (i % 8)) - FLOAT_TO_FIXED(1.0f);
+
+    fixed_t out[8];
+    kmeans_distances(point, centroids, 8, 4, 8, out);
+
+    for (int c = 0; c < 8; c++) {
+        int64_t sum = 0;
+        for (int d = 0; d < 4; d++) {
+            int64_t diff = (int64_t)point[d] - centroids[d * 8 + c];
+            sum += (diff * diff) >> FIXED_POINT_SHIFT;
+        }
+        assert(out[c] == (fixed_t)sum);
+    }
+}
+
+int main() {
+    printf("=== Distance Kernel Tests (%s) ===\n", kmeans_distance_kernel());
+
+    RUN_TEST(random_all_k);
+    RUN_TEST(odd_strides);
+    RUN_TEST(extreme_values);
+    RUN_TEST(matches_direct_formula);
+
+    printf("\n=== All Tests Passed ===\n");
+    return 0;
+}
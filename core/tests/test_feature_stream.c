@@ -0,0 +1,338 @@
+/**
+ * @file test_feature_stream.c
+ * @brief Batched feature streaming: framing, drop-oldest and spill backpressure
+ *
+ * A fake transport records every frame it accepts and can be "disconnected";
+ * a fake flash holds spilled frames. The last test reports the sustained
+ * samples/sec through add + poll.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../feature_stream.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define DIM 7
+#define MAX_VECTORS 4096
+
+static uint64_t storage[FEATURE_STREAM_STORAGE_SIZE(DIM, 64, 16) / 8 + 1];
+
+// =============================================================================
+// Fake transport: decodes what it accepts
+// =============================================================================
+
+typedef struct {
+    bool connected;
+    int fail_after;          // Refuse after this many frames (-1: never)
+    int frames;
+    size_t bytes;
+    uint16_t seqs[1024];
+    uint32_t times[MAX_VECTORS];
+    int vectors;
+} fake_link_t;
+
+static bool link_send(const uint8_t* frame, size_t len, void* ctx) {
+    fake_link_t* l = (fake_link_t*)ctx;
+    if (!l->connected || l->fail_after == 0) return false;
+    if (l->fail_after > 0) l->fail_after--;
+
+    telemetry_header_t h;
+    size_t frame_len;
+    assert(telemetry_check(frame, len, &h, &frame_len) && frame_len == len);
+    assert(h.type == TELEMETRY_FEATURES);
+    if (l->frames < 1024) l->seqs[l->frames] = h.seq;
+    l->frames++;
+    l->bytes += len;
+
+    telemetry_reader_t r;
+    telemetry_vector_t v;
+    assert(telemetry_features_begin(&r, frame, len));
+    assert(r.dim == DIM);
+    while (telemetry_features_next(&r, &v)) {
+        // Vector i was sent with timestamp 100*i, cluster i%3, features i + f/10
+        uint32_t i = v.timestamp / 100;
+        assert(v.cluster == (int32_t)(i % 3));
+        assert(fabsf(v.distance - 0.25f * (i % 4)) < 1e-3f);
+        for (int f = 0; f < DIM; f++) assert(fabsf(v.features[f] - (i + f * 0.1f)) < 2e-3f);
+        if (l->vectors < MAX_VECTORS) l->times[l->vectors] = v.timestamp;
+        l->vectors++;
+    }
+    assert(r.index == r.count);
+    return true;
+}
+
+static fake_link_t new_link(bool connected) {
+    fake_link_t l;
+    memset(&l, 0, sizeof(l));
+    l.connected = connected;
+    l.fail_after = -1;
+    return l;
+}
+
+static void add_vectors(feature_stream_t* s, uint32_t first, uint32_t n) {
+    float f[DIM];
+    for (uint32_t i = first; i < first + n; i++) {
+        for (int k = 0; k < DIM; k++) f[k] = i + k * 0.1f;
+        feature_stream_add(s, 100 * i, (int32_t)(i % 3), 0.25f * (i % 4), f);
+    }
+}
+
+// =============================================================================
+// Fake flash: a bounded FIFO of frames
+// =============================================================================
+
+#define FLASH_FRAMES 8
+
+typedef struct {
+    uint8_t data[FLASH_FRAMES][1024];
+    size_t len[FLASH_FRAMES];
+    int head, count;
+} fake_flash_t;
+
+static bool flash_write(const uint8_t* frame, size_t len, void* ctx) {
+    fake_flash_t* fl = (fake_flash_t*)ctx;
+    if (fl->count == FLASH_FRAMES || len > sizeof(fl->data[0])) return false;
+    int i = (fl->head + fl->count) % FLASH_FRAMES;
+    memcpy(fl->data[i], frame, len);
+    fl->len[i] = len;
+    fl->count++;
+    return true;
+}
+
+static size_t flash_peek(uint8_t* buf, size_t cap, void* ctx) {
+    fake_flash_t* fl = (fake_flash_t*)ctx;
+    if (fl->count == 0) return 0;
+    size_t len = fl->len[fl->head];
+    if (len <= cap) memcpy(buf, fl->data[fl->head], len);
+    return len;
+}
+
+static void flash_pop(void* ctx) {
+    fake_flash_t* fl = (fake_flash_t*)ctx;
+    fl->head = (fl->head + 1) % FLASH_FRAMES;
+    fl->count--;
+}
+
+static fake_flash_t flash;
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+TEST(init_validation) {
+    feature_stream_t s;
+    assert(!feature_stream_init(&s, 0, 10, 4, storage, sizeof(storage)));
+    assert(!feature_stream_init(&s, TELEMETRY_MAX_DIM + 1, 10, 4, storage, sizeof(storage)));
+    assert(!feature_stream_init(&s, DIM, 0, 4, storage, sizeof(storage)));
+    assert(!feature_stream_init(&s, DIM, 10, 0, storage, sizeof(storage)));
+    assert(!feature_stream_init(&s, DIM, 10, 4, NULL, sizeof(storage)));
+    assert(!feature_stream_init(&s, DIM, 10, 4, storage, FEATURE_STREAM_STORAGE_SIZE(DIM, 10, 4) - 1));
+    assert(feature_stream_init(&s, DIM, 10, 4, storage, FEATURE_STREAM_STORAGE_SIZE(DIM, 10, 4)));
+    assert(feature_stream_poll(&s, 10) == 0);  // No transport yet
+}
+
+TEST(batches_round_trip) {
+    feature_stream_t s;
+    fake_link_t link = new_link(true);
+    assert(feature_stream_init(&s, DIM, 10, 16, storage, sizeof(storage)));
+    feature_stream_set_transport(&s, link_send, &link);
+
+    add_vectors(&s, 0, 95);
+    assert(feature_stream_queued(&s) == 9);
+    assert(link.frames == 0);  // Nothing leaves until poll
+    assert(feature_stream_poll(&s, 100) == 9);
+    assert(feature_stream_queued(&s) == 0);
+    assert(link.vectors == 90);
+
+    // Partial batch goes out on seal
+    assert(feature_stream_seal(&s));
+    assert(!feature_stream_seal(&s));
+    assert(feature_stream_poll(&s, 100) == 1);
+    assert(link.vectors == 95);
+    for (int i = 0; i < 95; i++) assert(link.times[i] == 100u * i);
+    for (int i = 0; i < 10; i++) assert(link.seqs[i] == i);
+
+    assert(s.stats.vectors == 95 && s.stats.vectors_sent == 95 && s.stats.frames_sent == 10);
+    assert(s.stats.frames_dropped == 0);
+}
+
+TEST(refused_vector_seals_batch) {
+    // Real slots always fit batch_size vectors; shrink the open batch to force a refusal
+    feature_stream_t s;
+    fake_link_t link = new_link(true);
+    assert(feature_stream_init(&s, DIM, 10, 16, storage, sizeof(storage)));
+    feature_stream_set_transport(&s, link_send, &link);
+
+    add_vectors(&s, 0, 3);
+    s.batch.cap = s.batch.len + 2 + 1;  // CRC and one byte: no vector fits
+    add_vectors(&s, 3, 1);              // Seals 0..2, lands in a fresh batch
+    assert(feature_stream_queued(&s) == 1 && s.batch.count == 1);
+    add_vectors(&s, 4, 9);              // Second batch full at 3..12
+    assert(feature_stream_queued(&s) == 2 && s.batch.count == 0);
+
+    // Refused by an empty batch too: nothing to seal, so the vector is dropped
+    size_t cap = s.batch.cap;
+    s.batch.cap = s.batch.len + 2 + 1;
+    add_vectors(&s, 13, 1);
+    assert(feature_stream_queued(&s) == 2 && s.batch.count == 0);
+    s.batch.cap = cap;
+    add_vectors(&s, 14, 1);
+    assert(feature_stream_seal(&s));
+
+    assert(feature_stream_poll(&s, 100) == 3);
+    assert(link.vectors == 14);
+    for (int i = 0; i < 13; i++) assert(link.times[i] == 100u * i);
+    assert(link.times[13] == 1400);
+    assert(s.stats.vectors == 14 && s.stats.vectors_sent == 14 && s.stats.vectors_dropped == 1);
+}
+
+TEST(poll_limit_and_refusal) {
+    feature_stream_t s;
+    fake_link_t link = new_link(true);
+    assert(feature_stream_init(&s, DIM, 8, 16, storage, sizeof(storage)));
+    feature_stream_set_transport(&s, link_send, &link);
+    add_vectors(&s, 0, 80);
+    assert(feature_stream_poll(&s, 3) == 3);
+    assert(feature_stream_queued(&s) == 7);
+
+    // Publish fails mid-drain: the refused frame stays at the head
+    link.fail_after = 2;
+    assert(feature_stream_poll(&s, 100) == 2);
+    assert(feature_stream_queued(&s) == 5);
+    link.fail_after = -1;
+    assert(feature_stream_poll(&s, 100) == 5);
+    assert(link.vectors == 80);
+    for (int i = 0; i < 80; i++) assert(link.times[i] == 100u * i);
+}
+
+TEST(drop_oldest_when_disconnected) {
+    feature_stream_t s;
+    fake_link_t link = new_link(false);
+    assert(feature_stream_init(&s, DIM, 10, 4, storage, sizeof(storage)));
+    feature_stream_set_transport(&s, link_send, &link);
+
+    add_vectors(&s, 0, 100);  // 10 frames, room for 4
+    assert(feature_stream_poll(&s, 100) == 0);
+    assert(feature_stream_queued(&s) == 4);
+    assert(s.stats.frames_dropped == 6 && s.stats.vectors_dropped == 60);
+
+    link.connected = true;
+    assert(feature_stream_poll(&s, 100) == 4);
+    assert(link.vectors == 40);
+    for (int i = 0; i < 4; i++) assert(link.seqs[i] == 6 + i);  // Gap tells the receiver
+    assert(link.times[0] == 6000);
+}
+
+TEST(spill_to_flash_keeps_order) {
+    feature_stream_t s;
+    fake_link_t link = new_link(false);
+    memset(&flash, 0, sizeof(flash));
+    feature_stream_spill_t spill = {flash_write, flash_peek, flash_pop, &flash};
+    assert(feature_stream_init(&s, DIM, 10, 2, storage, sizeof(storage)));
+    feature_stream_set_transport(&s, link_send, &link);
+    feature_stream_set_spill(&s, &spill);
+
+    add_vectors(&s, 0, 100);  // 10 frames: 2 in RAM, 8 spilled
+    assert(feature_stream_queued(&s) == 2);
+    assert(s.stats.frames_spilled == 8 && s.stats.frames_dropped == 0);
+    assert(flash.count == FLASH_FRAMES);
+
+    link.connected = true;
+    assert(feature_stream_poll(&s, 100) == 10);
+    assert(link.vectors == 100);
+    for (int i = 0; i < 100; i++) assert(link.times[i] == 100u * i);
+    assert(flash.count == 0 && feature_stream_queued(&s) == 0);
+}
+
+TEST(spill_full_falls_back_to_drop) {
+    feature_stream_t s;
+    fake_link_t link = new_link(false);
+    memset(&flash, 0, sizeof(flash));
+    feature_stream_spill_t spill = {flash_write, flash_peek, flash_pop, &flash};
+    assert(feature_stream_init(&s, DIM, 10, 2, storage, sizeof(storage)));
+    feature_stream_set_transport(&s, link_send, &link);
+    feature_stream_set_spill(&s, &spill);
+
+    add_vectors(&s, 0, 130);  // 13 frames: 8 spilled, 3 dropped, 2 in RAM
+    assert(s.stats.frames_spilled == 8 && s.stats.frames_dropped == 3);
+
+    link.connected = true;
+    assert(feature_stream_poll(&s, 100) == 10);
+    // Frames 8..10 were dropped
+    for (int i = 0; i < 8; i++) assert(link.seqs[i] == i);
+    assert(link.seqs[8] == 11 && link.seqs[9] == 12);
+}
+
+TEST(corrupt_spilled_frame_skipped) {
+    feature_stream_t s;
+    fake_link_t link = new_link(false);
+    memset(&flash, 0, sizeof(flash));
+    feature_stream_spill_t spill = {flash_write, flash_peek, flash_pop, &flash};
+    assert(feature_stream_init(&s, DIM, 10, 2, storage, sizeof(storage)));
+    feature_stream_set_transport(&s, link_send, &link);
+    feature_stream_set_spill(&s, &spill);
+
+    add_vectors(&s, 0, 50);  // 3 spilled, 2 in RAM
+    assert(flash.count == 3);
+    flash.data[1][20] ^= 0x40;  // Bit rot in the second spilled frame
+
+    link.connected = true;
+    assert(feature_stream_poll(&s, 100) == 4);
+    assert(s.stats.frames_dropped == 1);
+    assert(link.vectors == 40);
+    assert(link.seqs[0] == 0 && link.seqs[1] == 2);
+}
+
+TEST(sustained_throughput) {
+    const uint32_t n = 2000000;
+    feature_stream_t s;
+    fake_link_t link = new_link(true);
+    assert(feature_stream_init(&s, DIM, 50, 4, storage, sizeof(storage)));
+    feature_stream_set_transport(&s, link_send, &link);
+
+    float f[DIM];
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t i = 0; i < n; i++) {
+        for (int k = 0; k < DIM; k++) f[k] = (i % 1000) + k * 0.1f;
+        feature_stream_add(&s, 100 * (i % 1000), (int32_t)((i % 1000) % 3),
+                           0.25f * ((i % 1000) % 4), f);
+        feature_stream_poll(&s, 1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+    assert(s.stats.vectors_sent == n && s.stats.frames_dropped == 0);
+    printf(" %.2f M samples/s incl. decode, %.1f B/sample (D=%d, batch 50)...",
+           n / sec / 1e6, (double)link.bytes / n, DIM);
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf("Feature Stream Tests\n");
+    printf("========================================\n\n");
+
+    RUN_TEST(init_validation);
+    RUN_TEST(batches_round_trip);
+    RUN_TEST(refused_vector_seals_batch);
+    RUN_TEST(poll_limit_and_refusal);
+    RUN_TEST(drop_oldest_when_disconnected);
+    RUN_TEST(spill_to_flash_keeps_order);
+    RUN_TEST(spill_full_falls_back_to_drop);
+    RUN_TEST(corrupt_spilled_frame_skipped);
+    RUN_TEST(sustained_throughput);
+
+    printf("\n✓ All feature stream tests passed\n");
+    return 0;
+}
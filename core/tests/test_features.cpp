@@ -0,0 +1,224 @@
+/**
+ * @file test_features.cpp
+ * @brief FeatureExtractor on the host, built once per FEATURE_SCHEMA_*
+ */
+
+// Whole sine periods and at least one impulse in every window
+#define VIB_WINDOW_SAMPLES 64
+
+#include "../feature_extractor.h"
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+static const double PI = 3.14159265358979323846;
+static const float G = 9.81f;
+
+#if defined(FEATURE_SCHEMA_FFT_CURRENT)
+  #define SCHEMA_NAME "FFT_CURRENT"
+  #define EXPECTED_DIM 10
+#elif defined(FEATURE_SCHEMA_FFT_ONLY)
+  #define SCHEMA_NAME "FFT_ONLY"
+  #define EXPECTED_DIM 6
+#elif defined(FEATURE_SCHEMA_TIME_CURRENT)
+  #define SCHEMA_NAME "TIME_CURRENT"
+  #define EXPECTED_DIM 7
+#else
+  #define SCHEMA_NAME "TIME_ONLY"
+  #define EXPECTED_DIM 3
+#endif
+
+// Sample i of a z-axis sine (period 8 samples) on top of gravity
+static void extract_sine(int i, float amp, float i1, float i2, float i3, float* f) {
+  float az = G + amp * (float)sin(2 * PI * i / 8);
+  #ifdef USE_FFT
+    FeatureExtractor::extract(0, 0, az, i1, i2, i3, FeatureExtractor::getFFTFrame(), f);
+  #else
+    FeatureExtractor::extract(0, 0, az, i1, i2, i3, NULL, f);
+  #endif
+}
+
+TEST(schema_dimension_and_names) {
+  assert(FeatureExtractor::getFeatureDim() == EXPECTED_DIM);
+  char names[EXPECTED_DIM][32];
+  FeatureExtractor::getFeatureNames(names);
+  assert(strcmp(names[0], "vib_rms") == 0);
+  assert(strcmp(names[2], "vib_crest") == 0);
+  #ifdef USE_FFT
+    assert(strcmp(names[3], "fft_peak_freq") == 0);
+  #endif
+  #ifdef USE_CURRENT
+    assert(strcmp(names[EXPECTED_DIM - 1], "current_rms") == 0);
+  #endif
+}
+
+TEST(gravity_is_removed) {
+  FeatureExtractor::reset();
+  float f[EXPECTED_DIM];
+  for (int i = 0; i < 500; i++) {
+    FeatureExtractor::extractSimple(0.1f, -0.2f, G, 0, 0, 0, f);
+  }
+  assert(f[0] < 1e-3f && f[1] < 1e-3f);
+  assert(fabsf(FeatureExtractor::getBaseline() - sqrtf(0.01f + 0.04f + G * G)) < 1e-3f);
+}
+
+TEST(sine_vibration_time_features) {
+  // |A sin| over whole periods: RMS = A / sqrt(2), peak = A, crest = sqrt(2)
+  FeatureExtractor::reset();
+  float f[EXPECTED_DIM];
+  const float amp = 2.0f;
+  for (int i = 0; i < 2000; i++) extract_sine(i, amp, 0, 0, 0, f);
+  assert(fabsf(f[0] - amp / sqrtf(2)) < 0.1f * amp);
+  assert(fabsf(f[1] - amp) < 0.1f * amp);
+  assert(fabsf(f[2] - sqrtf(2)) < 0.1f);
+}
+
+TEST(impulses_raise_crest) {
+  FeatureExtractor::reset();
+  float sine[EXPECTED_DIM], impulsive[EXPECTED_DIM];
+  for (int i = 0; i < 2000; i++) extract_sine(i, 1.0f, 0, 0, 0, sine);
+
+  FeatureExtractor::reset();
+  for (int i = 0; i < 2000; i++) {
+    float az = G + 0.2f * (float)sin(2 * PI * i / 8) + ((i % 40) == 0 ? 4.0f : 0.0f);
+    FeatureExtractor::extractSimple(0, 0, az, 0, 0, 0, impulsive);
+  }
+  assert(impulsive[2] > 2 * sine[2]);
+}
+
+#ifdef USE_FFT
+TEST(fft_sees_vibration_frequency) {
+  // Magnitude |sin| repeats twice per period: fs / 8 -> peak at fs / 4
+  FeatureExtractor::reset();
+  float f[EXPECTED_DIM];
+  for (int i = 0; i < FFT_SAMPLES - 1; i++) extract_sine(i, 1.0f, 0, 0, 0, f);
+  assert(f[3] == 0 && f[4] == 0);  // Frame not full yet
+
+  for (int i = FFT_SAMPLES - 1; i < 1000; i++) extract_sine(i, 1.0f, 0, 0, 0, f);
+  float bin_hz = (float)FFT_SAMPLE_FREQ / FFT_SAMPLES;
+  assert(fabsf(f[3] - (float)FFT_SAMPLE_FREQ / 4) <= bin_hz);
+  assert(f[4] > 0.1f);
+  assert(f[5] > 0 && f[5] < (float)FFT_SAMPLE_FREQ / 2);
+}
+
+TEST(frame_features_match_stream) {
+  // Windowed pipeline path on the same signal
+  static float frame[256];
+  for (int i = 0; i < 256; i++) frame[i] = fabsf(1.5f * (float)sin(2 * PI * i / 8));
+  float f[EXPECTED_DIM];
+  FeatureExtractor::extractFrame(frame, 256, 0, 0, 0, f);
+  assert(fabsf(f[0] - 1.5f / sqrtf(2)) < 1e-3f);
+  assert(fabsf(f[1] - 1.5f) < 1e-3f);
+  assert(fabsf(f[3] - (float)FFT_SAMPLE_FREQ / 4) < 1e-3f);
+}
+#endif
+
+#ifdef USE_CURRENT
+TEST(current_features) {
+  FeatureExtractor::reset();
+  float f[EXPECTED_DIM];
+  extract_sine(0, 1.0f, 1.0f, 2.0f, 3.0f, f);
+  int idx = EXPECTED_DIM - 4;
+  assert(f[idx] == 1.0f && f[idx + 1] == 2.0f && f[idx + 2] == 3.0f);
+  assert(fabsf(f[idx + 3] - sqrtf(14.0f / 3)) < 1e-6f);
+}
+
+// Three-phase mains on 12-bit ADC codes: 2048 +- amp, 20 samples per period
+static float phase_amp = 0;
+static long conversions = 0;
+static long phase_pos[3] = {0, 0, 0};
+
+static int three_phase_pin(int pin) {
+  int k = (pin == ADC_CURRENT_L1) ? 0 : (pin == ADC_CURRENT_L2) ? 1 : 2;
+  conversions++;
+  double ph = 2 * PI * (phase_pos[k]++ / 20.0 + k / 3.0);
+  return (int)lround(2048 + phase_amp * sin(ph));
+}
+
+static int three_phase_block(uint16_t* out, int frames, void*) {
+  for (int i = 0; i < 3 * frames; i++) {
+    int pin = (i % 3 == 0) ? ADC_CURRENT_L1 : (i % 3 == 1) ? ADC_CURRENT_L2 : ADC_CURRENT_L3;
+    out[i] = (uint16_t)three_phase_pin(pin);
+  }
+  return frames;
+}
+
+// Amps the sensor should report for a sine of `amp` codes
+static float expected_amps(float amp) {
+  return (amp / sqrtf(2) * 3.3f / 4095) / 0.1f;
+}
+
+TEST(current_sensor_three_phase) {
+  Serial.quiet = true;
+  host_analog_source(three_phase_pin);
+  CurrentSensor ct;
+
+  phase_amp = 0;  // Motor off
+  ct.calibrate();
+
+  phase_amp = 400;
+  conversions = 0;
+  float i1 = 0, i2 = 0, i3 = 0;
+  ct.read(&i1, &i2, &i3);
+  // One pass: DC midpoint and RMS from the same 1000 samples per phase
+  // (was two passes, 6000 conversions)
+  assert(conversions == 3000);
+
+  for (int i = 0; i < 4; i++) ct.read(&i1, &i2, &i3);  // Fill the 5-read average
+  float want = expected_amps(400);
+  assert(fabsf(i1 - want) < 0.01f * want);
+  assert(fabsf(i2 - want) < 0.01f * want);
+  assert(fabsf(i3 - want) < 0.01f * want);
+  assert(ct.isMotorRunning(i1, i2, i3));
+  host_analog_source(nullptr);
+}
+
+TEST(current_sensor_block_source) {
+  Serial.quiet = true;
+  host_analog_source(nullptr);  // analogRead() must not be used
+  CurrentSensor ct;
+  ct.setSource(three_phase_block);
+
+  phase_amp = 0;
+  ct.calibrate();
+  phase_amp = 200;
+  float i1 = 0, i2 = 0, i3 = 0;
+  for (int i = 0; i < 5; i++) ct.read(&i1, &i2, &i3);
+  float want = expected_amps(200);
+  assert(fabsf(i1 - want) < 0.01f * want);
+  assert(fabsf(i3 - want) < 0.01f * want);
+
+  phase_amp = 5;  // Below the 300 mA cutoff
+  for (int i = 0; i < 5; i++) ct.read(&i1, &i2, &i3);
+  assert(i1 == 0 && i2 == 0 && i3 == 0);
+  assert(!ct.isMotorRunning(i1, i2, i3));
+}
+#endif
+
+int main() {
+  printf("\n=== Feature Extractor Tests (%s, %dD) ===\n\n", SCHEMA_NAME, EXPECTED_DIM);
+
+  RUN_TEST(schema_dimension_and_names);
+  RUN_TEST(gravity_is_removed);
+  RUN_TEST(sine_vibration_time_features);
+  RUN_TEST(impulses_raise_crest);
+  #ifdef USE_FFT
+    RUN_TEST(fft_sees_vibration_frequency);
+    RUN_TEST(frame_features_match_stream);
+  #endif
+  #ifdef USE_CURRENT
+    RUN_TEST(current_features);
+    RUN_TEST(current_sensor_three_phase);
+    RUN_TEST(current_sensor_block_source);
+  #endif
+
+  printf("\n✓ All feature extractor tests passed\n\n");
+  return 0;
+}
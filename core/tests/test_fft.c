@@ -0,0 +1,184 @@
+/**
+ * @file test_fft.c
+ * @brief FFT kernels vs a double-precision reference DFT, and spectral features
+ */
+
+#include "../feature_fft.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define N_MAX FFT_MAX_POINTS
+
+static const double PI = 3.14159265358979323846;
+
+static double in[N_MAX], ref_re[N_MAX], ref_im[N_MAX];
+static float f_re[N_MAX], f_im[N_MAX];
+static int16_t q15_re[N_MAX], q15_im[N_MAX];
+static int32_t q31_re[N_MAX], q31_im[N_MAX];
+
+static void dft(const double* x, int n) {
+    for (int k = 0; k < n; k++) {
+        double sr = 0, si = 0;
+        for (int t = 0; t < n; t++) {
+            double a = 2 * PI * (double)k * t / n;
+            sr += x[t] * cos(a);
+            si -= x[t] * sin(a);
+        }
+        ref_re[k] = sr;
+        ref_im[k] = si;
+    }
+}
+
+// Random input in [-0.5, 0.5)
+static void random_input(int n, unsigned seed) {
+    srand(seed);
+    for (int i = 0; i < n; i++) in[i] = (double)rand() / RAND_MAX - 0.5;
+}
+
+// Largest |fft - dft| / n over all bins (fft output already divided by n)
+static double max_error(int n, double (*get)(int k, int imag)) {
+    double worst = 0;
+    for (int k = 0; k < n; k++) {
+        double er = fabs(get(k, 0) - ref_re[k] / n);
+        double ei = fabs(get(k, 1) - ref_im[k] / n);
+        if (er > worst) worst = er;
+        if (ei > worst) worst = ei;
+    }
+    return worst;
+}
+
+static int cur_n;
+static double get_f32(int k, int imag) { return (imag ? f_im[k] : f_re[k]) / cur_n; }
+static double get_q15(int k, int imag) { return (imag ? q15_im[k] : q15_re[k]) / 32768.0; }
+static double get_q31(int k, int imag) { return (imag ? q31_im[k] : q31_re[k]) / 2147483648.0; }
+
+TEST(rejects_invalid_sizes) {
+    const uint16_t bad[] = {0, 1, 3, 6, 100, 2048};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        assert(!fft_f32(f_re, f_im, bad[i]));
+        assert(!fft_q15(q15_re, q15_im, bad[i]));
+        assert(!fft_q31(q31_re, q31_im, bad[i]));
+    }
+}
+
+TEST(f32_matches_dft) {
+    for (int n = 2; n <= N_MAX; n <<= 1) {
+        random_input(n, n);
+        dft(in, n);
+        for (int i = 0; i < n; i++) { f_re[i] = (float)in[i]; f_im[i] = 0; }
+        assert(fft_f32(f_re, f_im, n));
+        cur_n = n;
+        assert(max_error(n, get_f32) < 1e-7);
+    }
+}
+
+TEST(q31_matches_dft) {
+    for (int n = 2; n <= N_MAX; n <<= 1) {
+        random_input(n, n);
+        dft(in, n);
+        for (int i = 0; i < n; i++) { q31_re[i] = (int32_t)lrint(in[i] * 2147483648.0); q31_im[i] = 0; }
+        assert(fft_q31(q31_re, q31_im, n));
+        assert(max_error(n, get_q31) < 1e-8);
+    }
+}
+
+TEST(q15_matches_dft) {
+    // One LSB of truncation per stage: error grows with log2(n)
+    for (int n = 2; n <= N_MAX; n <<= 1) {
+        random_input(n, n);
+        dft(in, n);
+        for (int i = 0; i < n; i++) { q15_re[i] = (int16_t)lrint(in[i] * 32768.0); q15_im[i] = 0; }
+        assert(fft_q15(q15_re, q15_im, n));
+        assert(max_error(n, get_q15) < 12.0 / 32768);
+    }
+}
+
+// DC offset + sines at given bins; returns features of all three variants
+static void tone_features(uint16_t n, float fs, const int* bins, const float* amps, int tones,
+                          fft_features_t out[3]) {
+    static float sig[N_MAX];
+    for (int i = 0; i < n; i++) {
+        double v = 9.8;
+        for (int t = 0; t < tones; t++) v += amps[t] * sin(2 * PI * bins[t] * i / n + 0.3);
+        sig[i] = (float)v;
+    }
+    assert(fft_features_f32(sig, n, fs, f_re, f_im, &out[0]));
+    assert(fft_features_q15(sig, n, fs, q15_re, q15_im, &out[1]));
+    assert(fft_features_q31(sig, n, fs, q31_re, q31_im, &out[2]));
+}
+
+TEST(single_tone_features) {
+    const int bins[] = {5};
+    const float amps[] = {2.0f};
+    fft_features_t f[3];
+    tone_features(64, 1000.0f, bins, amps, 1, f);
+
+    for (int v = 0; v < 3; v++) {
+        assert(fabsf(f[v].peak_freq - 5 * 1000.0f / 64) < 1e-3f);
+        assert(fabsf(f[v].peak_amp - 2.0f) < (v == 1 ? 0.01f : 1e-3f));
+        assert(fabsf(f[v].centroid - f[v].peak_freq) < (v == 1 ? 2.0f : 0.05f));
+    }
+}
+
+TEST(two_tone_centroid) {
+    // Bins 40 and 120: centroid is the amplitude-weighted mean, peak the larger tone
+    const int bins[] = {40, 120};
+    const float amps[] = {1.0f, 1.5f};
+    fft_features_t f[3];
+    tone_features(256, 2560.0f, bins, amps, 2, f);
+
+    float expected = 10.0f * (40 * 1.0f + 120 * 1.5f) / 2.5f;
+    for (int v = 0; v < 3; v++) {
+        assert(fabsf(f[v].peak_freq - 1200.0f) < 1e-2f);
+        assert(fabsf(f[v].peak_amp - 1.5f) < (v == 1 ? 0.01f : 1e-3f));
+        assert(fabsf(f[v].centroid - expected) < (v == 1 ? 15.0f : 1.0f));
+    }
+}
+
+TEST(nyquist_bin_amplitude) {
+    // Alternating +-A sits in bin n/2 and reads A, not 2A
+    static float sig[64];
+    for (int i = 0; i < 64; i++) sig[i] = (i & 1) ? -0.7f : 0.7f;
+    fft_features_t f;
+    assert(fft_features_f32(sig, 64, 100.0f, f_re, f_im, &f));
+    assert(fabsf(f.peak_freq - 50.0f) < 1e-4f);
+    assert(fabsf(f.peak_amp - 0.7f) < 1e-4f);
+}
+
+TEST(constant_signal_is_silent) {
+    static float sig[128];
+    for (int i = 0; i < 128; i++) sig[i] = 9.81f;
+    fft_features_t f[3];
+    assert(fft_features_f32(sig, 128, 1000.0f, f_re, f_im, &f[0]));
+    assert(fft_features_q15(sig, 128, 1000.0f, q15_re, q15_im, &f[1]));
+    assert(fft_features_q31(sig, 128, 1000.0f, q31_re, q31_im, &f[2]));
+    for (int v = 1; v < 3; v++) {
+        assert(f[v].peak_amp == 0 && f[v].centroid == 0);
+    }
+    assert(f[0].peak_amp < 1e-5f);
+}
+
+int main() {
+    printf("\n=== FFT Tests ===\n\n");
+
+    RUN_TEST(rejects_invalid_sizes);
+    RUN_TEST(f32_matches_dft);
+    RUN_TEST(q31_matches_dft);
+    RUN_TEST(q15_matches_dft);
+    RUN_TEST(single_tone_features);
+    RUN_TEST(two_tone_centroid);
+    RUN_TEST(nyquist_bin_amplitude);
+    RUN_TEST(constant_signal_is_silent);
+
+    printf("\n✓ All FFT tests passed\n\n");
+    return 0;
+}
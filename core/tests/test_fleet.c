@@ -0,0 +1,173 @@
+/**
+ * @file test_fleet.c
+ * @brief Fleet engine tests - pooled per-device models
+ */
+
+#include "../kmeans_fleet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define K 4
+#define D 3
+#define CAP 100
+
+static uint64_t arena[KMEANS_FLEET_ARENA_SIZE(8, K, D, CAP) / 8];
+
+static void make_point(fixed_t* p, float base, int i) {
+    for (int d = 0; d < D; d++) {
+        p[d] = FLOAT_TO_FIXED(base + 0.01f * ((i + d) % 5));
+    }
+}
+
+TEST(init_rejects_bad_shape) {
+    kmeans_fleet_t fleet;
+    assert(!kmeans_fleet_init(&fleet, arena, sizeof(arena), 0, K, CAP));
+    assert(!kmeans_fleet_init(&fleet, arena, sizeof(arena), D, MAX_CLUSTERS + 1, CAP));
+    assert(!kmeans_fleet_init(&fleet, arena, sizeof(arena), D, K, BOOTSTRAP_SAMPLES - 1));
+    assert(!kmeans_fleet_init(&fleet, (uint8_t*)arena + 4, sizeof(arena) - 4, D, K, CAP));
+    assert(kmeans_fleet_init(&fleet, arena, sizeof(arena), D, K, CAP));
+    assert(fleet.capacity == 8);
+}
+
+TEST(slot_is_compact) {
+    // Sized to real K, D and capacity - far below a MAX_* sized model
+    size_t slot = KMEANS_FLEET_SLOT_SIZE(K, D, CAP);
+    size_t legacy = sizeof(kmeans_model_t);
+    printf("\n  Slot: %zu bytes (K=%d D=%d cap=%d), legacy: %zu bytes\n", slot, K, D, CAP, legacy);
+    assert(slot < legacy / 10);
+}
+
+TEST(capacity_exhaustion) {
+    kmeans_fleet_t fleet;
+    kmeans_fleet_init(&fleet, arena, sizeof(arena), D, K, CAP);
+
+    for (int i = 0; i < 8; i++) {
+        assert(kmeans_fleet_create(&fleet, 0.2f) == i);
+    }
+    assert(kmeans_fleet_create(&fleet, 0.2f) == KMEANS_FLEET_INVALID);
+    assert(fleet.live == 8);
+}
+
+TEST(destroy_recycles_slot) {
+    kmeans_fleet_t fleet;
+    kmeans_fleet_init(&fleet, arena, sizeof(arena), D, K, CAP);
+
+    for (int i = 0; i < 8; i++) kmeans_fleet_create(&fleet, 0.2f);
+
+    assert(kmeans_fleet_destroy(&fleet, 5));
+    assert(!kmeans_fleet_destroy(&fleet, 5));  // Already free
+    assert(kmeans_fleet_model(&fleet, 5) == NULL);
+    assert(kmeans_fleet_update(&fleet, 5, (fixed_t[D]){0}) == -1);
+
+    assert(kmeans_fleet_destroy(&fleet, 2));
+    kmeans_device_t a = kmeans_fleet_create(&fleet, 0.2f);
+    kmeans_device_t b = kmeans_fleet_create(&fleet, 0.2f);
+    assert(KMEANS_FLEET_SLOT_OF(a) == 2 && KMEANS_FLEET_SLOT_OF(b) == 5);  // LIFO reuse
+    assert(kmeans_fleet_create(&fleet, 0.2f) == KMEANS_FLEET_INVALID);
+
+    // Recycled slot starts fresh
+    kmeans_model_t* m = kmeans_fleet_model(&fleet, a);
+    assert(m && m->state == STATE_BOOTSTRAP && m->k == 0 && m->buffer.count == 0);
+}
+
+TEST(stale_handle_rejected) {
+    kmeans_fleet_t fleet;
+    kmeans_fleet_init(&fleet, arena, sizeof(arena), D, K, CAP);
+
+    kmeans_device_t old = kmeans_fleet_create(&fleet, 0.2f);
+    assert(kmeans_fleet_destroy(&fleet, old));
+    kmeans_device_t tenant = kmeans_fleet_create(&fleet, 0.2f);
+    assert(KMEANS_FLEET_SLOT_OF(tenant) == KMEANS_FLEET_SLOT_OF(old) && tenant != old);
+
+    // The old handle must not reach the slot's new device
+    fixed_t p[D];
+    make_point(p, 1.0f, 0);
+    assert(kmeans_fleet_model(&fleet, old) == NULL);
+    assert(kmeans_fleet_update(&fleet, old, p) == -1);
+    assert(kmeans_fleet_predict(&fleet, old, p) == -1);
+    assert(!kmeans_fleet_destroy(&fleet, old));
+    assert(kmeans_fleet_model(&fleet, tenant)->buffer.count == 0);
+    assert(fleet.live == 1);
+
+    assert(kmeans_fleet_update(&fleet, tenant, p) == 0);
+    assert(kmeans_fleet_model(&fleet, tenant)->buffer.count == 1);
+}
+
+TEST(devices_are_isolated) {
+    kmeans_fleet_t fleet;
+    kmeans_fleet_init(&fleet, arena, sizeof(arena), D, K, CAP);
+    kmeans_device_t a = kmeans_fleet_create(&fleet, 0.2f);
+    kmeans_device_t b = kmeans_fleet_create(&fleet, 0.2f);
+
+    fixed_t p[D];
+    for (int i = 0; i < BOOTSTRAP_SAMPLES + 20; i++) {
+        make_point(p, 1.0f, i);
+        kmeans_fleet_update(&fleet, a, p);
+    }
+
+    kmeans_model_t* ma = kmeans_fleet_model(&fleet, a);
+    kmeans_model_t* mb = kmeans_fleet_model(&fleet, b);
+    assert(ma->state == STATE_NORMAL && ma->k == 1);
+    assert(mb->state == STATE_BOOTSTRAP && mb->k == 0 && mb->buffer.count == 0);
+}
+
+TEST(matches_standalone_model) {
+    kmeans_fleet_t fleet;
+    kmeans_fleet_init(&fleet, arena, sizeof(arena), D, K, CAP);
+    kmeans_device_t dev = kmeans_fleet_create(&fleet, 0.2f);
+
+    static uint64_t storage[KMEANS_STORAGE_SIZE(K, D, CAP) / 8];
+    kmeans_model_t ref;
+    assert(kmeans_init_with_storage(&ref, D, 0.2f, K, CAP, storage, sizeof(storage)));
+
+    fixed_t p[D];
+    for (int i = 0; i < 400; i++) {
+        make_point(p, (i > 200 && i < 230) ? 6.0f : 1.0f, i);
+        int8_t r1 = kmeans_fleet_update(&fleet, dev, p);
+        int8_t r2 = kmeans_update(&ref, p);
+        assert(r1 == r2);
+        assert(kmeans_fleet_predict(&fleet, dev, p) == (int8_t)kmeans_predict(&ref, p));
+
+        kmeans_model_t* m = kmeans_fleet_model(&fleet, dev);
+        if (m->state == STATE_ALARM && m->k == 1) {
+            assert(ref.state == STATE_ALARM);
+            kmeans_request_label(m);
+            kmeans_request_label(&ref);
+            assert(kmeans_add_cluster(m, "fault"));
+            assert(kmeans_add_cluster(&ref, "fault"));
+        }
+    }
+
+    kmeans_model_t* m = kmeans_fleet_model(&fleet, dev);
+    assert(m->k == 2 && ref.k == 2);
+    for (uint8_t c = 0; c < ref.k; c++) {
+        fixed_t c1[D], c2[D];
+        kmeans_get_centroid(m, c, c1);
+        kmeans_get_centroid(&ref, c, c2);
+        assert(memcmp(c1, c2, sizeof(c1)) == 0);
+    }
+}
+
+int main() {
+    printf("=== Fleet Tests ===\n");
+
+    RUN_TEST(init_rejects_bad_shape);
+    RUN_TEST(slot_is_compact);
+    RUN_TEST(capacity_exhaustion);
+    RUN_TEST(destroy_recycles_slot);
+    RUN_TEST(stale_handle_rejected);
+    RUN_TEST(devices_are_isolated);
+    RUN_TEST(matches_standalone_model);
+
+    printf("\n=== All Tests Passed ===\n");
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_memory.c
+ * @brief Memory footprint report: real sizeof per configuration
+ *
+ * Prints the model header + bound storage for each feature schema and
+ * buffer window, next to the pre-storage layout (MAX_FEATURES rows, 100 samples).
+ */
+
+#include "../streaming_kmeans.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+// Original fixed layout, for comparison
+typedef struct {
+    fixed_t centroid[MAX_FEATURES];
+    uint32_t count;
+    fixed_t inertia;
+    char label[MAX_LABEL_LENGTH];
+    bool active;
+} legacy_cluster_t;
+
+typedef struct {
+    fixed_t samples[RING_BUFFER_SIZE][MAX_FEATURES];
+    uint16_t head;
+    uint16_t count;
+    bool frozen;
+} legacy_ring_buffer_t;
+
+typedef struct {
+    legacy_cluster_t clusters[MAX_CLUSTERS];
+    uint8_t k;
+    uint8_t feature_dim;
+    fixed_t learning_rate;
+    uint32_t total_points;
+    bool initialized;
+    system_state_t state;
+    legacy_ring_buffer_t buffer;
+    fixed_t outlier_threshold;
+    fixed_t last_distance;
+    bool alarm_active;
+    bool waiting_label;
+    uint16_t alarm_sample_count;
+    uint16_t normal_streak;
+    uint8_t idle_count;
+    fixed_t last_rms;
+    fixed_t last_current;
+    bool motor_running;
+} legacy_model_t;
+
+static size_t footprint(uint8_t k, uint8_t d, uint16_t cap) {
+    return KMEANS_MODEL_HEADER_SIZE + KMEANS_STORAGE_SIZE(k, d, cap);
+}
+
+TEST(report) {
+    const uint8_t dims[] = {3, 6, 7, 10};
+    const char* schemas[] = {"TIME_ONLY", "FFT_ONLY", "TIME_CURRENT", "FFT_CURRENT"};
+    const uint16_t caps[] = {100, 1000};
+    const uint8_t ks[] = {4, MAX_CLUSTERS};
+
+    printf("\n\n  sizeof(kmeans_model_t) = %zu (kmeans_init), header = %zu, cluster_t = %zu\n",
+           sizeof(kmeans_model_t), (size_t)KMEANS_MODEL_HEADER_SIZE, sizeof(cluster_t));
+    printf("  legacy: model = %zu (ring buffer %zu)\n\n",
+           sizeof(legacy_model_t), sizeof(legacy_ring_buffer_t));
+    printf("  %-13s  D    K  window   buffer B   total B   vs legacy\n", "schema");
+    for (int s = 0; s < 4; s++) {
+        for (int k = 0; k < 2; k++) {
+            for (int c = 0; c < 2; c++) {
+                size_t buf = KMEANS_ALIGN8((size_t)caps[c] * dims[s] * sizeof(fixed_t));
+                size_t total = footprint(ks[k], dims[s], caps[c]);
+                printf("  %-13s %2d %4d %7d %10zu %9zu   %5.1f%%\n", schemas[s], dims[s], ks[k],
+                       caps[c], buf, total, 100.0 * total / sizeof(legacy_model_t));
+            }
+        }
+    }
+    printf("  ");
+}
+
+TEST(window_1000_fits_in_old_buffer) {
+    // 3D, all 16 clusters, 10x the old anomaly window: smaller than the old buffer alone
+    assert(footprint(MAX_CLUSTERS, 3, 1000) < sizeof(legacy_ring_buffer_t));
+    assert(footprint(MAX_CLUSTERS, 3, 1000) < sizeof(legacy_model_t));
+}
+
+TEST(captures_full_window) {
+    static uint64_t storage[KMEANS_STORAGE_SIZE(4, 3, 1000) / 8];
+    kmeans_model_t model;
+    assert(kmeans_init_with_storage(&model, 3, 0.2f, 4, 1000, storage, sizeof(storage)));
+    assert(model.buffer.capacity == 1000);
+
+    fixed_t p[3];
+    for (int i = 0; i < 1500; i++) {
+        for (int d = 0; d < 3; d++) p[d] = FLOAT_TO_FIXED(1.0f) + (i % 7) * 100;
+        kmeans_update(&model, p);
+    }
+    assert(model.state == STATE_NORMAL);
+
+    // Fault with motor stopped: freezes with the last 1000 samples captured
+    for (int i = 0; i < IDLE_CONSECUTIVE_SAMPLES; i++) kmeans_update_motor_status(&model, 0, 0);
+    for (int i = 0; i < 1200 && model.state != STATE_WAITING_LABEL; i++) {
+        for (int d = 0; d < 3; d++) p[d] = FLOAT_TO_FIXED(9.0f);
+        kmeans_update(&model, p);
+    }
+    assert(model.state == STATE_WAITING_LABEL);
+    assert(kmeans_get_buffer_size(&model) == 1000);
+    assert(kmeans_add_cluster(&model, "fault"));
+    assert(model.k == 2);
+}
+
+TEST(rejects_undersized_storage) {
+    static uint64_t storage[KMEANS_STORAGE_SIZE(4, 3, 1000) / 8];
+    kmeans_model_t model;
+    assert(!kmeans_init_with_storage(&model, 3, 0.2f, 4, 1000, storage, sizeof(storage) - 8));
+    assert(!kmeans_init_with_storage(&model, 4, 0.2f, 4, 1000, storage, sizeof(storage)));
+    assert(kmeans_init_with_storage(&model, 3, 0.2f, 4, 1000, storage, sizeof(storage)));
+}
+
+int main() {
+    printf("=== Memory Footprint Tests ===\n");
+
+    RUN_TEST(report);
+    RUN_TEST(window_1000_fits_in_old_buffer);
+    RUN_TEST(captures_full_window);
+    RUN_TEST(rejects_undersized_storage);
+
+    printf("\n=== All Tests Passed ===\n");
+    return 0;
+}
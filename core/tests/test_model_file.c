@@ -0,0 +1,250 @@
+/**
+ * @file test_model_file.c
+ * @brief v2 model file round trip, integrity checks and v1 migration
+ */
+
+#include "../model_file.h"
+#include "../crc.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+// The v1 structs as model_storage.h wrote them (ESP32 and RP2350 alike)
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t k;
+    uint8_t feature_dim;
+    uint8_t reserved;
+    uint32_t total_points;
+    fixed_t outlier_threshold;
+    fixed_t learning_rate;
+} v1_header_t;
+
+typedef struct {
+    fixed_t centroid[64];
+    uint32_t count;
+    fixed_t inertia;
+    char label[MAX_LABEL_LENGTH];
+    bool active;
+} v1_cluster_t;
+
+static uint8_t buf[8192];
+
+static void make_model(kmeans_model_t* m, uint8_t dim, uint8_t k) {
+    assert(kmeans_init(m, dim, 0.2f));
+    m->k = k;
+    m->total_points = 4321;
+    m->outlier_threshold = FLOAT_TO_FIXED(2.5f);
+    m->alpha_schedule = ALPHA_SCHEDULE_POW2;
+    for (uint8_t i = 0; i < k; i++) {
+        fixed_t c[MAX_FEATURES];
+        for (uint8_t d = 0; d < dim; d++) c[d] = (fixed_t)((i + 1) * 70000 - d * 1234);
+        c[0] = -c[0];
+        kmeans_set_centroid(m, i, c);
+        m->clusters[i].count = 100u * i + 7;
+        m->clusters[i].inertia = FLOAT_TO_FIXED(0.5f * i);
+        m->clusters[i].active = i != 2;
+        snprintf(m->labels[i], MAX_LABEL_LENGTH, i == 0 ? "normal" : "fault_%u", i);
+    }
+}
+
+static bool same_model(const kmeans_model_t* a, const kmeans_model_t* b) {
+    if (a->k != b->k || a->total_points != b->total_points) return false;
+    if (a->outlier_threshold != b->outlier_threshold || a->learning_rate != b->learning_rate) return false;
+    for (uint8_t i = 0; i < a->k; i++) {
+        fixed_t ca[MAX_FEATURES], cb[MAX_FEATURES];
+        kmeans_get_centroid(a, i, ca);
+        kmeans_get_centroid(b, i, cb);
+        if (memcmp(ca, cb, a->feature_dim * sizeof(fixed_t)) != 0) return false;
+        if (a->clusters[i].count != b->clusters[i].count) return false;
+        if (a->clusters[i].inertia != b->clusters[i].inertia) return false;
+        if (a->clusters[i].active != b->clusters[i].active) return false;
+        if (strcmp(a->labels[i], b->labels[i]) != 0) return false;
+    }
+    return true;
+}
+
+static size_t write_v1(const kmeans_model_t* m, uint8_t* out) {
+    v1_header_t h = {MODEL_FILE_V1_MAGIC, 1, m->k, m->feature_dim, 0,
+                     m->total_points, m->outlier_threshold, m->learning_rate};
+    memcpy(out, &h, sizeof(h));
+    size_t n = sizeof(h);
+    for (uint8_t i = 0; i < m->k; i++) {
+        v1_cluster_t c;
+        memset(&c, 0, sizeof(c));
+        kmeans_get_centroid(m, i, c.centroid);
+        c.count = m->clusters[i].count;
+        c.inertia = m->clusters[i].inertia;
+        strncpy(c.label, m->labels[i], MAX_LABEL_LENGTH);
+        c.active = m->clusters[i].active;
+        memcpy(out + n, &c, sizeof(c));
+        n += sizeof(c);
+    }
+    return n;
+}
+
+TEST(v1_layout) {
+    assert(sizeof(v1_header_t) == MODEL_FILE_V1_HEADER_SIZE);
+    assert(sizeof(v1_cluster_t) == MODEL_FILE_V1_CLUSTER_SIZE);
+}
+
+TEST(round_trip) {
+    kmeans_model_t m, got;
+    make_model(&m, 3, 4);
+    size_t n = model_file_write(&m, buf, sizeof(buf));
+    assert(n == model_file_size(&m));
+    assert(n <= MODEL_FILE_MAX_SIZE(4, 3));
+
+    model_file_info_t info;
+    assert(model_file_info(buf, n, &info));
+    assert(info.version == 2 && info.k == 4 && info.feature_dim == 3 && info.size == n);
+    assert(info.total_points == 4321);
+
+    assert(kmeans_init(&got, 3, 0.1f));
+    assert(model_file_read(buf, n, &got));
+    assert(same_model(&m, &got));
+    assert(got.alpha_schedule == ALPHA_SCHEDULE_POW2);
+    assert(got.state == STATE_NORMAL);
+}
+
+TEST(sized_to_k_and_d) {
+    kmeans_model_t m;
+    make_model(&m, 3, 4);
+    size_t v2 = model_file_write(&m, buf, sizeof(buf));
+    size_t v1 = MODEL_FILE_V1_HEADER_SIZE + 4 * MODEL_FILE_V1_CLUSTER_SIZE;
+    printf(" [K=4 D=3: v1 %zu B, v2 %zu B]", v1, v2);
+    assert(v2 == 20 + 4 * (10 + 12) + 6 + 3 * 7 + 4);
+    assert(v2 * 8 < v1);
+}
+
+TEST(buffer_too_small) {
+    kmeans_model_t m;
+    make_model(&m, 7, 3);
+    size_t n = model_file_size(&m);
+    assert(model_file_write(&m, buf, n - 1) == 0);
+    assert(model_file_write(&m, buf, n) == n);
+}
+
+// Any flipped byte or truncation is rejected and leaves the model alone
+TEST(corruption_rejected) {
+    kmeans_model_t m, got;
+    make_model(&m, 5, 3);
+    size_t n = model_file_write(&m, buf, sizeof(buf));
+    assert(kmeans_init(&got, 5, 0.1f));
+
+    for (size_t i = 0; i < n; i++) {
+        buf[i] ^= 0x10;
+        assert(!model_file_read(buf, n, &got));
+        buf[i] ^= 0x10;
+    }
+    for (size_t len = 0; len < n; len++) assert(!model_file_read(buf, len, &got));
+    assert(got.k == 0 && got.total_points == 0);
+    assert(model_file_read(buf, n, &got));
+
+    // A good CRC does not make an unknown alpha schedule loadable
+    buf[7] = ALPHA_SCHEDULE_CONSTANT + 1;
+    put_le32(buf + n - 4, crc32(buf, n - 4));
+    assert(!model_file_read(buf, n, &got));
+}
+
+TEST(model_mismatch) {
+    kmeans_model_t m, got;
+    make_model(&m, 5, 3);
+    size_t n = model_file_write(&m, buf, sizeof(buf));
+
+    assert(kmeans_init(&got, 4, 0.1f));
+    assert(!model_file_read(buf, n, &got));
+
+    static uint64_t memory[KMEANS_STORAGE_SIZE(2, 5, 50) / 8];
+    assert(kmeans_init_with_storage(&got, 5, 0.1f, 2, 50, memory, sizeof(memory)));
+    assert(!model_file_read(buf, n, &got));
+
+    buf[4] = 3;  // Unknown version
+    assert(kmeans_init(&got, 5, 0.1f));
+    assert(!model_file_read(buf, n, &got));
+}
+
+TEST(v1_migration) {
+    kmeans_model_t m, got;
+    make_model(&m, 7, 5);
+    size_t n = write_v1(&m, buf);
+
+    model_file_info_t info;
+    assert(model_file_info(buf, n, &info));
+    assert(info.version == 1 && info.k == 5 && info.size == n);
+    assert(!model_file_info(buf, n - 1, &info));
+
+    assert(kmeans_init(&got, 7, 0.1f));
+    assert(model_file_read(buf, n, &got));
+    assert(same_model(&m, &got));
+
+    // Re-saved as v2, then read back
+    size_t v2 = model_file_write(&got, buf, sizeof(buf));
+    printf(" [K=5 D=7: v1 %zu B, v2 %zu B]", n, v2);
+    kmeans_model_t again;
+    assert(kmeans_init(&again, 7, 0.1f));
+    assert(model_file_read(buf, v2, &again));
+    assert(same_model(&m, &again));
+}
+
+// ESP32 Preferences kept the header and every cluster as separate blobs
+TEST(v1_piecewise) {
+    kmeans_model_t m, got;
+    make_model(&m, 3, 3);
+    write_v1(&m, buf);
+
+    uint8_t k;
+    assert(kmeans_init(&got, 3, 0.1f));
+    assert(!model_file_v1_begin(buf, MODEL_FILE_V1_HEADER_SIZE - 1, &got, &k));
+    assert(model_file_v1_begin(buf, MODEL_FILE_V1_HEADER_SIZE, &got, &k));
+    assert(k == 3 && got.k == 0);
+    for (uint8_t i = 0; i < k; i++) {
+        const uint8_t* c = buf + MODEL_FILE_V1_HEADER_SIZE + i * MODEL_FILE_V1_CLUSTER_SIZE;
+        assert(!model_file_v1_cluster(c, MODEL_FILE_V1_CLUSTER_SIZE - 1, &got));
+        assert(model_file_v1_cluster(c, MODEL_FILE_V1_CLUSTER_SIZE, &got));
+    }
+    assert(same_model(&m, &got));
+
+    kmeans_model_t other;
+    assert(kmeans_init(&other, 4, 0.1f));
+    assert(!model_file_v1_begin(buf, MODEL_FILE_V1_HEADER_SIZE, &other, &k));
+}
+
+TEST(empty_model) {
+    kmeans_model_t m, got;
+    assert(kmeans_init(&m, 3, 0.2f));
+    size_t n = model_file_write(&m, buf, sizeof(buf));
+    assert(n == MODEL_FILE_HEADER_SIZE + 4);
+    make_model(&got, 3, 2);
+    assert(model_file_read(buf, n, &got));
+    assert(got.k == 0 && got.state == STATE_BOOTSTRAP);
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf("Model File Tests\n");
+    printf("========================================\n\n");
+
+    RUN_TEST(v1_layout);
+    RUN_TEST(round_trip);
+    RUN_TEST(sized_to_k_and_d);
+    RUN_TEST(buffer_too_small);
+    RUN_TEST(corruption_rejected);
+    RUN_TEST(model_mismatch);
+    RUN_TEST(v1_migration);
+    RUN_TEST(v1_piecewise);
+    RUN_TEST(empty_model);
+
+    printf("\n========================================\n");
+    printf("All tests passed!\n");
+    printf("========================================\n");
+    return 0;
+}
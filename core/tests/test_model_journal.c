@@ -0,0 +1,475 @@
+/**
+ * @file test_model_journal.c
+ * @brief Append-only model journal on a file-backed flash region
+ *
+ * Remounting the same file stands in for a reboot; flash_file.h enforces
+ * NOR write rules and cuts writes short to simulate power loss.
+ */
+
+#include "../model_journal.h"
+#include "host/flash_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define PATH "/tmp/test_model_journal.bin"
+#define SECTOR 512
+#define SECTORS 8
+#define DIM 4
+
+static flash_file_t flash;
+static model_journal_t journal;
+
+static void fresh(void) {
+    flash_file_close(&flash);
+    unlink(PATH);
+    assert(flash_file_open(&flash, PATH, SECTORS, SECTOR));
+    assert(model_journal_mount(&journal, &flash.region));
+}
+
+static void reboot(void) {
+    flash_file_close(&flash);
+    assert(flash_file_open(&flash, PATH, SECTORS, SECTOR));
+    assert(model_journal_mount(&journal, &flash.region));
+}
+
+// k clusters with values derived from seed
+static void make_model(kmeans_model_t* m, uint8_t k, uint32_t seed) {
+    assert(kmeans_init(m, DIM, 0.2f));
+    m->k = k;
+    m->total_points = seed * 10;
+    m->outlier_threshold = FLOAT_TO_FIXED(2.5f);
+    for (uint8_t i = 0; i < k; i++) {
+        fixed_t c[DIM];
+        for (int d = 0; d < DIM; d++) c[d] = (fixed_t)(seed * 131 + i * 17 + d);
+        kmeans_set_centroid(m, i, c);
+        m->clusters[i].count = seed + i;
+        m->clusters[i].inertia = (fixed_t)(seed * 3 + i);
+        m->clusters[i].active = true;
+        snprintf(m->labels[i], MAX_LABEL_LENGTH, "fault_%u", i);
+    }
+}
+
+// One cluster's centroid moves, as after kmeans_assign_existing()
+static void retrain(kmeans_model_t* m, uint8_t id, uint32_t step) {
+    fixed_t c[DIM];
+    kmeans_get_centroid(m, id, c);
+    for (int d = 0; d < DIM; d++) c[d] += (fixed_t)(step + d);
+    kmeans_set_centroid(m, id, c);
+    m->clusters[id].count += 5;
+    m->clusters[id].inertia += 1;
+    m->total_points += 5;
+}
+
+static bool same_model(const kmeans_model_t* a, const kmeans_model_t* b) {
+    if (a->k != b->k || a->total_points != b->total_points) return false;
+    if (a->outlier_threshold != b->outlier_threshold || a->learning_rate != b->learning_rate) return false;
+    for (uint8_t i = 0; i < a->k; i++) {
+        fixed_t ca[DIM], cb[DIM];
+        kmeans_get_centroid(a, i, ca);
+        kmeans_get_centroid(b, i, cb);
+        if (memcmp(ca, cb, sizeof(ca)) != 0) return false;
+        if (a->clusters[i].count != b->clusters[i].count) return false;
+        if (a->clusters[i].inertia != b->clusters[i].inertia) return false;
+        if (a->clusters[i].active != b->clusters[i].active) return false;
+        if (strcmp(a->labels[i], b->labels[i]) != 0) return false;
+    }
+    return true;
+}
+
+static bool load_equals(const kmeans_model_t* want) {
+    kmeans_model_t got;
+    assert(kmeans_init(&got, DIM, 0.1f));
+    return model_journal_load(&journal, &got) && same_model(&got, want);
+}
+
+TEST(mount_validation) {
+    fresh();
+    flash_region_t small = flash.region;
+    small.size = 3 * SECTOR;
+    model_journal_t j;
+    assert(!model_journal_mount(&j, &small));
+
+    assert(!model_journal_has_model(&journal));
+    kmeans_model_t m;
+    assert(kmeans_init(&m, DIM, 0.2f));
+    assert(!model_journal_load(&journal, &m));
+    assert(m.k == 0);  // Untouched
+}
+
+TEST(snapshot_round_trip) {
+    fresh();
+    kmeans_model_t m;
+    make_model(&m, 5, 7);
+    assert(model_journal_compact(&journal, &m));
+    reboot();
+    assert(model_journal_has_model(&journal));
+    assert(load_equals(&m));
+    assert(journal.stats.replayed == 0);
+}
+
+TEST(deltas_replay_after_reboot) {
+    fresh();
+    kmeans_model_t m;
+    make_model(&m, 2, 3);
+    assert(model_journal_log_cluster(&journal, &m, 1));  // Empty journal: snapshot
+    assert(journal.stats.snapshots == 1);
+
+    retrain(&m, 0, 9);
+    assert(model_journal_log_centroid(&journal, &m, 0));
+    m.k = 3;
+    fixed_t c[DIM] = {1, 2, 3, 4};
+    kmeans_set_centroid(&m, 2, c);
+    m.clusters[2].count = 12;
+    m.clusters[2].active = true;
+    strcpy(m.labels[2], "bearing");
+    assert(model_journal_log_cluster(&journal, &m, 2));
+    m.outlier_threshold = FLOAT_TO_FIXED(3.0f);
+    assert(model_journal_log_threshold(&journal, &m));
+    assert(journal.stats.snapshots == 1);
+
+    reboot();
+    assert(load_equals(&m));
+    assert(journal.stats.replayed == 3);
+}
+
+TEST(delta_is_small) {
+    fresh();
+    kmeans_model_t m;
+    make_model(&m, 8, 1);
+    assert(model_journal_compact(&journal, &m));
+    uint32_t snapshot = journal.stats.bytes;
+    uint32_t erases = journal.stats.erases;
+
+    retrain(&m, 3, 1);
+    assert(model_journal_log_centroid(&journal, &m, 3));
+    uint32_t delta = journal.stats.bytes - snapshot;
+    printf(" [snapshot %u B, delta %u B]", snapshot, delta);
+    assert(delta == ((8 + 5 + 10 + DIM * 4 + 3) & ~3u));  // id, total_points, cluster record
+    assert(delta * 8 < snapshot);
+    assert(journal.stats.erases == erases);
+}
+
+// Thousands of deltas through a small ring: compaction keeps it bounded,
+// every reboot sees the latest model and wear stays even
+TEST(ring_wraps_with_compaction) {
+    fresh();
+    kmeans_model_t m;
+    make_model(&m, 6, 2);
+    assert(model_journal_compact(&journal, &m));
+
+    for (uint32_t i = 0; i < 3000; i++) {
+        retrain(&m, (uint8_t)(i % 6), i);
+        assert(model_journal_log_centroid(&journal, &m, (uint8_t)(i % 6)));
+        if (i % 250 == 0) {
+            // Fresh mount of the live region: a reboot that keeps the wear counters
+            model_journal_t seen;
+            kmeans_model_t got;
+            assert(model_journal_mount(&seen, &flash.region));
+            assert(kmeans_init(&got, DIM, 0.1f));
+            assert(model_journal_load(&seen, &got) && same_model(&got, &m));
+        }
+    }
+
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (int s = 0; s < SECTORS; s++) {
+        if (flash.erases[s] < lo) lo = flash.erases[s];
+        if (flash.erases[s] > hi) hi = flash.erases[s];
+    }
+    printf(" [erases/sector %u..%u, %u snapshots]", lo, hi, journal.stats.snapshots);
+    assert(journal.stats.snapshots > 10);
+    assert(hi - lo <= 1);
+    reboot();
+    assert(load_equals(&m));
+}
+
+// Idle-time compaction keeps the live part of the ring under half
+TEST(background_compaction) {
+    fresh();
+    kmeans_model_t m;
+    make_model(&m, 3, 4);
+    assert(model_journal_compact(&journal, &m));
+    uint32_t i = 0;
+    while (!model_journal_needs_compaction(&journal)) {
+        retrain(&m, (uint8_t)(i % 3), i);
+        assert(model_journal_log_centroid(&journal, &m, (uint8_t)(i % 3)));
+        i++;
+    }
+    assert(model_journal_compact(&journal, &m));
+    assert(!model_journal_needs_compaction(&journal));
+    reboot();
+    assert(!model_journal_needs_compaction(&journal));
+    assert(load_equals(&m));
+    assert(journal.stats.replayed == 0);
+}
+
+// Power cut at every byte of a delta: the old or the new model loads, and
+// the journal keeps working afterwards
+TEST(power_loss_during_delta) {
+    kmeans_model_t before, after;
+    make_model(&before, 4, 5);
+    after = before;
+    retrain(&after, 2, 77);
+
+    fresh();
+    assert(model_journal_compact(&journal, &before));
+    uint32_t start = flash.bytes_written;
+    assert(model_journal_log_centroid(&journal, &after, 2));
+    uint32_t cost = flash.bytes_written - start;
+
+    for (uint32_t cut = 0; cut <= cost; cut++) {
+        fresh();
+        assert(model_journal_compact(&journal, &before));
+        flash_file_fail_after(&flash, (long)cut);
+        assert(model_journal_log_centroid(&journal, &after, 2) == (cut == cost));
+        flash_file_fail_after(&flash, -1);
+
+        reboot();
+        kmeans_model_t got;
+        assert(kmeans_init(&got, DIM, 0.1f));
+        assert(model_journal_load(&journal, &got));
+        assert(same_model(&got, cut == cost ? &after : &before));
+
+        retrain(&got, 0, cut);
+        assert(model_journal_log_centroid(&journal, &got, 0));
+        reboot();
+        assert(load_equals(&got));
+    }
+}
+
+// Power cut at every byte of a compaction: base + deltas or the new
+// snapshot, both the same model
+TEST(power_loss_during_compaction) {
+    kmeans_model_t m;
+    make_model(&m, 5, 6);
+    fresh();
+    assert(model_journal_compact(&journal, &m));
+    for (uint32_t i = 0; i < 20; i++) {
+        retrain(&m, (uint8_t)(i % 5), i);
+        assert(model_journal_log_centroid(&journal, &m, (uint8_t)(i % 5)));
+    }
+    flash_file_close(&flash);
+    FILE* src = fopen(PATH, "rb");
+    static uint8_t image[SECTORS * SECTOR];
+    assert(fread(image, 1, sizeof(image), src) == sizeof(image));
+    fclose(src);
+
+    reboot();
+    uint32_t start = flash.bytes_written;
+    assert(model_journal_compact(&journal, &m));
+    uint32_t cost = flash.bytes_written - start;
+
+    for (uint32_t cut = 0; cut <= cost; cut++) {
+        flash_file_close(&flash);
+        FILE* dst = fopen(PATH, "wb");
+        assert(fwrite(image, 1, sizeof(image), dst) == sizeof(image));
+        fclose(dst);
+        reboot();
+
+        flash_file_fail_after(&flash, (long)cut);
+        assert(model_journal_compact(&journal, &m) == (cut == cost));
+        flash_file_fail_after(&flash, -1);
+        reboot();
+        assert(load_equals(&m));
+        assert(cut == cost ? journal.stats.replayed == 0 : journal.stats.replayed >= 20);
+    }
+}
+
+// A device's history as journal calls: the first write snapshots, then
+// centroid deltas with a new cluster, a threshold change or an idle-time
+// compaction mixed in, and a reset at the end
+typedef enum { OP_CENTROID, OP_CLUSTER, OP_THRESHOLD, OP_COMPACT, OP_CLEAR } op_t;
+
+#define HISTORY 90
+
+static op_t history_step(uint32_t step, kmeans_model_t* m, uint8_t* id) {
+    if (step == HISTORY - 1) return OP_CLEAR;
+    if (step % 10 == 4 && m->k < 6) {
+        fixed_t c[DIM] = {(fixed_t)step, 2, 3, 4};
+        kmeans_set_centroid(m, m->k, c);
+        m->clusters[m->k].count = 1;
+        m->clusters[m->k].inertia = 0;
+        m->clusters[m->k].active = true;
+        snprintf(m->labels[m->k], MAX_LABEL_LENGTH, "new_%u", step);
+        *id = m->k++;
+        return OP_CLUSTER;
+    }
+    if (step % 10 == 7) {
+        m->outlier_threshold += FLOAT_TO_FIXED(0.125f);
+        return OP_THRESHOLD;
+    }
+    if (step % 25 == 24) return OP_COMPACT;
+    *id = (uint8_t)(step % m->k);
+    retrain(m, *id, step);
+    return OP_CENTROID;
+}
+
+static bool run_op(op_t op, const kmeans_model_t* m, uint8_t id) {
+    switch (op) {
+        case OP_CENTROID:  return model_journal_log_centroid(&journal, m, id);
+        case OP_CLUSTER:   return model_journal_log_cluster(&journal, m, id);
+        case OP_THRESHOLD: return model_journal_log_threshold(&journal, m);
+        case OP_COMPACT:   return model_journal_compact(&journal, m);
+        case OP_CLEAR:     return model_journal_clear(&journal);
+    }
+    return false;
+}
+
+static void copy_model(kmeans_model_t* dst, const kmeans_model_t* src) {
+    dst->k = src->k;
+    dst->total_points = src->total_points;
+    dst->outlier_threshold = src->outlier_threshold;
+    dst->learning_rate = src->learning_rate;
+    for (uint8_t i = 0; i < src->k; i++) {
+        fixed_t c[DIM];
+        kmeans_get_centroid(src, i, c);
+        kmeans_set_centroid(dst, i, c);
+        dst->clusters[i] = src->clusters[i];
+        memcpy(dst->labels[i], src->labels[i], MAX_LABEL_LENGTH);
+    }
+}
+
+static uint8_t image[SECTORS * SECTOR];
+
+static void power_up(bool restore) {
+    if (restore) {
+        assert(fseek(flash.fp, 0, SEEK_SET) == 0);
+        assert(fwrite(image, 1, sizeof(image), flash.fp) == sizeof(image));
+    }
+    reboot();
+    flash.tear_erases = true;
+}
+
+// Power cut at every byte written or erased over a whole history, ring
+// wraps and inline compactions included: a reboot always loads the model
+// from just before or just after the interrupted call (a reset may only
+// leave the old model or none), and the journal keeps working
+TEST(power_loss_anywhere) {
+    kmeans_model_t before, after;
+    assert(kmeans_init(&before, DIM, 0.2f));
+    assert(kmeans_init(&after, DIM, 0.2f));
+    kmeans_model_t first;
+    make_model(&first, 3, 8);
+    copy_model(&after, &first);
+    bool had_model = false;
+    uint32_t cuts = 0;
+
+    fresh();
+    for (uint32_t step = 0; step < HISTORY; step++) {
+        copy_model(&before, &after);
+        uint8_t id = 0;
+        op_t op = history_step(step, &after, &id);
+        assert(flash.region.read(0, image, sizeof(image), flash.region.ctx));
+
+        power_up(false);
+        uint32_t start = flash.bytes_written + flash.bytes_erased;
+        assert(run_op(op, &after, id));
+        uint32_t cost = flash.bytes_written + flash.bytes_erased - start;
+
+        for (uint32_t cut = 0; cut <= cost; cut++, cuts++) {
+            power_up(true);
+            flash_file_fail_after(&flash, (long)cut);
+            assert(run_op(op, &after, id) == (cut == cost));
+            flash_file_fail_after(&flash, -1);
+            reboot();
+
+            kmeans_model_t got;
+            assert(kmeans_init(&got, DIM, 0.1f));
+            bool loaded = model_journal_has_model(&journal);
+            if (loaded) assert(model_journal_load(&journal, &got));
+            if (op == OP_CLEAR) {
+                assert(!loaded || (cut < cost && same_model(&got, &before)));
+                continue;
+            }
+            assert(loaded || (!had_model && cut < cost));
+            if (!loaded) continue;
+            assert(same_model(&got, &after) || (cut < cost && same_model(&got, &before)));
+
+            retrain(&got, 0, cut);
+            assert(model_journal_log_centroid(&journal, &got, 0));
+            reboot();
+            assert(load_equals(&got));
+        }
+
+        // Continue the history from the uninterrupted call
+        power_up(true);
+        assert(run_op(op, &after, id));
+        had_model = true;
+    }
+    printf(" [%u cuts]", cuts);
+}
+
+TEST(dim_mismatch) {
+    fresh();
+    kmeans_model_t m;
+    make_model(&m, 2, 1);
+    assert(model_journal_compact(&journal, &m));
+    reboot();
+    kmeans_model_t other;
+    assert(kmeans_init(&other, DIM + 1, 0.2f));
+    assert(!model_journal_load(&journal, &other));
+    assert(other.k == 0);
+}
+
+TEST(unknown_alpha_schedule) {
+    fresh();
+    kmeans_model_t m;
+    make_model(&m, 2, 1);
+    m.alpha_schedule = (alpha_schedule_t)(ALPHA_SCHEDULE_CONSTANT + 1);
+    assert(model_journal_compact(&journal, &m));
+    reboot();
+    kmeans_model_t got;
+    assert(kmeans_init(&got, DIM, 0.2f));
+    assert(!model_journal_load(&journal, &got));
+    assert(got.alpha_schedule == ALPHA_SCHEDULE_DECAY);
+}
+
+TEST(clear) {
+    fresh();
+    kmeans_model_t m;
+    make_model(&m, 3, 1);
+    assert(model_journal_compact(&journal, &m));
+    assert(model_journal_clear(&journal));
+    assert(!model_journal_has_model(&journal));
+    reboot();
+    assert(!model_journal_has_model(&journal));
+
+    // Usable again
+    assert(model_journal_log_cluster(&journal, &m, 0));
+    reboot();
+    assert(load_equals(&m));
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf("Model Journal Tests\n");
+    printf("========================================\n\n");
+
+    RUN_TEST(mount_validation);
+    RUN_TEST(snapshot_round_trip);
+    RUN_TEST(deltas_replay_after_reboot);
+    RUN_TEST(delta_is_small);
+    RUN_TEST(ring_wraps_with_compaction);
+    RUN_TEST(background_compaction);
+    RUN_TEST(power_loss_during_delta);
+    RUN_TEST(power_loss_during_compaction);
+    RUN_TEST(power_loss_anywhere);
+    RUN_TEST(dim_mismatch);
+    RUN_TEST(unknown_alpha_schedule);
+    RUN_TEST(clear);
+
+    flash_file_close(&flash);
+    unlink(PATH);
+    printf("\n========================================\n");
+    printf("All tests passed!\n");
+    printf("========================================\n");
+    return 0;
+}
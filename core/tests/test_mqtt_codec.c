@@ -0,0 +1,215 @@
+/**
+ * @file test_mqtt_codec.c
+ * @brief MQTT JSON encoder output and command decoder edge cases
+ */
+
+#include "../mqtt_codec.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+static mqtt_summary_t sample_summary(void) {
+    mqtt_summary_t s = {
+        .device_id = "motor_01", .state = "NORMAL",
+        .alarm_active = false, .waiting_label = false, .motor_running = true,
+        .cluster = 0, .label = "normal", .k = 1, .total_points = 12500,
+        .vib_rms_avg = 5.2f, .vib_rms_max = 6.1f, .vib_peak_max = 9.1f, .vib_crest_avg = 1.75f,
+        .has_current = true, .current_rms_avg = 2.3f, .current_rms_max = 2.5f,
+        .baseline = 9.81f, .buffer_samples = 0, .sample_count = 100, .timestamp = 123456,
+    };
+    return s;
+}
+
+static const char* float_json(float v, uint8_t decimals) {
+    static char buf[64];
+    json_writer_t w;
+    json_begin(&w, buf, sizeof(buf));
+    json_float(&w, "v", v, decimals);
+    assert(json_end(&w) > 0);
+    return buf;
+}
+
+TEST(summary_matches_schema) {
+    mqtt_summary_t s = sample_summary();
+    char buf[512];
+    size_t len = mqtt_encode_summary(&s, buf, sizeof(buf));
+    const char* want =
+        "{\"device_id\":\"motor_01\",\"state\":\"NORMAL\",\"alarm_active\":false,"
+        "\"waiting_label\":false,\"motor_running\":true,\"cluster\":0,\"label\":\"normal\","
+        "\"k\":1,\"total_points\":12500,\"vib_rms_avg\":5.2,\"vib_rms_max\":6.1,"
+        "\"vib_peak_max\":9.1,\"vib_crest_avg\":1.75,\"current_rms_avg\":2.3,"
+        "\"current_rms_max\":2.5,\"baseline\":9.81,\"buffer_samples\":0,"
+        "\"sample_count\":100,\"timestamp\":123456}";
+    assert(strcmp(buf, want) == 0);
+    assert(len == strlen(want));
+
+    s.has_current = false;
+    s.cluster = -1;
+    mqtt_encode_summary(&s, buf, sizeof(buf));
+    assert(strstr(buf, "current_rms") == NULL);
+    assert(strstr(buf, "\"cluster\":-1,") != NULL);
+}
+
+TEST(overflow_never_writes_past_cap) {
+    mqtt_summary_t s = sample_summary();
+    char full[512];
+    size_t len = mqtt_encode_summary(&s, full, sizeof(full));
+
+    char buf[600];
+    for (size_t cap = 0; cap <= len + 1; cap++) {
+        memset(buf, 'X', sizeof(buf));
+        size_t got = mqtt_encode_summary(&s, buf, cap);
+        if (cap > len) {
+            assert(got == len && strcmp(buf, full) == 0);
+        } else {
+            assert(got == 0);
+            if (cap) assert(buf[0] == '\0');
+        }
+        for (size_t i = cap; i < sizeof(buf); i++) assert(buf[i] == 'X');
+    }
+    assert(mqtt_encode_summary(&s, NULL, 100) == 0);
+}
+
+TEST(string_escaping) {
+    char buf[128];
+    json_writer_t w;
+    json_begin(&w, buf, sizeof(buf));
+    json_str(&w, "label", "a\"b\\c\nd\x01 \xc3\xa9");
+    json_str(&w, "none", NULL);
+    assert(json_end(&w) > 0);
+    assert(strcmp(buf, "{\"label\":\"a\\\"b\\\\c\\nd\\u0001 \xc3\xa9\",\"none\":null}") == 0);
+}
+
+TEST(number_formatting) {
+    assert(strcmp(float_json(0, 4), "{\"v\":0}") == 0);
+    assert(strcmp(float_json(-0.00001f, 4), "{\"v\":0}") == 0);
+    assert(strcmp(float_json(-1.5f, 4), "{\"v\":-1.5}") == 0);
+    assert(strcmp(float_json(0.12345f, 4), "{\"v\":0.1235}") == 0);
+    assert(strcmp(float_json(9.99996f, 4), "{\"v\":10}") == 0);
+    assert(strcmp(float_json(123456.0f, 0), "{\"v\":123456}") == 0);
+    assert(strcmp(float_json(NAN, 4), "{\"v\":null}") == 0);
+    assert(strcmp(float_json(-INFINITY, 4), "{\"v\":null}") == 0);
+    assert(strcmp(float_json(3.0e20f, 4), "{\"v\":3.000000e+20}") == 0);
+    assert(strcmp(float_json(-1.0e30f, 4), "{\"v\":-1.000000e+30}") == 0);
+
+    char buf[64];
+    json_writer_t w;
+    json_begin(&w, buf, sizeof(buf));
+    json_int(&w, "a", INT32_MIN);
+    json_uint(&w, "b", UINT32_MAX);
+    json_bool(&w, "c", true);
+    assert(json_end(&w) > 0);
+    assert(strcmp(buf, "{\"a\":-2147483648,\"b\":4294967295,\"c\":true}") == 0);
+
+    json_begin(&w, buf, sizeof(buf));
+    assert(json_end(&w) == 2 && strcmp(buf, "{}") == 0);
+}
+
+static bool decode(const char* json, mqtt_command_t* cmd) {
+    return mqtt_decode_command(json, strlen(json), cmd);
+}
+
+TEST(decode_commands) {
+    mqtt_command_t c;
+    assert(decode("{\"label\": \"bearing_outer_race\"}", &c));
+    assert(c.has_label && strcmp(c.label, "bearing_outer_race") == 0);
+    assert(!c.has_discard && !c.has_cluster_id);
+
+    assert(decode(" {\"discard\":true}\n", &c) && c.has_discard && c.discard);
+    assert(decode("{\"freeze\":false}", &c) && c.has_freeze && !c.freeze);
+    assert(decode("{\"reset\":true}", &c) && c.has_reset && c.reset);
+    assert(decode("{\"export\":true}", &c) && c.has_export && c.export_model);
+    assert(decode("{\"cluster_id\":1}", &c) && c.has_cluster_id && c.cluster_id == 1);
+    assert(decode("{\"cluster_id\":-1}", &c) && c.cluster_id == -1);  // Device's own echo
+    assert(decode("{\"cluster_id\":2.9}", &c) && c.cluster_id == 2);
+    assert(decode("{\"cluster_id\":1e2}", &c) && c.cluster_id == 1);  // Integer part only
+    assert(decode("{\"cluster_id\":99999999999}", &c) && c.cluster_id == INT32_MAX);
+    assert(decode("{}", &c) && !c.has_label && !c.has_reset);
+}
+
+TEST(decode_type_mismatch_and_unknown_keys) {
+    mqtt_command_t c;
+    // Wrong types read as absent, like a null JsonVariant
+    assert(decode("{\"label\":5,\"discard\":\"yes\",\"cluster_id\":\"1\"}", &c));
+    assert(!c.has_label && !c.has_discard && !c.has_cluster_id);
+
+    // Unknown keys and nested values are skipped
+    assert(decode("{\"meta\":{\"a\":[1,2,{\"b\":null}],\"c\":\"}\"},\"x\":null,\"reset\":true}", &c));
+    assert(c.has_reset && c.reset);
+    assert(decode("{\"a_very_long_unknown_key_name\":1,\"freeze\":true}", &c) && c.freeze);
+}
+
+TEST(decode_strings) {
+    mqtt_command_t c;
+    assert(decode("{\"label\":\"a\\\"b\\\\c\\/d\\u00e9\\ud83d\\ude00\"}", &c));
+    assert(strcmp(c.label, "a\"b\\c/d\xc3\xa9\xf0\x9f\x98\x80") == 0);
+
+    // Truncated to MQTT_LABEL_MAX - 1, still terminated
+    assert(decode("{\"label\":\"0123456789012345678901234567890123456789\"}", &c));
+    assert(strlen(c.label) == MQTT_LABEL_MAX - 1);
+    assert(strncmp(c.label, "0123456789", 10) == 0);
+}
+
+TEST(decode_rejects_malformed) {
+    mqtt_command_t c;
+    const char* bad[] = {
+        "", "   ", "[]", "{", "}", "{\"label\"}", "{\"label\":}", "{\"label\":\"x}",
+        "{\"reset\":tru}", "{\"reset\":true,}", "{\"reset\":true} x", "{\"a\":01}",
+        "{\"a\":-}", "{\"a\":1.}", "{\"a\":\"\\q\"}", "{\"a\":\"\\u12\"}", "{\"a\":\"\\ud83d\"}",
+        "{\"a\":[1,2}", "{label:\"x\"}", "{\"a\":\"tab\there\"}",
+        "{\"a\":[[[[[[[[[[[[1]]]]]]]]]]]]}",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        assert(!decode(bad[i], &c));
+        assert(!c.has_label && !c.has_reset);  // Output cleared
+    }
+    assert(!mqtt_decode_command(NULL, 5, &c));
+}
+
+TEST(decode_respects_length) {
+    // MQTT payloads are not NUL-terminated: bytes past len must be ignored
+    const char raw[] = "{\"reset\":true}GARBAGE";
+    mqtt_command_t c;
+    assert(mqtt_decode_command(raw, 14, &c) && c.reset);
+    assert(!mqtt_decode_command(raw, 13, &c));
+    assert(!mqtt_decode_command(raw, sizeof(raw) - 1, &c));
+}
+
+TEST(round_trip_label) {
+    // A label the device echoes must decode back to the same bytes
+    const char* label = "unbalance \"200g\" \\ A\tB";
+    char buf[128];
+    json_writer_t w;
+    json_begin(&w, buf, sizeof(buf));
+    json_str(&w, "label", label);
+    size_t len = json_end(&w);
+    mqtt_command_t c;
+    assert(mqtt_decode_command(buf, len, &c));
+    assert(c.has_label && strcmp(c.label, label) == 0);
+}
+
+int main() {
+    printf("\n=== MQTT Codec Tests ===\n\n");
+
+    RUN_TEST(summary_matches_schema);
+    RUN_TEST(overflow_never_writes_past_cap);
+    RUN_TEST(string_escaping);
+    RUN_TEST(number_formatting);
+    RUN_TEST(decode_commands);
+    RUN_TEST(decode_type_mismatch_and_unknown_keys);
+    RUN_TEST(decode_strings);
+    RUN_TEST(decode_rejects_malformed);
+    RUN_TEST(decode_respects_length);
+    RUN_TEST(round_trip_label);
+
+    printf("\n✓ All MQTT codec tests passed\n\n");
+    return 0;
+}
@@ -0,0 +1,418 @@
+/**
+ * @file test_offline_queue.c
+ * @brief Store-and-forward flash queue on a file-backed flash region
+ *
+ * Remounting the same file stands in for a reboot; flash_file.h enforces
+ * NOR write rules and cuts writes short to simulate power loss.
+ */
+
+#include "../offline_queue.h"
+#include "host/flash_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define PATH "/tmp/test_offline_queue.bin"
+#define SECTOR 256
+#define SECTORS 4
+
+static flash_file_t flash;
+static offline_queue_t q;
+
+static void fresh(uint32_t sectors) {
+    flash_file_close(&flash);
+    unlink(PATH);
+    assert(flash_file_open(&flash, PATH, sectors, SECTOR));
+    assert(offline_queue_mount(&q, &flash.region));
+}
+
+// Close and reopen the file, then mount again
+static void reboot(void) {
+    uint32_t sectors = flash.region.size / SECTOR;
+    flash_file_close(&flash);
+    assert(flash_file_open(&flash, PATH, sectors, SECTOR));
+    assert(offline_queue_mount(&q, &flash.region));
+}
+
+// Message i: type i%4, length 10 + i%40, bytes derived from i
+static uint16_t make_msg(uint32_t i, uint8_t* buf) {
+    uint16_t len = (uint16_t)(10 + i % 40);
+    memcpy(buf, &i, 4);
+    for (uint16_t k = 4; k < len; k++) buf[k] = (uint8_t)(i * 7 + k);
+    return len;
+}
+
+static bool push_msg(uint32_t i) {
+    uint8_t buf[64];
+    uint16_t len = make_msg(i, buf);
+    return offline_queue_push(&q, (uint8_t)(i % 4), buf, len);
+}
+
+// Peeks and checks that the head is message i (does not pop)
+static void expect_head(uint32_t i) {
+    uint8_t want[64], got[256], type;
+    uint16_t len = make_msg(i, want);
+    uint16_t n = offline_queue_peek(&q, &type, got, sizeof(got));
+    assert(n == len);
+    assert(type == i % 4);
+    assert(memcmp(got, want, len) == 0);
+}
+
+static uint32_t head_index(void) {
+    uint8_t got[256], type;
+    assert(offline_queue_peek(&q, &type, got, sizeof(got)) > 0);
+    uint32_t i;
+    memcpy(&i, got, 4);
+    return i;
+}
+
+TEST(mount_validation) {
+    fresh(SECTORS);
+    flash_region_t one = flash.region;
+    one.size = SECTOR;
+    assert(!offline_queue_mount(&q, &one));
+    assert(!offline_queue_mount(&q, NULL));
+    assert(offline_queue_mount(&q, &flash.region));
+    assert(offline_queue_count(&q) == 0);
+    uint8_t buf[SECTOR];
+    memset(buf, 0, sizeof(buf));
+    assert(!offline_queue_push(&q, 0, buf, 0));
+    assert(!offline_queue_push(&q, 0, buf, OFFLINE_QUEUE_MAX_PAYLOAD(SECTOR) + 1));
+    assert(offline_queue_push(&q, 0, buf, OFFLINE_QUEUE_MAX_PAYLOAD(SECTOR)));
+    assert(offline_queue_peek(&q, NULL, buf, sizeof(buf)) == OFFLINE_QUEUE_MAX_PAYLOAD(SECTOR));
+}
+
+TEST(fifo_order) {
+    fresh(SECTORS);
+    uint8_t buf[64];
+    assert(offline_queue_peek(&q, NULL, buf, sizeof(buf)) == 0);
+    assert(!offline_queue_pop(&q));
+    for (uint32_t i = 0; i < 8; i++) assert(push_msg(i));
+    assert(offline_queue_count(&q) == 8);
+    for (uint32_t i = 0; i < 8; i++) {
+        expect_head(i);
+        expect_head(i);  // Peek is repeatable
+        assert(offline_queue_pop(&q));
+    }
+    assert(offline_queue_count(&q) == 0);
+    assert(offline_queue_peek(&q, NULL, buf, sizeof(buf)) == 0);
+}
+
+TEST(survives_reboot) {
+    fresh(SECTORS);
+    for (uint32_t i = 0; i < 10; i++) assert(push_msg(i));
+    for (int i = 0; i < 3; i++) assert(offline_queue_pop(&q));
+    reboot();
+    assert(offline_queue_count(&q) == 7);
+    expect_head(3);
+
+    // Appends continue after the last record
+    assert(push_msg(10));
+    reboot();
+    assert(offline_queue_count(&q) == 8);
+    for (uint32_t i = 3; i <= 10; i++) {
+        expect_head(i);
+        assert(offline_queue_pop(&q));
+    }
+    reboot();
+    assert(offline_queue_count(&q) == 0);
+}
+
+TEST(full_ring_drops_oldest) {
+    fresh(SECTORS);
+    uint32_t n = 200;
+    for (uint32_t i = 0; i < n; i++) assert(push_msg(i));
+    uint32_t kept = offline_queue_count(&q);
+    assert(kept > 0 && kept < n);
+    assert(q.stats.dropped == n - kept);
+
+    // What is left is the newest run, in order, across a reboot too
+    reboot();
+    assert(offline_queue_count(&q) == kept);
+    for (uint32_t i = n - kept; i < n; i++) {
+        expect_head(i);
+        assert(offline_queue_pop(&q));
+    }
+    assert(offline_queue_count(&q) == 0);
+}
+
+TEST(wear_is_even) {
+    fresh(8);
+    for (uint32_t i = 0; i < 5000; i++) {
+        assert(push_msg(i));
+        if (i % 3 == 0) {
+            expect_head(head_index());
+            assert(offline_queue_pop(&q));
+        }
+    }
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (int s = 0; s < 8; s++) {
+        if (flash.erases[s] < lo) lo = flash.erases[s];
+        if (flash.erases[s] > hi) hi = flash.erases[s];
+    }
+    assert(lo > 0 && hi - lo <= 1);
+}
+
+static int drain_budget;
+static uint32_t drain_next;
+
+static bool counting_send(uint8_t type, const uint8_t* data, uint16_t len, void* ctx) {
+    (void)ctx;
+    if (drain_budget-- <= 0) return false;
+    uint32_t i;
+    memcpy(&i, data, 4);
+    assert(i == drain_next++ && type == i % 4 && len == 10 + i % 40);
+    return true;
+}
+
+TEST(drain) {
+    fresh(SECTORS);
+    for (uint32_t i = 0; i < 9; i++) assert(push_msg(i));
+    uint8_t buf[64];
+    drain_next = 0;
+    drain_budget = 100;
+    assert(offline_queue_drain(&q, counting_send, NULL, buf, sizeof(buf), 4) == 4);  // Rate limit
+    drain_budget = 2;
+    assert(offline_queue_drain(&q, counting_send, NULL, buf, sizeof(buf), 10) == 2);  // Broker gone
+    assert(offline_queue_count(&q) == 3);
+    drain_budget = 100;
+    assert(offline_queue_drain(&q, counting_send, NULL, buf, sizeof(buf), 10) == 3);
+    assert(offline_queue_count(&q) == 0 && q.stats.delivered == 9);
+
+    // Oversized messages are skipped, not stuck
+    assert(push_msg(39));  // 49 bytes
+    assert(offline_queue_peek(&q, NULL, buf, 20) == 0);
+    assert(offline_queue_count(&q) == 0 && q.stats.dropped == 1 && q.stats.delivered == 9);
+}
+
+// Power cut at every byte of an append, including ones that open a segment
+TEST(power_loss_during_push) {
+    for (uint32_t victim = 0; victim < 14; victim++) {
+        fresh(SECTORS);
+        for (uint32_t i = 0; i < victim; i++) assert(push_msg(i));
+        reboot();
+
+        // Bytes the next push writes (erase is not a byte write)
+        uint32_t before = flash.bytes_written;
+        assert(push_msg(victim));
+        uint32_t cost = flash.bytes_written - before;
+
+        for (uint32_t cut = 0; cut <= cost; cut++) {
+            fresh(SECTORS);
+            for (uint32_t i = 0; i < victim; i++) assert(push_msg(i));
+            reboot();
+            flash_file_fail_after(&flash, (long)cut);
+            bool ok = push_msg(victim);
+            assert(ok == (cut == cost));
+            flash_file_fail_after(&flash, -1);
+
+            reboot();
+            uint32_t n = offline_queue_count(&q);
+            assert(n == victim || (n == victim + 1 && cut == cost));
+            // Queue still works: append after the damage and read everything back
+            assert(push_msg(100));
+            reboot();
+            for (uint32_t i = 0; i < n; i++) {
+                expect_head(i);
+                assert(offline_queue_pop(&q));
+            }
+            expect_head(100);
+            assert(offline_queue_pop(&q));
+            assert(offline_queue_count(&q) == 0);
+        }
+    }
+}
+
+// Same while the ring is full, so the push also erases the oldest segment
+TEST(power_loss_while_wrapping) {
+    const uint32_t prefill = 60;
+    for (uint32_t victim = prefill; victim < prefill + 10; victim++) {
+        fresh(SECTORS);
+        for (uint32_t i = 0; i < victim; i++) assert(push_msg(i));
+        uint32_t before_count = offline_queue_count(&q);
+        uint32_t before = flash.bytes_written;
+        assert(push_msg(victim));
+        uint32_t cost = flash.bytes_written - before;
+
+        for (uint32_t cut = 0; cut <= cost; cut++) {
+            fresh(SECTORS);
+            for (uint32_t i = 0; i < victim; i++) assert(push_msg(i));
+            flash_file_fail_after(&flash, (long)cut);
+            assert(push_msg(victim) == (cut == cost));
+            flash_file_fail_after(&flash, -1);
+
+            // A contiguous run of the newest messages, at most one segment lost
+            reboot();
+            uint32_t n = offline_queue_count(&q);
+            uint32_t last = cut == cost ? victim : victim - 1;
+            assert(n > 0 && n <= before_count + 1 && n + SECTOR / 20 >= before_count);
+            for (uint32_t i = last + 1 - n; i <= last; i++) {
+                expect_head(i);
+                assert(offline_queue_pop(&q));
+            }
+            assert(offline_queue_count(&q) == 0);
+        }
+    }
+}
+
+// Erases cut short too, at every byte of each push that reclaims a segment:
+// a half-erased segment must never mount again with its old messages
+TEST(power_loss_during_reclaim_erase) {
+    const uint32_t prefill = 60;
+    uint32_t reclaims = 0;
+    for (uint32_t victim = prefill; victim < prefill + 40; victim++) {
+        fresh(SECTORS);
+        flash.tear_erases = true;
+        for (uint32_t i = 0; i < victim; i++) assert(push_msg(i));
+        uint32_t before_count = offline_queue_count(&q);
+        uint32_t erases = q.stats.erases;
+        uint32_t before = flash.bytes_written + flash.bytes_erased;
+        assert(push_msg(victim));
+        if (q.stats.erases == erases) continue;
+        uint32_t cost = flash.bytes_written + flash.bytes_erased - before;
+        reclaims++;
+
+        for (uint32_t cut = 0; cut <= cost; cut++) {
+            fresh(SECTORS);
+            flash.tear_erases = true;
+            for (uint32_t i = 0; i < victim; i++) assert(push_msg(i));
+            flash_file_fail_after(&flash, (long)cut);
+            assert(push_msg(victim) == (cut == cost));
+            flash_file_fail_after(&flash, -1);
+
+            reboot();
+            uint32_t n = offline_queue_count(&q);
+            uint32_t last = cut == cost ? victim : victim - 1;
+            assert(n > 0 && n <= before_count + 1 && n + SECTOR / 20 >= before_count);
+            for (uint32_t i = last + 1 - n; i <= last; i++) {
+                expect_head(i);
+                assert(offline_queue_pop(&q));
+            }
+            assert(offline_queue_count(&q) == 0);
+            assert(push_msg(200));
+            reboot();
+            expect_head(200);
+        }
+    }
+    assert(reclaims >= 2);
+}
+
+TEST(power_loss_during_pop) {
+    fresh(SECTORS);
+    for (uint32_t i = 0; i < 5; i++) assert(push_msg(i));
+    flash_file_fail_after(&flash, 0);
+    assert(!offline_queue_pop(&q));
+    flash_file_fail_after(&flash, -1);
+    reboot();
+    // At-least-once: the message is still there
+    assert(offline_queue_count(&q) == 5);
+    expect_head(0);
+}
+
+TEST(corrupt_record_skipped) {
+    fresh(SECTORS);
+    for (uint32_t i = 0; i < 4; i++) assert(push_msg(i));
+    flash_file_close(&flash);
+
+    // Flip a payload bit of message 1 (segment 0, after message 0)
+    FILE* fp = fopen(PATH, "r+b");
+    uint32_t off = OFFLINE_QUEUE_SEGMENT_HEADER + ((OFFLINE_QUEUE_RECORD_HEADER + 10 + 3) & ~3u) +
+                   OFFLINE_QUEUE_RECORD_HEADER + 5;
+    fseek(fp, off, SEEK_SET);
+    int c = fgetc(fp);
+    fseek(fp, off, SEEK_SET);
+    fputc(c ^ 0x10, fp);
+    fclose(fp);
+
+    assert(flash_file_open(&flash, PATH, SECTORS, SECTOR));
+    assert(offline_queue_mount(&q, &flash.region));
+    assert(q.stats.corrupt == 1);
+    // Message 0 survives; 1 and what followed it in that segment are gone
+    expect_head(0);
+    assert(offline_queue_pop(&q));
+    assert(offline_queue_count(&q) == 0);
+    assert(push_msg(50));
+    reboot();
+    expect_head(50);
+}
+
+TEST(foreign_region_mounts_empty) {
+    fresh(SECTORS);
+    flash_file_close(&flash);
+    FILE* fp = fopen(PATH, "r+b");
+    for (int i = 0; i < SECTORS * SECTOR; i++) fputc((i * 37) & 0xFF, fp);
+    fclose(fp);
+    assert(flash_file_open(&flash, PATH, SECTORS, SECTOR));
+    assert(offline_queue_mount(&q, &flash.region));
+    assert(offline_queue_count(&q) == 0);
+    assert(push_msg(1) && push_msg(2));
+    reboot();
+    expect_head(1);
+}
+
+TEST(clear) {
+    fresh(SECTORS);
+    for (uint32_t i = 0; i < 20; i++) assert(push_msg(i));
+    assert(offline_queue_clear(&q));
+    assert(offline_queue_count(&q) == 0);
+    reboot();
+    assert(offline_queue_count(&q) == 0);
+    assert(push_msg(7));
+    expect_head(7);
+
+    // Cut anywhere: whatever survives is still the newest run, nothing older
+    fresh(SECTORS);
+    flash.tear_erases = true;
+    for (uint32_t i = 0; i < 20; i++) assert(push_msg(i));
+    uint32_t before = flash.bytes_written + flash.bytes_erased;
+    assert(offline_queue_clear(&q));
+    uint32_t cost = flash.bytes_written + flash.bytes_erased - before;
+    for (uint32_t cut = 0; cut < cost; cut++) {
+        fresh(SECTORS);
+        flash.tear_erases = true;
+        for (uint32_t i = 0; i < 20; i++) assert(push_msg(i));
+        flash_file_fail_after(&flash, (long)cut);
+        assert(!offline_queue_clear(&q));
+        flash_file_fail_after(&flash, -1);
+        reboot();
+        uint32_t n = offline_queue_count(&q);
+        assert(n <= 20);
+        for (uint32_t i = 20 - n; i < 20; i++) {
+            expect_head(i);
+            assert(offline_queue_pop(&q));
+        }
+    }
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf("Offline Queue Tests\n");
+    printf("========================================\n\n");
+
+    RUN_TEST(mount_validation);
+    RUN_TEST(fifo_order);
+    RUN_TEST(survives_reboot);
+    RUN_TEST(full_ring_drops_oldest);
+    RUN_TEST(wear_is_even);
+    RUN_TEST(drain);
+    RUN_TEST(power_loss_during_push);
+    RUN_TEST(power_loss_while_wrapping);
+    RUN_TEST(power_loss_during_reclaim_erase);
+    RUN_TEST(power_loss_during_pop);
+    RUN_TEST(corrupt_record_skipped);
+    RUN_TEST(foreign_region_mounts_empty);
+    RUN_TEST(clear);
+
+    flash_file_close(&flash);
+    unlink(PATH);
+    printf("\n✓ All offline queue tests passed\n");
+    return 0;
+}
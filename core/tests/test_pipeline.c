@@ -0,0 +1,242 @@
+/**
+ * @file test_pipeline.c
+ * @brief SPSC ring and windowing: single-thread semantics + two-thread stress
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../sample_pipeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define STRESS_SAMPLES 2000000u  // < 2^24, so the sequence is exact in a float
+#define STRESS_RING 4096         // Large enough that one-CPU hosts hand off rarely
+
+static accel_sample_t slots[STRESS_RING];
+
+static accel_sample_t make(uint32_t seq) {
+    accel_sample_t s = {(float)seq, (float)(seq & 0xFF), -(float)seq};
+    return s;
+}
+
+static void check(const accel_sample_t* s, uint32_t seq) {
+    assert(s->x == (float)seq);
+    assert(s->y == (float)(seq & 0xFF));
+    assert(s->z == -(float)seq);
+}
+
+TEST(init_rejects_bad_capacity) {
+    spsc_ring_t r;
+    assert(!spsc_init(&r, slots, 0));
+    assert(!spsc_init(&r, slots, 1));
+    assert(!spsc_init(&r, slots, 100));
+    assert(!spsc_init(&r, NULL, 64));
+    assert(spsc_init(&r, slots, 64));
+    assert(spsc_count(&r) == 0);
+}
+
+TEST(fifo_order_and_full_drop) {
+    spsc_ring_t r;
+    assert(spsc_init(&r, slots, 8));
+    accel_sample_t s;
+    assert(!spsc_pop(&r, &s));
+
+    for (uint32_t i = 0; i < 8; i++) {
+        s = make(i);
+        assert(spsc_push(&r, &s));
+    }
+    s = make(99);
+    assert(!spsc_try_push(&r, &s));  // Full: rejected, nothing counted
+    assert(spsc_dropped(&r) == 0);
+    assert(!spsc_push(&r, &s));      // Full: dropped, not overwritten
+    assert(spsc_dropped(&r) == 1);
+    assert(spsc_count(&r) == 8);
+
+    for (uint32_t i = 0; i < 8; i++) {
+        assert(spsc_pop(&r, &s));
+        check(&s, i);
+    }
+    assert(!spsc_pop(&r, &s));
+}
+
+TEST(index_wraparound) {
+    // Free-running uint32 indices must survive overflow
+    spsc_ring_t r;
+    assert(spsc_init(&r, slots, 16));
+    r.head = r.tail = 0xFFFFFFF0u;
+
+    accel_sample_t s;
+    for (uint32_t round = 0; round < 8; round++) {
+        for (uint32_t i = 0; i < 16; i++) {
+            s = make(round * 16 + i);
+            assert(spsc_push(&r, &s));
+        }
+        s = make(0);
+        assert(!spsc_push(&r, &s));
+        for (uint32_t i = 0; i < 16; i++) {
+            assert(spsc_pop(&r, &s));
+            check(&s, round * 16 + i);
+        }
+        assert(spsc_count(&r) == 0);
+    }
+    assert(r.head < 0xFFFFFFF0u);  // Really wrapped
+}
+
+// =============================================================================
+// TWO-THREAD STRESS
+// =============================================================================
+
+typedef struct {
+    spsc_ring_t ring;
+    bool retry;         // Producer waits on full instead of dropping
+    uint32_t accepted;  // Pushes that succeeded
+} stress_t;
+
+static void* producer(void* arg) {
+    stress_t* st = (stress_t*)arg;
+    for (uint32_t seq = 0; seq < STRESS_SAMPLES; seq++) {
+        accel_sample_t s = make(seq);
+        if (!st->retry) {
+            spsc_push(&st->ring, &s);
+            continue;
+        }
+        while (!spsc_try_push(&st->ring, &s)) sched_yield();
+    }
+    st->accepted = STRESS_SAMPLES - spsc_dropped(&st->ring);
+    return NULL;
+}
+
+// Consumes until the producer is done and the ring is empty
+static uint32_t consume(stress_t* st, pthread_t prod, bool expect_all) {
+    uint32_t received = 0;
+    int64_t last = -1;
+    accel_sample_t s;
+    for (;;) {
+        if (spsc_pop(&st->ring, &s)) {
+            uint32_t seq = (uint32_t)s.x;
+            check(&s, seq);                  // No torn slot
+            assert((int64_t)seq > last);     // Order kept
+            if (expect_all) assert((int64_t)seq == last + 1);  // Nothing lost
+            last = seq;
+            received++;
+            continue;
+        }
+        if (received + spsc_dropped(&st->ring) == STRESS_SAMPLES) break;
+        sched_yield();
+    }
+    pthread_join(prod, NULL);
+    assert(spsc_count(&st->ring) == 0);
+    return received;
+}
+
+TEST(stress_lossless) {
+    stress_t st = {.retry = true};
+    assert(spsc_init(&st.ring, slots, STRESS_RING));
+    pthread_t prod;
+    pthread_create(&prod, NULL, producer, &st);
+
+    uint32_t received = consume(&st, prod, true);
+    assert(received == STRESS_SAMPLES);
+    assert(spsc_dropped(&st.ring) == 0);
+}
+
+TEST(stress_with_drops) {
+    // Tiny ring + slow consumer: every sample is either received or counted
+    static accel_sample_t small[4];
+    stress_t st = {.retry = false};
+    assert(spsc_init(&st.ring, small, 4));
+    pthread_t prod;
+    pthread_create(&prod, NULL, producer, &st);
+
+    uint32_t received = consume(&st, prod, false);
+    assert(received == st.accepted);
+    assert(received + spsc_dropped(&st.ring) == STRESS_SAMPLES);
+    printf(" (%u received, %u dropped)", received, spsc_dropped(&st.ring));
+}
+
+// =============================================================================
+// WINDOWING
+// =============================================================================
+
+TEST(window_init_validation) {
+    sample_window_t w;
+    float frame[8];
+    assert(!window_init(&w, frame, 0, 1));
+    assert(!window_init(&w, frame, 8, 0));
+    assert(!window_init(&w, frame, 8, 9));
+    assert(!window_init(&w, NULL, 8, 4));
+    assert(window_init(&w, frame, 8, 8));
+}
+
+TEST(window_tiled) {
+    sample_window_t w;
+    float frame[4], out[4];
+    assert(window_init(&w, frame, 4, 4));
+
+    int ready = 0;
+    for (int i = 0; i < 12; i++) {
+        if (window_push(&w, (float)i)) {
+            ready++;
+            window_read(&w, out);
+            for (int j = 0; j < 4; j++) assert(out[j] == (float)(i - 3 + j));
+            assert(i % 4 == 3);
+        }
+    }
+    assert(ready == 3);
+}
+
+TEST(window_overlapping) {
+    // size 8, hop 3: first window at sample 7, then every 3 samples
+    sample_window_t w;
+    float frame[8], out[8];
+    assert(window_init(&w, frame, 8, 3));
+
+    int ready = 0;
+    for (int i = 0; i < 30; i++) {
+        bool r = window_push(&w, (float)i);
+        assert(r == (i >= 7 && (i - 7) % 3 == 0));
+        if (r) {
+            ready++;
+            window_read(&w, out);
+            for (int j = 0; j < 8; j++) assert(out[j] == (float)(i - 7 + j));
+        }
+    }
+    assert(ready == 8);
+}
+
+TEST(window_reset_refills) {
+    sample_window_t w;
+    float frame[4];
+    assert(window_init(&w, frame, 4, 2));
+    for (int i = 0; i < 5; i++) window_push(&w, 1.0f);
+    window_reset(&w);
+    assert(!window_push(&w, 0) && !window_push(&w, 0) && !window_push(&w, 0));
+    assert(window_push(&w, 0));
+}
+
+int main() {
+    printf("\n=== Sample Pipeline Tests ===\n\n");
+
+    RUN_TEST(init_rejects_bad_capacity);
+    RUN_TEST(fifo_order_and_full_drop);
+    RUN_TEST(index_wraparound);
+    RUN_TEST(stress_lossless);
+    RUN_TEST(stress_with_drops);
+    RUN_TEST(window_init_validation);
+    RUN_TEST(window_tiled);
+    RUN_TEST(window_overlapping);
+    RUN_TEST(window_reset_refills);
+
+    printf("\n✓ All pipeline tests passed\n\n");
+    return 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file test_sliding_stats.c
+ * @brief Incremental window stats vs brute-force recomputation
+ */
+
+#include "../sliding_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define MAX_W 512
+
+typedef struct {
+    double mean, rms, var, skew, kurt, max;
+} ref_t;
+
+// Last n samples of history[0..len-1], in double
+static ref_t brute_force(const float* history, int len, int w) {
+    int n = len < w ? len : w;
+    const float* x = history + len - n;
+    ref_t r = {0, 0, 0, 0, 0, -1e30};
+    for (int i = 0; i < n; i++) {
+        r.mean += x[i];
+        r.rms += (double)x[i] * x[i];
+        if (x[i] > r.max) r.max = x[i];
+    }
+    r.mean /= n;
+    r.rms = sqrt(r.rms / n);
+    double m2 = 0, m3 = 0, m4 = 0;
+    for (int i = 0; i < n; i++) {
+        double d = x[i] - r.mean;
+        m2 += d * d; m3 += d * d * d; m4 += d * d * d * d;
+    }
+    m2 /= n; m3 /= n; m4 /= n;
+    r.var = m2;
+    r.skew = m2 > 0 ? m3 / pow(m2, 1.5) : 0;
+    r.kurt = m2 > 0 ? m4 / (m2 * m2) - 3 : 0;
+    return r;
+}
+
+static int close_to(double got, double want, double rel, double abs_tol) {
+    return fabs(got - want) <= abs_tol + rel * fabs(want);
+}
+
+static float values[MAX_W];
+static uint16_t queue[MAX_W];
+static float history[200000];
+
+// Streams `len` samples and checks every step against brute force
+static void check_stream(int w, int len, double moment_tol) {
+    sliding_stats_t s;
+    assert(sliding_stats_init(&s, values, queue, w));
+    for (int i = 0; i < len; i++) {
+        sliding_stats_push(&s, history[i]);
+        ref_t r = brute_force(history, i + 1, w);
+        double scale = sqrt(r.var) + 1e-6;
+
+        assert(sliding_stats_count(&s) == (i + 1 < w ? i + 1 : w));
+        assert(sliding_stats_max(&s) == (float)r.max);  // Exact
+        assert(close_to(sliding_stats_mean(&s), r.mean, 1e-5, 1e-4 * scale));
+        assert(close_to(sliding_stats_rms(&s), r.rms, 1e-4, 1e-5));
+        assert(close_to(sliding_stats_variance(&s), r.var, moment_tol, 1e-6));
+        if (r.var > 1e-4) {
+            assert(close_to(sliding_stats_skewness(&s), r.skew, moment_tol, moment_tol));
+            assert(close_to(sliding_stats_kurtosis(&s), r.kurt, moment_tol, moment_tol));
+        }
+    }
+}
+
+static float gauss(void) {
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0), v = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return (float)(sqrt(-2 * log(u)) * cos(6.283185307179586 * v));
+}
+
+TEST(init_validation) {
+    sliding_stats_t s;
+    assert(!sliding_stats_init(&s, values, queue, 0));
+    assert(!sliding_stats_init(&s, NULL, queue, 8));
+    assert(!sliding_stats_init(&s, values, NULL, 8));
+    assert(sliding_stats_init(&s, values, queue, 8));
+    assert(sliding_stats_count(&s) == 0);
+    assert(sliding_stats_max(&s) == 0 && sliding_stats_rms(&s) == 0);
+    assert(sliding_stats_kurtosis(&s) == 0);
+}
+
+TEST(random_vibration_magnitudes) {
+    // Non-negative AC magnitudes, like VibrationFilter feeds
+    srand(1);
+    for (int i = 0; i < 20000; i++) history[i] = fabsf(0.5f * gauss()) + 0.05f * (i % 7);
+    check_stream(10, 20000, 2e-3);
+    check_stream(100, 20000, 2e-3);
+    check_stream(256, 20000, 2e-3);
+}
+
+TEST(impulsive_signal) {
+    // Sparse spikes: high kurtosis, the bearing-fault case
+    srand(2);
+    for (int i = 0; i < 20000; i++) {
+        history[i] = 0.1f * fabsf(gauss()) + ((rand() % 50) == 0 ? 5.0f : 0.0f);
+    }
+    check_stream(64, 20000, 5e-3);
+}
+
+TEST(large_offset_long_run) {
+    // 9.8 offset + small AC for 200k samples: no drift, no cancellation
+    srand(3);
+    for (int i = 0; i < 200000; i++) history[i] = 9.8f + 0.01f * gauss();
+    sliding_stats_t s;
+    assert(sliding_stats_init(&s, values, queue, 100));
+    for (int i = 0; i < 200000; i++) sliding_stats_push(&s, history[i]);
+    ref_t r = brute_force(history, 200000, 100);
+    assert(close_to(sliding_stats_mean(&s), r.mean, 1e-6, 0));
+    assert(close_to(sliding_stats_variance(&s), r.var, 1e-2, 0));
+    assert(close_to(sliding_stats_kurtosis(&s), r.kurt, 0, 0.05));
+}
+
+TEST(monotonic_sequences) {
+    // Rising: every push evicts the whole deque. Falling: the deque fills.
+    for (int i = 0; i < 2000; i++) history[i] = (float)i;
+    check_stream(32, 2000, 1e-3);
+    for (int i = 0; i < 2000; i++) history[i] = (float)(2000 - i);
+    check_stream(32, 2000, 1e-3);
+    for (int i = 0; i < 2000; i++) history[i] = (float)((i / 50) % 2 ? i % 50 : 50 - i % 50);
+    check_stream(17, 2000, 1e-3);
+}
+
+TEST(constant_signal) {
+    for (int i = 0; i < 500; i++) history[i] = 9.81f;
+    sliding_stats_t s;
+    assert(sliding_stats_init(&s, values, queue, 50));
+    for (int i = 0; i < 500; i++) sliding_stats_push(&s, history[i]);
+    assert(sliding_stats_max(&s) == 9.81f);
+    assert(fabsf(sliding_stats_mean(&s) - 9.81f) < 1e-5f);
+    assert(sliding_stats_variance(&s) < 1e-6f);
+    assert(sliding_stats_skewness(&s) == 0 && sliding_stats_kurtosis(&s) == 0);
+}
+
+TEST(window_of_one) {
+    sliding_stats_t s;
+    assert(sliding_stats_init(&s, values, queue, 1));
+    for (int i = 0; i < 10; i++) {
+        sliding_stats_push(&s, (float)(i % 3));
+        assert(sliding_stats_max(&s) == (float)(i % 3));
+        assert(sliding_stats_mean(&s) == (float)(i % 3));
+        assert(sliding_stats_variance(&s) == 0);
+    }
+}
+
+TEST(reset_clears_window) {
+    sliding_stats_t s;
+    assert(sliding_stats_init(&s, values, queue, 8));
+    for (int i = 0; i < 20; i++) sliding_stats_push(&s, 100.0f);
+    sliding_stats_reset(&s);
+    sliding_stats_push(&s, 1.0f);
+    sliding_stats_push(&s, 3.0f);
+    assert(sliding_stats_count(&s) == 2);
+    assert(sliding_stats_max(&s) == 3.0f);
+    assert(fabsf(sliding_stats_mean(&s) - 2.0f) < 1e-6f);
+    assert(fabsf(sliding_stats_variance(&s) - 1.0f) < 1e-6f);
+}
+
+int main() {
+    printf("\n=== Sliding Stats Tests ===\n\n");
+
+    RUN_TEST(init_validation);
+    RUN_TEST(random_vibration_magnitudes);
+    RUN_TEST(impulsive_signal);
+    RUN_TEST(large_offset_long_run);
+    RUN_TEST(monotonic_sequences);
+    RUN_TEST(constant_signal);
+    RUN_TEST(window_of_one);
+    RUN_TEST(reset_clears_window);
+
+    printf("\n✓ All sliding stats tests passed\n\n");
+    return 0;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file test_snapshot.c
+ * @brief Multi-model snapshot: write a fleet, mmap it, query the views
+ */
+
+#include "../kmeans_snapshot.h"
+#include "../kmeans_fleet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define K 6
+#define D 5
+#define N 40
+#define PATH "/tmp/test_snapshot.bin"
+
+static uint64_t arena[KMEANS_FLEET_ARENA_SIZE(N, K, D, BOOTSTRAP_SAMPLES) / 8];
+static kmeans_fleet_t fleet;
+
+static void device_id(char* id, int i) {
+    snprintf(id, KMEANS_SNAPSHOT_ID_LEN, "motor_%04d", i);  // Sorted by i
+}
+
+// Device i: 1 + i % K clusters at values derived from i
+static void build_fleet(void) {
+    assert(kmeans_fleet_init(&fleet, arena, sizeof(arena), D, K, BOOTSTRAP_SAMPLES));
+    for (int i = 0; i < N; i++) {
+        kmeans_device_t dev = kmeans_fleet_create(&fleet, 0.2f);
+        kmeans_model_t* m = kmeans_fleet_model(&fleet, dev);
+        m->k = (uint8_t)(1 + i % K);
+        m->total_points = 1000u + i;
+        m->outlier_threshold = FLOAT_TO_FIXED(2.0f + i * 0.01f);
+        m->state = STATE_NORMAL;
+        for (uint8_t c = 0; c < m->k; c++) {
+            fixed_t centroid[D];
+            for (int d = 0; d < D; d++) centroid[d] = FLOAT_TO_FIXED(c * 3.0f + d * 0.5f + i * 0.1f);
+            kmeans_set_centroid(m, c, centroid);
+            m->clusters[c].count = 10u * c + i;
+            m->clusters[c].inertia = FLOAT_TO_FIXED(0.5f + c);
+            m->clusters[c].active = c != 3;
+            snprintf(m->labels[c], MAX_LABEL_LENGTH, c ? "fault_%u" : "normal", c);
+        }
+    }
+}
+
+static void write_fleet(const char* path, int n) {
+    FILE* fp = fopen(path, "wb");
+    assert(fp);
+    kmeans_snapshot_writer_t w;
+    assert(kmeans_snapshot_begin(&w, fp, D, K));
+    for (int i = 0; i < n; i++) {
+        char id[KMEANS_SNAPSHOT_ID_LEN];
+        device_id(id, i);
+        assert(kmeans_snapshot_add(&w, id, kmeans_fleet_model(&fleet, i)));
+    }
+    assert(kmeans_snapshot_finish(&w));
+    fclose(fp);
+}
+
+static void point_near(fixed_t* p, uint8_t c, int i, float jitter) {
+    for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(c * 3.0f + d * 0.5f + i * 0.1f + jitter);
+}
+
+TEST(views_match_fleet) {
+    build_fleet();
+    write_fleet(PATH, N);
+
+    kmeans_snapshot_t s;
+    assert(kmeans_snapshot_map(&s, PATH));
+    assert(s.count == N && s.feature_dim == D && s.max_clusters == K);
+    assert(s.map_size == KMEANS_SNAPSHOT_HEADER_SIZE + (size_t)N * KMEANS_SNAPSHOT_RECORD_SIZE(K, D));
+
+    for (int i = 0; i < N; i++) {
+        char id[KMEANS_SNAPSHOT_ID_LEN];
+        device_id(id, i);
+        int32_t index = kmeans_snapshot_find(&s, id);
+        assert(index == i);
+        assert(strcmp(kmeans_snapshot_id(&s, (uint32_t)index), id) == 0);
+
+        kmeans_model_header_t header;  // Header-only: the view needs no storage
+        kmeans_model_t* view = kmeans_model_of(&header);
+        const kmeans_model_t* m = kmeans_fleet_model(&fleet, i);
+        assert(kmeans_snapshot_model(&s, (uint32_t)index, view));
+        assert(view->k == m->k && view->total_points == m->total_points);
+        assert(view->outlier_threshold == m->outlier_threshold);
+
+        // Pointers lead into the mapping: nothing was copied
+        const uint8_t* lo = (const uint8_t*)s.map;
+        assert((const uint8_t*)view->centroids > lo && (const uint8_t*)view->centroids < lo + s.map_size);
+
+        for (uint8_t c = 0; c < m->k; c++) {
+            fixed_t a[D], b[D];
+            char la[MAX_LABEL_LENGTH], lb[MAX_LABEL_LENGTH];
+            assert(kmeans_get_centroid(view, c, a) && kmeans_get_centroid(m, c, b));
+            assert(memcmp(a, b, sizeof(a)) == 0);
+            assert(kmeans_get_label(view, c, la) && kmeans_get_label(m, c, lb));
+            assert(strcmp(la, lb) == 0);
+            assert(view->clusters[c].count == m->clusters[c].count);
+            assert(view->clusters[c].active == m->clusters[c].active);
+
+            fixed_t p[D];
+            point_near(p, c, i, 0.2f);
+            assert(kmeans_predict(view, p) == kmeans_predict(m, p));
+            assert(kmeans_is_outlier(view, p) == kmeans_is_outlier(m, p));
+            point_near(p, c, i, 40.0f);
+            assert(kmeans_is_outlier(view, p) == kmeans_is_outlier(m, p));
+        }
+    }
+    kmeans_snapshot_unmap(&s);
+    assert(s.base == NULL);
+}
+
+TEST(unknown_ids) {
+    kmeans_snapshot_t s;
+    assert(kmeans_snapshot_map(&s, PATH));
+    assert(kmeans_snapshot_find(&s, "motor_9999") == -1);
+    assert(kmeans_snapshot_find(&s, "a") == -1);
+    assert(kmeans_snapshot_find(&s, "motor_0000x") == -1);
+    assert(kmeans_snapshot_id(&s, N) == NULL);
+    kmeans_model_t view;
+    assert(!kmeans_snapshot_model(&s, N, &view));
+    kmeans_snapshot_unmap(&s);
+}
+
+TEST(writer_rejects_bad_input) {
+    FILE* fp = fopen(PATH, "wb");
+    kmeans_snapshot_writer_t w;
+    assert(!kmeans_snapshot_begin(&w, fp, 0, K));
+    assert(!kmeans_snapshot_begin(&w, fp, D, MAX_CLUSTERS + 1));
+    assert(kmeans_snapshot_begin(&w, fp, D, K - 1));
+
+    kmeans_model_t* m = kmeans_fleet_model(&fleet, 1);  // k = 2
+    assert(kmeans_snapshot_add(&w, "b", m));
+    assert(!kmeans_snapshot_add(&w, "b", m));  // Not increasing
+    assert(!kmeans_snapshot_add(&w, "a", m));
+    assert(!kmeans_snapshot_add(&w, "", m));
+    assert(!kmeans_snapshot_add(&w, "c_an_id_that_is_far_too_long_for_it", m));
+    assert(!kmeans_snapshot_add(&w, "c", kmeans_fleet_model(&fleet, K - 1)));  // k = K > K - 1
+
+    uint64_t other_arena[KMEANS_FLEET_SLOT_SIZE(K, D + 1, BOOTSTRAP_SAMPLES) / 8];
+    kmeans_fleet_t other;
+    assert(kmeans_fleet_init(&other, other_arena, sizeof(other_arena), D + 1, K, BOOTSTRAP_SAMPLES));
+    assert(!kmeans_snapshot_add(&w, "d", kmeans_fleet_model(&other, kmeans_fleet_create(&other, 0.2f))));
+
+    assert(kmeans_snapshot_add(&w, "e", m));
+    assert(kmeans_snapshot_finish(&w));
+    fclose(fp);
+
+    kmeans_snapshot_t s;
+    assert(kmeans_snapshot_map(&s, PATH));
+    assert(s.count == 2 && s.max_clusters == K - 1);
+    assert(kmeans_snapshot_find(&s, "e") == 1);
+    kmeans_snapshot_unmap(&s);
+}
+
+TEST(empty_snapshot) {
+    write_fleet(PATH, 0);
+    kmeans_snapshot_t s;
+    assert(kmeans_snapshot_map(&s, PATH));
+    assert(s.count == 0);
+    assert(kmeans_snapshot_find(&s, "motor_0000") == -1);
+    kmeans_snapshot_unmap(&s);
+}
+
+// Header damage and truncation are caught on open
+TEST(damaged_files_rejected) {
+    write_fleet(PATH, 3);
+    size_t size = KMEANS_SNAPSHOT_HEADER_SIZE + 3 * KMEANS_SNAPSHOT_RECORD_SIZE(K, D);
+    uint64_t* buf = malloc(size + 8);
+    FILE* fp = fopen(PATH, "rb");
+    assert(fread(buf, 1, size, fp) == size);
+    fclose(fp);
+
+    kmeans_snapshot_t s;
+    assert(kmeans_snapshot_open(&s, buf, size));
+    assert(kmeans_snapshot_find(&s, "motor_0002") == 2);
+
+    uint8_t* bytes = (uint8_t*)buf;
+    for (size_t i = 0; i < KMEANS_SNAPSHOT_HEADER_SIZE; i++) {
+        bytes[i] ^= 0x01;
+        assert(!kmeans_snapshot_open(&s, buf, size));
+        bytes[i] ^= 0x01;
+    }
+    assert(!kmeans_snapshot_open(&s, buf, size - 1));
+    assert(!kmeans_snapshot_open(&s, buf, KMEANS_SNAPSHOT_HEADER_SIZE - 1));
+    memmove(bytes + 4, bytes, size);
+    assert(!kmeans_snapshot_open(&s, bytes + 4, size));  // Misaligned
+    free(buf);
+
+    assert(!kmeans_snapshot_map(&s, "/tmp/test_snapshot_missing.bin"));
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf("Model Snapshot Tests\n");
+    printf("========================================\n\n");
+
+    RUN_TEST(views_match_fleet);
+    RUN_TEST(unknown_ids);
+    RUN_TEST(writer_rejects_bad_input);
+    RUN_TEST(empty_snapshot);
+    RUN_TEST(damaged_files_rejected);
+
+    unlink(PATH);
+    printf("\n========================================\n");
+    printf("All tests passed!\n");
+    printf("========================================\n");
+    return 0;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file test_state.c
+ * @brief Runtime state snapshot: serialize, restore, continue identically
+ */
+
+#include "../streaming_kmeans.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define K MAX_CLUSTERS          // kmeans_init() layout
+#define D 3
+#define CAP RING_BUFFER_SIZE
+
+static uint8_t state[KMEANS_STATE_MAX_SIZE(K, D, CAP)];
+static uint32_t rng = 1;
+
+static fixed_t noise(fixed_t span) {
+    rng = 1103515245u * rng + 12345u;
+    return (fixed_t)((rng >> 8) % (uint32_t)(2 * span + 1)) - span;
+}
+
+static void point(fixed_t* p, float center) {
+    for (int d = 0; d < D; d++) p[d] = FLOAT_TO_FIXED(center + d) + noise(FLOAT_TO_FIXED(0.1f));
+}
+
+// Live rows oldest first, as the model will evict them
+static void rows_in_order(const kmeans_model_t* m, fixed_t* out) {
+    uint16_t row = (uint16_t)((m->buffer.head + m->buffer.capacity - m->buffer.count) % m->buffer.capacity);
+    for (uint16_t r = 0; r < m->buffer.count; r++) {
+        memcpy(out + r * D, m->buffer.samples + row * D, D * sizeof(fixed_t));
+        row = (uint16_t)((row + 1) % m->buffer.capacity);
+    }
+}
+
+static void assert_same(const kmeans_model_t* a, const kmeans_model_t* b) {
+    assert(a->k == b->k && a->state == b->state && a->total_points == b->total_points);
+    assert(a->learning_rate == b->learning_rate && a->alpha_schedule == b->alpha_schedule);
+    assert(a->outlier_threshold == b->outlier_threshold && a->last_distance == b->last_distance);
+    assert(a->alarm_active == b->alarm_active && a->waiting_label == b->waiting_label);
+    assert(a->alarm_sample_count == b->alarm_sample_count && a->normal_streak == b->normal_streak);
+    assert(a->idle_count == b->idle_count && a->motor_running == b->motor_running);
+    assert(a->last_rms == b->last_rms && a->last_current == b->last_current);
+    for (uint8_t i = 0; i < a->k; i++) {
+        fixed_t ca[D], cb[D];
+        kmeans_get_centroid(a, i, ca);
+        kmeans_get_centroid(b, i, cb);
+        assert(memcmp(ca, cb, sizeof(ca)) == 0);
+        assert(a->clusters[i].count == b->clusters[i].count);
+        assert(a->clusters[i].inertia == b->clusters[i].inertia);
+        assert(a->clusters[i].active == b->clusters[i].active);
+        assert(strcmp(a->labels[i], b->labels[i]) == 0);
+    }
+    assert(a->buffer.count == b->buffer.count && a->buffer.frozen == b->buffer.frozen);
+    static fixed_t ra[CAP * D], rb[CAP * D];
+    rows_in_order(a, ra);
+    rows_in_order(b, rb);
+    assert(memcmp(ra, rb, (size_t)a->buffer.count * D * sizeof(fixed_t)) == 0);
+    for (int d = 0; d < D; d++) {
+        assert(a->buffer.sum[d] == b->buffer.sum[d] && a->buffer.sum_sq[d] == b->buffer.sum_sq[d]);
+    }
+}
+
+static void round_trip(const kmeans_model_t* from, kmeans_model_t* to) {
+    size_t n = kmeans_serialize(from, state, sizeof(state));
+    assert(n == kmeans_state_size(from));
+    assert(kmeans_deserialize(to, state, n));
+    assert_same(from, to);
+}
+
+// Reboot while waiting for a label: the anomaly window survives and the
+// label lands exactly as it would have without the restart
+TEST(waiting_label_survives) {
+    kmeans_model_t live, restored;
+    assert(kmeans_init(&live, D, 0.2f));
+    fixed_t p[D];
+    for (int i = 0; i < 200; i++) {
+        point(p, 1.0f);
+        kmeans_update(&live, p);
+    }
+    for (int i = 0; i < IDLE_CONSECUTIVE_SAMPLES; i++) kmeans_update_motor_status(&live, 0, 0);
+    point(p, 8.0f);
+    kmeans_update(&live, p);
+    assert(live.state == STATE_WAITING_LABEL && live.buffer.frozen);
+    assert(live.buffer.count == CAP);  // Wrapped ring
+
+    assert(kmeans_init(&restored, D, 0.2f));
+    round_trip(&live, &restored);
+
+    assert(kmeans_add_cluster(&live, "bearing"));
+    assert(kmeans_add_cluster(&restored, "bearing"));
+    assert_same(&live, &restored);
+}
+
+// Restored mid-stream, both models agree on every later sample: ring order,
+// sums, alarm counters and motor hysteresis all carried over
+TEST(continues_identically) {
+    uint32_t steps[] = {0, 10, BOOTSTRAP_SAMPLES + 5, 130, 400};
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        kmeans_model_t live, restored;
+        assert(kmeans_init(&live, D, 0.2f));
+        rng = 7;
+        fixed_t p[D];
+        for (uint32_t i = 0; i < steps[s]; i++) {
+            point(p, i % 50 < 45 ? 1.0f : 4.0f);
+            kmeans_update_motor_status(&live, FLOAT_TO_FIXED(i % 97 < 90 ? 3.0f : 1.0f), 0);
+            kmeans_update(&live, p);
+            if (live.state == STATE_WAITING_LABEL) kmeans_discard(&live);
+        }
+
+        assert(kmeans_init(&restored, D, 0.2f));
+        round_trip(&live, &restored);
+        for (uint32_t i = 0; i < 300; i++) {
+            point(p, i % 40 < 34 ? 1.0f : 5.0f);
+            fixed_t rms = FLOAT_TO_FIXED(i % 61 < 50 ? 3.0f : 1.0f);
+            kmeans_update_motor_status(&live, rms, 0);
+            kmeans_update_motor_status(&restored, rms, 0);
+            assert(kmeans_update(&live, p) == kmeans_update(&restored, p));
+            if (live.state == STATE_WAITING_LABEL) {
+                assert(kmeans_add_cluster(&live, "x") == kmeans_add_cluster(&restored, "x"));
+            }
+        }
+        assert_same(&live, &restored);
+    }
+}
+
+// Only live rows travel: a fresh model is a few dozen bytes
+TEST(compact) {
+    kmeans_model_t m;
+    assert(kmeans_init(&m, D, 0.2f));
+    size_t empty = kmeans_state_size(&m);
+    assert(empty == KMEANS_STATE_HEADER_SIZE + 4);
+
+    fixed_t p[D];
+    for (int i = 0; i < 10; i++) {
+        point(p, 1.0f);
+        kmeans_update(&m, p);
+    }
+    assert(kmeans_state_size(&m) == empty + 10 * D * 4);
+    for (int i = 0; i < 500; i++) {
+        point(p, 1.0f);
+        kmeans_update(&m, p);
+    }
+    printf(" [K=%d, %d rows: %zu B, max %zu B]", m.k, m.buffer.count, kmeans_state_size(&m),
+           (size_t)KMEANS_STATE_MAX_SIZE(K, D, CAP));
+    assert(kmeans_state_size(&m) <= KMEANS_STATE_MAX_SIZE(K, D, CAP));
+    assert(kmeans_serialize(&m, state, kmeans_state_size(&m) - 1) == 0);
+}
+
+// Every truncation, every flipped byte and every mismatched target is
+// refused, with the target left as it was
+TEST(rejects_bad_input) {
+    kmeans_model_t m, target;
+    assert(kmeans_init(&m, D, 0.2f));
+    fixed_t p[D];
+    for (int i = 0; i < 120; i++) {
+        point(p, 2.0f);
+        kmeans_update(&m, p);
+    }
+    size_t n = kmeans_serialize(&m, state, sizeof(state));
+    assert(n > 0);
+
+    assert(kmeans_init(&target, D, 0.2f));
+    target.total_points = 1234;
+    for (size_t len = 0; len < n; len++) assert(!kmeans_deserialize(&target, state, len));
+    for (size_t i = 0; i < n; i++) {
+        state[i] ^= 0x40;
+        assert(!kmeans_deserialize(&target, state, n));
+        state[i] ^= 0x40;
+    }
+    assert(target.total_points == 1234 && target.k == 0);
+
+    // Other dimension, fewer clusters, smaller ring
+    static uint64_t other[KMEANS_STORAGE_SIZE(K, D + 1, CAP) / 8];
+    kmeans_model_t wrong;
+    assert(kmeans_init(&wrong, D + 1, 0.2f));
+    assert(!kmeans_deserialize(&wrong, state, n));
+    assert(kmeans_init_with_storage(&wrong, D, 0.2f, 1, CAP, other, sizeof(other)));
+    m.k = 2;  // More clusters than the target holds
+    n = kmeans_serialize(&m, state, sizeof(state));
+    assert(!kmeans_deserialize(&wrong, state, n));
+    assert(kmeans_init_with_storage(&wrong, D, 0.2f, K, BOOTSTRAP_SAMPLES, other, sizeof(other)));
+    assert(m.buffer.count > BOOTSTRAP_SAMPLES);
+    assert(!kmeans_deserialize(&wrong, state, n));
+    assert(kmeans_deserialize(&target, state, n));
+}
+
+int main() {
+    printf("\n========================================\n");
+    printf("Runtime State Tests\n");
+    printf("========================================\n\n");
+
+    RUN_TEST(waiting_label_survives);
+    RUN_TEST(continues_identically);
+    RUN_TEST(compact);
+    RUN_TEST(rejects_bad_input);
+
+    printf("\n========================================\n");
+    printf("All tests passed!\n");
+    printf("========================================\n");
+    return 0;
+}
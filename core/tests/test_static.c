@@ -0,0 +1,121 @@
+/**
+ * @file test_static.c
+ * @brief KMEANS_DEFINE(D) variants must behave exactly like the dynamic API
+ */
+
+#include "../kmeans_static.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+KMEANS_DEFINE(3)
+KMEANS_DEFINE(7)
+KMEANS_DEFINE(10)
+
+#define N 3000
+#define MAX_D 10
+
+static uint64_t dyn_storage[KMEANS_STORAGE_SIZE(KMEANS_STATIC_CLUSTERS, MAX_D, KMEANS_STATIC_BUFFER) / 8];
+static fixed_t points[N * MAX_D];
+
+// Baseline with two kinds of fault bursts at different levels
+static void make_stream(uint8_t dim) {
+    uint32_t rng = 42;
+    for (int i = 0; i < N; i++) {
+        float base = 1.0f;
+        if (i % 500 >= 300 && i % 500 < 380) base = (i / 500) % 2 ? 6.0f : 12.0f;
+        for (int d = 0; d < dim; d++) {
+            rng = 1103515245u * rng + 12345u;
+            points[i * dim + d] = FLOAT_TO_FIXED(base) + (fixed_t)((rng >> 8) % 13108) - 6554;
+        }
+    }
+}
+
+static void init_dynamic(kmeans_model_t* model, uint8_t dim) {
+    assert(kmeans_init_with_storage(model, dim, 0.2f, KMEANS_STATIC_CLUSTERS, KMEANS_STATIC_BUFFER,
+                                    dyn_storage, sizeof(dyn_storage)));
+}
+
+static void assert_same(const kmeans_model_t* a, const kmeans_model_t* b) {
+    assert(a->k == b->k);
+    assert(a->state == b->state);
+    assert(a->total_points == b->total_points);
+    assert(a->last_distance == b->last_distance);
+    assert(a->buffer.count == b->buffer.count);
+    for (uint8_t c = 0; c < a->k; c++) {
+        fixed_t ca[MAX_D], cb[MAX_D];
+        kmeans_get_centroid(a, c, ca);
+        kmeans_get_centroid(b, c, cb);
+        assert(memcmp(ca, cb, a->feature_dim * sizeof(fixed_t)) == 0);
+        assert(a->clusters[c].count == b->clusters[c].count);
+        assert(a->clusters[c].inertia == b->clusters[c].inertia);
+    }
+}
+
+// Drives both models through alarms and labeling; labels each freeze
+#define RUN_SAME(D) do { \
+    static kmeans_d##D##_t s; \
+    kmeans_model_t dyn; \
+    make_stream(D); \
+    assert(kmeans_d##D##_init(&s, 0.2f)); \
+    init_dynamic(&dyn, D); \
+    int labels = 0; \
+    for (int i = 0; i < N; i++) { \
+        const fixed_t* p = &points[i * D]; \
+        bool stopped = (i % 500 >= 320 && i % 500 < 380); \
+        fixed_t rms = stopped ? 0 : FLOAT_TO_FIXED(5.0f); \
+        kmeans_update_motor_status(kmeans_d##D##_model(&s), rms, 0); \
+        kmeans_update_motor_status(&dyn, rms, 0); \
+        assert(kmeans_d##D##_update(&s, p) == kmeans_update(&dyn, p)); \
+        assert(kmeans_d##D##_predict(&s, p) == kmeans_predict(&dyn, p)); \
+        if (dyn.state == STATE_WAITING_LABEL) { \
+            char name[16]; \
+            snprintf(name, sizeof(name), "fault_%d", labels++); \
+            assert(kmeans_add_cluster(kmeans_d##D##_model(&s), name) == kmeans_add_cluster(&dyn, name)); \
+        } \
+        assert_same(kmeans_d##D##_model(&s), &dyn); \
+    } \
+    assert(labels > 0 && dyn.k > 1); \
+} while (0)
+
+TEST(matches_dynamic_3d) { RUN_SAME(3); }
+TEST(matches_dynamic_7d) { RUN_SAME(7); }
+TEST(matches_dynamic_10d) { RUN_SAME(10); }
+
+TEST(struct_sizes) {
+    // Storage embedded at the exact shape
+    assert(sizeof(kmeans_d3_t) < sizeof(kmeans_d7_t));
+    assert(sizeof(kmeans_d7_t) < sizeof(kmeans_d10_t));
+    assert(sizeof(kmeans_d3_t) == KMEANS_MODEL_HEADER_SIZE +
+           KMEANS_STORAGE_SIZE(KMEANS_STATIC_CLUSTERS, 3, KMEANS_STATIC_BUFFER));
+    printf(" (d3 %zu B, d7 %zu B, d10 %zu B)", sizeof(kmeans_d3_t), sizeof(kmeans_d7_t),
+           sizeof(kmeans_d10_t));
+}
+
+TEST(uninitialized) {
+    static kmeans_d3_t s;  // Zeroed, never initialized
+    fixed_t p[3] = {0, 0, 0};
+    assert(kmeans_d3_update(&s, p) == -1);
+    assert(kmeans_d3_predict(&s, p) == 0);
+}
+
+int main() {
+    printf("=== Static (KMEANS_DEFINE) Tests ===\n");
+
+    RUN_TEST(matches_dynamic_3d);
+    RUN_TEST(matches_dynamic_7d);
+    RUN_TEST(matches_dynamic_10d);
+    RUN_TEST(struct_sizes);
+    RUN_TEST(uninitialized);
+
+    printf("\n=== All Tests Passed ===\n");
+    return 0;
+}
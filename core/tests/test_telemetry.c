@@ -0,0 +1,233 @@
+/**
+ * @file test_telemetry.c
+ * @brief Binary telemetry: round trips, CRC/corruption handling, batching
+ */
+
+#include "../telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+static mqtt_summary_t sample_summary(void) {
+    mqtt_summary_t s = {
+        .device_id = "motor_01", .state = "ALARM",
+        .alarm_active = true, .waiting_label = false, .motor_running = true,
+        .cluster = -1, .label = "bearing_outer", .k = 3, .total_points = 12500,
+        .vib_rms_avg = 5.2f, .vib_rms_max = 6.125f, .vib_peak_max = 9.1f, .vib_crest_avg = 1.75f,
+        .has_current = true, .current_rms_avg = 2.3f, .current_rms_max = -0.5f,
+        .baseline = 9.81f, .buffer_samples = 40, .sample_count = 100, .timestamp = 4000000000u,
+    };
+    return s;
+}
+
+static int near(float a, float b) {
+    return fabsf(a - b) <= 0.0005f + 1e-6f * fabsf(b);
+}
+
+TEST(summary_round_trip) {
+    mqtt_summary_t s = sample_summary();
+    uint8_t buf[128];
+    size_t len = telemetry_encode_summary(&s, 77, buf, sizeof(buf));
+    assert(len > TELEMETRY_OVERHEAD && len < 64);  // vs ~360 bytes of JSON
+
+    telemetry_header_t h;
+    size_t frame_len;
+    assert(telemetry_check(buf, len, &h, &frame_len));
+    assert(frame_len == len && h.type == TELEMETRY_SUMMARY && h.seq == 77);
+    assert(h.decimals == TELEMETRY_DECIMALS);
+
+    mqtt_summary_t d;
+    char label[MQTT_LABEL_MAX];
+    assert(telemetry_decode_summary(buf, len, &d, label));
+    assert(d.device_id == NULL);
+    assert(strcmp(d.state, "ALARM") == 0 && strcmp(d.label, "bearing_outer") == 0);
+    assert(d.alarm_active && !d.waiting_label && d.motor_running && d.has_current);
+    assert(d.cluster == -1 && d.k == 3 && d.total_points == 12500);
+    assert(d.buffer_samples == 40 && d.sample_count == 100 && d.timestamp == 4000000000u);
+    assert(near(d.vib_rms_avg, 5.2f) && near(d.vib_rms_max, 6.125f));
+    assert(near(d.vib_peak_max, 9.1f) && near(d.vib_crest_avg, 1.75f));
+    assert(near(d.current_rms_avg, 2.3f) && near(d.current_rms_max, -0.5f));
+    assert(near(d.baseline, 9.81f));
+
+    // Decoded summary re-encodes to the JSON data topic
+    d.device_id = "motor_01";
+    char json[512];
+    assert(mqtt_encode_summary(&d, json, sizeof(json)) > 0);
+    assert(strstr(json, "\"vib_rms_max\":6.125,") && strstr(json, "\"current_rms_max\":-0.5,"));
+}
+
+TEST(summary_variants) {
+    mqtt_summary_t s = sample_summary();
+    s.has_current = false;
+    s.state = "SOMETHING_NEW";
+    s.label = NULL;
+    s.vib_crest_avg = NAN;
+    s.vib_rms_max = 1e12f;  // Saturates
+    uint8_t buf[128];
+    size_t len = telemetry_encode_summary(&s, 0, buf, sizeof(buf));
+    assert(len > 0);
+
+    mqtt_summary_t d;
+    char label[MQTT_LABEL_MAX];
+    assert(telemetry_decode_summary(buf, len, &d, label));
+    assert(!d.has_current && d.current_rms_avg == 0);
+    assert(strcmp(d.state, "UNKNOWN") == 0 && strcmp(d.label, "") == 0);
+    assert(isnan(d.vib_crest_avg));
+    assert(d.vib_rms_max > 2.1e6f);
+
+    // Too small a buffer: nothing usable, no overrun
+    uint8_t small[40];
+    memset(small, 0xAA, sizeof(small));
+    assert(telemetry_encode_summary(&s, 0, small, 20) == 0);
+    for (size_t i = 20; i < sizeof(small); i++) assert(small[i] == 0xAA);
+}
+
+TEST(every_bit_flip_detected) {
+    mqtt_summary_t s = sample_summary();
+    uint8_t buf[128];
+    size_t len = telemetry_encode_summary(&s, 1, buf, sizeof(buf));
+    for (size_t byte = 0; byte < len; byte++) {
+        for (int bit = 0; bit < 8; bit++) {
+            buf[byte] ^= (uint8_t)(1 << bit);
+            mqtt_summary_t d;
+            char label[MQTT_LABEL_MAX];
+            assert(!telemetry_decode_summary(buf, len, &d, label));
+            buf[byte] ^= (uint8_t)(1 << bit);
+        }
+    }
+    // Truncation at any point is rejected as well
+    for (size_t cut = 0; cut < len; cut++) assert(!telemetry_check(buf, cut, NULL, NULL));
+    assert(telemetry_check(buf, len, NULL, NULL));
+}
+
+TEST(crc16_reference) {
+    // CRC-16/CCITT-FALSE check value
+    assert(telemetry_crc16((const uint8_t*)"123456789", 9) == 0x29B1);
+}
+
+TEST(feature_batch_round_trip) {
+    static uint8_t buf[2048];
+    telemetry_batch_t b;
+    assert(telemetry_batch_begin(&b, buf, sizeof(buf), 7, 500));
+
+    float ref[50][7];
+    uint32_t t = 0xFFFFFF00u;  // Crosses the millis() wrap
+    for (int i = 0; i < 50; i++) {
+        for (int f = 0; f < 7; f++) ref[i][f] = 9.81f * (f == 6) + 0.5f * sinf(i * 0.2f + f) - f;
+        if (i == 10) ref[i][2] = NAN;
+        if (i == 11) ref[i][3] = 3e9f;
+        assert(telemetry_batch_add(&b, t, i % 4 - 1, 0.01f * i, ref[i]));
+        t += 100;
+    }
+    size_t len = telemetry_batch_finish(&b);
+    assert(len > 0);
+    // ~7 deltas of 1-3 bytes per vector, against ~150 bytes of JSON each
+    assert(len < 50 * 25);
+
+    telemetry_reader_t r;
+    telemetry_vector_t v;
+    assert(telemetry_features_begin(&r, buf, len));
+    assert(r.dim == 7 && r.count == 50);
+    t = 0xFFFFFF00u;
+    for (int i = 0; i < 50; i++) {
+        assert(telemetry_features_next(&r, &v));
+        assert(v.timestamp == t);
+        t += 100;
+        assert(v.cluster == i % 4 - 1);
+        assert(near(v.distance, 0.01f * i));
+        for (int f = 0; f < 7; f++) {
+            if (i == 10 && f == 2) assert(isnan(v.features[f]));
+            else if (i == 11 && f == 3) assert(v.features[f] > 2.1e6f);  // Saturated
+            else assert(near(v.features[f], ref[i][f]));
+        }
+    }
+    assert(!telemetry_features_next(&r, &v));
+
+    // Not a summary
+    mqtt_summary_t s;
+    char label[MQTT_LABEL_MAX];
+    assert(!telemetry_decode_summary(buf, len, &s, label));
+}
+
+TEST(batch_fills_without_corruption) {
+    uint8_t buf[100];
+    telemetry_batch_t b;
+    assert(!telemetry_batch_begin(&b, buf, sizeof(buf), 0, 0));
+    assert(!telemetry_batch_begin(&b, buf, sizeof(buf), TELEMETRY_MAX_DIM + 1, 0));
+    assert(telemetry_batch_begin(&b, buf, sizeof(buf), 3, 9));
+    assert(telemetry_batch_finish(&b) == 0);  // Empty
+
+    float x[3] = {100.0f, -200.0f, 300.0f};
+    int added = 0;
+    while (telemetry_batch_add(&b, 1000u * added, 0, 1.0f, x)) {
+        added++;
+        x[0] += 1000.0f;  // Big deltas: several bytes each
+    }
+    assert(added > 1);
+    size_t len = telemetry_batch_finish(&b);
+    assert(len > 0 && len <= sizeof(buf));
+
+    telemetry_reader_t r;
+    telemetry_vector_t v;
+    assert(telemetry_features_begin(&r, buf, len) && r.count == added);
+    for (int i = 0; i < added; i++) {
+        assert(telemetry_features_next(&r, &v));
+        assert(near(v.features[0], 100.0f + 1000.0f * i));
+    }
+}
+
+TEST(stream_of_frames) {
+    // Back-to-back frames with junk in between, as a capture file would hold
+    static uint8_t stream[1024];
+    size_t n = 0;
+    mqtt_summary_t s = sample_summary();
+    n += telemetry_encode_summary(&s, 1, stream + n, sizeof(stream) - n);
+    memcpy(stream + n, "\xB7\x01junk", 6);
+    n += 6;
+    telemetry_batch_t b;
+    assert(telemetry_batch_begin(&b, stream + n, sizeof(stream) - n, 3, 2));
+    float x[3] = {1, 2, 3};
+    for (int i = 0; i < 5; i++) assert(telemetry_batch_add(&b, i * 10u, 0, 0, x));
+    n += telemetry_batch_finish(&b);
+    n += telemetry_encode_summary(&s, 3, stream + n, sizeof(stream) - n);
+
+    int found = 0, skipped = 0;
+    uint16_t seqs[3];
+    for (size_t off = 0; off < n; ) {
+        telemetry_header_t h;
+        size_t len;
+        if (!telemetry_check(stream + off, n - off, &h, &len)) {
+            off++;
+            skipped++;
+            continue;
+        }
+        seqs[found++] = h.seq;
+        off += len;
+    }
+    assert(found == 3 && skipped == 6);
+    assert(seqs[0] == 1 && seqs[1] == 2 && seqs[2] == 3);
+}
+
+int main() {
+    printf("\n=== Binary Telemetry Tests ===\n\n");
+
+    RUN_TEST(summary_round_trip);
+    RUN_TEST(summary_variants);
+    RUN_TEST(every_bit_flip_detected);
+    RUN_TEST(crc16_reference);
+    RUN_TEST(feature_batch_round_trip);
+    RUN_TEST(batch_fills_without_corruption);
+    RUN_TEST(stream_of_frames);
+
+    printf("\n✓ All telemetry tests passed\n\n");
+    return 0;
+}
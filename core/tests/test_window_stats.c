@@ -0,0 +1,163 @@
+/**
+ * @file test_window_stats.c
+ * @brief Incremental per-feature window summaries vs brute-force rescans
+ */
+
+#include "../window_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    printf("Running %s...", #name); \
+    test_##name(); \
+    printf(" PASS\n"); \
+} while(0)
+
+#define MAX_D 10
+#define MAX_W 128
+#define LEN 20000
+
+static uint64_t storage[WINDOW_STATS_STORAGE_SIZE(MAX_D, MAX_W) / 8];
+static float history[LEN][MAX_D];
+
+typedef struct {
+    double sum, mean, var, min, max;
+} ref_t;
+
+// Feature f over the last min(len, w) rows
+static ref_t brute_force(int len, int w, int f) {
+    int n = len < w ? len : w;
+    ref_t r = {0, 0, 0, 1e30, -1e30};
+    for (int i = len - n; i < len; i++) {
+        double x = history[i][f];
+        r.sum += x;
+        if (x < r.min) r.min = x;
+        if (x > r.max) r.max = x;
+    }
+    r.mean = r.sum / n;
+    for (int i = len - n; i < len; i++) {
+        double d = history[i][f] - r.mean;
+        r.var += d * d;
+    }
+    r.var /= n;
+    return r;
+}
+
+static int close_to(double got, double want, double rel, double abs_tol) {
+    return fabs(got - want) <= abs_tol + rel * fabs(want);
+}
+
+static void check_stream(int d, int w, int len) {
+    window_stats_t ws;
+    assert(window_stats_init(&ws, d, w, storage, sizeof(storage)));
+    for (int i = 0; i < len; i++) {
+        window_stats_push(&ws, history[i]);
+        assert(window_stats_count(&ws) == (i + 1 < w ? i + 1 : w));
+        for (int f = 0; f < d; f++) {
+            ref_t r = brute_force(i + 1, w, f);
+            double scale = sqrt(r.var) + 1e-3;
+            assert(window_stats_max(&ws, f) == (float)r.max);  // Exact
+            assert(window_stats_min(&ws, f) == (float)r.min);
+            assert(close_to(window_stats_mean(&ws, f), r.mean, 1e-5, 1e-4 * scale));
+            assert(close_to(window_stats_sum(&ws, f), r.sum, 1e-5, 1e-3 * scale * w));
+            assert(close_to(window_stats_variance(&ws, f), r.var, 2e-3, 1e-6));
+        }
+    }
+}
+
+TEST(init_validation) {
+    window_stats_t ws;
+    assert(!window_stats_init(&ws, 0, 10, storage, sizeof(storage)));
+    assert(!window_stats_init(&ws, 3, 0, storage, sizeof(storage)));
+    assert(!window_stats_init(&ws, 3, 10, NULL, sizeof(storage)));
+    assert(!window_stats_init(&ws, 3, 10, storage, WINDOW_STATS_STORAGE_SIZE(3, 10) - 1));
+    assert(!window_stats_init(&ws, 3, 10, (uint8_t*)storage + 1, sizeof(storage) - 8));
+    assert(window_stats_init(&ws, 3, 10, storage, WINDOW_STATS_STORAGE_SIZE(3, 10)));
+    assert(window_stats_count(&ws) == 0);
+    assert(window_stats_mean(&ws, 0) == 0 && window_stats_max(&ws, 2) == 0);
+    assert(window_stats_variance(&ws, 1) == 0);
+}
+
+TEST(feature_vectors) {
+    // Mixed scales like [rms, peak, crest, ..., current]: small AC, offsets
+    srand(11);
+    for (int i = 0; i < LEN; i++) {
+        for (int f = 0; f < MAX_D; f++) {
+            double u = (double)rand() / RAND_MAX;
+            history[i][f] = (float)(f * 3.0 + (f + 1) * 0.1 * u + ((rand() % 200) == 0 ? 5.0 : 0.0));
+        }
+    }
+    check_stream(3, 100, LEN);
+    check_stream(MAX_D, 100, 5000);
+    check_stream(7, 17, 5000);
+    check_stream(MAX_D, MAX_W, 3000);
+}
+
+TEST(monotonic_and_ties) {
+    for (int i = 0; i < 1000; i++) {
+        history[i][0] = (float)i;               // Rising
+        history[i][1] = (float)(1000 - i);      // Falling
+        history[i][2] = (float)((i / 7) % 3);   // Runs of equal values
+    }
+    check_stream(3, 32, 1000);
+}
+
+TEST(partial_window) {
+    // Before wraparound every pushed row counts, not just the last few
+    window_stats_t ws;
+    assert(window_stats_init(&ws, 1, 100, storage, sizeof(storage)));
+    float x;
+    for (int i = 1; i <= 30; i++) {
+        x = (float)i;
+        window_stats_push(&ws, &x);
+    }
+    assert(window_stats_count(&ws) == 30);
+    assert(window_stats_sum(&ws, 0) == 465.0f);
+    assert(window_stats_mean(&ws, 0) == 15.5f);
+    assert(window_stats_min(&ws, 0) == 1.0f && window_stats_max(&ws, 0) == 30.0f);
+}
+
+TEST(wraparound_covers_whole_window) {
+    // 130 rows into a 100-row window: stats span rows 30..129, all 100 of them
+    window_stats_t ws;
+    assert(window_stats_init(&ws, 1, 100, storage, sizeof(storage)));
+    float x;
+    for (int i = 0; i < 130; i++) {
+        x = (float)i;
+        window_stats_push(&ws, &x);
+    }
+    assert(window_stats_count(&ws) == 100);
+    assert(window_stats_min(&ws, 0) == 30.0f && window_stats_max(&ws, 0) == 129.0f);
+    assert(fabsf(window_stats_mean(&ws, 0) - 79.5f) < 1e-4f);
+    assert(fabsf(window_stats_variance(&ws, 0) - 833.25f) < 0.05f);
+}
+
+TEST(reset_clears_window) {
+    window_stats_t ws;
+    assert(window_stats_init(&ws, 2, 8, storage, sizeof(storage)));
+    float row[2] = {100, -100};
+    for (int i = 0; i < 20; i++) window_stats_push(&ws, row);
+    window_stats_reset(&ws);
+    row[0] = 1; row[1] = 2;
+    window_stats_push(&ws, row);
+    assert(window_stats_count(&ws) == 1);
+    assert(window_stats_max(&ws, 0) == 1.0f && window_stats_min(&ws, 1) == 2.0f);
+    assert(window_stats_mean(&ws, 1) == 2.0f && window_stats_variance(&ws, 0) == 0);
+}
+
+int main() {
+    printf("\n=== Window Stats Tests ===\n\n");
+
+    RUN_TEST(init_validation);
+    RUN_TEST(feature_vectors);
+    RUN_TEST(monotonic_and_ties);
+    RUN_TEST(partial_window);
+    RUN_TEST(wraparound_covers_whole_window);
+    RUN_TEST(reset_clears_window);
+
+    printf("\n✓ All window stats tests passed\n\n");
+    return 0;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file window_stats.h
+ * @brief Per-feature sum/mean/variance/min/max over the last N vectors (header-only)
+ *
+ * Each push adds the new row and evicts the oldest once the window is full,
+ * so a summary of any feature is O(1) and a full summary is O(D), with no
+ * rescan of the window at publish time:
+ *   - shifted sums S1, S2 of (x - shift) per feature -> sum, mean, variance
+ *   - two monotonic deques of window positions per feature -> min, max
+ *
+ * As in sliding_stats.h, the sums are rebuilt around the current mean once
+ * per `capacity` pushes (O(N*D) per N pushes, O(D) amortized), and right
+ * away when an evicted row leaves mostly rounding error in S2.
+ *
+ * All arrays live in one caller buffer of WINDOW_STATS_STORAGE_SIZE(dim,
+ * capacity) bytes, the same way kmeans_init_with_storage() binds a model.
+ */
+
+#ifndef WINDOW_STATS_H
+#define WINDOW_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    float shift;
+    float s1, s2;         // Sums of (x - shift)^1, ^2
+    uint16_t max_head, max_len;
+    uint16_t min_head, min_len;
+} window_feature_t;
+
+typedef struct {
+    float* values;              // capacity rows x dim, circular
+    window_feature_t* features; // dim
+    uint16_t* max_q;            // dim deques of capacity positions
+    uint16_t* min_q;
+    uint16_t dim;
+    uint16_t capacity;
+    uint16_t next;              // Row written by the next push
+    uint16_t count;
+    uint16_t since_resync;
+} window_stats_t;
+
+#define WINDOW_STATS_STORAGE_SIZE(dim, capacity) \
+    ((((size_t)(capacity) * (dim) * sizeof(float) + \
+       (size_t)(dim) * sizeof(window_feature_t) + \
+       2 * (size_t)(dim) * (capacity) * sizeof(uint16_t)) + 7) & ~(size_t)7)
+
+static inline void window_stats_reset(window_stats_t* ws) {
+    ws->next = 0;
+    ws->count = 0;
+    ws->since_resync = 0;
+    for (uint16_t f = 0; f < ws->dim; f++) {
+        window_feature_t* wf = &ws->features[f];
+        wf->shift = wf->s1 = wf->s2 = 0;
+        wf->max_head = wf->max_len = wf->min_head = wf->min_len = 0;
+    }
+}
+
+static inline bool window_stats_init(window_stats_t* ws, uint16_t dim, uint16_t capacity,
+                                     void* storage, size_t storage_bytes) {
+    if (!ws || !storage || dim == 0 || capacity == 0) return false;
+    if (storage_bytes < WINDOW_STATS_STORAGE_SIZE(dim, capacity)) return false;
+    if (((uintptr_t)storage & 3) != 0) return false;
+
+    uint8_t* p = (uint8_t*)storage;
+    ws->values = (float*)p;
+    p += (size_t)capacity * dim * sizeof(float);
+    ws->features = (window_feature_t*)p;
+    p += (size_t)dim * sizeof(window_feature_t);
+    ws->max_q = (uint16_t*)p;
+    p += (size_t)dim * capacity * sizeof(uint16_t);
+    ws->min_q = (uint16_t*)p;
+
+    ws->dim = dim;
+    ws->capacity = capacity;
+    window_stats_reset(ws);
+    return true;
+}
+
+static inline float window_stats_value_(const window_stats_t* ws, uint16_t pos, uint16_t f) {
+    return ws->values[(size_t)pos * ws->dim + f];
+}
+
+static inline void window_stats_resync_(window_stats_t* ws) {
+    uint16_t n = ws->count;
+    for (uint16_t f = 0; f < ws->dim; f++) {
+        window_feature_t* wf = &ws->features[f];
+        float mean = wf->shift + wf->s1 / n;
+        float s1 = 0, s2 = 0;
+        for (uint16_t i = 0; i < n; i++) {
+            float d = window_stats_value_(ws, i, f) - mean;
+            s1 += d;
+            s2 += d * d;
+        }
+        wf->shift = mean;
+        wf->s1 = s1;
+        wf->s2 = s2;
+    }
+    ws->since_resync = 0;
+}
+
+static inline void window_stats_push(window_stats_t* ws, const float* row) {
+    uint16_t pos = ws->next;
+    uint16_t cap = ws->capacity;
+    bool full = ws->count == cap;
+    bool cancelled = false;
+
+    for (uint16_t f = 0; f < ws->dim; f++) {
+        window_feature_t* wf = &ws->features[f];
+        uint16_t* max_q = ws->max_q + (size_t)f * cap;
+        uint16_t* min_q = ws->min_q + (size_t)f * cap;
+        float x = row[f];
+
+        if (full) {
+            // Evict the row being overwritten
+            float d = window_stats_value_(ws, pos, f) - wf->shift;
+            wf->s1 -= d;
+            wf->s2 -= d * d;
+            if (d * d > wf->s2) cancelled = true;
+            if (wf->max_len && max_q[wf->max_head] == pos) {
+                wf->max_head = (uint16_t)((wf->max_head + 1) % cap);
+                wf->max_len--;
+            }
+            if (wf->min_len && min_q[wf->min_head] == pos) {
+                wf->min_head = (uint16_t)((wf->min_head + 1) % cap);
+                wf->min_len--;
+            }
+        } else if (ws->count == 0) {
+            wf->shift = x;
+        }
+
+        ws->values[(size_t)pos * ws->dim + f] = x;
+        float d = x - wf->shift;
+        wf->s1 += d;
+        wf->s2 += d * d;
+
+        // Back entries the new value dominates can never be the extreme again
+        while (wf->max_len) {
+            uint16_t back = (uint16_t)((wf->max_head + wf->max_len - 1) % cap);
+            if (window_stats_value_(ws, max_q[back], f) > x) break;
+            wf->max_len--;
+        }
+        max_q[(wf->max_head + wf->max_len) % cap] = pos;
+        wf->max_len++;
+
+        while (wf->min_len) {
+            uint16_t back = (uint16_t)((wf->min_head + wf->min_len - 1) % cap);
+            if (window_stats_value_(ws, min_q[back], f) < x) break;
+            wf->min_len--;
+        }
+        min_q[(wf->min_head + wf->min_len) % cap] = pos;
+        wf->min_len++;
+    }
+
+    if (!full) ws->count++;
+    ws->next = (uint16_t)((pos + 1) % cap);
+    if (full && (++ws->since_resync >= cap || cancelled)) window_stats_resync_(ws);
+}
+
+static inline uint16_t window_stats_count(const window_stats_t* ws) {
+    return ws->count;
+}
+
+static inline float window_stats_sum(const window_stats_t* ws, uint16_t f) {
+    const window_feature_t* wf = &ws->features[f];
+    return wf->s1 + wf->shift * ws->count;
+}
+
+// 0 for an empty window
+static inline float window_stats_mean(const window_stats_t* ws, uint16_t f) {
+    const window_feature_t* wf = &ws->features[f];
+    return ws->count ? wf->shift + wf->s1 / ws->count : 0.0f;
+}
+
+// Population variance
+static inline float window_stats_variance(const window_stats_t* ws, uint16_t f) {
+    if (ws->count == 0) return 0.0f;
+    const window_feature_t* wf = &ws->features[f];
+    float a = wf->s1 / ws->count;
+    float v = wf->s2 / ws->count - a * a;
+    return v > 0 ? v : 0.0f;
+}
+
+static inline float window_stats_max(const window_stats_t* ws, uint16_t f) {
+    const window_feature_t* wf = &ws->features[f];
+    return wf->max_len ? window_stats_value_(ws, ws->max_q[(size_t)f * ws->capacity + wf->max_head], f)
+                       : 0.0f;
+}
+
+static inline float window_stats_min(const window_stats_t* ws, uint16_t f) {
+    const window_feature_t* wf = &ws->features[f];
+    return wf->min_len ? window_stats_value_(ws, ws->min_q[(size_t)f * ws->capacity + wf->min_head], f)
+                       : 0.0f;
+}
+
+#endif